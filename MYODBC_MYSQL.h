@@ -90,6 +90,7 @@ extern "C"
 #define myodbc_realloc(A,B,C) my_realloc(PSI_NOT_INSTRUMENTED,A,B,C)
 #define myodbc_memdup(A,B,C) my_memdup(PSI_NOT_INSTRUMENTED,A,B,C)
 #define myodbc_strdup(A,B) my_strdup(PSI_NOT_INSTRUMENTED,A,B)
+#define myodbc_strndup(A,B,C) my_strndup(PSI_NOT_INSTRUMENTED,A,B,C)
 #define myodbc_init_dynamic_array(A,B,C,D) my_init_dynamic_array(A,PSI_NOT_INSTRUMENTED,B,NULL,C,D)
 #define myodbc_mutex_lock native_mutex_lock
 #define myodbc_mutex_unlock native_mutex_unlock
@@ -0,0 +1,191 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/*
+  Timing and reporting shared by the benchmarks, to be included after
+  odbctap.h.
+
+  Every measurement is one JSON object on a line, printed as a TAP comment
+  and appended to the file named by BENCH_OUTPUT if it is set:
+
+    {"bench":"fetch_bindcol","column":"INT","ctype":"char","array_size":100,
+     "ops":200,"rows":20000,"seconds":0.0123,"rows_per_sec":1626016,
+     "mb_per_sec":12.5,"p50_us":55.1,"p99_us":80.2,"cpu_us_per_op":50.3}
+*/
+
+#ifndef _BENCH_H
+#define _BENCH_H
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <time.h>
+# include <sys/resource.h>
+#endif
+
+static FILE *bench_output= NULL;
+
+/* Members that go into every line, such as the server the run is against */
+static char bench_common[256]= "";
+
+
+/* Latencies and totals of one measurement */
+typedef struct
+{
+  double    *latency;       /* microseconds */
+  size_t    count, size;
+  long long rows, bytes;
+  double    started, cpu_started, op_started;
+} BENCH;
+
+
+static double now_seconds()
+{
+#ifdef _WIN32
+  LARGE_INTEGER freq, count;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&count);
+  return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+
+static double cpu_seconds()
+{
+#ifdef _WIN32
+  FILETIME created, exited, kernel, user;
+  ULARGE_INTEGER k, u;
+  GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user);
+  k.LowPart= kernel.dwLowDateTime;
+  k.HighPart= kernel.dwHighDateTime;
+  u.LowPart= user.dwLowDateTime;
+  u.HighPart= user.dwHighDateTime;
+  return (k.QuadPart + u.QuadPart) / 1e7;
+#else
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+         ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+#endif
+}
+
+
+static void bench_open_output()
+{
+  if (!bench_output && getenv("BENCH_OUTPUT"))
+    bench_output= fopen(getenv("BENCH_OUTPUT"), "a");
+}
+
+
+static void bench_close_output()
+{
+  if (bench_output)
+  {
+    fclose(bench_output);
+    bench_output= NULL;
+  }
+}
+
+
+static void bench_begin(BENCH *b)
+{
+  memset(b, 0, sizeof(BENCH));
+  b->started= now_seconds();
+  b->cpu_started= cpu_seconds();
+}
+
+
+static void op_begin(BENCH *b)
+{
+  b->op_started= now_seconds();
+}
+
+
+static void op_end(BENCH *b)
+{
+  if (b->count == b->size)
+  {
+    b->size= b->size ? b->size * 2 : 1024;
+    b->latency= (double *)realloc(b->latency, b->size * sizeof(double));
+  }
+  b->latency[b->count++]= (now_seconds() - b->op_started) * 1e6;
+}
+
+
+static int compare_latency(const void *a, const void *b)
+{
+  double x= *(const double *)a, y= *(const double *)b;
+  return x < y ? -1 : x > y;
+}
+
+
+/*
+  Prints the measurement. The parameters are the JSON members that tell
+  it apart from the others of the same benchmark.
+*/
+static void bench_report(BENCH *b, const char *name, const char *params)
+{
+  double seconds= now_seconds() - b->started;
+  double cpu= cpu_seconds() - b->cpu_started;
+  double p50= 0, p99= 0;
+  char   line[1024];
+
+  if (b->count)
+  {
+    qsort(b->latency, b->count, sizeof(double), compare_latency);
+    p50= b->latency[b->count / 2];
+    p99= b->latency[b->count * 99 / 100];
+  }
+
+  sprintf(line, "{\"bench\":\"%s\",%s%s%s%s\"ops\":%lu,\"rows\":%lld,"
+                "\"seconds\":%.4f,\"rows_per_sec\":%.0f,\"mb_per_sec\":%.2f,"
+                "\"p50_us\":%.1f,\"p99_us\":%.1f,\"cpu_us_per_op\":%.1f}",
+          name, bench_common, bench_common[0] ? "," : "",
+          params, params[0] ? "," : "", (unsigned long)b->count,
+          b->rows, seconds, b->rows / seconds,
+          b->bytes / seconds / (1024 * 1024), p50, p99,
+          b->count ? cpu * 1e6 / b->count : 0);
+
+  printMessage("%s", line);
+
+  if (bench_output)
+  {
+    fprintf(bench_output, "%s\n", line);
+    fflush(bench_output);
+  }
+
+  free(b->latency);
+  b->latency= NULL;
+}
+
+#endif /* _BENCH_H */
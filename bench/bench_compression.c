@@ -0,0 +1,200 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+/*
+  Fetches a wide result over each protocol compression setting and reports
+  the throughput together with the driver's compression statistics.
+
+  Run it against a local server the same way as the tests (TEST_DSN,
+  TEST_UID, ... or command line arguments). BENCH_ROWS and BENCH_LOOPS
+  change the size of the run.
+*/
+
+#include "odbctap.h"
+
+#ifndef _WIN32
+# include <time.h>
+#endif
+
+#ifndef SQL_ATTR_MYSQL_COMPRESSION_STATS
+# define SQL_ATTR_MYSQL_COMPRESSION_STATS 0x4001
+#endif
+
+#define BENCH_COLUMNS 16
+#define BENCH_COLUMN_SIZE 256
+
+static int bench_rows= 20000;
+static int bench_loops= 5;
+
+static const struct
+{
+  const char *name;
+  const char *options;
+} settings[]=
+{
+  {"uncompressed", ""},
+  {"legacy-zlib",  "COMPRESSED_PROTO=1"},
+  {"zlib",         "COMPRESSION_ALGORITHMS=zlib"},
+  {"zstd-1",       "COMPRESSION_ALGORITHMS=zstd;ZSTD_COMPRESSION_LEVEL=1"},
+  {"zstd-3",       "COMPRESSION_ALGORITHMS=zstd;ZSTD_COMPRESSION_LEVEL=3"},
+  {"zstd-9",       "COMPRESSION_ALGORITHMS=zstd;ZSTD_COMPRESSION_LEVEL=9"}
+};
+
+
+static double now_seconds()
+{
+#ifdef _WIN32
+  LARGE_INTEGER freq, count;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&count);
+  return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+
+DECLARE_TEST(bench_setup)
+{
+  char query[4096], *pos;
+  int i;
+
+  if (getenv("BENCH_ROWS"))
+    bench_rows= atoi(getenv("BENCH_ROWS"));
+  if (getenv("BENCH_LOOPS"))
+    bench_loops= atoi(getenv("BENCH_LOOPS"));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS bench_compression");
+
+  pos= query + sprintf(query, "CREATE TABLE bench_compression "
+                              "(id INT PRIMARY KEY");
+  for (i= 0; i < BENCH_COLUMNS; ++i)
+    pos+= sprintf(pos, ", c%d VARCHAR(%d)", i, BENCH_COLUMN_SIZE);
+  strcpy(pos, ")");
+  ok_stmt(hstmt, SQLExecDirect(hstmt, (SQLCHAR *)query, SQL_NTS));
+
+  /*
+    Text that compresses about as well as typical application data: some
+    repetition mixed with random hex
+  */
+  pos= query + sprintf(query, "INSERT INTO bench_compression SELECT "
+                              "seq.n");
+  for (i= 0; i < BENCH_COLUMNS; ++i)
+    pos+= sprintf(pos, ", LEFT(CONCAT('customer-', seq.n, ' ', "
+                       "MD5(RAND()), ' status=ACTIVE region=EMEA ', "
+                       "MD5(RAND())), %d)", BENCH_COLUMN_SIZE);
+  sprintf(pos, " FROM (WITH RECURSIVE s(n) AS (SELECT 1 UNION ALL "
+               "SELECT n + 1 FROM s WHERE n < %d) SELECT n FROM s) seq",
+          bench_rows);
+
+  ok_sql(hstmt, "SET SESSION cte_max_recursion_depth= 10000000");
+  ok_stmt(hstmt, SQLExecDirect(hstmt, (SQLCHAR *)query, SQL_NTS));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  return OK;
+}
+
+
+DECLARE_TEST(bench_fetch_wide)
+{
+  unsigned int s;
+
+  for (s= 0; s < sizeof(settings) / sizeof(settings[0]); ++s)
+  {
+    SQLHENV    henv1;
+    SQLHDBC    hdbc1;
+    SQLHSTMT   hstmt1;
+    SQLCHAR    data[BENCH_COLUMNS][BENCH_COLUMN_SIZE + 1];
+    SQLLEN     len[BENCH_COLUMNS];
+    SQLCHAR    stats[256];
+    SQLRETURN  rc;
+    double     start, elapsed;
+    long long  rows= 0, bytes= 0;
+    int        i, loop;
+
+    is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                          NULL, NULL, NULL,
+                                          (SQLCHAR *)settings[s].options));
+
+    for (i= 0; i < BENCH_COLUMNS; ++i)
+    {
+      ok_stmt(hstmt1, SQLBindCol(hstmt1, (SQLUSMALLINT)(i + 2), SQL_C_CHAR,
+                                 data[i], sizeof(data[i]), &len[i]));
+    }
+
+    start= now_seconds();
+
+    for (loop= 0; loop < bench_loops; ++loop)
+    {
+      ok_sql(hstmt1, "SELECT * FROM bench_compression");
+
+      while ((rc= SQLFetch(hstmt1)) == SQL_SUCCESS)
+      {
+        ++rows;
+        for (i= 0; i < BENCH_COLUMNS; ++i)
+          bytes+= len[i];
+      }
+      is_num(rc, SQL_NO_DATA);
+
+      ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+    }
+
+    elapsed= now_seconds() - start;
+
+    ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYSQL_COMPRESSION_STATS,
+                                    stats, sizeof(stats), NULL));
+
+    printMessage("setting=%s;seconds=%.3f;rows_per_sec=%.0f;mb_per_sec=%.2f;%s",
+                 settings[s].name, elapsed, rows / elapsed,
+                 bytes / elapsed / (1024 * 1024), stats);
+
+    free_basic_handles(&henv1, &hdbc1, &hstmt1);
+  }
+
+  return OK;
+}
+
+
+DECLARE_TEST(bench_cleanup)
+{
+  ok_sql(hstmt, "DROP TABLE IF EXISTS bench_compression");
+
+  return OK;
+}
+
+
+BEGIN_TESTS
+  ADD_TEST(bench_setup)
+  ADD_TEST(bench_fetch_wide)
+  ADD_TEST(bench_cleanup)
+END_TESTS
+
+
+RUN_TESTS
@@ -0,0 +1,246 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/*
+  Checks and times myodbc_ftoa(), the float/double formatter used for
+  parameters and server-side prepared statement results.
+
+    bench_ftoa check [count]   random doubles and floats must read back
+                               unchanged with strtod()/strtof()
+    bench_ftoa all-floats      the same for every float (takes minutes)
+    bench_ftoa time [count]    compares the speed with sprintf()
+
+  It is built from driver/ftoa.cc alone and needs no server.
+*/
+
+#include "ftoa.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+static unsigned long long failures= 0, longer= 0, checked= 0;
+
+
+/* Fewest significant digits printf() needs to round-trip the value */
+static int shortest_digits(double value, bool single)
+{
+  char buf[64];
+  int p;
+
+  for (p= 1; p < 17; ++p)
+  {
+    snprintf(buf, sizeof(buf), "%.*e", p - 1, value);
+    if (single ? strtof(buf, NULL) == (float)value : strtod(buf, NULL) == value)
+      break;
+  }
+
+  return p;
+}
+
+
+static int significant_digits(const char *str)
+{
+  int digits= 0, leading= 1;
+
+  for (; *str && *str != 'e'; ++str)
+  {
+    if (*str >= '0' && *str <= '9')
+    {
+      if (*str != '0')
+        leading= 0;
+      if (!leading)
+        ++digits;
+    }
+  }
+
+  /* Trailing zeros of integers written in full are not significant */
+  for (--str; digits > 1 && *str == '0'; --str)
+    --digits;
+
+  return digits ? digits : 1;
+}
+
+
+static void check_value(double value, bool single, bool digits)
+{
+  char buf[MYODBC_FTOA_BUFFER_SIZE];
+  int flags;
+
+  for (flags= 0; flags <= MYODBC_FTOA_EXP; flags+= MYODBC_FTOA_EXP)
+  {
+    size_t length= myodbc_ftoa(value, buf, flags | (single ? MYODBC_FTOA_FLOAT : 0));
+    bool ok= length == strlen(buf) && length < MYODBC_FTOA_BUFFER_SIZE &&
+             (single ? strtof(buf, NULL) == (float)value
+                     : strtod(buf, NULL) == value);
+
+    ++checked;
+    if (!ok)
+    {
+      if (++failures <= 10)
+        printf("FAILED %s %.17g -> %s\n", single ? "float" : "double",
+               value, buf);
+    }
+  }
+
+  if (digits && significant_digits(buf) > shortest_digits(value, single))
+    ++longer;
+}
+
+
+static int check(unsigned long long count)
+{
+  std::mt19937_64 rng(20180101);
+  const double special[]= {0.0, -0.0, 1.0, -1.0, 0.1, 0.2, 0.3, 1e-15, 1e15,
+                           9.999999999999999e14, 1e16, 123456789012345678.0,
+                           5e-324, 2.2250738585072014e-308, 1.7976931348623157e308,
+                           1.5, 100.0, 1e21, 1e-7, 3.4028234663852886e38,
+                           1.401298464324817e-45, 1.1754943508222875e-38};
+  unsigned long long i;
+
+  for (i= 0; i < sizeof(special) / sizeof(special[0]); ++i)
+  {
+    check_value(special[i], false, true);
+    check_value(special[i], true, true);
+  }
+
+  for (i= 0; i < count; ++i)
+  {
+    unsigned long long bits= rng();
+    unsigned int fbits= (unsigned int)bits;
+    double d;
+    float f;
+
+    memcpy(&d, &bits, sizeof(d));
+    memcpy(&f, &fbits, sizeof(f));
+
+    if (std::isfinite(d))
+      check_value(d, false, i % 64 == 0);
+    if (std::isfinite(f))
+      check_value(f, true, i % 64 == 0);
+
+    /* Short decimals, the usual application data */
+    d= (double)(long long)(rng() % 2000000 - 1000000) / 1000.0;
+    check_value(d, false, i % 64 == 0);
+    check_value((float)d, true, i % 64 == 0);
+  }
+
+  printf("checked=%llu;failures=%llu;longer_than_shortest=%llu\n",
+         checked, failures, longer);
+
+  return failures ? 1 : 0;
+}
+
+
+static int check_all_floats()
+{
+  unsigned long long fbits;
+
+  for (fbits= 0; fbits <= 0xFFFFFFFFULL; ++fbits)
+  {
+    unsigned int b= (unsigned int)fbits;
+    float f;
+
+    memcpy(&f, &b, sizeof(f));
+    if (std::isfinite(f))
+      check_value(f, true, false);
+  }
+
+  printf("checked=%llu;failures=%llu\n", checked, failures);
+
+  return failures ? 1 : 0;
+}
+
+
+static int time_formatting(unsigned long long count)
+{
+  std::mt19937_64 rng(20180101);
+  double *values= (double *)malloc(count * sizeof(double));
+  char buf[64];
+  size_t total= 0;
+  unsigned long long i;
+  int kind;
+
+  for (i= 0; i < count; ++i)
+  {
+    /* Half random doubles, half short decimals */
+    if (i % 2)
+    {
+      unsigned long long bits= rng() & ~(0x7FFULL << 52);
+      bits|= (unsigned long long)(0x3FF - 20 + rng() % 40) << 52;
+      memcpy(&values[i], &bits, sizeof(double));
+    }
+    else
+      values[i]= (double)(long long)(rng() % 2000000) / 100.0;
+  }
+
+  for (kind= 0; kind < 3; ++kind)
+  {
+    const char *name[]= {"myodbc_ftoa", "myodbc_ftoa_exp", "sprintf_17e"};
+    auto start= std::chrono::steady_clock::now();
+    double seconds;
+
+    total= 0;
+    for (i= 0; i < count; ++i)
+    {
+      if (kind == 2)
+        total+= sprintf(buf, "%.17e", values[i]);
+      else
+        total+= myodbc_ftoa(values[i], buf, kind ? MYODBC_FTOA_EXP : 0);
+    }
+
+    seconds= std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           start).count();
+    printf("kernel=%s;values=%llu;ns_per_value=%.1f;avg_length=%.1f\n",
+           name[kind], count, seconds * 1e9 / count, (double)total / count);
+  }
+
+  free(values);
+  return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  const char *mode= argc > 1 ? argv[1] : "check";
+  unsigned long long count= argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000;
+
+  if (!strcmp(mode, "check"))
+    return check(count);
+  if (!strcmp(mode, "all-floats"))
+    return check_all_floats();
+  if (!strcmp(mode, "time"))
+    return time_formatting(count);
+
+  fprintf(stderr, "usage: %s check|all-floats|time [count]\n", argv[0]);
+  return 2;
+}
@@ -0,0 +1,816 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/*
+  Times the conversion routines of the driver one at a time, without a
+  server. The handles are allocated by the driver and set up the way
+  connecting to a MySQL 8.0 server with utf8mb4 leaves them.
+
+    bench_kernels check                     every kernel converts every
+                                            data set once, the results
+                                            are checked
+    bench_kernels time [kernel [data]]      times all kernels, one kernel
+                                            or one kernel on one data set
+
+  Data sets: ascii, cjk, emoji, nulls (90% NULL), decimal (up to 38
+  digits) and datetime. BENCH_VALUES (default 10000) is the number of
+  values of a set, BENCH_LOOPS (default 50) how often each is converted.
+  Every timing is one line of key=value pairs, so the output of two
+  builds can be compared line by line.
+
+  It is built from the sources of the Unicode driver.
+*/
+
+#include "driver.h"
+#include "stringutil.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#define KIND_TEXT     1
+#define KIND_DECIMAL  2
+#define KIND_DATETIME 4
+
+#define BUFFER_SIZE 1024
+
+struct Data
+{
+  const char *name;
+  int kind;
+  std::vector<std::string> values;
+  std::vector<char> null;
+  /* The same values as SQL_C_WCHAR, SQL_C_NUMERIC or SQL_C_TIMESTAMP */
+  std::vector<std::vector<SQLWCHAR> > wide;
+  std::vector<SQL_NUMERIC_STRUCT> numeric;
+  std::vector<SQLSCHAR> scale;
+  std::vector<SQL_TIMESTAMP_STRUCT> ts;
+};
+
+typedef unsigned long long (*kernel_func)(const Data &data, bool check);
+
+static DBC *dbc;
+static STMT *stmt;
+static DESCREC *irrec, *iprec;
+static MYSQL_FIELD field;
+static CHARSET_INFO *utf8mb4_cs, *target_cs;
+
+static unsigned long long failures= 0, checked= 0;
+
+
+static void failed(const char *kernel, const Data &data, size_t i,
+                   const char *what)
+{
+  if (++failures <= 10)
+    printf("FAILED %s data=%s value=%zu: %s\n", kernel, data.name, i, what);
+}
+
+
+/* Generators */
+
+static void put_utf8(std::string &str, unsigned long cp)
+{
+  if (cp < 0x80)
+    str+= (char)cp;
+  else if (cp < 0x800)
+  {
+    str+= (char)(0xC0 | (cp >> 6));
+    str+= (char)(0x80 | (cp & 0x3F));
+  }
+  else if (cp < 0x10000)
+  {
+    str+= (char)(0xE0 | (cp >> 12));
+    str+= (char)(0x80 | ((cp >> 6) & 0x3F));
+    str+= (char)(0x80 | (cp & 0x3F));
+  }
+  else
+  {
+    str+= (char)(0xF0 | (cp >> 18));
+    str+= (char)(0x80 | ((cp >> 12) & 0x3F));
+    str+= (char)(0x80 | ((cp >> 6) & 0x3F));
+    str+= (char)(0x80 | (cp & 0x3F));
+  }
+}
+
+
+/* Words with the odd character that needs escaping in a query */
+static std::string ascii_text(std::mt19937_64 &rng)
+{
+  static const char special[]= "'\\\"%_\n";
+  std::string str;
+  size_t length= 4 + rng() % 60;
+
+  while (str.length() < length)
+  {
+    unsigned int r= rng() % 64;
+
+    if (r < 52)
+      str+= (char)((r < 26 ? 'a' : 'A') + r % 26);
+    else if (r < 62)
+      str+= (r % 2) ? ' ' : (char)('0' + rng() % 10);
+    else
+      str+= special[rng() % (sizeof(special) - 1)];
+  }
+
+  return str;
+}
+
+
+static std::string cjk_text(std::mt19937_64 &rng)
+{
+  std::string str;
+  size_t chars= 2 + rng() % 24, i;
+
+  for (i= 0; i < chars; ++i)
+  {
+    if (rng() % 8 == 0)
+      put_utf8(str, rng() % 2 ? ' ' : '0' + rng() % 10);
+    else
+      put_utf8(str, 0x4E00 + rng() % (0x9FA5 - 0x4E00));
+  }
+
+  return str;
+}
+
+
+/* Chat messages: words with an emoji now and then */
+static std::string emoji_text(std::mt19937_64 &rng)
+{
+  std::string str;
+  size_t words= 1 + rng() % 8, i;
+
+  for (i= 0; i < words; ++i)
+  {
+    if (rng() % 3 == 0)
+      put_utf8(str, 0x1F300 + rng() % (0x1F64F - 0x1F300));
+    else
+      str+= ascii_text(rng).substr(0, 3 + rng() % 6);
+    str+= ' ';
+  }
+
+  return str;
+}
+
+
+/* DECIMAL(38, scale) values that use from 1 to all 38 digits */
+static std::string decimal_text(std::mt19937_64 &rng, SQLSCHAR *scale)
+{
+  int precision= 1 + rng() % 38, i;
+  std::string str;
+
+  *scale= (SQLSCHAR)(rng() % (myodbc_min(precision, 11)));
+
+  if (rng() % 2)
+    str+= '-';
+  for (i= 0; i < precision; ++i)
+  {
+    if (i == precision - *scale)
+      str+= '.';
+    str+= (char)((i ? '0' : '1') + rng() % (i ? 10 : 9));
+  }
+
+  return str;
+}
+
+
+static std::string datetime_text(std::mt19937_64 &rng,
+                                 SQL_TIMESTAMP_STRUCT *ts)
+{
+  char buff[40];
+  int length;
+
+  ts->year= (SQLSMALLINT)(1970 + rng() % 68);
+  ts->month= (SQLUSMALLINT)(1 + rng() % 12);
+  ts->day= (SQLUSMALLINT)(1 + rng() % 28);
+  ts->hour= (SQLUSMALLINT)(rng() % 24);
+  ts->minute= (SQLUSMALLINT)(rng() % 60);
+  ts->second= (SQLUSMALLINT)(rng() % 60);
+  ts->fraction= rng() % 2 ? (SQLUINTEGER)(rng() % 1000000) * 1000 : 0;
+
+  length= sprintf(buff, "%04d-%02d-%02d %02d:%02d:%02d", ts->year, ts->month,
+                  ts->day, ts->hour, ts->minute, ts->second);
+  if (ts->fraction)
+    sprintf(buff + length, ".%06lu", (unsigned long)ts->fraction / 1000);
+
+  return buff;
+}
+
+
+static void make_data(Data &data, size_t count)
+{
+  std::mt19937_64 rng(20180101);
+  size_t i;
+
+  for (i= 0; i < count; ++i)
+  {
+    std::string value;
+    SQLSCHAR scale= 0;
+    SQL_TIMESTAMP_STRUCT ts;
+    bool null= false;
+
+    switch (data.name[0])
+    {
+    case 'a': value= ascii_text(rng); break;
+    case 'c': value= cjk_text(rng); break;
+    case 'e': value= emoji_text(rng); break;
+    case 'n':
+      null= rng() % 10 != 0;
+      if (!null)
+        value= ascii_text(rng);
+      break;
+    case 'd':
+      if (data.kind == KIND_DECIMAL)
+        value= decimal_text(rng, &scale);
+      else
+        value= datetime_text(rng, &ts);
+      break;
+    }
+
+    data.values.push_back(value);
+    data.null.push_back(null);
+
+    if (data.kind == KIND_TEXT)
+    {
+      std::vector<SQLWCHAR> wide(value.length() + 1);
+      wide.resize(utf8_as_sqlwchar(&wide[0], (SQLINTEGER)wide.size(),
+                                   (SQLCHAR *)value.c_str(),
+                                   (SQLINTEGER)value.length()));
+      data.wide.push_back(wide);
+    }
+    else if (data.kind == KIND_DECIMAL)
+    {
+      SQL_NUMERIC_STRUCT num;
+      int overflow= 0;
+
+      memset(&num, 0, sizeof(num));
+      num.precision= 38;
+      num.scale= scale;
+      sqlnum_from_str(value.c_str(), &num, &overflow);
+      data.numeric.push_back(num);
+      data.scale.push_back(scale);
+    }
+    else
+      data.ts.push_back(ts);
+  }
+}
+
+
+/* Kernels, each converts every value of the data set once */
+
+static unsigned long long bench_str_to_ts(const Data &data, bool check)
+{
+  unsigned long long bytes= 0;
+  size_t i;
+
+  for (i= 0; i < data.values.size(); ++i)
+  {
+    SQL_TIMESTAMP_STRUCT ts;
+    int rc= str_to_ts(&ts, data.values[i].c_str(), SQL_NTS, 0, TRUE);
+
+    bytes+= data.values[i].length();
+    if (check && (rc || memcmp(&ts, &data.ts[i], sizeof(ts))))
+      failed("str_to_ts", data, i, data.values[i].c_str());
+  }
+
+  return bytes;
+}
+
+
+static bool numeric_as_string(SQL_NUMERIC_STRUCT num, SQLSCHAR scale,
+                              const std::string &expected)
+{
+  SQLCHAR buff[80], *numbegin;
+  int trunc= 0;
+
+  sqlnum_to_str(&num, buff + sizeof(buff) - 1, &numbegin, 38, scale, &trunc);
+
+  return !trunc && expected == (char *)numbegin;
+}
+
+
+static unsigned long long bench_sqlnum_from_str(const Data &data, bool check)
+{
+  unsigned long long bytes= 0;
+  size_t i;
+
+  for (i= 0; i < data.values.size(); ++i)
+  {
+    SQL_NUMERIC_STRUCT num;
+    int overflow= 0;
+
+    num.precision= 38;
+    num.scale= data.scale[i];
+    sqlnum_from_str(data.values[i].c_str(), &num, &overflow);
+
+    bytes+= data.values[i].length();
+    if (check && (overflow ||
+                  !numeric_as_string(num, data.scale[i], data.values[i])))
+      failed("sqlnum_from_str", data, i, data.values[i].c_str());
+  }
+
+  return bytes;
+}
+
+
+static unsigned long long bench_sqlnum_to_str(const Data &data, bool check)
+{
+  unsigned long long bytes= 0;
+  size_t i;
+
+  for (i= 0; i < data.numeric.size(); ++i)
+  {
+    /* sqlnum_to_str() writes the precision and scale it used */
+    SQL_NUMERIC_STRUCT num= data.numeric[i];
+    SQLCHAR buff[80], *numbegin;
+    int trunc= 0;
+
+    sqlnum_to_str(&num, buff + sizeof(buff) - 1, &numbegin, 38,
+                  data.scale[i], &trunc);
+
+    bytes+= sizeof(num);
+    if (check && (trunc || data.values[i] != (char *)numbegin))
+      failed("sqlnum_to_str", data, i, data.values[i].c_str());
+  }
+
+  return bytes;
+}
+
+
+/* Source and result are the same text when nothing had to be replaced */
+static bool lossless(const Data &data, size_t i)
+{
+  size_t j;
+
+  if (target_cs == utf8mb4_cs)
+    return true;
+  for (j= 0; j < data.values[i].length(); ++j)
+    if (data.values[i][j] & 0x80)
+      return false;
+  return true;
+}
+
+
+static unsigned long long bench_copy_ansi_result(const Data &data, bool check)
+{
+  unsigned long long bytes= 0;
+  size_t i;
+
+  dbc->ansi_charset_info= target_cs;
+  fix_row_charsets(stmt, irrec, &field);
+
+  for (i= 0; i < data.values.size(); ++i)
+  {
+    SQLCHAR buff[BUFFER_SIZE];
+    SQLLEN length;
+    SQLRETURN rc;
+
+    if (data.null[i])
+    {
+      length= SQL_NULL_DATA;
+      continue;
+    }
+
+    reset_getdata_position(stmt);
+    rc= copy_ansi_result(stmt, buff, sizeof(buff), &length, irrec,
+                         (char *)data.values[i].c_str(),
+                         (unsigned long)data.values[i].length());
+
+    bytes+= data.values[i].length();
+    if (check && (!SQL_SUCCEEDED(rc) ||
+                  (lossless(data, i) && data.values[i] != (char *)buff)))
+      failed("copy_ansi_result", data, i, data.values[i].c_str());
+  }
+
+  dbc->ansi_charset_info= utf8mb4_cs;
+  fix_row_charsets(stmt, irrec, &field);
+
+  return bytes;
+}
+
+
+static unsigned long long bench_copy_wchar_result(const Data &data,
+                                                  bool check)
+{
+  unsigned long long bytes= 0;
+  size_t i;
+
+  for (i= 0; i < data.values.size(); ++i)
+  {
+    SQLWCHAR buff[BUFFER_SIZE];
+    SQLLEN length;
+    SQLRETURN rc;
+
+    if (data.null[i])
+    {
+      length= SQL_NULL_DATA;
+      continue;
+    }
+
+    reset_getdata_position(stmt);
+    rc= copy_wchar_result(stmt, buff, BUFFER_SIZE, &length, irrec,
+                          (char *)data.values[i].c_str(),
+                          (long)data.values[i].length());
+
+    bytes+= data.values[i].length();
+    if (!check)
+      continue;
+
+    /*
+      The characters go through utf8_charset_info, which is utf8mb3:
+      supplementary characters come back as '?' with a warning
+    */
+    if (!SQL_SUCCEEDED(rc) ||
+        (data.values[i].find_first_of("\xF0\xF1\xF2\xF3\xF4") ==
+           std::string::npos &&
+         (rc != SQL_SUCCESS ||
+          length != (SQLLEN)(data.wide[i].size() * sizeof(SQLWCHAR)) ||
+          memcmp(buff, data.wide[i].data(), length) ||
+          buff[data.wide[i].size()])))
+      failed("copy_wchar_result", data, i, data.values[i].c_str());
+  }
+
+  return bytes;
+}
+
+
+static unsigned long long bench_escape_string(const Data &data, bool check)
+{
+  unsigned long long bytes= 0;
+  size_t i;
+
+  for (i= 0; i < data.values.size(); ++i)
+  {
+    char buff[BUFFER_SIZE];
+    ulong length;
+
+    if (data.null[i])
+      continue;
+
+    length= myodbc_escape_string(stmt, buff, sizeof(buff),
+                                 data.values[i].c_str(),
+                                 (ulong)data.values[i].length(), 0);
+
+    bytes+= data.values[i].length();
+    if (check)
+    {
+      std::string unescaped;
+      ulong j;
+
+      for (j= 0; j < length; ++j)
+      {
+        if (buff[j] == '\\' && ++j < length)
+          unescaped+= buff[j] == '0' ? '\0' : buff[j] == 'n' ? '\n' :
+                      buff[j] == 'r' ? '\r' : buff[j];
+        else
+          unescaped+= buff[j];
+      }
+
+      if (unescaped != data.values[i])
+        failed("myodbc_escape_string", data, i, data.values[i].c_str());
+    }
+  }
+
+  return bytes;
+}
+
+
+/* Parameters as the application binds them: SQL_C_WCHAR text, SQL_C_NUMERIC
+   decimals and SQL_C_TIMESTAMP datetimes */
+static unsigned long long bench_convert_c_type2str(const Data &data,
+                                                   bool check)
+{
+  unsigned long long bytes= 0;
+  size_t i;
+
+  for (i= 0; i < data.values.size(); ++i)
+  {
+    char buff[BUFFER_SIZE], *res;
+    long length;
+    SQLSMALLINT ctype;
+    SQLRETURN rc;
+    SQL_TIMESTAMP_STRUCT ts;
+
+    if (data.null[i])
+      continue;
+
+    switch (data.kind)
+    {
+    case KIND_TEXT:
+      ctype= SQL_C_WCHAR;
+      res= (char *)data.wide[i].data();
+      length= (long)(data.wide[i].size() * sizeof(SQLWCHAR));
+      iprec->concise_type= SQL_WVARCHAR;
+      break;
+    case KIND_DECIMAL:
+      ctype= SQL_C_NUMERIC;
+      res= (char *)&data.numeric[i];
+      length= sizeof(SQL_NUMERIC_STRUCT);
+      iprec->concise_type= SQL_DECIMAL;
+      iprec->precision= 38;
+      iprec->scale= data.scale[i];
+      break;
+    default:
+      ctype= SQL_C_TIMESTAMP;
+      res= (char *)&data.ts[i];
+      length= sizeof(SQL_TIMESTAMP_STRUCT);
+      iprec->concise_type= SQL_TYPE_TIMESTAMP;
+      break;
+    }
+
+    bytes+= length;
+    rc= convert_c_type2str(stmt, ctype, iprec, &res, &length, buff,
+                           sizeof(buff));
+
+    if (!check)
+      continue;
+
+    if (rc != SQL_SUCCESS)
+      failed("convert_c_type2str", data, i, data.values[i].c_str());
+    else if (data.kind == KIND_DATETIME)
+    {
+      /* The fraction loses its trailing zeros, compare the values */
+      if (str_to_ts(&ts, std::string(res, length).c_str(), SQL_NTS, 0, TRUE) ||
+          memcmp(&ts, &data.ts[i], sizeof(ts)))
+        failed("convert_c_type2str", data, i, data.values[i].c_str());
+    }
+    else if (data.values[i] != std::string(res, length))
+      failed("convert_c_type2str", data, i, data.values[i].c_str());
+  }
+
+  return bytes;
+}
+
+
+static unsigned long long bench_sqlwchar_as_utf8_ext(const Data &data,
+                                                     bool check)
+{
+  unsigned long long bytes= 0;
+  size_t i;
+
+  for (i= 0; i < data.wide.size(); ++i)
+  {
+    SQLCHAR buff[BUFFER_SIZE], *res;
+    SQLINTEGER length= (SQLINTEGER)data.wide[i].size();
+    int utf8mb4_used= 0;
+
+    if (data.null[i])
+      continue;
+
+    res= sqlwchar_as_utf8_ext(data.wide[i].data(), &length, buff,
+                              sizeof(buff), &utf8mb4_used);
+
+    bytes+= data.wide[i].size() * sizeof(SQLWCHAR);
+    if (check && (res != buff || data.values[i] !=
+                                 std::string((char *)res, length)))
+      failed("sqlwchar_as_utf8_ext", data, i, data.values[i].c_str());
+  }
+
+  return bytes;
+}
+
+
+static unsigned long long bench_copy_and_convert(const Data &data, bool check)
+{
+  unsigned long long bytes= 0;
+  size_t i;
+
+  for (i= 0; i < data.values.size(); ++i)
+  {
+    char buff[BUFFER_SIZE];
+    uint32 length, used_bytes, used_chars;
+    uint errors= 0;
+
+    if (data.null[i])
+      continue;
+
+    length= copy_and_convert(buff, sizeof(buff), target_cs,
+                             data.values[i].c_str(),
+                             (uint32)data.values[i].length(), utf8mb4_cs,
+                             &used_bytes, &used_chars, &errors);
+
+    bytes+= data.values[i].length();
+    if (check && used_bytes != data.values[i].length())
+      failed("copy_and_convert", data, i, data.values[i].c_str());
+    else if (check && lossless(data, i) &&
+             (errors || data.values[i] != std::string(buff, length)))
+      failed("copy_and_convert", data, i, data.values[i].c_str());
+  }
+
+  return bytes;
+}
+
+
+static const struct
+{
+  const char *name;
+  kernel_func func;
+  int kinds;
+  bool charsets;  /* Run once per target character set */
+} kernels[]=
+{
+  {"str_to_ts",            bench_str_to_ts,            KIND_DATETIME, false},
+  {"sqlnum_from_str",      bench_sqlnum_from_str,      KIND_DECIMAL,  false},
+  {"sqlnum_to_str",        bench_sqlnum_to_str,        KIND_DECIMAL,  false},
+  {"copy_ansi_result",     bench_copy_ansi_result,     KIND_TEXT,     true},
+  {"copy_wchar_result",    bench_copy_wchar_result,    KIND_TEXT,     false},
+  {"myodbc_escape_string", bench_escape_string,        KIND_TEXT,     false},
+  {"convert_c_type2str",   bench_convert_c_type2str,
+                           KIND_TEXT | KIND_DECIMAL | KIND_DATETIME,  false},
+  {"sqlwchar_as_utf8_ext", bench_sqlwchar_as_utf8_ext, KIND_TEXT,     false},
+  {"copy_and_convert",     bench_copy_and_convert,     KIND_TEXT,     true}
+};
+
+/* Targets of the conversions from utf8mb4: none, single-byte, multi-byte */
+static const char *charsets[]= {"utf8mb4", "latin1", "gbk"};
+
+static Data data_sets[]=
+{
+  {"ascii",    KIND_TEXT},
+  {"cjk",      KIND_TEXT},
+  {"emoji",    KIND_TEXT},
+  {"nulls",    KIND_TEXT},
+  {"decimal",  KIND_DECIMAL},
+  {"datetime", KIND_DATETIME}
+};
+
+
+/*
+  Handles as after connecting to a MySQL 8.0 server with the Unicode driver
+  and utf8mb4, and a utf8mb4 VARCHAR result column. Nothing is freed, the
+  program ends after using them.
+*/
+static bool alloc_handles()
+{
+  SQLHENV henv;
+  SQLHDBC hdbc;
+  SQLHSTMT hstmt;
+
+#ifndef _UNIX_
+  myodbc_init();
+#endif
+
+  if (my_SQLAllocEnv(&henv) != SQL_SUCCESS ||
+      my_SQLAllocConnect(henv, &hdbc) != SQL_SUCCESS)
+    return false;
+
+  dbc= (DBC *)hdbc;
+  dbc->ds= ds_new();
+  dbc->unicode= TRUE;
+  dbc->mysql.server_version= (char *)"8.0.13";
+
+  utf8mb4_cs= get_charset_by_csname("utf8mb4", MYF(MY_CS_PRIMARY), MYF(0));
+  if (!utf8mb4_cs)
+    return false;
+  dbc->ansi_charset_info= dbc->cxn_charset_info= utf8mb4_cs;
+
+  if (my_SQLAllocStmt(hdbc, &hstmt) != SQL_SUCCESS)
+    return false;
+  stmt= (STMT *)hstmt;
+
+  field.name= field.org_name= (char *)"c";
+  field.table= field.org_table= (char *)"t";
+  field.org_table_length= 1;
+  field.type= MYSQL_TYPE_VAR_STRING;
+  field.charsetnr= utf8mb4_cs->number;
+  field.length= 255 * 4;
+
+  irrec= desc_get_rec(stmt->ird, 0, TRUE);
+  iprec= desc_get_rec(stmt->ipd, 0, TRUE);
+  if (!irrec || !iprec)
+    return false;
+  fix_row_charsets(stmt, irrec, &field);
+
+  return true;
+}
+
+
+static int run(bool check, const char *kernel, const char *data_name)
+{
+  size_t values= getenv("BENCH_VALUES") ? atol(getenv("BENCH_VALUES")) : 10000;
+  int loops= getenv("BENCH_LOOPS") ? atoi(getenv("BENCH_LOOPS")) : 50;
+  size_t k, d, c;
+  bool found= false;
+
+  if (!alloc_handles())
+  {
+    fprintf(stderr, "could not set up the driver handles\n");
+    return 2;
+  }
+
+  for (d= 0; d < sizeof(data_sets) / sizeof(data_sets[0]); ++d)
+  {
+    if (!data_name || !strcmp(data_name, data_sets[d].name))
+      make_data(data_sets[d], check ? myodbc_min(values, 1000) : values);
+  }
+
+  for (k= 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k)
+  {
+    if (kernel && strcmp(kernel, kernels[k].name))
+      continue;
+
+    for (d= 0; d < sizeof(data_sets) / sizeof(data_sets[0]); ++d)
+    {
+      const Data &data= data_sets[d];
+
+      if ((data_name && strcmp(data_name, data.name)) ||
+          !(kernels[k].kinds & data.kind))
+        continue;
+
+      for (c= 0; c < (kernels[k].charsets ? 3 : 1); ++c)
+      {
+        unsigned long long bytes= 0;
+        double seconds;
+        int loop;
+
+        found= true;
+        target_cs= get_charset_by_csname(charsets[c], MYF(MY_CS_PRIMARY),
+                                         MYF(0));
+        if (!target_cs)
+          continue;
+
+        if (check)
+        {
+          kernels[k].func(data, true);
+          ++checked;
+          continue;
+        }
+
+        /* One round to warm up the caches */
+        kernels[k].func(data, false);
+
+        auto start= std::chrono::steady_clock::now();
+        for (loop= 0; loop < loops; ++loop)
+          bytes+= kernels[k].func(data, false);
+        seconds= std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - start).count();
+
+        printf("kernel=%s;data=%s;", kernels[k].name, data.name);
+        if (kernels[k].charsets)
+          printf("charset=%s;", charsets[c]);
+        printf("values=%zu;ns_per_value=%.1f;mb_per_sec=%.1f\n",
+               data.values.size(),
+               seconds * 1e9 / ((double)loops * data.values.size()),
+               bytes / seconds / (1024 * 1024));
+      }
+    }
+  }
+
+  if (!found)
+  {
+    fprintf(stderr, "no such kernel or data set\n");
+    return 2;
+  }
+
+  if (check)
+  {
+    printf("checked=%llu;failures=%llu\n", checked, failures);
+    return failures ? 1 : 0;
+  }
+
+  return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  const char *mode= argc > 1 ? argv[1] : "check";
+
+  if (!strcmp(mode, "check"))
+    return run(true, NULL, NULL);
+  if (!strcmp(mode, "time"))
+    return run(false, argc > 2 && strcmp(argv[2], "all") ? argv[2] : NULL,
+               argc > 3 ? argv[3] : NULL);
+
+  fprintf(stderr, "usage: %s check|time [kernel|all [data]]\n", argv[0]);
+  return 2;
+}
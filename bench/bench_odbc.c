@@ -0,0 +1,589 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/*
+  Throughput and latency of the common ODBC calls: fetching each kind of
+  column with SQLBindCol and SQLGetData, parameter arrays, prepared
+  statements, connecting and the catalog functions.
+
+  Run it against a local server the same way as the tests (TEST_DSN,
+  TEST_UID, ... or command line arguments), or with "make run_benchmarks"
+  which uses the data sources of the test suite. BENCH_ROWS, BENCH_OPS and
+  BENCH_CONNECTS change the size of the run. The results are written as
+  described in bench.h.
+
+  With BENCH_REPLAY set the driver talks to the replay server in this
+  process instead, which answers every query from memory, so what is left
+  is the cost of the driver itself. BENCH_LATENCY_US adds a delay to each
+  of its replies. The catalog functions are skipped then.
+
+  Fetches are measured in the text protocol and, by adding a parameter to
+  the query, in the binary protocol of server-side prepared statements.
+
+  Latencies are of one operation: a SQLFetch() of a row array, a row read
+  with SQLGetData(), one SQLExecute() of a parameter array, one statement
+  or connection, one catalog call with its result. CPU time is that of the
+  whole process, which is mostly the driver.
+*/
+
+#include "odbctap.h"
+
+#include "bench.h"
+
+#ifndef _WIN32
+# include <unistd.h>
+# include "replay_server.h"
+#endif
+
+static int bench_rows= 20000;
+static int bench_ops= 2000;
+static int bench_connects= 200;
+static int bench_replay= 0;
+
+/* Large enough for any of the columns as text, with room to spare */
+#define BENCH_TEXT_SIZE 1024
+
+static const SQLULEN array_sizes[]= {1, 10, 100, 1000, 10000};
+static const SQLULEN paramset_sizes[]= {1, 10, 100, 1000};
+
+static const struct
+{
+  const char  *name;
+  const char  *column;
+  const char  *type;         /* for the replay server */
+  unsigned long length, decimals;
+  SQLSMALLINT native_type;   /* C type the column maps to */
+  SQLLEN      native_size;
+} columns[]=
+{
+  {"INT",      "i", "INT",      0,  0, SQL_C_SLONG,  sizeof(SQLINTEGER)},
+  {"DOUBLE",   "d", "DOUBLE",   0,  0, SQL_C_DOUBLE, sizeof(SQLDOUBLE)},
+  {"DECIMAL",  "n", "DECIMAL",  18, 4, SQL_C_NUMERIC,
+                                       sizeof(SQL_NUMERIC_STRUCT)},
+  {"VARCHAR",  "v", "VARCHAR",  64, 0, SQL_C_CHAR,   BENCH_TEXT_SIZE},
+  {"DATETIME", "t", "DATETIME", 0,  0, SQL_C_TYPE_TIMESTAMP,
+                                       sizeof(SQL_TIMESTAMP_STRUCT)},
+  {"BLOB",     "b", "BLOB",     0,  0, SQL_C_BINARY, BENCH_TEXT_SIZE}
+};
+
+static const struct
+{
+  const char  *name;
+  SQLSMALLINT type;          /* 0 - the native type of the column */
+  SQLLEN      size;
+} ctypes[]=
+{
+  {"native", 0,           0},
+  {"char",   SQL_C_CHAR,  BENCH_TEXT_SIZE},
+  {"wchar",  SQL_C_WCHAR, BENCH_TEXT_SIZE * sizeof(SQLWCHAR)}
+};
+
+/* The binary protocol is used for queries with parameters */
+static const char *protocols[]= {"text", "binary"};
+static const char *fetch_queries[]= {"SELECT %s FROM bench_types",
+                                     "SELECT %s FROM bench_types "
+                                     "WHERE id > ?"};
+
+static const char *param_statements[]=
+{
+  "INSERT INTO bench_params (v, d, id) VALUES (?, ?, ?)",
+  "UPDATE bench_params SET v= ?, d= ? WHERE id= ?"
+};
+
+static const char *lookup_query= "SELECT v FROM bench_types WHERE id= ?";
+
+
+static void read_options()
+{
+  if (getenv("BENCH_ROWS"))
+    bench_rows= atoi(getenv("BENCH_ROWS"));
+  if (getenv("BENCH_OPS"))
+    bench_ops= atoi(getenv("BENCH_OPS"));
+  if (getenv("BENCH_CONNECTS"))
+    bench_connects= atoi(getenv("BENCH_CONNECTS"));
+  bench_replay= getenv("BENCH_REPLAY") != NULL;
+}
+
+
+#ifndef _WIN32
+static REPLAY_SERVER *replay= NULL;
+static char replay_socket[256];
+
+static void replay_stop()
+{
+  replay_server_stop(replay);
+  replay= NULL;
+}
+
+
+/*
+  Starts the replay server with the results of all queries the benchmarks
+  run and points the connections at it.
+*/
+static int replay_start()
+{
+  unsigned int c, p, latency= 0;
+  char query[128];
+  REPLAY_RESULT *result;
+
+  read_options();
+
+  if (getenv("BENCH_REPLAY_SOCKET"))
+    sprintf(replay_socket, "%.250s", getenv("BENCH_REPLAY_SOCKET"));
+  else
+    sprintf(replay_socket, "/tmp/bench_odbc_%d.sock", (int)getpid());
+
+  if (getenv("BENCH_LATENCY_US"))
+    latency= atoi(getenv("BENCH_LATENCY_US"));
+
+  if (!(replay= replay_server_start(replay_socket)))
+    return 1;
+  atexit(replay_stop);
+
+  replay_server_set_latency(replay, latency);
+
+  for (c= 0; c < sizeof(columns) / sizeof(columns[0]); ++c)
+  for (p= 0; p < sizeof(fetch_queries) / sizeof(fetch_queries[0]); ++p)
+  {
+    sprintf(query, fetch_queries[p], columns[c].column);
+    result= replay_server_add_result(replay, query);
+    if (replay_result_add_column(result, columns[c].column, columns[c].type,
+                                 columns[c].length, columns[c].decimals) ||
+        replay_result_generate(result, bench_rows))
+      return 1;
+  }
+
+  result= replay_server_add_result(replay, lookup_query);
+  if (replay_result_add_column(result, "v", "VARCHAR", 64, 0) ||
+      replay_result_generate(result, 1))
+    return 1;
+
+  for (p= 0; p < sizeof(param_statements) / sizeof(param_statements[0]); ++p)
+    replay_server_add_ok(replay, param_statements[p], 1);
+
+  mysock= (SQLCHAR *)replay_socket;
+  myport= 0;
+  my_str_options= (SQLCHAR *)"SERVER=localhost";
+  sprintf(bench_common, "\"server\":\"replay\",\"latency_us\":%u", latency);
+
+  return 0;
+}
+#else
+static int replay_start()
+{
+  printMessage("The replay server needs Unix sockets");
+  return 1;
+}
+#endif
+
+
+DECLARE_TEST(bench_setup)
+{
+  char query[1024];
+
+  read_options();
+  bench_open_output();
+
+  /* The replay server just accepts all of this, it has the results already */
+  ok_sql(hstmt, "DROP TABLE IF EXISTS bench_types");
+  ok_sql(hstmt, "CREATE TABLE bench_types (id INT PRIMARY KEY, i INT, "
+                "d DOUBLE, n DECIMAL(18,4), v VARCHAR(64), t DATETIME, "
+                "b BLOB, KEY (i))");
+
+  sprintf(query, "INSERT INTO bench_types SELECT seq.n, seq.n * 7, "
+                 "seq.n / 3, seq.n * 1.2345, CONCAT('row ', MD5(seq.n)), "
+                 "'2018-01-01' + INTERVAL seq.n SECOND, "
+                 "UNHEX(REPEAT(MD5(seq.n), 8)) "
+                 "FROM (WITH RECURSIVE s(n) AS (SELECT 1 UNION ALL "
+                 "SELECT n + 1 FROM s WHERE n < %d) SELECT n FROM s) seq",
+          bench_rows);
+
+  ok_sql(hstmt, "SET SESSION cte_max_recursion_depth= 10000000");
+  ok_stmt(hstmt, SQLExecDirect(hstmt, (SQLCHAR *)query, SQL_NTS));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS bench_params");
+  ok_sql(hstmt, "CREATE TABLE bench_params (id INT PRIMARY KEY, "
+                "v VARCHAR(64), d DOUBLE)");
+
+  return OK;
+}
+
+
+DECLARE_TEST(bench_fetch_bindcol)
+{
+  unsigned int c, t, a, p;
+  SQLINTEGER   min_id= 0;
+
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG,
+                                  SQL_INTEGER, 0, 0, &min_id, 0, NULL));
+
+  for (p= 0; p < sizeof(protocols) / sizeof(protocols[0]); ++p)
+  for (c= 0; c < sizeof(columns) / sizeof(columns[0]); ++c)
+  for (t= 0; t < sizeof(ctypes) / sizeof(ctypes[0]); ++t)
+  for (a= 0; a < sizeof(array_sizes) / sizeof(array_sizes[0]); ++a)
+  {
+    SQLSMALLINT type= ctypes[t].type ? ctypes[t].type : columns[c].native_type;
+    SQLLEN      size= ctypes[t].type ? ctypes[t].size : columns[c].native_size;
+    SQLULEN     array_size= array_sizes[a], fetched, i;
+    SQLLEN      *len= (SQLLEN *)malloc(array_size * sizeof(SQLLEN));
+    char        *data= (char *)malloc(array_size * size);
+    char        query[128], params[128];
+    SQLRETURN   rc;
+    BENCH       b;
+
+    ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                  (SQLPOINTER)array_size, 0));
+    ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR,
+                                  &fetched, 0));
+    ok_stmt(hstmt, SQLBindCol(hstmt, 1, type, data, size, len));
+
+    sprintf(query, fetch_queries[p], columns[c].column);
+
+    bench_begin(&b);
+    ok_stmt(hstmt, SQLExecDirect(hstmt, (SQLCHAR *)query, SQL_NTS));
+
+    for (;;)
+    {
+      op_begin(&b);
+      rc= SQLFetch(hstmt);
+      op_end(&b);
+
+      if (rc == SQL_NO_DATA)
+        break;
+      ok_stmt(hstmt, rc);
+
+      b.rows+= fetched;
+      for (i= 0; i < fetched; ++i)
+        b.bytes+= len[i] > 0 ? len[i] : 0;
+    }
+
+    sprintf(params, "\"protocol\":\"%s\",\"column\":\"%s\",\"ctype\":\"%s\","
+                    "\"array_size\":%lu", protocols[p], columns[c].name,
+            ctypes[t].name, (unsigned long)array_size);
+    bench_report(&b, "fetch_bindcol", params);
+
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+    free(len);
+    free(data);
+  }
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)1, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+
+  return OK;
+}
+
+
+DECLARE_TEST(bench_fetch_getdata)
+{
+  unsigned int c, t, p;
+  SQLINTEGER   min_id= 0;
+
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG,
+                                  SQL_INTEGER, 0, 0, &min_id, 0, NULL));
+
+  for (p= 0; p < sizeof(protocols) / sizeof(protocols[0]); ++p)
+  for (c= 0; c < sizeof(columns) / sizeof(columns[0]); ++c)
+  for (t= 0; t < sizeof(ctypes) / sizeof(ctypes[0]); ++t)
+  {
+    SQLSMALLINT type= ctypes[t].type ? ctypes[t].type : columns[c].native_type;
+    SQLLEN      size= ctypes[t].type ? ctypes[t].size : columns[c].native_size;
+    SQLLEN      len;
+    char        data[BENCH_TEXT_SIZE * sizeof(SQLWCHAR)];
+    char        query[128], params[128];
+    SQLRETURN   rc;
+    BENCH       b;
+
+    sprintf(query, fetch_queries[p], columns[c].column);
+
+    bench_begin(&b);
+    ok_stmt(hstmt, SQLExecDirect(hstmt, (SQLCHAR *)query, SQL_NTS));
+
+    for (;;)
+    {
+      op_begin(&b);
+      if ((rc= SQLFetch(hstmt)) == SQL_SUCCESS)
+        rc= SQLGetData(hstmt, 1, type, data, size, &len);
+      op_end(&b);
+
+      if (rc == SQL_NO_DATA)
+        break;
+      ok_stmt(hstmt, rc);
+
+      ++b.rows;
+      b.bytes+= len > 0 ? len : 0;
+    }
+
+    sprintf(params, "\"protocol\":\"%s\",\"column\":\"%s\",\"ctype\":\"%s\"",
+            protocols[p], columns[c].name, ctypes[t].name);
+    bench_report(&b, "fetch_getdata", params);
+
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  }
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+
+  return OK;
+}
+
+
+DECLARE_TEST(bench_param_arrays)
+{
+  unsigned int p, op;
+
+  for (p= 0; p < sizeof(paramset_sizes) / sizeof(paramset_sizes[0]); ++p)
+  {
+    SQLULEN     paramset_size= paramset_sizes[p], i;
+    SQLINTEGER  *id= (SQLINTEGER *)malloc(paramset_size * sizeof(SQLINTEGER));
+    SQLDOUBLE   *d= (SQLDOUBLE *)malloc(paramset_size * sizeof(SQLDOUBLE));
+    SQLCHAR     (*v)[65]= (SQLCHAR (*)[65])malloc(paramset_size * 65);
+    SQLLEN      *v_len= (SQLLEN *)malloc(paramset_size * sizeof(SQLLEN));
+    char        params[64];
+
+    ok_sql(hstmt, "TRUNCATE TABLE bench_params");
+
+    ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE,
+                                  (SQLPOINTER)paramset_size, 0));
+    ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_CHAR,
+                                    SQL_VARCHAR, 64, 0, v, 65, v_len));
+    ok_stmt(hstmt, SQLBindParameter(hstmt, 2, SQL_PARAM_INPUT, SQL_C_DOUBLE,
+                                    SQL_DOUBLE, 0, 0, d, 0, NULL));
+    ok_stmt(hstmt, SQLBindParameter(hstmt, 3, SQL_PARAM_INPUT, SQL_C_SLONG,
+                                    SQL_INTEGER, 0, 0, id, 0, NULL));
+
+    for (op= 0; op < sizeof(param_statements) / sizeof(param_statements[0]);
+         ++op)
+    {
+      SQLULEN done;
+      BENCH   b;
+
+      ok_stmt(hstmt, SQLPrepare(hstmt, (SQLCHAR *)param_statements[op],
+                                SQL_NTS));
+
+      bench_begin(&b);
+
+      for (done= 0; done + paramset_size <= (SQLULEN)bench_rows;
+           done+= paramset_size)
+      {
+        for (i= 0; i < paramset_size; ++i)
+        {
+          id[i]= (SQLINTEGER)(done + i + 1);
+          d[i]= id[i] / 7.0 + op;
+          v_len[i]= sprintf((char *)v[i], "value %d of %u", id[i], op);
+        }
+
+        op_begin(&b);
+        ok_stmt(hstmt, SQLExecute(hstmt));
+        op_end(&b);
+
+        b.rows+= paramset_size;
+      }
+
+      sprintf(params, "\"statement\":\"%s\",\"paramset_size\":%lu",
+              op ? "UPDATE" : "INSERT", (unsigned long)paramset_size);
+      bench_report(&b, "param_array", params);
+    }
+
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+    free(id);
+    free(d);
+    free(v);
+    free(v_len);
+  }
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE,
+                                (SQLPOINTER)1, 0));
+
+  return OK;
+}
+
+
+DECLARE_TEST(bench_prepare_execute)
+{
+  SQLINTEGER  id;
+  SQLCHAR     v[65];
+  SQLLEN      len;
+  int         i, once;
+
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG,
+                                  SQL_INTEGER, 0, 0, &id, 0, NULL));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_CHAR, v, sizeof(v), &len));
+
+  /* Preparing for every execution, then once for all of them */
+  for (once= 0; once < 2; ++once)
+  {
+    BENCH b;
+
+    if (once)
+      ok_stmt(hstmt, SQLPrepare(hstmt, (SQLCHAR *)lookup_query, SQL_NTS));
+
+    bench_begin(&b);
+
+    for (i= 0; i < bench_ops; ++i)
+    {
+      id= i % bench_rows + 1;
+
+      op_begin(&b);
+      if (!once)
+        ok_stmt(hstmt, SQLPrepare(hstmt, (SQLCHAR *)lookup_query, SQL_NTS));
+      ok_stmt(hstmt, SQLExecute(hstmt));
+      ok_stmt(hstmt, SQLFetch(hstmt));
+      ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+      op_end(&b);
+
+      ++b.rows;
+      b.bytes+= len;
+    }
+
+    bench_report(&b, once ? "execute_prepared" : "prepare_execute", "");
+  }
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+
+  return OK;
+}
+
+
+DECLARE_TEST(bench_connect)
+{
+  BENCH b;
+  int   i;
+
+  bench_begin(&b);
+
+  for (i= 0; i < bench_connects; ++i)
+  {
+    SQLHDBC hdbc1;
+
+    op_begin(&b);
+    ok_env(henv, SQLAllocHandle(SQL_HANDLE_DBC, henv, &hdbc1));
+    ok_con(hdbc1, get_connection(&hdbc1, NULL, NULL, NULL, NULL, NULL));
+    ok_con(hdbc1, SQLDisconnect(hdbc1));
+    ok_con(hdbc1, SQLFreeHandle(SQL_HANDLE_DBC, hdbc1));
+    op_end(&b);
+  }
+
+  bench_report(&b, "connect_disconnect", "");
+
+  return OK;
+}
+
+
+DECLARE_TEST(bench_catalog)
+{
+  unsigned int f;
+  const char *functions[]= {"SQLTables", "SQLColumns", "SQLPrimaryKeys",
+                            "SQLStatistics", "SQLGetTypeInfo"};
+
+  if (bench_replay)
+    skip("The replay server has no catalog");
+
+  for (f= 0; f < sizeof(functions) / sizeof(functions[0]); ++f)
+  {
+    char  params[64];
+    int   i;
+    BENCH b;
+
+    bench_begin(&b);
+
+    for (i= 0; i < bench_ops / 10; ++i)
+    {
+      SQLRETURN rc;
+
+      op_begin(&b);
+      switch (f)
+      {
+      case 0:
+        rc= SQLTables(hstmt, mydb, SQL_NTS, NULL, 0, NULL, 0, NULL, 0);
+        break;
+      case 1:
+        rc= SQLColumns(hstmt, mydb, SQL_NTS, NULL, 0,
+                       (SQLCHAR *)"bench_types", SQL_NTS, NULL, 0);
+        break;
+      case 2:
+        rc= SQLPrimaryKeys(hstmt, mydb, SQL_NTS, NULL, 0,
+                           (SQLCHAR *)"bench_types", SQL_NTS);
+        break;
+      case 3:
+        rc= SQLStatistics(hstmt, mydb, SQL_NTS, NULL, 0,
+                          (SQLCHAR *)"bench_types", SQL_NTS,
+                          SQL_INDEX_ALL, SQL_QUICK);
+        break;
+      default:
+        rc= SQLGetTypeInfo(hstmt, SQL_ALL_TYPES);
+        break;
+      }
+      ok_stmt(hstmt, rc);
+
+      while ((rc= SQLFetch(hstmt)) == SQL_SUCCESS)
+        ++b.rows;
+      is_num(rc, SQL_NO_DATA);
+
+      ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+      op_end(&b);
+    }
+
+    sprintf(params, "\"function\":\"%s\"", functions[f]);
+    bench_report(&b, "catalog", params);
+  }
+
+  return OK;
+}
+
+
+DECLARE_TEST(bench_cleanup)
+{
+  ok_sql(hstmt, "DROP TABLE IF EXISTS bench_types");
+  ok_sql(hstmt, "DROP TABLE IF EXISTS bench_params");
+
+  bench_close_output();
+
+  return OK;
+}
+
+
+BEGIN_TESTS
+  ADD_TEST(bench_setup)
+  ADD_TEST(bench_fetch_bindcol)
+  ADD_TEST(bench_fetch_getdata)
+  ADD_TEST(bench_param_arrays)
+  ADD_TEST(bench_prepare_execute)
+  ADD_TEST(bench_connect)
+  ADD_TEST(bench_catalog)
+  ADD_TEST(bench_cleanup)
+END_TESTS
+
+  if (getenv("BENCH_REPLAY") && replay_start())
+    exit(1);
+
+RUN_TESTS
@@ -0,0 +1,336 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/*
+  Checks the replay server against the client library: the handshake,
+  text and binary result sets, cursors, affected rows, files of recorded
+  results and the simulated latency.
+
+    replay_check [socket]
+
+  It needs no server, the replay server runs in the same process.
+*/
+
+#include "replay_server.h"
+
+#include <mysql.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <unistd.h>
+
+static unsigned int failures= 0, checked= 0;
+
+#define CHECK(cond) \
+  do { \
+    ++checked; \
+    if (!(cond)) \
+    { \
+      ++failures; \
+      printf("FAILED line %d: %s\n", __LINE__, #cond); \
+    } \
+  } while (0)
+
+#define CHECK_STR(value, expected) CHECK((value) && !strcmp((value), (expected)))
+
+
+static const char *check_query= "SELECT i, d, v, t, n FROM check_types";
+static const char *check_prepared= "SELECT i, d, v, t, n FROM check_types "
+                                   "WHERE i > ?";
+
+static void add_results(REPLAY_SERVER *server, unsigned long rows)
+{
+  const char *queries[]= {check_query, check_prepared};
+  const char *row[]= {"-7", "2.5", "first\tline", "2020-01-02 03:04:05.120",
+                      NULL};
+
+  for (int i= 0; i < 2; ++i)
+  {
+    REPLAY_RESULT *result= replay_server_add_result(server, queries[i]);
+
+    CHECK(!replay_result_add_column(result, "i", "INT", 0, 0));
+    CHECK(!replay_result_add_column(result, "d", "DOUBLE", 0, 0));
+    CHECK(!replay_result_add_column(result, "v", "VARCHAR", 64, 0));
+    CHECK(!replay_result_add_column(result, "t", "DATETIME", 0, 3));
+    CHECK(!replay_result_add_column(result, "n", "DECIMAL", 18, 4));
+    CHECK(replay_result_add_column(result, "x", "GEOMETRY", 0, 0));
+
+    CHECK(!replay_result_add_row(result, row, NULL));
+    CHECK(!replay_result_generate(result, rows - 1));
+  }
+
+  replay_server_add_ok(server, "UPDATE check_types SET v= ?", 42);
+}
+
+
+static void check_text(MYSQL *mysql, unsigned long rows)
+{
+  MYSQL_RES *res;
+  MYSQL_ROW row;
+  unsigned long count= 0;
+
+  CHECK(!mysql_query(mysql, check_query));
+  CHECK((res= mysql_store_result(mysql)) != NULL);
+  if (!res)
+    return;
+
+  CHECK(mysql_num_fields(res) == 5);
+  CHECK(mysql_fetch_field_direct(res, 0)->type == MYSQL_TYPE_LONG);
+  CHECK(mysql_fetch_field_direct(res, 3)->type == MYSQL_TYPE_DATETIME);
+  CHECK(mysql_fetch_field_direct(res, 3)->decimals == 3);
+  CHECK(mysql_fetch_field_direct(res, 4)->type == MYSQL_TYPE_NEWDECIMAL);
+
+  row= mysql_fetch_row(res);
+  CHECK(row != NULL);
+  if (row)
+  {
+    CHECK_STR(row[0], "-7");
+    CHECK_STR(row[2], "first\tline");
+    CHECK_STR(row[3], "2020-01-02 03:04:05.120");
+    CHECK(row[4] == NULL);
+    ++count;
+  }
+
+  if ((row= mysql_fetch_row(res)))
+  {
+    /* The first generated row */
+    CHECK_STR(row[0], "1");
+    CHECK_STR(row[4], "1.0037");
+    ++count;
+  }
+
+  while (mysql_fetch_row(res))
+    ++count;
+  CHECK(count == rows);
+
+  mysql_free_result(res);
+
+  /* Statements nobody registered just succeed */
+  CHECK(!mysql_query(mysql, "SET SESSION sql_mode= ''"));
+  CHECK(mysql_field_count(mysql) == 0);
+  CHECK(!mysql_ping(mysql));
+}
+
+
+static void check_binary(MYSQL *mysql, unsigned long rows, bool cursor)
+{
+  MYSQL_STMT *stmt= mysql_stmt_init(mysql);
+  MYSQL_BIND param, result[5];
+  MYSQL_TIME t;
+  int i_value, min_value= -100;
+  double d_value;
+  char v_value[65], n_value[32];
+  unsigned long v_length, n_length, count= 0;
+  bool is_null[5];
+  int rc;
+
+  CHECK(!mysql_stmt_prepare(stmt, check_prepared, strlen(check_prepared)));
+  CHECK(mysql_stmt_param_count(stmt) == 1);
+  CHECK(mysql_stmt_field_count(stmt) == 5);
+
+  if (cursor)
+  {
+    unsigned long type= CURSOR_TYPE_READ_ONLY, prefetch= 7;
+    mysql_stmt_attr_set(stmt, STMT_ATTR_CURSOR_TYPE, &type);
+    mysql_stmt_attr_set(stmt, STMT_ATTR_PREFETCH_ROWS, &prefetch);
+  }
+
+  memset(&param, 0, sizeof(param));
+  param.buffer_type= MYSQL_TYPE_LONG;
+  param.buffer= &min_value;
+  CHECK(!mysql_stmt_bind_param(stmt, &param));
+
+  memset(result, 0, sizeof(result));
+  result[0].buffer_type= MYSQL_TYPE_LONG;
+  result[0].buffer= &i_value;
+  result[1].buffer_type= MYSQL_TYPE_DOUBLE;
+  result[1].buffer= &d_value;
+  result[2].buffer_type= MYSQL_TYPE_STRING;
+  result[2].buffer= v_value;
+  result[2].buffer_length= sizeof(v_value);
+  result[2].length= &v_length;
+  result[3].buffer_type= MYSQL_TYPE_DATETIME;
+  result[3].buffer= &t;
+  result[4].buffer_type= MYSQL_TYPE_STRING;
+  result[4].buffer= n_value;
+  result[4].buffer_length= sizeof(n_value);
+  result[4].length= &n_length;
+  for (int i= 0; i < 5; ++i)
+    result[i].is_null= &is_null[i];
+  CHECK(!mysql_stmt_bind_result(stmt, result));
+
+  CHECK(!mysql_stmt_execute(stmt));
+
+  while ((rc= mysql_stmt_fetch(stmt)) == 0)
+  {
+    if (count == 0)
+    {
+      CHECK(i_value == -7);
+      CHECK(d_value == 2.5);
+      CHECK(v_length == 10 && !memcmp(v_value, "first\tline", 10));
+      CHECK(t.year == 2020 && t.month == 1 && t.day == 2 && t.hour == 3 &&
+            t.minute == 4 && t.second == 5 && t.second_part == 120000);
+      CHECK(is_null[4] && !is_null[3]);
+    }
+    else if (count == 1)
+    {
+      CHECK(i_value == 1);
+      CHECK(d_value == 1 / 3.0);
+      CHECK(t.year == 2018 && t.minute == 1 && t.second == 1);
+      CHECK(n_length == 6 && !memcmp(n_value, "1.0037", 6));
+    }
+    ++count;
+  }
+  CHECK(rc == MYSQL_NO_DATA);
+  CHECK(count == rows);
+
+  mysql_stmt_close(stmt);
+
+  /* A registered statement without a result set */
+  stmt= mysql_stmt_init(mysql);
+  CHECK(!mysql_stmt_prepare(stmt, "UPDATE check_types SET v= ?", 27));
+  param.buffer_type= MYSQL_TYPE_STRING;
+  param.buffer= v_value;
+  param.buffer_length= 3;
+  CHECK(!mysql_stmt_bind_param(stmt, &param));
+  CHECK(!mysql_stmt_execute(stmt));
+  CHECK(mysql_stmt_affected_rows(stmt) == 42);
+  mysql_stmt_close(stmt);
+}
+
+
+static void check_file(REPLAY_SERVER *server, MYSQL *mysql)
+{
+  char path[]= "/tmp/replay_checkXXXXXX";
+  int fd= mkstemp(path);
+  FILE *file= fd < 0 ? NULL : fdopen(fd, "w");
+  MYSQL_RES *res;
+  MYSQL_ROW row;
+  unsigned long *lengths;
+
+  CHECK(file != NULL);
+  if (!file)
+    return;
+
+  fputs("# recorded\n"
+        "query SELECT a, b FROM recorded\n"
+        "column a BIGINT UNSIGNED\n"
+        "column b VARBINARY 16\n"
+        "row 18446744073709551615\t\\x00\\xff\\\\\n"
+        "row 1\t\\N\n"
+        "ok 3 DELETE FROM recorded\n"
+        "bogus\n", file);
+  fclose(file);
+
+  CHECK(replay_server_load(server, path) == 8);
+  CHECK(replay_server_load(server, "/nonexistent/replay") == -1);
+  unlink(path);
+
+  CHECK(!mysql_query(mysql, "SELECT a, b FROM recorded"));
+  CHECK((res= mysql_store_result(mysql)) != NULL);
+  if (!res)
+    return;
+
+  CHECK(mysql_fetch_field_direct(res, 0)->flags & UNSIGNED_FLAG);
+  row= mysql_fetch_row(res);
+  lengths= mysql_fetch_lengths(res);
+  CHECK(row && !strcmp(row[0], "18446744073709551615"));
+  CHECK(row && lengths[1] == 3 && !memcmp(row[1], "\0\xff\\", 3));
+  row= mysql_fetch_row(res);
+  CHECK(row && row[1] == NULL);
+  CHECK(mysql_fetch_row(res) == NULL);
+  mysql_free_result(res);
+
+  CHECK(!mysql_query(mysql, "DELETE FROM recorded"));
+  CHECK(mysql_affected_rows(mysql) == 3);
+}
+
+
+static void check_latency(REPLAY_SERVER *server, MYSQL *mysql)
+{
+  std::chrono::steady_clock::time_point start;
+  double elapsed;
+
+  replay_server_set_latency(server, 20000);
+  start= std::chrono::steady_clock::now();
+  CHECK(!mysql_ping(mysql));
+  elapsed= std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start).count();
+  replay_server_set_latency(server, 0);
+
+  CHECK(elapsed >= 0.02);
+}
+
+
+int main(int argc, char **argv)
+{
+  char default_path[64];
+  std::string path;
+  const unsigned long rows= 1000;
+  REPLAY_SERVER *server;
+  MYSQL *mysql;
+
+  sprintf(default_path, "/tmp/replay_check_%d.sock", (int)getpid());
+  path= argc > 1 ? argv[1] : default_path;
+
+  if (!(server= replay_server_start(path.c_str())))
+    return 1;
+
+  add_results(server, rows);
+
+  mysql= mysql_init(NULL);
+  if (!mysql_real_connect(mysql, "localhost", "user", "password", "test", 0,
+                          path.c_str(), 0))
+  {
+    printf("FAILED to connect: %s\n", mysql_error(mysql));
+    replay_server_stop(server);
+    return 1;
+  }
+
+  CHECK(!strcmp(mysql_get_server_info(mysql), "8.0.13-replay"));
+
+  check_text(mysql, rows);
+  check_binary(mysql, rows, false);
+  check_binary(mysql, rows, true);
+  check_file(server, mysql);
+  check_latency(server, mysql);
+
+  /* The server closes connections that are still open when it stops */
+  replay_server_stop(server);
+  CHECK(mysql_ping(mysql) != 0);
+  mysql_close(mysql);
+
+  printf("checked=%u;failures=%u\n", checked, failures);
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,1474 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/**
+  @file  replay_server.cc
+  @brief A MySQL protocol server that answers from memory, see
+         replay_server.h.
+*/
+
+#include "replay_server.h"
+
+#include <mysql.h>
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define REPLAY_VERSION "8.0.13-replay"
+#define REPLAY_AUTH_PLUGIN "caching_sha2_password"
+#define REPLAY_SCRAMBLE_LENGTH 20
+
+/* utf8mb4_0900_ai_ci, what text columns are reported in */
+#define REPLAY_TEXT_CHARSET 255
+#define REPLAY_TEXT_MBMAXLEN 4
+#define REPLAY_BINARY_CHARSET 63
+
+#define REPLAY_CAPABILITIES (CLIENT_LONG_PASSWORD | CLIENT_FOUND_ROWS | \
+  CLIENT_LONG_FLAG | CLIENT_CONNECT_WITH_DB | CLIENT_NO_SCHEMA | \
+  CLIENT_ODBC | CLIENT_IGNORE_SPACE | CLIENT_PROTOCOL_41 | \
+  CLIENT_INTERACTIVE | CLIENT_IGNORE_SIGPIPE | CLIENT_TRANSACTIONS | \
+  CLIENT_RESERVED2 | CLIENT_MULTI_STATEMENTS | CLIENT_MULTI_RESULTS | \
+  CLIENT_PS_MULTI_RESULTS | CLIENT_PLUGIN_AUTH)
+
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
+
+
+struct replay_column
+{
+  std::string      name;
+  enum_field_types type;
+  unsigned int     charset;
+  unsigned long    length;
+  unsigned int     flags;
+  unsigned int     decimals;
+};
+
+
+struct replay_result
+{
+  std::vector<replay_column> columns;
+  /* Payloads of the rows in the text and in the binary protocol */
+  std::vector<std::string>   text_rows, binary_rows;
+  unsigned long long         affected_rows;
+
+  /* Complete replies to COM_QUERY and COM_STMT_EXECUTE, built on first use */
+  std::once_flag             built;
+  std::atomic<bool>          in_use;
+  std::string                metadata, text_reply, binary_reply;
+
+  replay_result() : affected_rows(0), in_use(false) {}
+};
+
+
+struct replay_server
+{
+  std::string     path;
+  int             fd;
+  std::thread     acceptor;
+  std::atomic<bool> stopping;
+  std::atomic<unsigned int> latency;
+
+  std::mutex      lock;
+  std::vector<std::unique_ptr<replay_result>> results;
+  std::map<std::string, replay_result *> queries;
+
+  /* Open connections, to be able to close them on stop */
+  std::set<int>   connections;
+  std::condition_variable all_closed;
+  unsigned long   next_id;
+
+  replay_server() : fd(-1), stopping(false), latency(0), next_id(0) {}
+};
+
+
+/*
+  Building packets
+*/
+
+static void put_int(std::string &buf, unsigned long long value, int bytes)
+{
+  for (int i= 0; i < bytes; ++i)
+    buf+= (char)((value >> (8 * i)) & 0xff);
+}
+
+
+static void put_lenenc(std::string &buf, unsigned long long value)
+{
+  if (value < 251)
+    put_int(buf, value, 1);
+  else if (value < 0x10000ULL)
+  {
+    buf+= (char)0xfc;
+    put_int(buf, value, 2);
+  }
+  else if (value < 0x1000000ULL)
+  {
+    buf+= (char)0xfd;
+    put_int(buf, value, 3);
+  }
+  else
+  {
+    buf+= (char)0xfe;
+    put_int(buf, value, 8);
+  }
+}
+
+
+static void put_lenenc_str(std::string &buf, const char *str, size_t length)
+{
+  put_lenenc(buf, length);
+  buf.append(str, length);
+}
+
+
+static void put_lenenc_str(std::string &buf, const std::string &str)
+{
+  put_lenenc_str(buf, str.data(), str.size());
+}
+
+
+/**
+  Append a payload as one or more packets, numbering them from seq on.
+*/
+static void put_packet(std::string &out, unsigned char &seq,
+                       const std::string &payload)
+{
+  size_t pos= 0;
+
+  for (;;)
+  {
+    size_t length= payload.size() - pos;
+    if (length > MAX_PACKET_LENGTH)
+      length= MAX_PACKET_LENGTH;
+
+    put_int(out, length, 3);
+    out+= (char)seq++;
+    out.append(payload, pos, length);
+    pos+= length;
+
+    /* A full packet is followed by another one, if only an empty one */
+    if (length < MAX_PACKET_LENGTH)
+      break;
+  }
+}
+
+
+static std::string ok_payload(unsigned long long affected_rows)
+{
+  std::string buf(1, '\0');
+  put_lenenc(buf, affected_rows);
+  put_lenenc(buf, 0);
+  put_int(buf, SERVER_STATUS_AUTOCOMMIT, 2);
+  put_int(buf, 0, 2);
+  return buf;
+}
+
+
+static std::string eof_payload(unsigned int status)
+{
+  std::string buf(1, (char)0xfe);
+  put_int(buf, 0, 2);
+  put_int(buf, status, 2);
+  return buf;
+}
+
+
+static std::string error_payload(unsigned int error, const char *sqlstate,
+                                 const char *message)
+{
+  std::string buf(1, (char)0xff);
+  put_int(buf, error, 2);
+  buf+= '#';
+  buf.append(sqlstate, 5);
+  buf+= message;
+  return buf;
+}
+
+
+static std::string column_payload(const replay_column &column)
+{
+  std::string buf;
+
+  put_lenenc_str(buf, "def", 3);
+  put_lenenc_str(buf, "", 0);     /* schema */
+  put_lenenc_str(buf, "", 0);     /* table */
+  put_lenenc_str(buf, "", 0);     /* original table */
+  put_lenenc_str(buf, column.name);
+  put_lenenc_str(buf, column.name);
+  put_lenenc(buf, 0x0c);
+  put_int(buf, column.charset, 2);
+  put_int(buf, column.length, 4);
+  put_int(buf, column.type, 1);
+  put_int(buf, column.flags, 2);
+  put_int(buf, column.decimals, 1);
+  put_int(buf, 0, 2);
+
+  return buf;
+}
+
+
+/*
+  Column types and values
+*/
+
+static const struct
+{
+  const char       *name;
+  enum_field_types type;
+  unsigned long    length;    /* default */
+  bool             text;      /* character data, otherwise binary */
+  bool             blob;
+} replay_types[]=
+{
+  {"TINYINT",   MYSQL_TYPE_TINY,        4,     false, false},
+  {"SMALLINT",  MYSQL_TYPE_SHORT,       6,     false, false},
+  {"MEDIUMINT", MYSQL_TYPE_INT24,       9,     false, false},
+  {"INT",       MYSQL_TYPE_LONG,        11,    false, false},
+  {"INTEGER",   MYSQL_TYPE_LONG,        11,    false, false},
+  {"BIGINT",    MYSQL_TYPE_LONGLONG,    20,    false, false},
+  {"FLOAT",     MYSQL_TYPE_FLOAT,       12,    false, false},
+  {"DOUBLE",    MYSQL_TYPE_DOUBLE,      22,    false, false},
+  {"DECIMAL",   MYSQL_TYPE_NEWDECIMAL,  10,    false, false},
+  {"DATE",      MYSQL_TYPE_DATE,        10,    false, false},
+  {"TIME",      MYSQL_TYPE_TIME,        10,    false, false},
+  {"DATETIME",  MYSQL_TYPE_DATETIME,    19,    false, false},
+  {"TIMESTAMP", MYSQL_TYPE_TIMESTAMP,   19,    false, false},
+  {"YEAR",      MYSQL_TYPE_YEAR,        4,     false, false},
+  {"CHAR",      MYSQL_TYPE_STRING,      1,     true,  false},
+  {"VARCHAR",   MYSQL_TYPE_VAR_STRING,  255,   true,  false},
+  {"BINARY",    MYSQL_TYPE_STRING,      1,     false, false},
+  {"VARBINARY", MYSQL_TYPE_VAR_STRING,  255,   false, false},
+  {"TEXT",      MYSQL_TYPE_BLOB,        65535, true,  true},
+  {"BLOB",      MYSQL_TYPE_BLOB,        65535, false, true}
+};
+
+
+static bool is_string_type(enum_field_types type)
+{
+  return type == MYSQL_TYPE_STRING || type == MYSQL_TYPE_VAR_STRING ||
+         type == MYSQL_TYPE_BLOB;
+}
+
+
+static bool parse_datetime(const std::string &value, MYSQL_TIME *tm)
+{
+  unsigned int frac= 0, digits= 0;
+  const char *dot;
+
+  memset(tm, 0, sizeof(MYSQL_TIME));
+
+  if (sscanf(value.c_str(), "%4u-%2u-%2u %2u:%2u:%2u", &tm->year, &tm->month,
+             &tm->day, &tm->hour, &tm->minute, &tm->second) < 3)
+    return false;
+
+  if ((dot= strchr(value.c_str(), '.')))
+  {
+    for (++dot; *dot >= '0' && *dot <= '9' && digits < 6; ++dot, ++digits)
+      frac= frac * 10 + (*dot - '0');
+    for (; digits < 6; ++digits)
+      frac*= 10;
+    tm->second_part= frac;
+  }
+
+  return true;
+}
+
+
+static bool parse_time(const std::string &value, MYSQL_TIME *tm)
+{
+  const char *pos= value.c_str();
+  const char *dot;
+  unsigned int hours, frac= 0, digits= 0;
+
+  memset(tm, 0, sizeof(MYSQL_TIME));
+
+  if (*pos == '-')
+  {
+    tm->neg= true;
+    ++pos;
+  }
+
+  if (sscanf(pos, "%u:%2u:%2u", &hours, &tm->minute, &tm->second) != 3)
+    return false;
+
+  tm->day= hours / 24;
+  tm->hour= hours % 24;
+
+  if ((dot= strchr(pos, '.')))
+  {
+    for (++dot; *dot >= '0' && *dot <= '9' && digits < 6; ++dot, ++digits)
+      frac= frac * 10 + (*dot - '0');
+    for (; digits < 6; ++digits)
+      frac*= 10;
+    tm->second_part= frac;
+  }
+
+  return true;
+}
+
+
+/**
+  Append a value in the binary protocol, converted from its text form.
+*/
+static bool put_binary_value(std::string &buf, const replay_column &column,
+                             const std::string &value)
+{
+  bool is_unsigned= (column.flags & UNSIGNED_FLAG) != 0;
+  char *end;
+  MYSQL_TIME tm;
+
+  if (is_string_type(column.type) || column.type == MYSQL_TYPE_NEWDECIMAL)
+  {
+    put_lenenc_str(buf, value);
+    return true;
+  }
+
+  switch (column.type)
+  {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_YEAR:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+  case MYSQL_TYPE_LONGLONG:
+  {
+    unsigned long long number= is_unsigned ?
+      strtoull(value.c_str(), &end, 10) :
+      (unsigned long long)strtoll(value.c_str(), &end, 10);
+
+    if (*end || value.empty())
+      return false;
+
+    put_int(buf, number, column.type == MYSQL_TYPE_TINY ? 1 :
+                         column.type == MYSQL_TYPE_SHORT ||
+                         column.type == MYSQL_TYPE_YEAR ? 2 :
+                         column.type == MYSQL_TYPE_LONGLONG ? 8 : 4);
+    return true;
+  }
+
+  case MYSQL_TYPE_FLOAT:
+  {
+    float number= strtof(value.c_str(), &end);
+    if (*end || value.empty())
+      return false;
+    buf.append((const char *)&number, sizeof(number));
+    return true;
+  }
+
+  case MYSQL_TYPE_DOUBLE:
+  {
+    double number= strtod(value.c_str(), &end);
+    if (*end || value.empty())
+      return false;
+    buf.append((const char *)&number, sizeof(number));
+    return true;
+  }
+
+  case MYSQL_TYPE_DATE:
+  case MYSQL_TYPE_DATETIME:
+  case MYSQL_TYPE_TIMESTAMP:
+  {
+    unsigned int length;
+
+    if (!parse_datetime(value, &tm))
+      return false;
+
+    /* Only as much as is not zero */
+    length= tm.second_part ? 11 : tm.hour || tm.minute || tm.second ? 7 : 4;
+
+    put_int(buf, length, 1);
+    put_int(buf, tm.year, 2);
+    put_int(buf, tm.month, 1);
+    put_int(buf, tm.day, 1);
+    if (length >= 7)
+    {
+      put_int(buf, tm.hour, 1);
+      put_int(buf, tm.minute, 1);
+      put_int(buf, tm.second, 1);
+    }
+    if (length == 11)
+      put_int(buf, tm.second_part, 4);
+    return true;
+  }
+
+  case MYSQL_TYPE_TIME:
+    if (!parse_time(value, &tm))
+      return false;
+
+    buf+= (char)(tm.second_part ? 12 : 8);
+    put_int(buf, tm.neg, 1);
+    put_int(buf, tm.day, 4);
+    put_int(buf, tm.hour, 1);
+    put_int(buf, tm.minute, 1);
+    put_int(buf, tm.second, 1);
+    if (tm.second_part)
+      put_int(buf, tm.second_part, 4);
+    return true;
+
+  default:
+    put_lenenc_str(buf, value);
+    return true;
+  }
+}
+
+
+/**
+  The value of a generated row, as text.
+*/
+static std::string generate_value(const replay_column &column,
+                                  unsigned long row)
+{
+  unsigned long long n= row + 1;
+  /* 2018-01-01 00:00:00 UTC */
+  time_t base= 1514764800;
+  char buff[128];
+  struct tm tm;
+  std::string text;
+  size_t length;
+
+  switch (column.type)
+  {
+  case MYSQL_TYPE_TINY:
+    sprintf(buff, "%llu", n % (column.flags & UNSIGNED_FLAG ? 256 : 128));
+    return buff;
+  case MYSQL_TYPE_SHORT:
+    sprintf(buff, "%llu", n % (column.flags & UNSIGNED_FLAG ? 65536 : 32768));
+    return buff;
+  case MYSQL_TYPE_INT24:
+    sprintf(buff, "%llu", n % 8388608);
+    return buff;
+  case MYSQL_TYPE_LONG:
+    sprintf(buff, "%llu", n % 2147483648ULL);
+    return buff;
+  case MYSQL_TYPE_LONGLONG:
+    sprintf(buff, "%llu", n * 1000003);
+    return buff;
+  case MYSQL_TYPE_YEAR:
+    sprintf(buff, "%llu", 1901 + n % 255);
+    return buff;
+  case MYSQL_TYPE_FLOAT:
+    sprintf(buff, "%.7g", n / 4.0);
+    return buff;
+  case MYSQL_TYPE_DOUBLE:
+    sprintf(buff, "%.17g", n / 3.0);
+    return buff;
+
+  case MYSQL_TYPE_NEWDECIMAL:
+  {
+    unsigned long long int_limit= 1, frac_limit= 1;
+    unsigned int i, precision= column.length - 2;
+
+    for (i= column.decimals; i < precision && i < 18; ++i)
+      int_limit*= 10;
+    for (i= 0; i < column.decimals && i < 18; ++i)
+      frac_limit*= 10;
+
+    if (column.decimals)
+      sprintf(buff, "%llu.%0*llu", n % int_limit, (int)column.decimals,
+              n * 37 % frac_limit);
+    else
+      sprintf(buff, "%llu", n % int_limit);
+    return buff;
+  }
+
+  case MYSQL_TYPE_DATE:
+    base+= (time_t)(n % 36500) * 86400;
+    gmtime_r(&base, &tm);
+    strftime(buff, sizeof(buff), "%Y-%m-%d", &tm);
+    return buff;
+
+  case MYSQL_TYPE_DATETIME:
+  case MYSQL_TYPE_TIMESTAMP:
+    base+= (time_t)(n % 100000000) * 61;
+    gmtime_r(&base, &tm);
+    length= strftime(buff, sizeof(buff), "%Y-%m-%d %H:%M:%S", &tm);
+    if (column.decimals)
+      sprintf(buff + length, ".%06llu", n * 7919 % 1000000);
+    /* Only as many digits as the column has */
+    text= buff;
+    if (column.decimals)
+      text.resize(length + 1 + column.decimals);
+    return text;
+
+  case MYSQL_TYPE_TIME:
+    sprintf(buff, "%02llu:%02llu:%02llu", n % 3000000 / 3600,
+            n % 3600 / 60, n % 60);
+    return buff;
+
+  default:
+    break;
+  }
+
+  /* Character and binary data */
+  if (column.flags & BLOB_FLAG)
+    length= 256;
+  else
+  {
+    length= column.length;
+    if (column.charset == REPLAY_TEXT_CHARSET)
+      length/= REPLAY_TEXT_MBMAXLEN;
+    if (length > 64)
+      length= 64;
+  }
+
+  sprintf(buff, "value %llu ", n);
+  while (text.size() < length)
+    text+= buff;
+  /* CHAR is padded to its length, VARCHAR and the rest vary with the row */
+  if (column.type != MYSQL_TYPE_STRING)
+    length-= n % (length / 2 + 1);
+  text.resize(length);
+
+  return text;
+}
+
+
+/**
+  Put the replies together, after which the result set cannot change.
+*/
+static void build_replies(replay_result *result)
+{
+  unsigned char seq= 1;
+
+  result->in_use= true;
+
+  if (result->columns.empty())
+  {
+    put_packet(result->text_reply, seq, ok_payload(result->affected_rows));
+    result->binary_reply= result->text_reply;
+    return;
+  }
+
+  std::string count;
+  put_lenenc(count, result->columns.size());
+  put_packet(result->metadata, seq, count);
+  for (size_t i= 0; i < result->columns.size(); ++i)
+    put_packet(result->metadata, seq, column_payload(result->columns[i]));
+  put_packet(result->metadata, seq, eof_payload(SERVER_STATUS_AUTOCOMMIT));
+
+  for (int binary= 0; binary < 2; ++binary)
+  {
+    std::string &reply= binary ? result->binary_reply : result->text_reply;
+    std::vector<std::string> &rows= binary ? result->binary_rows :
+                                             result->text_rows;
+    unsigned char row_seq= seq;
+    size_t size= result->metadata.size() + 9;
+
+    for (size_t i= 0; i < rows.size(); ++i)
+      size+= rows[i].size() + 4;
+
+    reply.reserve(size);
+    reply.append(result->metadata);
+    for (size_t i= 0; i < rows.size(); ++i)
+      put_packet(reply, row_seq, rows[i]);
+    put_packet(reply, row_seq, eof_payload(SERVER_STATUS_AUTOCOMMIT));
+  }
+}
+
+
+/*
+  The connection
+*/
+
+struct replay_statement
+{
+  replay_result *result;
+  unsigned long  position;   /* of the next row to fetch with a cursor */
+};
+
+
+class replay_connection
+{
+  replay_server *server;
+  int            fd;
+  std::string    packet;
+  unsigned char  seq;
+  std::map<unsigned long, replay_statement> statements;
+  unsigned long  next_statement;
+
+  bool read_exactly(char *buf, size_t length)
+  {
+    while (length)
+    {
+      ssize_t got= recv(fd, buf, length, 0);
+      if (got < 0 && errno == EINTR)
+        continue;
+      if (got <= 0)
+        return false;
+      buf+= got;
+      length-= got;
+    }
+    return true;
+  }
+
+  /* Read a payload, joined from as many packets as it takes */
+  bool read_packet()
+  {
+    unsigned char header[4];
+    size_t length;
+
+    packet.clear();
+    do
+    {
+      if (!read_exactly((char *)header, 4))
+        return false;
+      length= header[0] | (header[1] << 8) | (header[2] << 16);
+      seq= header[3] + 1;
+
+      size_t pos= packet.size();
+      packet.resize(pos + length);
+      if (length && !read_exactly(&packet[pos], length))
+        return false;
+    } while (length == MAX_PACKET_LENGTH);
+
+    return true;
+  }
+
+  bool write_all(const std::string &buf)
+  {
+    const char *pos= buf.data();
+    size_t length= buf.size();
+    unsigned int latency= server->latency;
+
+    if (latency)
+      std::this_thread::sleep_for(std::chrono::microseconds(latency));
+
+    while (length)
+    {
+      ssize_t sent= send(fd, pos, length, MSG_NOSIGNAL);
+      if (sent < 0 && errno == EINTR)
+        continue;
+      if (sent <= 0)
+        return false;
+      pos+= sent;
+      length-= sent;
+    }
+    return true;
+  }
+
+  /* Send one payload as the reply to the packet just read */
+  bool reply(const std::string &payload)
+  {
+    std::string out;
+    put_packet(out, seq, payload);
+    return write_all(out);
+  }
+
+  replay_result *find_result(const std::string &query)
+  {
+    std::lock_guard<std::mutex> guard(server->lock);
+    std::map<std::string, replay_result *>::iterator it=
+      server->queries.find(query);
+    if (it == server->queries.end())
+      return NULL;
+
+    std::call_once(it->second->built, build_replies, it->second);
+    return it->second;
+  }
+
+  bool handshake();
+  bool prepare();
+  bool execute();
+  bool fetch();
+
+public:
+  replay_connection(replay_server *server_arg, int fd_arg)
+    : server(server_arg), fd(fd_arg), seq(0), next_statement(0)
+  {}
+
+  void run();
+};
+
+
+bool replay_connection::handshake()
+{
+  std::string greeting, scramble;
+  unsigned long id;
+  unsigned int capabilities;
+  size_t pos, auth_length;
+  const char *plugin;
+
+  {
+    std::lock_guard<std::mutex> guard(server->lock);
+    id= ++server->next_id;
+  }
+
+  /* Never checked, but the client needs one to scramble the password */
+  for (int i= 0; i < REPLAY_SCRAMBLE_LENGTH; ++i)
+    scramble+= (char)('!' + (id * 31 + i * 7) % 90);
+
+  greeting+= (char)10;
+  greeting.append(REPLAY_VERSION, sizeof(REPLAY_VERSION));
+  put_int(greeting, id, 4);
+  greeting.append(scramble, 0, 8);
+  greeting+= '\0';
+  put_int(greeting, REPLAY_CAPABILITIES & 0xffff, 2);
+  put_int(greeting, REPLAY_TEXT_CHARSET, 1);
+  put_int(greeting, SERVER_STATUS_AUTOCOMMIT, 2);
+  put_int(greeting, REPLAY_CAPABILITIES >> 16, 2);
+  put_int(greeting, REPLAY_SCRAMBLE_LENGTH + 1, 1);
+  greeting.append(10, '\0');
+  greeting.append(scramble, 8, std::string::npos);
+  greeting+= '\0';
+  greeting.append(REPLAY_AUTH_PLUGIN, sizeof(REPLAY_AUTH_PLUGIN));
+
+  if (!reply(greeting) || !read_packet())
+    return false;
+
+  /*
+    HandshakeResponse41: capabilities, max packet, charset, filler, then
+    the user, the scrambled password, the database and the plugin
+  */
+  if (packet.size() < 32)
+    return false;
+
+  capabilities= (unsigned char)packet[0] | ((unsigned char)packet[1] << 8) |
+                ((unsigned char)packet[2] << 16) |
+                ((unsigned int)(unsigned char)packet[3] << 24);
+
+  if (capabilities & CLIENT_SSL)
+  {
+    reply(error_payload(1045, "28000", "SSL is not supported"));
+    return false;
+  }
+
+  /* The user */
+  pos= 32 + strlen(packet.c_str() + 32) + 1;
+  auth_length= 0;
+
+  if (pos < packet.size())
+  {
+    if (capabilities & CLIENT_RESERVED2)
+      auth_length= (unsigned char)packet[pos++];
+    else
+      auth_length= strlen(packet.c_str() + pos) + 1;
+    pos+= auth_length;
+  }
+
+  if ((capabilities & CLIENT_CONNECT_WITH_DB) && pos < packet.size())
+    pos+= strlen(packet.c_str() + pos) + 1;
+
+  plugin= (capabilities & CLIENT_PLUGIN_AUTH) && pos < packet.size() ?
+          packet.c_str() + pos : REPLAY_AUTH_PLUGIN;
+
+  if (!strcmp(plugin, "mysql_native_password"))
+    return reply(ok_payload(0));
+
+  /* Switch to caching_sha2_password if the client started with another one */
+  if (strcmp(plugin, REPLAY_AUTH_PLUGIN))
+  {
+    std::string change(1, (char)0xfe);
+    change.append(REPLAY_AUTH_PLUGIN, sizeof(REPLAY_AUTH_PLUGIN));
+    change+= scramble;
+    change+= '\0';
+
+    if (!reply(change) || !read_packet())
+      return false;
+    auth_length= packet.size();
+  }
+
+  /*
+    An empty password is sent as nothing or a single zero byte. Any other
+    one passes the fast authentication, as if it had been cached.
+  */
+  if (auth_length > 1 && !reply(std::string("\x01\x03", 2)))
+    return false;
+
+  return reply(ok_payload(0));
+}
+
+
+bool replay_connection::prepare()
+{
+  std::string query(packet, 1), out;
+  replay_result *result= find_result(query);
+  unsigned int params= 0;
+  char quote= 0;
+
+  /* Count the parameter markers outside of quotes */
+  for (size_t i= 0; i < query.size(); ++i)
+  {
+    char c= query[i];
+
+    if (quote)
+    {
+      if (c == '\\' && quote != '`')
+        ++i;
+      else if (c == quote)
+        quote= 0;
+    }
+    else if (c == '\'' || c == '"' || c == '`')
+      quote= c;
+    else if (c == '?')
+      ++params;
+  }
+
+  replay_statement &stmt= statements[++next_statement];
+  stmt.result= result;
+  stmt.position= 0;
+
+  size_t columns= result ? result->columns.size() : 0;
+  std::string prepare_ok(1, '\0');
+  put_int(prepare_ok, next_statement, 4);
+  put_int(prepare_ok, columns, 2);
+  put_int(prepare_ok, params, 2);
+  put_int(prepare_ok, 0, 1);
+  put_int(prepare_ok, 0, 2);
+  put_packet(out, seq, prepare_ok);
+
+  if (params)
+  {
+    replay_column param;
+    param.name= "?";
+    param.type= MYSQL_TYPE_VAR_STRING;
+    param.charset= REPLAY_BINARY_CHARSET;
+    param.length= 0;
+    param.flags= BINARY_FLAG;
+    param.decimals= 0;
+
+    std::string payload= column_payload(param);
+    for (unsigned int i= 0; i < params; ++i)
+      put_packet(out, seq, payload);
+    put_packet(out, seq, eof_payload(SERVER_STATUS_AUTOCOMMIT));
+  }
+
+  if (columns)
+  {
+    for (size_t i= 0; i < columns; ++i)
+      put_packet(out, seq, column_payload(result->columns[i]));
+    put_packet(out, seq, eof_payload(SERVER_STATUS_AUTOCOMMIT));
+  }
+
+  return write_all(out);
+}
+
+
+bool replay_connection::execute()
+{
+  unsigned long id;
+  std::map<unsigned long, replay_statement>::iterator it;
+
+  if (packet.size() < 10)
+    return reply(error_payload(1210, "HY000",
+                               "Incorrect arguments to mysqld_stmt_execute"));
+
+  id= (unsigned char)packet[1] | ((unsigned char)packet[2] << 8) |
+      ((unsigned char)packet[3] << 16) |
+      ((unsigned long)(unsigned char)packet[4] << 24);
+
+  if ((it= statements.find(id)) == statements.end())
+    return reply(error_payload(1243, "HY000",
+                               "Unknown prepared statement handler"));
+
+  replay_result *result= it->second.result;
+
+  if (!result)
+    return reply(ok_payload(0));
+
+  if (result->columns.empty() || !(packet[5] & CURSOR_TYPE_READ_ONLY))
+  {
+    seq= 1;
+    return write_all(result->binary_reply);
+  }
+
+  /* With a cursor only the metadata now, the rows come with COM_STMT_FETCH */
+  std::string out= result->metadata;
+  out.resize(out.size() - 9);
+  seq= 1 + 1 + result->columns.size();
+  put_packet(out, seq, eof_payload(SERVER_STATUS_AUTOCOMMIT |
+                                   SERVER_STATUS_CURSOR_EXISTS));
+  it->second.position= 0;
+
+  return write_all(out);
+}
+
+
+bool replay_connection::fetch()
+{
+  unsigned long id, rows, i;
+  std::map<unsigned long, replay_statement>::iterator it;
+  std::string out;
+
+  if (packet.size() < 9)
+    return reply(error_payload(1210, "HY000",
+                               "Incorrect arguments to mysqld_stmt_fetch"));
+
+  id= (unsigned char)packet[1] | ((unsigned char)packet[2] << 8) |
+      ((unsigned char)packet[3] << 16) |
+      ((unsigned long)(unsigned char)packet[4] << 24);
+  rows= (unsigned char)packet[5] | ((unsigned char)packet[6] << 8) |
+        ((unsigned char)packet[7] << 16) |
+        ((unsigned long)(unsigned char)packet[8] << 24);
+
+  if ((it= statements.find(id)) == statements.end() || !it->second.result)
+    return reply(error_payload(1243, "HY000",
+                               "Unknown prepared statement handler"));
+
+  replay_statement &stmt= it->second;
+  std::vector<std::string> &data= stmt.result->binary_rows;
+
+  for (i= 0; i < rows && stmt.position < data.size(); ++i)
+    put_packet(out, seq, data[stmt.position++]);
+
+  put_packet(out, seq, eof_payload(SERVER_STATUS_AUTOCOMMIT |
+                                   (stmt.position < data.size() ?
+                                    SERVER_STATUS_CURSOR_EXISTS :
+                                    SERVER_STATUS_LAST_ROW_SENT)));
+  return write_all(out);
+}
+
+
+void replay_connection::run()
+{
+  if (!handshake())
+    return;
+
+  while (read_packet())
+  {
+    bool ok= true;
+
+    if (packet.empty())
+      break;
+
+    switch ((unsigned char)packet[0])
+    {
+    case COM_QUIT:
+      return;
+
+    case COM_QUERY:
+    {
+      replay_result *result= find_result(std::string(packet, 1));
+      if (result)
+      {
+        seq= 1;
+        ok= write_all(result->text_reply);
+      }
+      else
+        ok= reply(ok_payload(0));
+      break;
+    }
+
+    case COM_STMT_PREPARE:
+      ok= prepare();
+      break;
+
+    case COM_STMT_EXECUTE:
+      ok= execute();
+      break;
+
+    case COM_STMT_FETCH:
+      ok= fetch();
+      break;
+
+    case COM_STMT_CLOSE:
+      if (packet.size() >= 5)
+        statements.erase((unsigned char)packet[1] |
+                         ((unsigned char)packet[2] << 8) |
+                         ((unsigned char)packet[3] << 16) |
+                         ((unsigned long)(unsigned char)packet[4] << 24));
+      break;
+
+    case COM_STMT_SEND_LONG_DATA:
+      break;
+
+    case COM_SET_OPTION:
+      ok= reply(eof_payload(SERVER_STATUS_AUTOCOMMIT));
+      break;
+
+    case COM_PING:
+    case COM_INIT_DB:
+    case COM_STMT_RESET:
+    case COM_RESET_CONNECTION:
+      ok= reply(ok_payload(0));
+      break;
+
+    default:
+      ok= reply(error_payload(1047, "08S01", "Unknown command"));
+      break;
+    }
+
+    if (!ok)
+      break;
+  }
+}
+
+
+static void serve(replay_server *server, int fd)
+{
+  replay_connection(server, fd).run();
+
+  std::lock_guard<std::mutex> guard(server->lock);
+  server->connections.erase(fd);
+  close(fd);
+  server->all_closed.notify_all();
+}
+
+
+static void accept_connections(replay_server *server)
+{
+  for (;;)
+  {
+    int fd= accept(server->fd, NULL, NULL);
+
+    if (fd < 0)
+    {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      break;
+    }
+
+    std::lock_guard<std::mutex> guard(server->lock);
+    if (server->stopping)
+    {
+      close(fd);
+      break;
+    }
+    server->connections.insert(fd);
+    std::thread(serve, server, fd).detach();
+  }
+}
+
+
+/*
+  The interface
+*/
+
+REPLAY_SERVER *replay_server_start(const char *socket_path)
+{
+  struct sockaddr_un addr;
+  std::unique_ptr<replay_server> server(new replay_server());
+
+  if (strlen(socket_path) >= sizeof(addr.sun_path))
+  {
+    fprintf(stderr, "# replay server: socket path too long: %s\n",
+            socket_path);
+    return NULL;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family= AF_UNIX;
+  strcpy(addr.sun_path, socket_path);
+  unlink(socket_path);
+
+  if ((server->fd= socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+      bind(server->fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+      listen(server->fd, 128))
+  {
+    fprintf(stderr, "# replay server: cannot listen on %s: %s\n",
+            socket_path, strerror(errno));
+    if (server->fd >= 0)
+      close(server->fd);
+    return NULL;
+  }
+
+  /* Clients that go away in the middle of a reply are not an error */
+  signal(SIGPIPE, SIG_IGN);
+
+  server->path= socket_path;
+  server->acceptor= std::thread(accept_connections, server.get());
+
+  return server.release();
+}
+
+
+void replay_server_stop(REPLAY_SERVER *server)
+{
+  if (!server)
+    return;
+
+  {
+    std::unique_lock<std::mutex> guard(server->lock);
+    server->stopping= true;
+
+    /* Wakes up accept(), on some systems closing the socket alone does not */
+    shutdown(server->fd, SHUT_RDWR);
+    close(server->fd);
+
+    for (std::set<int>::iterator it= server->connections.begin();
+         it != server->connections.end(); ++it)
+      shutdown(*it, SHUT_RDWR);
+
+    while (!server->connections.empty())
+      server->all_closed.wait(guard);
+  }
+
+  server->acceptor.join();
+  unlink(server->path.c_str());
+  delete server;
+}
+
+
+void replay_server_set_latency(REPLAY_SERVER *server, unsigned int usec)
+{
+  server->latency= usec;
+}
+
+
+REPLAY_RESULT *replay_server_add_result(REPLAY_SERVER *server,
+                                        const char *query)
+{
+  std::lock_guard<std::mutex> guard(server->lock);
+  replay_result *result= new replay_result();
+
+  /* A result set that is replaced may still be in use, it stays around */
+  server->results.push_back(std::unique_ptr<replay_result>(result));
+  server->queries[query]= result;
+
+  return result;
+}
+
+
+void replay_server_add_ok(REPLAY_SERVER *server, const char *query,
+                          unsigned long long affected_rows)
+{
+  replay_server_add_result(server, query)->affected_rows= affected_rows;
+}
+
+
+int replay_result_add_column(REPLAY_RESULT *result, const char *name,
+                             const char *type, unsigned long length,
+                             unsigned int decimals)
+{
+  replay_column column;
+  const char *unsigned_word= strchr(type, ' ');
+  size_t type_length= unsigned_word ? unsigned_word - type : strlen(type);
+  size_t i;
+
+  if (result->in_use || !result->text_rows.empty())
+    return 1;
+
+  for (i= 0; i < sizeof(replay_types) / sizeof(replay_types[0]); ++i)
+    if (strlen(replay_types[i].name) == type_length &&
+        !strncasecmp(replay_types[i].name, type, type_length))
+      break;
+
+  if (i == sizeof(replay_types) / sizeof(replay_types[0]))
+    return 1;
+
+  column.name= name;
+  column.type= replay_types[i].type;
+  column.decimals= decimals;
+  column.flags= 0;
+  column.length= length ? length : replay_types[i].length;
+
+  if (unsigned_word)
+  {
+    while (*unsigned_word == ' ')
+      ++unsigned_word;
+    if (strcasecmp(unsigned_word, "UNSIGNED"))
+      return 1;
+    column.flags|= UNSIGNED_FLAG;
+  }
+
+  if (replay_types[i].text)
+  {
+    column.charset= REPLAY_TEXT_CHARSET;
+    column.length*= REPLAY_TEXT_MBMAXLEN;
+  }
+  else
+  {
+    column.charset= REPLAY_BINARY_CHARSET;
+    column.flags|= BINARY_FLAG;
+  }
+
+  if (replay_types[i].blob)
+    column.flags|= BLOB_FLAG;
+
+  switch (column.type)
+  {
+  case MYSQL_TYPE_NEWDECIMAL:
+    /* Precision, the sign and the decimal point */
+    column.length= (length ? length : 10) + 2;
+    break;
+  case MYSQL_TYPE_DATETIME:
+  case MYSQL_TYPE_TIMESTAMP:
+  case MYSQL_TYPE_TIME:
+    if (decimals)
+      column.length+= decimals + 1;
+    break;
+  case MYSQL_TYPE_FLOAT:
+  case MYSQL_TYPE_DOUBLE:
+    /* Not fixed, as in a column declared without them */
+    if (!decimals)
+      column.decimals= 31;
+    break;
+  default:
+    break;
+  }
+
+  result->columns.push_back(column);
+  return 0;
+}
+
+
+int replay_result_add_row(REPLAY_RESULT *result, const char * const *values,
+                          const unsigned long *lengths)
+{
+  size_t columns= result->columns.size();
+  std::string text, binary(1 + (columns + 7 + 2) / 8, '\0');
+
+  if (result->in_use)
+    return 1;
+
+  for (size_t i= 0; i < columns; ++i)
+  {
+    if (!values[i])
+    {
+      text+= (char)0xfb;
+      /* The binary null bitmap starts after the header byte, offset by 2 */
+      binary[1 + (i + 2) / 8]|= (char)(1 << ((i + 2) % 8));
+      continue;
+    }
+
+    std::string value(values[i], lengths ? lengths[i] : strlen(values[i]));
+    put_lenenc_str(text, value);
+    if (!put_binary_value(binary, result->columns[i], value))
+      return 1;
+  }
+
+  result->text_rows.push_back(text);
+  result->binary_rows.push_back(binary);
+  return 0;
+}
+
+
+int replay_result_generate(REPLAY_RESULT *result, unsigned long rows)
+{
+  size_t columns= result->columns.size();
+  std::vector<std::string> values(columns);
+  std::vector<const char *> pointers(columns);
+  std::vector<unsigned long> lengths(columns);
+
+  for (unsigned long row= 0; row < rows; ++row)
+  {
+    for (size_t i= 0; i < columns; ++i)
+    {
+      values[i]= generate_value(result->columns[i], row);
+      pointers[i]= values[i].data();
+      lengths[i]= values[i].size();
+    }
+
+    if (replay_result_add_row(result, pointers.data(), lengths.data()))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/**
+  Undo the escapes of a value in a file, returns false for a bad one.
+*/
+static bool unescape(const std::string &in, std::string &out, bool &is_null)
+{
+  is_null= in == "\\N";
+  out.clear();
+
+  for (size_t i= 0; i < in.size() && !is_null; ++i)
+  {
+    if (in[i] != '\\')
+    {
+      out+= in[i];
+      continue;
+    }
+
+    if (++i == in.size())
+      return false;
+
+    switch (in[i])
+    {
+    case 't':  out+= '\t'; break;
+    case 'n':  out+= '\n'; break;
+    case 'r':  out+= '\r'; break;
+    case '0':  out+= '\0'; break;
+    case '\\': out+= '\\'; break;
+    case 'x':
+    {
+      char hex[3]= {0}, *end;
+      if (i + 2 >= in.size())
+        return false;
+      hex[0]= in[i + 1];
+      hex[1]= in[i + 2];
+      out+= (char)strtoul(hex, &end, 16);
+      if (*end)
+        return false;
+      i+= 2;
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+int replay_server_load(REPLAY_SERVER *server, const char *path)
+{
+  FILE *file= fopen(path, "r");
+  REPLAY_RESULT *result= NULL;
+  std::string line;
+  char buff[4096];
+  int number= 0;
+
+  if (!file)
+    return -1;
+
+  while (fgets(buff, sizeof(buff), file))
+  {
+    line+= buff;
+    /* Long lines come in pieces */
+    if (line[line.size() - 1] != '\n' && !feof(file))
+      continue;
+
+    ++number;
+    while (!line.empty() &&
+           (line[line.size() - 1] == '\n' || line[line.size() - 1] == '\r'))
+      line.resize(line.size() - 1);
+
+    size_t space= line.find(' ');
+    std::string keyword(line, 0, space);
+    std::string rest(space == std::string::npos ? "" : line.substr(space + 1));
+    bool bad= false;
+
+    if (line.empty() || line[0] == '#')
+      ;
+    else if (keyword == "query")
+      result= replay_server_add_result(server, rest.c_str());
+    else if (keyword == "ok")
+    {
+      char *end;
+      unsigned long long rows= strtoull(rest.c_str(), &end, 10);
+      bad= *end != ' ';
+      if (!bad)
+        replay_server_add_ok(server, end + 1, rows);
+    }
+    else if (!result)
+      bad= true;
+    else if (keyword == "column")
+    {
+      /* name, the type words, then the numbers */
+      char name[256], type[256];
+      unsigned long length= 0;
+      unsigned int decimals= 0;
+      size_t pos;
+
+      bad= sscanf(rest.c_str(), "%255s", name) != 1;
+      pos= rest.find(' ');
+      if (!bad && pos != std::string::npos)
+      {
+        std::string spec(rest, pos + 1);
+        size_t digits= spec.find_first_of("0123456789");
+
+        std::string type_words(spec, 0, digits);
+        while (!type_words.empty() && type_words[type_words.size() - 1] == ' ')
+          type_words.resize(type_words.size() - 1);
+        strncpy(type, type_words.c_str(), sizeof(type) - 1);
+        type[sizeof(type) - 1]= '\0';
+
+        if (digits != std::string::npos)
+          sscanf(spec.c_str() + digits, "%lu %u", &length, &decimals);
+
+        bad= replay_result_add_column(result, name, type, length, decimals)
+             != 0;
+      }
+      else
+        bad= true;
+    }
+    else if (keyword == "row")
+    {
+      std::vector<std::string> values;
+      std::vector<const char *> pointers;
+      std::vector<unsigned long> lengths;
+      size_t start= 0, tab;
+
+      do
+      {
+        std::string value;
+        bool is_null;
+
+        tab= rest.find('\t', start);
+        if (!unescape(rest.substr(start, tab == std::string::npos ?
+                                         std::string::npos : tab - start),
+                      value, is_null))
+          bad= true;
+        values.push_back(value);
+        pointers.push_back(is_null ? NULL : "");
+        start= tab + 1;
+      } while (tab != std::string::npos);
+
+      for (size_t i= 0; i < values.size(); ++i)
+      {
+        if (pointers[i])
+          pointers[i]= values[i].data();
+        lengths.push_back(values[i].size());
+      }
+
+      bad= bad || values.size() != result->columns.size() ||
+           replay_result_add_row(result, pointers.data(), lengths.data());
+    }
+    else if (keyword == "generate")
+      bad= replay_result_generate(result, strtoul(rest.c_str(), NULL, 10)) != 0;
+    else
+      bad= true;
+
+    if (bad)
+    {
+      fclose(file);
+      return number;
+    }
+
+    line.clear();
+  }
+
+  fclose(file);
+  return 0;
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/**
+  @file  replay_server.h
+  @brief A MySQL protocol server that answers from memory.
+
+  The server runs in a thread of the benchmark itself and listens on a Unix
+  socket. It speaks enough of the protocol for the client library and the
+  driver: the handshake with caching_sha2_password or mysql_native_password
+  (any user and password are accepted), COM_QUERY, COM_STMT_PREPARE/EXECUTE/FETCH/CLOSE, COM_PING
+  and the other simple commands.
+
+  Queries are answered from result sets registered up front, either built
+  row by row, generated or loaded from a file. The packets of a result set
+  are put together once, so serving it costs little more than a write()
+  and what is measured is the driver. Statements nobody registered succeed
+  with no result set. A latency can be added to every reply to simulate
+  the network and the server.
+*/
+
+#ifndef _REPLAY_SERVER_H
+#define _REPLAY_SERVER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct replay_server REPLAY_SERVER;
+typedef struct replay_result REPLAY_RESULT;
+
+/**
+  Start listening on the given Unix socket, replacing the file if it
+  exists. Returns NULL and prints the reason if that is not possible.
+*/
+REPLAY_SERVER *replay_server_start(const char *socket_path);
+
+/** Close all connections, stop the server and remove the socket file. */
+void replay_server_stop(REPLAY_SERVER *server);
+
+/** Delay every reply by the given number of microseconds. */
+void replay_server_set_latency(REPLAY_SERVER *server, unsigned int usec);
+
+/**
+  Register the result set for a query, matched by its exact text. Columns
+  and rows have to be added before the first time the query is run.
+*/
+REPLAY_RESULT *replay_server_add_result(REPLAY_SERVER *server,
+                                        const char *query);
+
+/** Register a statement that succeeds changing the given number of rows. */
+void replay_server_add_ok(REPLAY_SERVER *server, const char *query,
+                          unsigned long long affected_rows);
+
+/**
+  Register the queries of a file. Lines are
+
+    query <text>                   starts a result set for the query
+    column <name> <type> [<length> [<decimals>]]
+    row <value>[TAB<value>...]     \N is NULL; \t, \n, \\, \0 and \xHH
+    generate <rows>
+    ok <affected rows> <text>
+
+  and lines starting with # are comments.
+
+  @return 0 on success, -1 if the file cannot be read, otherwise the number
+          of the line that is wrong
+*/
+int replay_server_load(REPLAY_SERVER *server, const char *path);
+
+/**
+  Add a column. The type is the SQL name, optionally followed by UNSIGNED:
+  TINYINT, SMALLINT, MEDIUMINT, INT, BIGINT, FLOAT, DOUBLE, DECIMAL, DATE,
+  TIME, DATETIME, TIMESTAMP, YEAR, CHAR, VARCHAR, BINARY, VARBINARY, TEXT
+  or BLOB. A length of 0 gives the usual one for the type; for DECIMAL it
+  is the precision.
+
+  @return 0 on success, 1 for an unknown type or a result already in use
+*/
+int replay_result_add_column(REPLAY_RESULT *result, const char *name,
+                             const char *type, unsigned long length,
+                             unsigned int decimals);
+
+/**
+  Add a row from its values as the server would send them in the text
+  protocol. A NULL value is SQL NULL, lengths can be NULL for
+  null-terminated values.
+
+  @return 0 on success, 1 if a value does not fit its column or the result
+          is already in use
+*/
+int replay_result_add_row(REPLAY_RESULT *result, const char * const *values,
+                          const unsigned long *lengths);
+
+/**
+  Add rows of made up values that depend on the row number and the column
+  type, such as counting integers, timestamps a minute apart and text of
+  up to 64 characters (256 bytes for TEXT and BLOB).
+*/
+int replay_result_generate(REPLAY_RESULT *result, unsigned long rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _REPLAY_SERVER_H */
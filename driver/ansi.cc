@@ -652,7 +652,7 @@ SQLGetStmtAttr(SQLHSTMT hstmt, SQLINTEGER attribute, SQLPOINTER value,
 {
   CHECK_HANDLE(hstmt);
 
-  /* Nothing special to do, since we don't have any string stmt attribs */
+  /* Nothing special to do, the only string stmt attribute is ASCII */
   return MySQLGetStmtAttr(hstmt, attribute, value, value_max, value_len);
 }
 
@@ -0,0 +1,839 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+/**
+  @file  arrow.cc
+  @brief Apache Arrow C stream interface export of results, see arrow.h
+
+  A batch is built directly from fetch_row(): every column gets a validity
+  bitmap and its value buffer sized for chunk_rows rows up front, and the
+  data of strings grows as needed. The buffers belong to the batch and are
+  freed by its release callback, independently of the statement.
+*/
+
+#include "driver.h"
+#include "arrow.h"
+
+#include <errno.h>
+#include <limits.h>
+
+enum arrow_kind
+{
+  ARROW_NULL, ARROW_BOOL, ARROW_INT, ARROW_UINT, ARROW_FLOAT, ARROW_DOUBLE,
+  ARROW_DECIMAL, ARROW_DATE, ARROW_TIMESTAMP, ARROW_DURATION, ARROW_STRING
+};
+
+typedef struct arrow_column
+{
+  enum arrow_kind kind;
+  int           width;      /* bytes of a value, 0 for bits and strings */
+  SQLSMALLINT   scale;      /* of decimals */
+  my_bool       nullable;
+  char          format[24];
+  char          *name;
+  CHARSET_INFO  *from_cs;   /* of text converted to UTF-8, NULL to copy */
+  CHARSET_INFO  *utf8_cs;
+} ARROW_COLUMN;
+
+typedef struct arrow_stream
+{
+  STMT          *stmt;
+  MYSQL_RES     *result;    /* the stream ends if it is no longer current */
+  SQLULEN       chunk_rows;
+  uint          count;
+  ARROW_COLUMN  *columns;
+  char          error[SQL_MAX_MESSAGE_LENGTH + 1];
+} ARROW_STREAM;
+
+/* private_data of a column of a batch */
+typedef struct arrow_buffers
+{
+  const void    *buffers[3];
+  uchar         *validity, *values, *data;
+  size_t        data_used, data_max;
+} ARROW_BUFFERS;
+
+
+/* Unsigned and signed format of integers, by their width in bytes */
+static const char *int_formats[]= {"", "Cc", "Ss", "", "Ii", "", "", "", "Ll"};
+
+
+static void describe_column(ARROW_COLUMN *column, DESCREC *irrec,
+                            CHARSET_INFO *utf8_cs)
+{
+  MYSQL_FIELD *field= irrec->row.field;
+  my_bool is_unsigned= (field->flags & UNSIGNED_FLAG) != 0;
+
+  column->nullable= irrec->nullable != SQL_NO_NULLS;
+  column->width= 0;
+
+  switch (irrec->concise_type)
+  {
+  case SQL_BIT:
+    column->kind= ARROW_BOOL;
+    strcpy(column->format, "b");
+    return;
+
+  case SQL_TINYINT:
+  case SQL_SMALLINT:
+  case SQL_INTEGER:
+  case SQL_BIGINT:
+    /* Sized by the server type, NO_BIGINT reports BIGINT as SQL_INTEGER */
+    column->kind= is_unsigned ? ARROW_UINT : ARROW_INT;
+    switch (field->type)
+    {
+    case MYSQL_TYPE_TINY:     column->width= 1; break;
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_YEAR:     column->width= 2; break;
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:     column->width= 4; break;
+    default:                  column->width= 8; break;
+    }
+    column->format[0]= int_formats[column->width][is_unsigned ? 0 : 1];
+    column->format[1]= '\0';
+    return;
+
+  case SQL_REAL:
+    column->kind= ARROW_FLOAT;
+    column->width= 4;
+    strcpy(column->format, "f");
+    return;
+
+  case SQL_FLOAT:
+  case SQL_DOUBLE:
+    column->kind= ARROW_DOUBLE;
+    column->width= 8;
+    strcpy(column->format, "g");
+    return;
+
+  case SQL_DECIMAL:
+  case SQL_NUMERIC:
+    column->kind= ARROW_DECIMAL;
+    column->scale= irrec->scale;
+    column->width= irrec->precision > 38 ? 32 : 16;
+    sprintf(column->format, column->width == 32 ? "d:%d,%d,256" : "d:%d,%d",
+            (int)irrec->precision, (int)irrec->scale);
+    return;
+
+  case SQL_DATE:
+  case SQL_TYPE_DATE:
+    column->kind= ARROW_DATE;
+    column->width= 4;
+    column->nullable= TRUE;       /* zero dates */
+    strcpy(column->format, "tdD");
+    return;
+
+  case SQL_TIMESTAMP:
+  case SQL_TYPE_TIMESTAMP:
+    column->kind= ARROW_TIMESTAMP;
+    column->width= 8;
+    column->nullable= TRUE;
+    strcpy(column->format, "tsu:");
+    return;
+
+  case SQL_TIME:
+  case SQL_TYPE_TIME:
+    column->kind= ARROW_DURATION;
+    column->width= 8;
+    strcpy(column->format, "tDu");
+    return;
+  }
+
+  if (field->type == MYSQL_TYPE_NULL)
+  {
+    column->kind= ARROW_NULL;
+    strcpy(column->format, "n");
+    return;
+  }
+
+  column->kind= ARROW_STRING;
+
+  if (field->type != MYSQL_TYPE_JSON &&
+      (field->charsetnr == BINARY_CHARSET_NUMBER ||
+       irrec->concise_type == SQL_BINARY ||
+       irrec->concise_type == SQL_VARBINARY ||
+       irrec->concise_type == SQL_LONGVARBINARY))
+    strcpy(column->format, "z");
+  /*
+    character_set_results is NULL, so the text of every column comes in
+    the column's own character set. Other than UTF-8 it is converted.
+  */
+  else if (irrec->row.wchar_cs &&
+           (!strncmp(irrec->row.wchar_cs->csname, "utf8", 4) ||
+            !strcmp(irrec->row.wchar_cs->csname, "ascii")))
+    strcpy(column->format, "u");
+  else if (irrec->row.wchar_cs && utf8_cs)
+  {
+    strcpy(column->format, "u");
+    column->from_cs= irrec->row.wchar_cs;
+    column->utf8_cs= utf8_cs;
+  }
+  else
+    strcpy(column->format, "z");
+}
+
+
+/* words= words * 10 + digit, computed in 32 bit halves */
+static void decimal_mul10_add(unsigned long long *words, int count, int digit)
+{
+  unsigned long long carry= digit;
+  int i;
+
+  for (i= 0; i < count; ++i)
+  {
+    unsigned long long lo= (words[i] & 0xffffffffULL) * 10 + carry;
+    unsigned long long hi= (words[i] >> 32) * 10 + (lo >> 32);
+    words[i]= (hi << 32) | (lo & 0xffffffffULL);
+    carry= hi >> 32;
+  }
+}
+
+
+/*
+  The text of a decimal as the integer Arrow stores, the value times
+  10^scale in two's complement, least significant word first.
+*/
+static my_bool parse_decimal(const char *str, size_t length, int scale,
+                             unsigned long long *words, int count)
+{
+  const char *end= str + length;
+  my_bool negative= FALSE, point= FALSE;
+  int i, fraction= 0;
+
+  memset(words, 0, sizeof(*words) * count);
+
+  if (str < end && (*str == '-' || *str == '+'))
+    negative= *str++ == '-';
+
+  for (; str < end; ++str)
+  {
+    if (*str == '.' && !point)
+    {
+      point= TRUE;
+      continue;
+    }
+    if (*str < '0' || *str > '9')
+      return FALSE;
+    if (point)
+    {
+      /* More fraction digits than the scale are dropped */
+      if (fraction == scale)
+        continue;
+      ++fraction;
+    }
+    decimal_mul10_add(words, count, *str - '0');
+  }
+
+  for (; fraction < scale; ++fraction)
+    decimal_mul10_add(words, count, 0);
+
+  if (negative)
+  {
+    unsigned long long carry= 1;
+    for (i= 0; i < count; ++i)
+    {
+      words[i]= ~words[i] + carry;
+      carry= carry && words[i] == 0;
+    }
+  }
+
+  return TRUE;
+}
+
+
+/* [-]HHH:MM:SS[.ffffff] as microseconds */
+static my_bool parse_duration(const char *str, size_t length, long long *us)
+{
+  const char *end= str + length;
+  long long hours= 0, minutes= 0, seconds= 0, fraction= 0, unit= 100000;
+  my_bool negative= FALSE;
+
+  if (str < end && *str == '-')
+  {
+    negative= TRUE;
+    ++str;
+  }
+
+  for (; str < end && *str >= '0' && *str <= '9'; ++str)
+    hours= hours * 10 + (*str - '0');
+  if (str >= end || *str++ != ':')
+    return FALSE;
+  for (; str < end && *str >= '0' && *str <= '9'; ++str)
+    minutes= minutes * 10 + (*str - '0');
+  if (str >= end || *str++ != ':')
+    return FALSE;
+  for (; str < end && *str >= '0' && *str <= '9'; ++str)
+    seconds= seconds * 10 + (*str - '0');
+  if (str < end && *str == '.')
+  {
+    for (++str; str < end && *str >= '0' && *str <= '9' && unit; ++str)
+    {
+      fraction+= (*str - '0') * unit;
+      unit/= 10;
+    }
+  }
+
+  *us= ((hours * 60 + minutes) * 60 + seconds) * 1000000 + fraction;
+  if (negative)
+    *us= -*us;
+
+  return TRUE;
+}
+
+
+static void release_schema(struct ArrowSchema *schema)
+{
+  int64_t i;
+
+  for (i= 0; i < schema->n_children; ++i)
+  {
+    if (schema->children[i]->release)
+      schema->children[i]->release(schema->children[i]);
+  }
+
+  x_free((char *)schema->format);
+  x_free((char *)schema->name);
+  x_free(schema->private_data);   /* children of the struct */
+  schema->release= NULL;
+}
+
+
+static my_bool init_schema(struct ArrowSchema *schema, const char *format,
+                           const char *name, int64_t flags)
+{
+  memset(schema, 0, sizeof(*schema));
+  schema->format= myodbc_strdup(format, MYF(0));
+  schema->name= myodbc_strdup(name, MYF(0));
+  schema->flags= flags;
+  schema->release= release_schema;
+
+  if (!schema->format || !schema->name)
+  {
+    release_schema(schema);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+static int stream_get_schema(struct ArrowArrayStream *stream,
+                             struct ArrowSchema *out)
+{
+  ARROW_STREAM *as= (ARROW_STREAM *)stream->private_data;
+  struct ArrowSchema *children, **child_ptrs;
+  uint i;
+
+  if (!init_schema(out, "+s", "", 0))
+    return ENOMEM;
+
+  /* One block: the pointers, then the children they point to */
+  child_ptrs= (struct ArrowSchema **)
+    myodbc_malloc((sizeof(struct ArrowSchema *) + sizeof(struct ArrowSchema)) *
+                  as->count + 1, MYF(MY_ZEROFILL));
+  if (!child_ptrs)
+  {
+    release_schema(out);
+    return ENOMEM;
+  }
+  children= (struct ArrowSchema *)(child_ptrs + as->count);
+  out->private_data= child_ptrs;
+  out->children= child_ptrs;
+
+  for (i= 0; i < as->count; ++i)
+  {
+    child_ptrs[i]= &children[i];
+    if (!init_schema(&children[i], as->columns[i].format,
+                     as->columns[i].name ? as->columns[i].name : "",
+                     as->columns[i].nullable ? ARROW_FLAG_NULLABLE : 0))
+    {
+      release_schema(out);
+      return ENOMEM;
+    }
+    out->n_children= i + 1;
+  }
+
+  return 0;
+}
+
+
+/* A column of a batch, its buffers are in ARROW_BUFFERS */
+static void release_column(struct ArrowArray *array)
+{
+  ARROW_BUFFERS *buffers= (ARROW_BUFFERS *)array->private_data;
+
+  if (buffers)
+  {
+    x_free(buffers->validity);
+    x_free(buffers->values);
+    x_free(buffers->data);
+    x_free(buffers);
+  }
+  array->release= NULL;
+}
+
+
+/* A batch, one block holds its buffers, children pointers and children */
+static void release_batch(struct ArrowArray *array)
+{
+  int64_t i;
+
+  for (i= 0; i < array->n_children; ++i)
+  {
+    if (array->children[i]->release)
+      array->children[i]->release(array->children[i]);
+  }
+
+  x_free((void *)array->buffers);
+  array->release= NULL;
+}
+
+
+static my_bool init_column_array(struct ArrowArray *array,
+                                 ARROW_COLUMN *column, SQLULEN rows)
+{
+  ARROW_BUFFERS *buffers;
+  size_t bitmap= (size_t)(rows + 7) / 8 + 1;
+
+  memset(array, 0, sizeof(*array));
+  array->release= release_column;
+
+  if (!(buffers= (ARROW_BUFFERS *)myodbc_malloc(sizeof(ARROW_BUFFERS),
+                                                 MYF(MY_ZEROFILL))))
+    return FALSE;
+  array->private_data= buffers;
+  array->buffers= buffers->buffers;
+
+  switch (column->kind)
+  {
+  case ARROW_NULL:
+    array->n_buffers= 0;
+    return TRUE;
+
+  case ARROW_BOOL:
+    buffers->values= (uchar *)myodbc_malloc(bitmap, MYF(MY_ZEROFILL));
+    array->n_buffers= 2;
+    break;
+
+  case ARROW_STRING:
+    buffers->values= (uchar *)myodbc_malloc((size_t)(rows + 1) * 4,
+                                            MYF(MY_ZEROFILL));
+    buffers->data_max= 16384;
+    buffers->data= (uchar *)myodbc_malloc(buffers->data_max, MYF(0));
+    if (!buffers->data)
+      return FALSE;
+    array->n_buffers= 3;
+    break;
+
+  default:
+    buffers->values= (uchar *)myodbc_malloc((size_t)rows * column->width + 1,
+                                            MYF(MY_ZEROFILL));
+    array->n_buffers= 2;
+    break;
+  }
+
+  buffers->validity= (uchar *)myodbc_malloc(bitmap, MYF(MY_ZEROFILL));
+
+  return buffers->validity && buffers->values;
+}
+
+
+/*
+  Adds a value to row i of a column of the batch. Returns 0, or EIO with
+  the error of the statement set.
+*/
+static int add_value(STMT *stmt, uint col, ARROW_COLUMN *column,
+                     struct ArrowArray *array, SQLULEN i, char *value,
+                     unsigned long length)
+{
+  ARROW_BUFFERS *buffers= (ARROW_BUFFERS *)array->private_data;
+  char as_string[50];
+
+  if (column->kind == ARROW_NULL || is_null(stmt, col, value))
+    goto null;
+
+  switch (column->kind)
+  {
+  case ARROW_BOOL:
+    {
+      ulong j;
+      for (j= 0; j < length; ++j)
+      {
+        if (value[j])
+        {
+          buffers->values[i / 8]|= 1 << (i % 8);
+          break;
+        }
+      }
+      break;
+    }
+
+  case ARROW_INT:
+  case ARROW_UINT:
+    {
+      long long v;
+
+      if (ssps_used(stmt))
+        v= get_int64(stmt, col, value, length);
+      else if (column->kind == ARROW_UINT)
+        v= (long long)strtoull(value, NULL, 10);
+      else
+        v= strtoll(value, NULL, 10);
+
+      switch (column->width)
+      {
+      case 1: ((int8_t *)buffers->values)[i]= (int8_t)v; break;
+      case 2: ((int16_t *)buffers->values)[i]= (int16_t)v; break;
+      case 4: ((int32_t *)buffers->values)[i]= (int32_t)v; break;
+      default: ((int64_t *)buffers->values)[i]= (int64_t)v; break;
+      }
+      break;
+    }
+
+  case ARROW_FLOAT:
+  case ARROW_DOUBLE:
+    {
+      double v= ssps_used(stmt) ? (double)get_double(stmt, col, value, length)
+                                : strtod(value, NULL);
+      if (column->kind == ARROW_FLOAT)
+        ((float *)buffers->values)[i]= (float)v;
+      else
+        ((double *)buffers->values)[i]= v;
+      break;
+    }
+
+  case ARROW_DECIMAL:
+    value= get_string(stmt, col, value, &length, as_string);
+    if (!parse_decimal(value, length, column->scale,
+                       (unsigned long long *)buffers->values +
+                       i * (column->width / 8), column->width / 8))
+    {
+      set_stmt_error(stmt, "22018", "Invalid character value for cast "
+                     "specification", 0);
+      return EIO;
+    }
+    break;
+
+  case ARROW_DATE:
+  case ARROW_TIMESTAMP:
+    {
+      SQL_TIMESTAMP_STRUCT ts;
+      long days;
+
+      switch (str_to_ts(&ts, get_string(stmt, col, value, &length, as_string),
+                        SQL_NTS, stmt->dbc->ds->zero_date_to_min, TRUE))
+      {
+      case SQLTS_BAD_DATE:
+        set_stmt_error(stmt, "22018", "Data value is not a valid "
+                       "date/time(stamp) value", 0);
+        return EIO;
+      case SQLTS_NULL_DATE:
+        goto null;
+      }
+
+      days= days_from_civil(ts.year, ts.month, ts.day);
+      if (column->kind == ARROW_DATE)
+        ((int32_t *)buffers->values)[i]= (int32_t)days;
+      else
+        ((int64_t *)buffers->values)[i]=
+          (((int64_t)days * 24 + ts.hour) * 60 + ts.minute) * 60 * 1000000 +
+          (int64_t)ts.second * 1000000 + ts.fraction / 1000;
+      break;
+    }
+
+  case ARROW_DURATION:
+    value= get_string(stmt, col, value, &length, as_string);
+    if (!parse_duration(value, length, (long long *)buffers->values + i))
+    {
+      set_stmt_error(stmt, "22018", "Data value is not a valid time value",
+                     0);
+      return EIO;
+    }
+    break;
+
+  case ARROW_STRING:
+    {
+    /* A character takes at most 4 bytes in UTF-8 */
+    size_t room;
+
+    value= get_string(stmt, col, value, &length, as_string);
+    room= column->from_cs ? (size_t)length * 4 : length;
+
+    if (buffers->data_used + room > INT_MAX)
+    {
+      set_stmt_error(stmt, "22001", "String data, right truncated", 0);
+      return EIO;
+    }
+    if (buffers->data_used + room > buffers->data_max)
+    {
+      size_t size= myodbc_max(buffers->data_max * 2,
+                              buffers->data_used + room);
+      uchar *data= (uchar *)myodbc_realloc(buffers->data, size, MYF(0));
+      if (!data)
+      {
+        set_error(stmt, MYERR_S1001, NULL, 4001);
+        return ENOMEM;
+      }
+      buffers->data= data;
+      buffers->data_max= size;
+    }
+    if (column->from_cs)
+    {
+      uint32 used_bytes, used_chars;
+      uint errors;
+
+      length= copy_and_convert((char *)buffers->data + buffers->data_used,
+                               (uint32)room, column->utf8_cs, value,
+                               (uint32)length, column->from_cs, &used_bytes,
+                               &used_chars, &errors);
+    }
+    else
+    {
+      memcpy(buffers->data + buffers->data_used, value, length);
+    }
+    buffers->data_used+= length;
+    ((int32_t *)buffers->values)[i + 1]= (int32_t)buffers->data_used;
+    break;
+    }
+
+  default:
+    break;
+  }
+
+  buffers->validity[i / 8]|= 1 << (i % 8);
+  return 0;
+
+null:
+  ++array->null_count;
+  if (column->kind == ARROW_STRING)
+    ((int32_t *)buffers->values)[i + 1]= (int32_t)buffers->data_used;
+  return 0;
+}
+
+
+static int stream_get_next(struct ArrowArrayStream *stream,
+                           struct ArrowArray *out)
+{
+  ARROW_STREAM *as= (ARROW_STREAM *)stream->private_data;
+  STMT *stmt= as->stmt;
+  SQLULEN rows= 0;
+  long cur_row;
+  uint col;
+  int error= 0;
+
+  memset(out, 0, sizeof(*out));
+  CLEAR_STMT_ERROR(stmt);
+
+  if (stmt->result != as->result)
+  {
+    strcpy(as->error, "The result of the stream was closed");
+    return EINVAL;
+  }
+
+  /* The struct array of the batch and its columns */
+  out->release= release_batch;
+  out->n_buffers= 1;
+  out->buffers= (const void **)myodbc_malloc(sizeof(void *) *
+                                             (as->count + 1) +
+                                             sizeof(struct ArrowArray) *
+                                             as->count, MYF(MY_ZEROFILL));
+  if (!out->buffers)
+    return ENOMEM;
+
+  /* buffers[0] (no validity), then the children pointers and children */
+  out->children= (struct ArrowArray **)(out->buffers + 1);
+  for (col= 0; col < as->count; ++col)
+  {
+    struct ArrowArray *child= (struct ArrowArray *)(out->children + as->count)
+                              + col;
+    out->children[col]= child;
+    out->n_children= col + 1;
+    if (!init_column_array(child, &as->columns[col], as->chunk_rows))
+    {
+      error= ENOMEM;
+      goto end;
+    }
+  }
+
+  cur_row= columnar_next_row(stmt);
+
+  if (!stmt->dbc->ds->dont_use_set_locale)
+  {
+    setlocale(LC_NUMERIC, "C");
+  }
+
+  while (rows < as->chunk_rows)
+  {
+    MYSQL_ROW values;
+    unsigned long *lengths;
+
+    if ((values= stmt->columnar_pending))
+      stmt->columnar_pending= NULL;
+    else if (!(values= fetch_row(stmt)))
+      break;
+
+    lengths= fetch_lengths(stmt);
+
+    for (col= 0; col < as->count && !error; ++col)
+      error= add_value(stmt, col, &as->columns[col], out->children[col], rows,
+                       values[col], lengths[col]);
+    if (error)
+      break;
+
+    ++rows;
+  }
+
+  if (!stmt->dbc->ds->dont_use_set_locale)
+  {
+    setlocale(LC_NUMERIC, default_locale);
+  }
+
+  columnar_end(stmt, cur_row, rows);
+
+  if (!error && !rows && mysql_errno(&stmt->dbc->mysql))
+  {
+    set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
+              mysql_errno(&stmt->dbc->mysql));
+    error= EIO;
+  }
+
+end:
+  if (error)
+  {
+    if (stmt->error.message[0])
+      strmake(as->error, stmt->error.message, sizeof(as->error) - 1);
+    release_batch(out);
+    return error;
+  }
+
+  /* The end of the stream is an array without release */
+  if (rows == 0)
+  {
+    release_batch(out);
+    memset(out, 0, sizeof(*out));
+    return 0;
+  }
+
+  out->length= rows;
+  for (col= 0; col < as->count; ++col)
+  {
+    struct ArrowArray *child= out->children[col];
+    ARROW_BUFFERS *buffers= (ARROW_BUFFERS *)child->private_data;
+
+    child->length= rows;
+    if (as->columns[col].kind == ARROW_NULL)
+      child->null_count= rows;
+    buffers->buffers[0]= child->null_count ? buffers->validity : NULL;
+    buffers->buffers[1]= buffers->values;
+    buffers->buffers[2]= buffers->data;
+  }
+
+  return 0;
+}
+
+
+static const char *stream_get_last_error(struct ArrowArrayStream *stream)
+{
+  ARROW_STREAM *as= (ARROW_STREAM *)stream->private_data;
+  return as->error[0] ? as->error : NULL;
+}
+
+
+static void release_stream(struct ArrowArrayStream *stream)
+{
+  ARROW_STREAM *as= (ARROW_STREAM *)stream->private_data;
+  uint i;
+
+  for (i= 0; i < as->count; ++i)
+    x_free(as->columns[i].name);
+  x_free(as->columns);
+  x_free(as);
+  stream->release= NULL;
+}
+
+
+/*
+  @type    : myodbc extension
+  @purpose : exports the rest of the current result of the statement as an
+             Arrow stream, see arrow.h
+*/
+SQLRETURN SQL_API MySQLGetArrowStream(SQLHSTMT hstmt, SQLULEN chunk_rows,
+                                      struct ArrowArrayStream *stream)
+{
+  STMT *stmt= (STMT *)hstmt;
+  ARROW_STREAM *as;
+  SQLRETURN rc;
+  CHARSET_INFO *utf8_cs;
+  uint i;
+
+  CHECK_HANDLE(hstmt);
+  CLEAR_STMT_ERROR(stmt);
+
+  if (!stream)
+    return set_error(stmt, MYERR_S1009, NULL, 0);
+
+  if ((rc= columnar_check(stmt)) != SQL_SUCCESS)
+    return rc;
+
+  if (!(as= (ARROW_STREAM *)myodbc_malloc(sizeof(ARROW_STREAM),
+                                          MYF(MY_ZEROFILL))) ||
+      !(as->columns= (ARROW_COLUMN *)myodbc_malloc(sizeof(ARROW_COLUMN) *
+                                                   field_count(stmt) + 1,
+                                                   MYF(MY_ZEROFILL))))
+  {
+    x_free(as);
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  as->stmt= stmt;
+  as->result= stmt->result;
+  as->chunk_rows= chunk_rows ? chunk_rows : MYODBC_ARROW_CHUNK_ROWS;
+  as->count= field_count(stmt);
+  utf8_cs= get_charset_by_csname("utf8mb4", MYF(MY_CS_PRIMARY), MYF(0));
+
+  for (i= 0; i < as->count; ++i)
+  {
+    DESCREC *irrec= desc_get_rec(stmt->ird, i, FALSE);
+
+    describe_column(&as->columns[i], irrec, utf8_cs);
+    if (irrec->name &&
+        !(as->columns[i].name= myodbc_strdup((char *)irrec->name, MYF(0))))
+    {
+      stream->private_data= as;
+      release_stream(stream);
+      return set_error(stmt, MYERR_S1001, NULL, 4001);
+    }
+  }
+
+  stream->get_schema= stream_get_schema;
+  stream->get_next= stream_get_next;
+  stream->get_last_error= stream_get_last_error;
+  stream->release= release_stream;
+  stream->private_data= as;
+
+  return SQL_SUCCESS;
+}
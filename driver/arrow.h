@@ -0,0 +1,126 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/**
+  @file  arrow.h
+  @brief export of result sets through the Apache Arrow C stream interface
+
+  Only in drivers built with -DWITH_ARROW=1. MySQLGetArrowStream() wraps
+  the current result of a statement into an ArrowArrayStream. Each call of
+  its get_next() reads up to chunk_rows rows from where the statement is
+  and returns them as a struct array with one child per column. The stream
+  ends when the result has no more rows. Like MySQLFetchColumns(), it is
+  called on the driver's statement handle (SQLGetInfo(SQL_DRIVER_HSTMT)).
+
+  The schema comes from the column descriptions of the IRD:
+
+  BIT(1)                    b
+  TINYINT .. BIGINT         c s i l, C S I L if unsigned
+  FLOAT, DOUBLE             f, g
+  DECIMAL(p,s)              d:p,s, or d:p,s,256 if p > 38
+  DATE                      tdD (days)
+  DATETIME, TIMESTAMP       tsu: (microseconds, no time zone)
+  TIME                      tDu (duration in microseconds)
+  binary strings            z
+  other strings             u, converted to UTF-8 from the character set
+                            of the column
+
+  Zero dates are NULL. The statement must not be used otherwise, closed or
+  freed until the stream is released.
+*/
+
+#ifndef __MYODBC_ARROW_H__
+# define __MYODBC_ARROW_H__
+
+#include <stdint.h>
+
+/* From the Arrow C data interface, shared by every producer and consumer */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema
+{
+  const char *format;
+  const char *name;
+  const char *metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema **children;
+  struct ArrowSchema *dictionary;
+  void (*release)(struct ArrowSchema *);
+  void *private_data;
+};
+
+struct ArrowArray
+{
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void **buffers;
+  struct ArrowArray **children;
+  struct ArrowArray *dictionary;
+  void (*release)(struct ArrowArray *);
+  void *private_data;
+};
+
+#endif /* ARROW_C_DATA_INTERFACE */
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+struct ArrowArrayStream
+{
+  int (*get_schema)(struct ArrowArrayStream *, struct ArrowSchema *out);
+  int (*get_next)(struct ArrowArrayStream *, struct ArrowArray *out);
+  const char *(*get_last_error)(struct ArrowArrayStream *);
+  void (*release)(struct ArrowArrayStream *);
+  void *private_data;
+};
+
+#endif /* ARROW_C_STREAM_INTERFACE */
+
+/* Rows of a batch if chunk_rows is 0 */
+#define MYODBC_ARROW_CHUNK_ROWS 65536
+
+#ifdef __cplusplus
+extern "C"
+#endif
+SQLRETURN SQL_API MySQLGetArrowStream(SQLHSTMT hstmt, SQLULEN chunk_rows,
+                                      struct ArrowArrayStream *stream);
+
+typedef SQLRETURN (SQL_API *MySQLGetArrowStream_t)(SQLHSTMT, SQLULEN,
+                                                   struct ArrowArrayStream *);
+
+#endif /* __MYODBC_ARROW_H__ */
@@ -210,6 +210,9 @@ server_list_dbcolumns(STMT *stmt,
     strncpy(buff, (const char*)szCatalog, cbCatalog);
     buff[cbCatalog]= '\0';
 
+    PERF_DBC_ADD(dbc, PERF_ROUND_TRIPS, 1);
+    PERF_DBC_ADD(dbc, PERF_HIDDEN_ROUND_TRIPS, 1);
+
     if (mysql_select_db(mysql, buff))
     {
       myodbc_mutex_unlock(&dbc->lock);
@@ -225,10 +228,15 @@ server_list_dbcolumns(STMT *stmt,
   column_buff[cbColumn]= '\0';
 
   result= mysql_list_fields(mysql, buff, column_buff);
+  PERF_DBC_ADD(dbc, PERF_ROUND_TRIPS, 1);
+  PERF_DBC_ADD(dbc, PERF_HIDDEN_ROUND_TRIPS, 1);
 
   /* If before this call no database were selected - we cannot revert that */
   if (cbCatalog && dbc->database)
   {
+    PERF_DBC_ADD(dbc, PERF_ROUND_TRIPS, 1);
+    PERF_DBC_ADD(dbc, PERF_HIDDEN_ROUND_TRIPS, 1);
+
     if (mysql_select_db( mysql, dbc->database))
     {
       /* Well, probably have to return error here */
@@ -930,6 +938,9 @@ MYSQL_RES *server_show_create_table(STMT        *stmt,
 
   assert(to - buff < sizeof(buff));
 
+  PERF_ADD(stmt, PERF_ROUND_TRIPS, 1);
+  PERF_ADD(stmt, PERF_HIDDEN_ROUND_TRIPS, 1);
+
   if (mysql_real_query(mysql,buff,(unsigned long)(to - buff)))
   {
     return NULL;
@@ -2488,6 +2499,8 @@ tables_no_i_s(SQLHSTMT hstmt,
                                       (char *)catalog, catalog_len);
         to= myodbc_stpmov(to, "'");
         MYLOG_QUERY(stmt, buff);
+        PERF_ADD(stmt, PERF_ROUND_TRIPS, 1);
+        PERF_ADD(stmt, PERF_HIDDEN_ROUND_TRIPS, 1);
         if (!mysql_query(&stmt->dbc->mysql, buff))
           catalog_res= mysql_store_result(&stmt->dbc->mysql);
       }
@@ -0,0 +1,527 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+/**
+  @file  columnar.cc
+  @brief column-wise fetching of result sets, see columnar.h
+
+  Rows of a stored result stay where libmysqlclient put them until the
+  result is freed, so up to COLUMNAR_CHUNK of them are gathered first and
+  then converted one column at a time. Prepared statements and streamed
+  results overwrite the previous row on every fetch and are converted a row
+  at a time, through the same per-column functions.
+*/
+
+#include "driver.h"
+
+#include <limits.h>
+
+/* Rows of a stored result gathered before their columns are converted */
+#define COLUMNAR_CHUNK 1024
+
+
+/* Days from 1970-01-01 to a date of the proleptic Gregorian calendar */
+long days_from_civil(long y, unsigned int m, unsigned int d)
+{
+  long era;
+  unsigned int yoe, doy, doe;
+
+  if (m <= 2)
+    --y;
+  era= (y >= 0 ? y : y - 399) / 400;
+  yoe= (unsigned int)(y - era * 400);
+  doy= (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  doe= yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+  return era * 146097 + (long)doe - 719468;
+}
+
+
+static my_bool layout_allowed(MYSQL_FIELD *field, SQLSMALLINT layout)
+{
+  switch (layout)
+  {
+  case MYODBC_COLUMN_SKIP:
+  case MYODBC_COLUMN_STRING:
+    return TRUE;
+
+  case MYODBC_COLUMN_DOUBLE:
+    switch (field->type)
+    {
+    case MYSQL_TYPE_DECIMAL:
+    case MYSQL_TYPE_NEWDECIMAL:
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_DOUBLE:
+      return TRUE;
+    default:
+      break;
+    }
+    /* fall through */
+  case MYODBC_COLUMN_INT64:
+    switch (field->type)
+    {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_LONGLONG:
+    case MYSQL_TYPE_YEAR:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+
+  case MYODBC_COLUMN_TIMESTAMP:
+    if (field->type == MYSQL_TYPE_DATETIME ||
+        field->type == MYSQL_TYPE_TIMESTAMP)
+      return TRUE;
+    /* fall through */
+  case MYODBC_COLUMN_DATE32:
+    return field->type == MYSQL_TYPE_DATE || field->type == MYSQL_TYPE_NEWDATE;
+  }
+
+  return FALSE;
+}
+
+
+/*
+  Converts the values of column col of n gathered rows, stored with stride
+  between rows, into rows first.. of the column arrays. NULL values were
+  already marked by fetch_columns().
+*/
+static SQLRETURN convert_column(STMT *stmt, uint col, MYODBC_COLUMN *column,
+                                char **cells, unsigned long *lengths,
+                                uint stride, SQLULEN first, SQLULEN n)
+{
+  MYSQL_FIELD *field= stmt->result->fields + col;
+  BOOL ssps= ssps_used(stmt);
+  SQLULEN i;
+
+  switch (column->layout)
+  {
+  case MYODBC_COLUMN_INT64:
+    {
+      SQLBIGINT *values= (SQLBIGINT *)column->values + first;
+      BOOL ubigint= field->type == MYSQL_TYPE_LONGLONG &&
+                    (field->flags & UNSIGNED_FLAG);
+
+      for (i= 0; i < n; ++i, cells+= stride)
+      {
+        if (!*cells)
+        {
+          values[i]= 0;
+        }
+        else if (ssps)
+        {
+          values[i]= get_int64(stmt, col, *cells, 0);
+          if (ubigint && values[i] < 0)
+            break;
+        }
+        else if (ubigint)
+        {
+          unsigned long long value= strtoull(*cells, NULL, 10);
+          if (value > (unsigned long long)LLONG_MAX)
+            break;
+          values[i]= (SQLBIGINT)value;
+        }
+        else
+        {
+          values[i]= strtoll(*cells, NULL, 10);
+        }
+      }
+
+      if (i < n)
+        return set_stmt_error(stmt, "22003", "Numeric value out of range", 0);
+      break;
+    }
+
+  case MYODBC_COLUMN_DOUBLE:
+    {
+      SQLDOUBLE *values= (SQLDOUBLE *)column->values + first;
+
+      for (i= 0; i < n; ++i, cells+= stride)
+      {
+        if (!*cells)
+          values[i]= 0;
+        else if (ssps)
+          values[i]= (SQLDOUBLE)get_double(stmt, col, *cells, 0);
+        else
+          values[i]= strtod(*cells, NULL);
+      }
+      break;
+    }
+
+  case MYODBC_COLUMN_DATE32:
+  case MYODBC_COLUMN_TIMESTAMP:
+    {
+      SQL_TIMESTAMP_STRUCT ts;
+      char as_string[50];
+
+      for (i= 0; i < n; ++i, cells+= stride)
+      {
+        ulong length= 0;
+        long days;
+
+        if (!*cells)
+          continue;
+
+        switch (str_to_ts(&ts, get_string(stmt, col, *cells, &length,
+                                          as_string), SQL_NTS,
+                          stmt->dbc->ds->zero_date_to_min, TRUE))
+        {
+        case SQLTS_BAD_DATE:
+          return set_stmt_error(stmt, "22018", "Data value is not a valid "
+                                "date/time(stamp) value", 0);
+        case SQLTS_NULL_DATE:
+          if (!column->validity)
+            return set_stmt_error(stmt, "22002", "Indicator variable "
+                                  "required but not supplied", 0);
+          column->validity[(first + i) / 8]&= ~(1 << ((first + i) % 8));
+          ++column->null_count;
+          days= 0;
+          memset(&ts, 0, sizeof(ts));
+          break;
+        default:
+          days= days_from_civil(ts.year, ts.month, ts.day);
+        }
+
+        if (column->layout == MYODBC_COLUMN_DATE32)
+          ((SQLINTEGER *)column->values)[first + i]= (SQLINTEGER)days;
+        else
+          ((SQLBIGINT *)column->values)[first + i]=
+            (((SQLBIGINT)days * 24 + ts.hour) * 60 + ts.minute) * 60 *
+            1000000 + (SQLBIGINT)ts.second * 1000000 + ts.fraction / 1000;
+      }
+      break;
+    }
+
+  case MYODBC_COLUMN_STRING:
+    {
+      SQLINTEGER *offsets= (SQLINTEGER *)column->values + first;
+
+      /* fetch_columns() made sure they fit */
+      for (i= 0; i < n; ++i, cells+= stride, lengths+= stride)
+      {
+        if (*cells)
+        {
+          memcpy(column->data + column->data_used, *cells, *lengths);
+          column->data_used+= *lengths;
+        }
+        offsets[i + 1]= (SQLINTEGER)column->data_used;
+      }
+      break;
+    }
+  }
+
+  return SQL_SUCCESS;
+}
+
+
+/*
+  Reads the next row of the result into cells and lengths, NULL values as
+  NULL pointers. Returns 0 if there are no more rows, -1 if its strings do
+  not fit into what is left of the data buffers.
+*/
+static int gather_row(STMT *stmt, uint count, MYODBC_COLUMN *columns,
+                      SQLULEN *reserved, char **cells,
+                      unsigned long *lengths, char (*as_string)[50])
+{
+  MYSQL_ROW_OFFSET save_position= 0;
+  MYSQL_ROW values;
+  unsigned long *row_lengths;
+  uint col;
+
+  if ((values= stmt->columnar_pending))
+  {
+    stmt->columnar_pending= NULL;
+  }
+  else
+  {
+    if (!if_forward_cache(stmt))
+      save_position= row_tell(stmt);
+
+    if (!(values= fetch_row(stmt)))
+      return 0;
+  }
+
+  row_lengths= fetch_lengths(stmt);
+
+  for (col= 0; col < count; ++col)
+  {
+    if (columns[col].layout == MYODBC_COLUMN_SKIP ||
+        is_null(stmt, col, values[col]))
+    {
+      cells[col]= NULL;
+      lengths[col]= 0;
+      continue;
+    }
+
+    cells[col]= values[col];
+    lengths[col]= row_lengths[col];
+
+    if (columns[col].layout != MYODBC_COLUMN_STRING)
+      continue;
+
+    if (as_string)
+      cells[col]= get_string(stmt, col, values[col], &lengths[col],
+                             as_string[col]);
+
+    if (reserved[col] + lengths[col] > columns[col].data_max)
+    {
+      /* Give the row back, it is the first one of the next call */
+      if (if_forward_cache(stmt))
+        stmt->columnar_pending= values;
+      else
+        row_seek(stmt, save_position);
+
+      for (; col > 0; --col)
+        if (columns[col - 1].layout == MYODBC_COLUMN_STRING)
+          reserved[col - 1]-= lengths[col - 1];
+      return -1;
+    }
+    reserved[col]+= lengths[col];
+  }
+
+  return 1;
+}
+
+
+/*
+  Checks that the result of the statement can be read a rowset at a time by
+  MySQLFetchColumns() or the Arrow export.
+*/
+SQLRETURN columnar_check(STMT *stmt)
+{
+  if (!stmt->result)
+    return set_stmt_error(stmt, "24000", "Fetch without a SELECT", 0);
+
+  /* Catalog functions, scrolling and out parameters fetch the usual way */
+  if (stmt->fake_result || stmt->fix_fields || stmt->result_array ||
+      scroller_exists(stmt) || if_dynamic_cursor(stmt) ||
+      stmt->out_params_state != OPS_UNKNOWN)
+    return set_error(stmt, MYERR_S1C00, NULL, 0);
+
+  return SQL_SUCCESS;
+}
+
+
+/*
+  Moves to the first row after the current rowset, the same way as
+  SQL_FETCH_NEXT in my_SQLExtendedFetch(), and returns its number.
+*/
+long columnar_next_row(STMT *stmt)
+{
+  long cur_row= (stmt->current_row < 0 ? 0 :
+                 stmt->current_row + stmt->rows_found_in_set);
+
+  reset_getdata_position(stmt);
+  stmt->current_values= 0;          /* For SQLGetData */
+
+  if (!if_forward_cache(stmt))
+  {
+    if (cur_row && cur_row == (long)(stmt->current_row +
+                                     stmt->rows_found_in_set))
+      row_seek(stmt, stmt->end_of_set);
+    else
+      data_seek(stmt, cur_row);
+  }
+
+  return cur_row;
+}
+
+
+/* Makes the rows read the current rowset, SQLFetch() continues after them */
+void columnar_end(STMT *stmt, long cur_row, SQLULEN rows)
+{
+  stmt->current_row= cur_row;
+  stmt->rows_found_in_set= (uint)rows;
+  if (!if_forward_cache(stmt))
+    stmt->end_of_set= row_tell(stmt);
+}
+
+
+/*
+  @type    : myodbc extension
+  @purpose : fetches up to max_rows rows of the result into column arrays,
+             see columnar.h
+*/
+SQLRETURN SQL_API MySQLFetchColumns(SQLHSTMT hstmt, SQLUSMALLINT column_count,
+                                    MYODBC_COLUMN *columns, SQLULEN max_rows,
+                                    SQLULEN *rows_fetched)
+{
+  STMT *stmt= (STMT *)hstmt;
+  SQLRETURN res= SQL_SUCCESS;
+  SQLULEN rows= 0, chunk, n, i;
+  SQLULEN *reserved;
+  char **cells, (*as_string)[50]= NULL;
+  unsigned long *lengths;
+  long cur_row;
+  uint col;
+  int got= 1;
+
+  CHECK_HANDLE(hstmt);
+  CLEAR_STMT_ERROR(stmt);
+
+  if (rows_fetched)
+    *rows_fetched= 0;
+
+  if ((res= columnar_check(stmt)) != SQL_SUCCESS)
+    return res;
+
+  if (column_count > field_count(stmt))
+    return set_error(stmt, MYERR_07009, NULL, 0);
+
+  for (col= 0; col < column_count; ++col)
+  {
+    MYODBC_COLUMN *column= &columns[col];
+
+    if (!layout_allowed(stmt->result->fields + col, column->layout))
+      return set_error(stmt, MYERR_07006, NULL, 0);
+
+    if (column->layout != MYODBC_COLUMN_SKIP &&
+        (!column->values ||
+         (column->layout == MYODBC_COLUMN_STRING && column->data_max &&
+          !column->data)))
+      return set_error(stmt, MYERR_S1009, NULL, 0);
+
+    column->data_used= 0;
+    column->null_count= 0;
+    column->charsetnr= stmt->result->fields[col].charsetnr;
+    if (column->layout == MYODBC_COLUMN_STRING)
+      ((SQLINTEGER *)column->values)[0]= 0;
+    if (column->validity)
+      memset(column->validity, 0, (size_t)((max_rows + 7) / 8));
+  }
+
+  cur_row= columnar_next_row(stmt);
+
+  chunk= (ssps_used(stmt) || if_forward_cache(stmt)) ? 1 : COLUMNAR_CHUNK;
+  chunk= myodbc_min(chunk, max_rows);
+
+  cells= (char **)myodbc_malloc(sizeof(char *) * column_count * chunk + 1,
+                                MYF(0));
+  lengths= (unsigned long *)myodbc_malloc(sizeof(unsigned long) *
+                                          column_count * chunk + 1, MYF(0));
+  reserved= (SQLULEN *)myodbc_malloc(sizeof(SQLULEN) * column_count + 1,
+                                     MYF(MY_ZEROFILL));
+  if (ssps_used(stmt))
+    as_string= (char (*)[50])myodbc_malloc(50 * column_count + 1, MYF(0));
+
+  if (!cells || !lengths || !reserved || (ssps_used(stmt) && !as_string))
+  {
+    x_free(cells);
+    x_free(lengths);
+    x_free(reserved);
+    x_free(as_string);
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  if (!stmt->dbc->ds->dont_use_set_locale)
+  {
+    setlocale(LC_NUMERIC, "C");
+  }
+
+  while (got > 0 && rows < max_rows && SQL_SUCCEEDED(res))
+  {
+    long long started;
+
+    for (n= 0; n < myodbc_min(chunk, max_rows - rows); ++n)
+    {
+      got= gather_row(stmt, column_count, columns, reserved,
+                      cells + n * column_count, lengths + n * column_count,
+                      as_string);
+      if (got <= 0)
+        break;
+    }
+
+    if (got < 0 && rows + n == 0)
+    {
+      res= set_stmt_error(stmt, "22001", "String data, right truncated", 0);
+      break;
+    }
+
+    started= perf_clock_ns();
+
+    for (col= 0; col < column_count && SQL_SUCCEEDED(res); ++col)
+    {
+      MYODBC_COLUMN *column= &columns[col];
+
+      if (column->layout == MYODBC_COLUMN_SKIP)
+        continue;
+
+      for (i= 0; i < n; ++i)
+      {
+        if (!cells[i * column_count + col])
+        {
+          if (!column->validity)
+          {
+            res= set_stmt_error(stmt, "22002", "Indicator variable required "
+                                "but not supplied", 0);
+            break;
+          }
+          ++column->null_count;
+        }
+        else if (column->validity)
+        {
+          column->validity[(rows + i) / 8]|= 1 << ((rows + i) % 8);
+        }
+      }
+
+      if (SQL_SUCCEEDED(res))
+        res= convert_column(stmt, col, column, cells + col, lengths + col,
+                            column_count, rows, n);
+    }
+
+    PERF_ADD(stmt, PERF_FETCH_NS, perf_clock_ns() - started);
+    rows+= n;
+  }
+
+  if (!stmt->dbc->ds->dont_use_set_locale)
+  {
+    setlocale(LC_NUMERIC, default_locale);
+  }
+
+  x_free(cells);
+  x_free(lengths);
+  x_free(reserved);
+  x_free(as_string);
+
+  columnar_end(stmt, cur_row, rows);
+
+  if (rows_fetched)
+    *rows_fetched= rows;
+
+  if (!got && is_connection_lost(mysql_errno(&stmt->dbc->mysql))
+      && handle_connection_error(stmt))
+    return SQL_ERROR;
+
+  if (SQL_SUCCEEDED(res) && rows == 0)
+    return SQL_NO_DATA_FOUND;
+
+  return res;
+}
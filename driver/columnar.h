@@ -0,0 +1,100 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/**
+  @file  columnar.h
+  @brief column-wise fetching of result sets, MySQLFetchColumns()
+
+  MySQLFetchColumns() is an extension of the driver, not part of ODBC. It
+  fills one array per column for up to max_rows rows of the result, the same
+  layout Apache Arrow uses, so the arrays can be handed to Arrow or numpy
+  without another copy.
+
+  The function is called on the driver's statement handle, which is returned
+  by SQLGetInfo(SQL_DRIVER_HSTMT) when a driver manager is used. Its address
+  comes from GetProcAddress()/dlsym() on the driver library.
+
+  Layouts a column can be fetched into:
+
+  MYODBC_COLUMN_INT64     SQLBIGINT values[max_rows] (integer columns)
+  MYODBC_COLUMN_DOUBLE    SQLDOUBLE values[max_rows] (numeric columns)
+  MYODBC_COLUMN_DATE32    SQLINTEGER values[max_rows], days since 1970-01-01
+                          (DATE columns)
+  MYODBC_COLUMN_TIMESTAMP SQLBIGINT values[max_rows], microseconds since
+                          1970-01-01 00:00:00 without any time zone
+                          conversion (DATE, DATETIME and TIMESTAMP columns)
+  MYODBC_COLUMN_STRING    SQLINTEGER values[max_rows + 1] of offsets into
+                          data, value i is data[values[i]..values[i+1]). The
+                          bytes are in the character set of the column, which
+                          is returned in charsetnr; numbers and dates are in
+                          their text form.
+
+  validity, if given, is a bitmap of at least (max_rows + 7) / 8 bytes: bit
+  (i % 8) of byte i / 8 is set if the value of row i is not NULL. Without it
+  a NULL value is an error (22002). Zero dates are NULL, as for SQLGetData().
+
+  Fetching stops early when the strings of the next row do not fit into the
+  data buffers; that row is the first one of the next call. Only SQL_NO_DATA
+  tells that the result is exhausted.
+*/
+
+#ifndef __MYODBC_COLUMNAR_H__
+# define __MYODBC_COLUMNAR_H__
+
+#define MYODBC_COLUMN_SKIP      0
+#define MYODBC_COLUMN_INT64     1
+#define MYODBC_COLUMN_DOUBLE    2
+#define MYODBC_COLUMN_DATE32    3
+#define MYODBC_COLUMN_TIMESTAMP 4
+#define MYODBC_COLUMN_STRING    5
+
+typedef struct myodbc_column
+{
+  SQLSMALLINT   layout;       /* MYODBC_COLUMN_* */
+  SQLPOINTER    values;       /* values, or offsets of strings */
+  SQLCHAR       *data;        /* bytes of strings */
+  SQLULEN       data_max;     /* size of data */
+  SQLCHAR       *validity;    /* may be NULL if the column has no NULLs */
+  SQLULEN       data_used;    /* out: bytes of data filled */
+  SQLULEN       null_count;   /* out: NULL values fetched */
+  SQLUINTEGER   charsetnr;    /* out: character set number of the column */
+} MYODBC_COLUMN;
+
+#ifdef __cplusplus
+extern "C"
+#endif
+SQLRETURN SQL_API MySQLFetchColumns(SQLHSTMT hstmt, SQLUSMALLINT column_count,
+                                    MYODBC_COLUMN *columns, SQLULEN max_rows,
+                                    SQLULEN *rows_fetched);
+
+typedef SQLRETURN (SQL_API *MySQLFetchColumns_t)(SQLHSTMT, SQLUSMALLINT,
+                                                 MYODBC_COLUMN *, SQLULEN,
+                                                 SQLULEN *);
+
+#endif /* __MYODBC_COLUMNAR_H__ */
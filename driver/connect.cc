@@ -59,7 +59,12 @@ unsigned long get_client_flags(DataSource *ds)
     flags|= CLIENT_FOUND_ROWS;
   if (ds->no_catalog)
     flags|= CLIENT_NO_SCHEMA;
+#if MYSQL_VERSION_ID >= 80018
+  /* COMPRESSION_ALGORITHMS supersedes the legacy zlib-only flag */
+  if (ds->use_compressed_protocol && !ds->compression_algorithms)
+#else
   if (ds->use_compressed_protocol)
+#endif
     flags|= CLIENT_COMPRESS;
   if (ds->ignore_space_after_function_names)
     flags|= CLIENT_IGNORE_SPACE;
@@ -144,44 +149,24 @@ SQLRETURN myodbc_set_initial_character_set(DBC *dbc, const char *charset)
 
 
 /**
-  Try to establish a connection to a MySQL server based on the data source
-  configuration.
+  Set the client options for a connection that is about to be established
+  from the data source configuration. Used for the primary connection as
+  well as for the read replicas.
 
-  @param[in]  dbc  Database connection
-  @param[in]  ds   Data source information
+  @param[in]  dbc    Database connection
+  @param[in]  mysql  Initialized, not yet connected MYSQL handle
+  @param[in]  ds     Data source information
 
-  @return Standard SQLRETURN code. If it is @c SQL_SUCCESS or @c
-  SQL_SUCCESS_WITH_INFO, a connection has been established.
+  @return Standard SQLRETURN code
 */
-SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
+static SQLRETURN myodbc_set_connect_options(DBC *dbc, MYSQL *mysql,
+                                            DataSource *ds)
 {
-  SQLRETURN rc= SQL_SUCCESS;
-  MYSQL *mysql= &dbc->mysql;
-  unsigned long flags;
   /* Use 'int' and fill all bits to avoid alignment Bug#25920 */
   unsigned int opt_ssl_verify_server_cert = ~0;
   const my_bool on= 1;
   unsigned long max_long = ~0L;
 
-#ifdef WIN32
-  /*
-   Detect if we are running with ADO present, and force on the
-   FLAG_COLUMN_SIZE_S32 option if we are.
-  */
-  if (GetModuleHandle("msado15.dll") != NULL)
-    ds->limit_column_size= 1;
-
-  /* Detect another problem specific to MS Access */
-  if (GetModuleHandle("msaccess.exe") != NULL)
-    ds->default_bigint_bind_str= 1;
-#endif
-
-  mysql_init(mysql);
-
-  flags= get_client_flags(ds);
-
-  /* Set other connection options */
-
   if (ds->allow_big_results || ds->safe)
 #if MYSQL_VERSION_ID >= 50709
     mysql_options(mysql, MYSQL_OPT_MAX_ALLOWED_PACKET, &max_long);
@@ -287,13 +272,36 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   }
 #endif
 
+#if MYSQL_VERSION_ID >= 80018
+  if (ds->compression_algorithms)
+  {
+    mysql_options(mysql, MYSQL_OPT_COMPRESSION_ALGORITHMS,
+                  ds_get_utf8attr(ds->compression_algorithms,
+                                  &ds->compression_algorithms8));
+  }
+
+  if (ds->zstd_compression_level)
+  {
+    unsigned int level= ds->zstd_compression_level;
+    mysql_options(mysql, MYSQL_OPT_ZSTD_COMPRESSION_LEVEL, &level);
+  }
+#endif
+
+  if (ds->enable_local_infile)
+  {
+    unsigned int local_infile= 1;
+    mysql_options(mysql, MYSQL_OPT_LOCAL_INFILE, &local_infile);
+    /* Only the files load_data_params() makes are sent */
+    load_data_refuse(mysql);
+  }
+
   if (dbc->unicode)
   {
     /*
       Get the ANSI charset info before we change connection to UTF-8.
     */
     MY_CHARSET_INFO my_charset;
-    mysql_get_character_set_info(&dbc->mysql, &my_charset);
+    mysql_get_character_set_info(mysql, &my_charset);
     dbc->ansi_charset_info= get_charset(my_charset.number, MYF(0));
     /*
       We always use utf8 for the connection, and change it afterwards if needed.
@@ -317,7 +325,7 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
     }
 #else
     MY_CHARSET_INFO my_charset;
-    mysql_get_character_set_info(&dbc->mysql, &my_charset);
+    mysql_get_character_set_info(mysql, &my_charset);
     dbc->ansi_charset_info= get_charset(my_charset.number, MYF(0));
 #endif
 }
@@ -358,6 +366,224 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   }
 #endif
 
+  return SQL_SUCCESS;
+}
+
+
+/**
+  Connect one read replica. The replica inherits the client options,
+  credentials, default database and character set of the primary
+  connection.
+
+  @param[in]  dbc      Database connection, already connected to the primary
+  @param[in]  ds       Data source information
+  @param[in]  replica  Replica with host and port filled in
+  @param[in]  flags    Client flags used for the primary connection
+
+  @return TRUE if the replica has been connected
+*/
+static my_bool myodbc_connect_replica(DBC *dbc, DataSource *ds,
+                                      REPLICA *replica, unsigned long flags)
+{
+  MYSQL *mysql= &replica->mysql;
+  const my_bool on= 1;
+  /* Options setup resets those, but they are already final for the DBC */
+  CHARSET_INFO *ansi_charset_info= dbc->ansi_charset_info,
+               *cxn_charset_info= dbc->cxn_charset_info;
+  SQLRETURN rc;
+
+  /* A replica that cannot be connected is tried again after this */
+  replica->last_query_time= (time_t) time((time_t*) 0);
+
+  mysql_init(mysql);
+
+  rc= myodbc_set_connect_options(dbc, mysql, ds);
+  dbc->ansi_charset_info= ansi_charset_info;
+  dbc->cxn_charset_info= cxn_charset_info;
+
+  if (!SQL_SUCCEEDED(rc))
+  {
+    mysql_close(mysql);
+    return FALSE;
+  }
+
+  if (!mysql_real_connect(mysql, replica->host, (char *)ds->uid8,
+                          (char *)ds->pwd8, dbc->database,
+                          replica->port ? replica->port : ds->port,
+                          NULL, flags))
+  {
+    mysql_close(mysql);
+    return FALSE;
+  }
+
+  /* Same character set as the primary, whatever way it was chosen */
+  if (mysql_set_character_set(mysql, mysql_character_set_name(&dbc->mysql)) ||
+      (!ds->auto_increment_null_search &&
+       mysql_query(mysql, "SET SQL_AUTO_IS_NULL = 0")))
+  {
+    mysql_close(mysql);
+    return FALSE;
+  }
+
+  if (ds->auto_reconnect)
+  {
+    mysql_options(mysql, MYSQL_OPT_RECONNECT, (char *)&on);
+  }
+
+  replica->last_query_time= (time_t) time((time_t*) 0);
+  replica->sql_select_limit= (SQLULEN) -1;
+  replica->connected= replica->alive= TRUE;
+
+  return TRUE;
+}
+
+
+/**
+  Try again to connect a read replica that could not be connected before.
+
+  @param[in]  dbc      Database connection
+  @param[in]  replica  Replica that is not connected
+
+  @return TRUE if the replica has been connected
+*/
+my_bool myodbc_reconnect_replica(DBC *dbc, REPLICA *replica)
+{
+  return myodbc_connect_replica(dbc, dbc->ds, replica, replica->flags);
+}
+
+
+/**
+  Parse the READ_REPLICAS option (comma separated list of host[:port]) and
+  connect every replica in it. Replicas that cannot be connected are kept
+  in the list and connected again later, see replica_is_alive(). Until
+  then statements simply stay on the primary.
+
+  @param[in]  dbc    Database connection, already connected to the primary
+  @param[in]  ds     Data source information
+  @param[in]  flags  Client flags used for the primary connection
+*/
+static void myodbc_connect_replicas(DBC *dbc, DataSource *ds,
+                                    unsigned long flags)
+{
+  char *list= ds_get_utf8attr(ds->read_replicas, &ds->read_replicas8);
+  char *pos, *end, *colon;
+  uint count= 1, i;
+
+  for (pos= list; *pos; ++pos)
+  {
+    if (*pos == ',')
+      ++count;
+  }
+
+  dbc->replicas= (REPLICA *)myodbc_malloc(sizeof(REPLICA) * count,
+                                          MYF(MY_ZEROFILL));
+  if (!dbc->replicas)
+  {
+    return;
+  }
+
+  for (pos= list, i= 0; i < count; pos= end + 1, ++i)
+  {
+    REPLICA *replica= &dbc->replicas[dbc->replica_count];
+    size_t len;
+
+    if (!(end= strchr(pos, ',')))
+    {
+      end= pos + strlen(pos);
+    }
+
+    while (pos < end && isspace(*pos))
+      ++pos;
+    for (len= end - pos; len > 0 && isspace(pos[len - 1]); --len);
+
+    if (len == 0)
+      continue;
+
+    replica->host= myodbc_strndup(pos, len, MYF(0));
+    if (!replica->host)
+      break;
+
+    if ((colon= strchr(replica->host, ':')) != NULL)
+    {
+      *colon= '\0';
+      replica->port= (uint)atoi(colon + 1);
+    }
+
+    myodbc_mutex_init(&replica->lock, NULL);
+    replica->flags= flags;
+    myodbc_connect_replica(dbc, ds, replica, flags);
+    ++dbc->replica_count;
+  }
+}
+
+
+/**
+  Close the read replica connections of a connection.
+
+  @param[in]  dbc  Database connection
+*/
+void myodbc_close_replicas(DBC *dbc)
+{
+  uint i;
+
+  for (i= 0; i < dbc->replica_count; ++i)
+  {
+    REPLICA *replica= &dbc->replicas[i];
+
+    if (replica->connected)
+    {
+      mysql_close(&replica->mysql);
+    }
+    myodbc_mutex_destroy(&replica->lock);
+    x_free(replica->host);
+  }
+
+  x_free(dbc->replicas);
+  dbc->replicas= NULL;
+  dbc->replica_count= 0;
+}
+
+
+/**
+  Try to establish a connection to a MySQL server based on the data source
+  configuration.
+
+  @param[in]  dbc  Database connection
+  @param[in]  ds   Data source information
+
+  @return Standard SQLRETURN code. If it is @c SQL_SUCCESS or @c
+  SQL_SUCCESS_WITH_INFO, a connection has been established.
+*/
+SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
+{
+  SQLRETURN rc= SQL_SUCCESS;
+  MYSQL *mysql= &dbc->mysql;
+  unsigned long flags;
+  const my_bool on= 1;
+
+#ifdef WIN32
+  /*
+   Detect if we are running with ADO present, and force on the
+   FLAG_COLUMN_SIZE_S32 option if we are.
+  */
+  if (GetModuleHandle("msado15.dll") != NULL)
+    ds->limit_column_size= 1;
+
+  /* Detect another problem specific to MS Access */
+  if (GetModuleHandle("msaccess.exe") != NULL)
+    ds->default_bigint_bind_str= 1;
+#endif
+
+  mysql_init(mysql);
+
+  flags= get_client_flags(ds);
+
+  /* Set other connection options */
+  if (!SQL_SUCCEEDED(rc= myodbc_set_connect_options(dbc, mysql, ds)))
+  {
+    return rc;
+  }
+
   if (!mysql_real_connect(mysql,
                           ds_get_utf8attr(ds->server,   &ds->server8),
                           ds_get_utf8attr(ds->uid,      &ds->uid8),
@@ -441,7 +667,17 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   }
 
   if (ds->save_queries && !dbc->query_log)
-    dbc->query_log= init_query_log();
+    dbc->query_log= query_log_open();
+
+  if (ds->statement_digests)
+  {
+    /* Shared by all connections of the environment that ask for it */
+    myodbc_mutex_lock(&dbc->env->lock);
+    if (!dbc->env->digests)
+      dbc->env->digests= digests_new();
+    dbc->digests= dbc->env->digests;
+    myodbc_mutex_unlock(&dbc->env->lock);
+  }
 
   /* Set the statement error prefix based on the server version. */
   strxmov(dbc->st_error_prefix, MYODBC_ERROR_PREFIX, "[mysqld-",
@@ -520,6 +756,13 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   // for older versions just use net_buffer_length() macro
   dbc->net_buffer_len = net_buffer_length;
 #endif
+
+  dbc->temporary_tables= FALSE;
+  if (ds->read_replicas && ds->read_replicas[0])
+  {
+    myodbc_connect_replicas(dbc, ds, flags);
+  }
+
   return rc;
 
 error:
@@ -944,6 +1187,8 @@ void free_connection_stmts(DBC *dbc)
       next_element= list_element->next;
       my_SQLFreeStmt((SQLHSTMT)list_element->data, SQL_DROP);
   }
+
+  free_stmt_pool(dbc);
 }
 
 
@@ -965,10 +1210,18 @@ SQLRETURN SQL_API SQLDisconnect(SQLHDBC hdbc)
 
   free_connection_stmts(dbc);
 
+  myodbc_close_replicas(dbc);
+  perf_counters_dump(dbc);
   mysql_close(&dbc->mysql);
 
-  if (dbc->ds && dbc->ds->save_queries)
-    end_query_log(dbc->query_log);
+  /* The next connection may use a different charset */
+  query_cache_clear(&dbc->query_cache);
+
+  query_log_close(dbc->query_log);
+  dbc->query_log= NULL;
+  dbc->digests= NULL;
+  x_free(dbc->digest_text);
+  dbc->digest_text= NULL;
 
   /* free allocated packet buffer */
   if (dbc->mysql.net.buff)
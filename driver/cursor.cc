@@ -145,6 +145,7 @@ char *check_if_positioned_cursor_exists(STMT *pStmt, STMT **pStmtCursor)
       can find the cursor name this statement is referring to - it
       must have a result set to count.
     */
+    myodbc_mutex_lock(&dbc->handle_lock);
     for (list_element= dbc->statements;
          list_element;
          list_element= list_element->next)
@@ -160,9 +161,11 @@ char *check_if_positioned_cursor_exists(STMT *pStmt, STMT **pStmtCursor)
           !myodbc_strcasecmp((*pStmtCursor)->cursor.name,
                              cursorName))
       {
+        myodbc_mutex_unlock(&dbc->handle_lock);
         return (char *)wherePos;
       }
     }
+    myodbc_mutex_unlock(&dbc->handle_lock);
 
     /* Did we run out of statements without finding a viable cursor? */
     if (!list_element)
@@ -465,7 +468,7 @@ static my_bool insert_field(STMT *stmt, MYSQL_RES *result,
   DESCREC *aprec= &aprec_, *iprec= &iprec_;
   MYSQL_FIELD *field= mysql_fetch_field_direct(result,nSrcCol);
   MYSQL_ROW   row_data;
-  NET         *net=&stmt->dbc->mysql.net;
+  NET         *net= &stmt->query_buf;
   unsigned char *to= net->buff;
   SQLLEN      length;
   char as_string[50], *dummy;
@@ -733,7 +736,7 @@ static SQLRETURN build_set_clause(STMT *stmt, SQLULEN irow,
     uint          ncol, ignore_count= 0;
     MYSQL_FIELD *field;
     MYSQL_RES   *result= stmt->result;
-    NET         *net=&stmt->dbc->mysql.net;
+    NET         *net= &stmt->query_buf;
     DESCREC *arrec, *irrec;
 
     dynstr_append_mem(dynQuery," SET ",5);
@@ -1345,7 +1348,7 @@ static SQLRETURN batch_insert( STMT *stmt, SQLULEN irow, DYNAMIC_STRING *ext_que
     SQLULEN      insert_count= 1;           /* num rows to insert - will be real value when row is 0 (all)  */
     SQLULEN      count= 0;                  /* current row */
     SQLLEN       length;
-    NET         *net= &stmt->dbc->mysql.net;
+    NET         *net= &stmt->query_buf;
     SQLUSMALLINT ncol;
     long i;
     SQLCHAR      *to;
@@ -111,6 +111,29 @@ void desc_free(DESC *desc)
 }
 
 
+/*
+  Reset a descriptor to the state it has right after desc_alloc(). The
+  memory allocated for the records is kept, so the descriptor of a
+  recycled statement does not need to grow again.
+*/
+void desc_reset(DESC *desc)
+{
+  if (IS_APD(desc))
+    desc_free_paramdata(desc);
+  reset_dynamic(&desc->records);
+  reset_dynamic(&desc->bookmark);
+
+  desc->array_size= 1;
+  desc->array_status_ptr= NULL;
+  desc->bind_offset_ptr= NULL;
+  desc->bind_type= SQL_BIND_BY_COLUMN;
+  desc->count= 0;
+  desc->bookmark_count= 0;
+  desc->rows_processed_ptr= NULL;
+  memset(&desc->error, 0, sizeof(desc->error));
+}
+
+
 /*
   Free any memory allocated for SQLPutData(). This is only useful
   for APDs.
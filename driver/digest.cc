@@ -0,0 +1,223 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/**
+  @file  digest.cc
+  @brief per statement digest statistics of an environment
+
+  Every executed statement is reduced to its digest text by query_digest()
+  and counted against it in a fixed size open addressing table shared by
+  the connections of the environment. The table is never resized or
+  emptied, so a digest stays at the same place once it is in it and
+  statements may hold on to it until their result is closed.
+*/
+
+#include "driver.h"
+
+#include <vector>
+#include <algorithm>
+
+
+/* FNV-1a */
+static unsigned int digest_hash(const char *text, size_t length)
+{
+  unsigned int hash= 2166136261U;
+
+  while (length--)
+  {
+    hash= (hash ^ (unsigned char)*text++) * 16777619U;
+  }
+
+  return hash;
+}
+
+
+STMT_DIGESTS *digests_new(void)
+{
+  STMT_DIGESTS *digests= (STMT_DIGESTS *)myodbc_malloc(sizeof(STMT_DIGESTS),
+                                                       MYF(MY_ZEROFILL));
+  if (digests)
+  {
+    myodbc_mutex_init(&digests->lock, NULL);
+    digests->lost.text= (char *)"<lost>";
+    digests->lost.length= strlen(digests->lost.text);
+  }
+
+  return digests;
+}
+
+
+void digests_free(STMT_DIGESTS *digests)
+{
+  unsigned int i;
+
+  if (!digests)
+  {
+    return;
+  }
+
+  for (i= 0; i < DIGEST_TABLE_SIZE; ++i)
+  {
+    x_free(digests->entry[i].text);
+  }
+
+  myodbc_mutex_destroy(&digests->lock);
+  x_free(digests);
+}
+
+
+/**
+  Looks up the digest of the text and adds it if it is not there yet.
+
+  @return The digest, or the one for lost statements if the table is full
+*/
+STMT_DIGEST *digest_find(STMT_DIGESTS *digests, const char *text,
+                         size_t length)
+{
+  unsigned int hash= digest_hash(text, length);
+  unsigned int i, slot;
+  STMT_DIGEST *digest= &digests->lost;
+
+  myodbc_mutex_lock(&digests->lock);
+
+  for (i= 0; i < DIGEST_TABLE_SIZE; ++i)
+  {
+    slot= (hash + i) % DIGEST_TABLE_SIZE;
+
+    if (!digests->entry[slot].text)
+    {
+      /* Keep the last slot free so that a miss ends the probe */
+      if (digests->used < DIGEST_TABLE_SIZE - 1 &&
+          (digests->entry[slot].text= (char *)myodbc_malloc(length + 1,
+                                                            MYF(0))))
+      {
+        memcpy(digests->entry[slot].text, text, length);
+        digests->entry[slot].text[length]= '\0';
+        digests->entry[slot].length= length;
+        digests->entry[slot].hash= hash;
+        ++digests->used;
+        digest= &digests->entry[slot];
+      }
+      break;
+    }
+
+    if (digests->entry[slot].hash == hash &&
+        digests->entry[slot].length == length &&
+        !memcmp(digests->entry[slot].text, text, length))
+    {
+      digest= &digests->entry[slot];
+      break;
+    }
+  }
+
+  myodbc_mutex_unlock(&digests->lock);
+
+  return digest;
+}
+
+
+void digest_add(STMT_DIGESTS *digests, STMT_DIGEST *digest,
+                unsigned long long count, unsigned long long errors,
+                unsigned long long latency_us, unsigned long long rows,
+                unsigned long long bytes)
+{
+  myodbc_mutex_lock(&digests->lock);
+
+  digest->count+= count;
+  digest->errors+= errors;
+  digest->rows+= rows;
+  digest->bytes+= bytes;
+  digest->total_latency_us+= latency_us;
+  digest->max_latency_us= std::max(digest->max_latency_us, latency_us);
+
+  myodbc_mutex_unlock(&digests->lock);
+}
+
+
+/**
+  Formats the statistics, one line per digest with the most time spent
+  first, the statements that did not fit into the table last.
+
+  @return The text, to be freed with x_free(), or NULL if out of memory
+*/
+char *digests_format(STMT_DIGESTS *digests)
+{
+  std::vector<STMT_DIGEST> list;
+  size_t size= 1, sorted;
+  char *text, *pos;
+  unsigned int i;
+
+  myodbc_mutex_lock(&digests->lock);
+
+  for (i= 0; i < DIGEST_TABLE_SIZE; ++i)
+  {
+    if (digests->entry[i].text && digests->entry[i].count)
+    {
+      list.push_back(digests->entry[i]);
+    }
+  }
+  sorted= list.size();
+
+  /* The copies point at texts that are never freed before the table */
+  if (digests->lost.count)
+  {
+    list.push_back(digests->lost);
+  }
+
+  myodbc_mutex_unlock(&digests->lock);
+
+  std::stable_sort(list.begin(), list.begin() + sorted,
+                   [](const STMT_DIGEST &a, const STMT_DIGEST &b)
+                   { return a.total_latency_us > b.total_latency_us; });
+
+  for (i= 0; i < list.size(); ++i)
+  {
+    /* The numbers and names take well under 256 bytes */
+    size+= list[i].length + 256;
+  }
+
+  if (!(text= pos= (char *)myodbc_malloc(size, MYF(0))))
+  {
+    return NULL;
+  }
+  *pos= '\0';
+
+  for (i= 0; i < list.size(); ++i)
+  {
+    pos+= myodbc_snprintf(pos, size - (pos - text),
+                          "count=%llu;errors=%llu;total_latency_us=%llu;"
+                          "max_latency_us=%llu;rows=%llu;bytes=%llu;"
+                          "digest=%s\n",
+                          list[i].count, list[i].errors,
+                          list[i].total_latency_us, list[i].max_latency_us,
+                          list[i].rows, list[i].bytes, list[i].text);
+  }
+
+  return text;
+}
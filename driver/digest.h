@@ -0,0 +1,75 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/**
+  @file  digest.h
+  @brief per statement digest statistics of an environment
+*/
+
+#ifndef __MYODBC_DIGEST_H__
+# define __MYODBC_DIGEST_H__
+
+/* Distinct digests an environment keeps, the rest are counted as lost */
+#define DIGEST_TABLE_SIZE 1024
+/* Longest digest text, longer ones are cut and end with "..." */
+#define DIGEST_TEXT_LENGTH 1024
+
+typedef struct stmt_digest
+{
+  unsigned int        hash;
+  unsigned long long  count;
+  unsigned long long  errors;
+  unsigned long long  rows;               /* fetched or affected */
+  unsigned long long  bytes;              /* row data the application read */
+  unsigned long long  total_latency_us;
+  unsigned long long  max_latency_us;
+  size_t              length;
+  char                *text;              /* NULL while the slot is free */
+} STMT_DIGEST;
+
+typedef struct stmt_digests
+{
+  STMT_DIGEST         entry[DIGEST_TABLE_SIZE];
+  STMT_DIGEST         lost;               /* statements that found it full */
+  unsigned int        used;
+  myodbc_mutex_t      lock;
+} STMT_DIGESTS;
+
+STMT_DIGESTS *digests_new(void);
+void digests_free(STMT_DIGESTS *digests);
+
+STMT_DIGEST *digest_find(STMT_DIGESTS *digests, const char *text,
+                         size_t length);
+void digest_add(STMT_DIGESTS *digests, STMT_DIGEST *digest,
+                unsigned long long count, unsigned long long errors,
+                unsigned long long latency_us, unsigned long long rows,
+                unsigned long long bytes);
+char *digests_format(STMT_DIGESTS *digests);
+
+#endif /* __MYODBC_DIGEST_H__ */
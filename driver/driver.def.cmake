@@ -120,6 +120,9 @@ SQLTables@WIDECHARCALL@
 SQLTablePrivileges@WIDECHARCALL@
 SQLTransact
 ;
+MySQLFetchColumns
+@ARROW_EXPORTS@
+;
 DllMain
 LoadByOrdinal
 ;_DllMainCRTStartup
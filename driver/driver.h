@@ -51,6 +51,28 @@
 /* Needed for offsetof() CPP macro */
 #include <stddef.h>
 
+/* SSE2 is used to scan and convert data 16 bytes at a time where available */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define MYODBC_SSE2
+# include <emmintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+# endif
+
+/* Index of the lowest set bit of a non-zero _mm_movemask_epi8() result */
+static inline unsigned int myodbc_first_bit(unsigned int mask)
+{
+# ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (unsigned int)index;
+# else
+  return (unsigned int)__builtin_ctz(mask);
+# endif
+}
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -73,6 +95,11 @@ extern "C"
 
 #include "error.h"
 #include "parse.h"
+#include "ftoa.h"
+#include "querylog.h"
+#include "digest.h"
+#include "perfcounters.h"
+#include "columnar.h"
 
 #if defined(_WIN32) || defined(WIN32)
 # define INTFUNC  __stdcall
@@ -115,6 +142,8 @@ extern "C"
 #define MYSQL_RESET 1001	  /* param to SQLFreeStmt */
 #define MYSQL_3_21_PROTOCOL 10	  /* OLD protocol */
 #define CHECK_IF_ALIVE	    1800  /* Seconds between queries for ping */
+#define MAX_POOLED_STMTS    16    /* Dropped statements kept for reuse */
+#define MAX_KEPT_QUERY_BUF  (16L*1024L*1024L) /* larger STMT::query_buf is freed after use */
 
 #define MYSQL_MAX_CURSOR_LEN 18   /* Max cursor name length */
 #define MYSQL_STMT_LEN 1024	  /* Max statement length */
@@ -145,6 +174,15 @@ extern "C"
 # define SQL_PARAM_DATA_AVAILABLE 101
 #endif
 
+#ifndef SQL_DRIVER_CONN_ATTR_BASE
+# define SQL_DRIVER_CONN_ATTR_BASE 0x00004000
+#endif
+
+/* Driver-specific connection attributes */
+#define SQL_ATTR_MYSQL_COMPRESSION_STATS (SQL_DRIVER_CONN_ATTR_BASE + 1)
+#define SQL_ATTR_MYSQL_PERF_COUNTERS     (SQL_DRIVER_CONN_ATTR_BASE + 2)
+#define SQL_ATTR_MYSQL_STATEMENT_DIGESTS (SQL_DRIVER_CONN_ATTR_BASE + 3)
+
 /* Connection flags to validate after the connection*/
 #define CHECK_AUTOCOMMIT_ON	1  /* AUTOCOMMIT_ON */
 #define CHECK_AUTOCOMMIT_OFF	2  /* AUTOCOMMIT_OFF */
@@ -188,7 +226,7 @@ typedef enum { DESC_HDR, DESC_REC } fld_loc;
 #define SQL_IS_LEN (-10)
 
 /* check if ARD record is a bound column */
-#define ARD_IS_BOUND(d) (d)&&((d)->data_ptr || (d)->octet_length_ptr)
+#define ARD_IS_BOUND(d) ((d) && ((d)->data_ptr || (d)->octet_length_ptr))
 
 /* get the dbc from a descriptor */
 #define DESC_GET_DBC(X) (((X)->alloc_type == SQL_DESC_ALLOC_USER) ? \
@@ -325,6 +363,10 @@ typedef struct {
     ulong datalen; /* actual length, maintained for *each* row */
     /* TODO ugly, but easiest way to handle memory */
     SQLCHAR type_name[40];
+    /* charsets of the data, resolved once by fix_row_charsets() */
+    CHARSET_INFO *ansi_cs;  /* for SQL_C_CHAR, NULL if not supported */
+    CHARSET_INFO *wchar_cs; /* for SQL_C_WCHAR, NULL if not supported */
+    my_bool ansi_as_is;     /* already in the ANSI charset */
   } row;
 } DESCREC;
 
@@ -355,9 +397,29 @@ typedef struct	tagENV
 #ifdef THREAD
   myodbc_mutex_t lock;
 #endif
+  STMT_DIGESTS *digests;        /* created by the first STATEMENT_DIGESTS dsn */
 } ENV;
 
 
+/* Read replica connection, used for read/write splitting */
+
+typedef struct tagREPLICA
+{
+  MYSQL         mysql;
+  char          *host;
+  uint          port;
+  time_t        last_query_time;
+  SQLULEN       sql_select_limit;   /* same as in DBC, but for the replica session */
+  uint          outstanding;        /* statements holding a result from it */
+  unsigned long flags;              /* client flags, to connect again */
+  my_bool       connected;
+  my_bool       alive;              /* result of the last health check */
+#ifdef THREAD
+  myodbc_mutex_t lock;              /* protects outstanding */
+#endif
+} REPLICA;
+
+
 /* Connection handler */
 
 typedef struct tagDBC
@@ -369,7 +431,8 @@ typedef struct tagDBC
   LIST          list;
   STMT_OPTIONS  stmt_options;
   MYERROR       error;
-  FILE          *query_log;
+  QUERY_LOG     *query_log;         /* NULL if queries are not logged */
+  STMT_DIGESTS  *digests;           /* the environment's, if the dsn asks */
   char          st_error_prefix[255];
   char          *database;
   SQLUINTEGER   login_timeout;
@@ -380,7 +443,8 @@ typedef struct tagDBC
   ulong         net_buffer_len;
   uint          commit_flag;
 #ifdef THREAD
-  myodbc_mutex_t lock;
+  myodbc_mutex_t lock;              /* protocol lock, held during queries */
+  myodbc_mutex_t handle_lock;       /* protects statements and exp_desc lists */
 #endif
 
   my_bool       unicode;            /* Whether SQL*ConnectW was used */
@@ -391,6 +455,18 @@ typedef struct tagDBC
   SQLULEN       sql_select_limit;   /* value of the sql_select_limit currently set for a session
                                        (SQLULEN)(-1) if wasn't set */
   int           need_to_wakeup;      /* Connection have been put to the pool */
+  SQLUINTEGER   access_mode;        /* SQL_ATTR_ACCESS_MODE */
+  REPLICA       *replicas;          /* READ_REPLICAS connections */
+  uint          replica_count;
+  my_bool       temporary_tables;   /* created in the session, reads stay on
+                                       the primary */
+  LIST          *stmt_pool;         /* dropped statements kept for reuse */
+  uint          stmt_pool_count;
+  PERF_COUNTER  perf[PERF_COUNTER_COUNT]; /* see perfcounters.h */
+  char          compression_stats[256]; /* SQL_ATTR_MYSQL_COMPRESSION_STATS */
+  char          perf_counters[PERF_COUNTERS_TEXT_SIZE]; /* SQL_ATTR_MYSQL_PERF_COUNTERS */
+  char          *digest_text;       /* SQL_ATTR_MYSQL_STATEMENT_DIGESTS */
+  QUERY_CACHE   query_cache;        /* parse results of recent query texts */
 } DBC;
 
 
@@ -400,14 +476,6 @@ enum MY_STATE { ST_UNKNOWN, ST_PREPARED, ST_PRE_EXECUTED, ST_EXECUTED };
 enum MY_DUMMY_STATE { ST_DUMMY_UNKNOWN, ST_DUMMY_PREPARED, ST_DUMMY_EXECUTED };
 
 
-typedef struct limit
-{
-  unsigned long long  offset;
-  unsigned int        row_count;
-  char                *begin, *end;
-
-} MY_LIMIT_CLAUSE;
-
 typedef struct limit_scroller
 {
    char               *query, *offset_pos;
@@ -455,6 +523,8 @@ typedef struct tagSTMT
   MYSQL_ROW	        (*fix_fields)(struct tagSTMT *stmt,MYSQL_ROW row);
   MYSQL_FIELD	      *fields;
   MYSQL_ROW_OFFSET  end_of_set;
+  MYSQL_ROW         columnar_pending; /* row of a streamed result read, but not
+                                         returned by MySQLFetchColumns() */
 
   LIST              list;
   MYCURSOR          cursor;
@@ -464,6 +534,8 @@ typedef struct tagSTMT
 
   MY_PARSED_QUERY	query, orig_query;
   DYNAMIC_ARRAY     *param_bind;
+  NET               query_buf; /* query with parameter values put in, kept
+                                  allocated for the next executions */
 
   unsigned long     *lengths; /* used to set lengths if we shuffle field values
                          of the resultset of auxiliary query or if we fix_fields. */
@@ -507,6 +579,12 @@ typedef struct tagSTMT
   MYSQL_STMT *ssps;
   MYSQL_BIND *result_bind;
 
+  REPLICA *replica; /* replica the current result came from, NULL - primary */
+  QUERY_LOG_ENTRY *query_log_entry; /* logged once the result is closed */
+  STMT_DIGEST *digest;              /* counted once the result is closed */
+  unsigned long long digest_rows, digest_bytes;
+  unsigned long long perf[PERF_COUNTER_COUNT]; /* this statement's share */
+
   MY_LIMIT_SCROLLER scroller;
 
   enum OUT_PARAM_STATE out_params_state;
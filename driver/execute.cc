@@ -32,9 +32,181 @@
 */
 
 #include "driver.h"
+#include "errmsg.h"
 #include <locale.h>
 
 
+/*
+  @type    : myodbc3 internal
+  @purpose : checks the read replica health with the same logic that is
+  used for the primary connection. The replica that has failed the check,
+  or could not be connected, is not tried again until CHECK_IF_ALIVE seconds
+  pass
+*/
+
+static my_bool replica_is_alive(DBC *dbc, REPLICA *replica)
+{
+  time_t seconds= (time_t) time((time_t*) 0);
+
+  if (!replica->connected)
+  {
+    return (ulong)(seconds - replica->last_query_time) >= CHECK_IF_ALIVE &&
+           myodbc_reconnect_replica(dbc, replica);
+  }
+
+  if (!replica->alive
+   && (ulong)(seconds - replica->last_query_time) < CHECK_IF_ALIVE)
+    return FALSE;
+
+  replica->alive= !check_if_mysql_is_alive(&replica->mysql,
+                                           &replica->last_query_time);
+  return replica->alive;
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : picks the read replica the statement is to be executed on, or
+  returns NULL if it has to stay on the primary connection. SELECT
+  statements are routed in autocommit mode, and SELECT and SHOW statements
+  while the application has SQL_ATTR_ACCESS_MODE set to SQL_MODE_READ_ONLY.
+  Everything else, including statements inside of a transaction, goes to the
+  primary, and so do reads that depend on the session (see
+  is_session_select()) or may read its temporary tables. Among healthy
+  replicas the one with the least outstanding requests is chosen
+*/
+
+static REPLICA * choose_replica(STMT *stmt)
+{
+  DBC     *dbc= stmt->dbc;
+  REPLICA *best= NULL;
+  uint    i;
+
+  /* Pending results of a batch would block the replica for others */
+  if (dbc->replica_count == 0 || dbc->ds->allow_multiple_statements ||
+      dbc->temporary_tables)
+    return NULL;
+
+  if (dbc->access_mode == SQL_MODE_READ_ONLY)
+  {
+    if (stmt->query.query_type != myqtSelect
+     && stmt->query.query_type != myqtShow)
+      return NULL;
+  }
+  else if (!autocommit_on(dbc) || !is_select_statement(&stmt->query))
+  {
+    return NULL;
+  }
+
+  if (is_session_select(&stmt->query))
+    return NULL;
+
+  for (i= 0; i < dbc->replica_count; ++i)
+  {
+    REPLICA *replica= &dbc->replicas[i];
+
+    if ((best == NULL || replica->outstanding < best->outstanding)
+      && replica_is_alive(dbc, replica))
+    {
+      best= replica;
+    }
+  }
+
+  if (best != NULL)
+  {
+    myodbc_mutex_lock(&best->lock);
+    ++best->outstanding;
+    myodbc_mutex_unlock(&best->lock);
+  }
+
+  return best;
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : executes the query on the replica chosen for the statement.
+  The replica session is brought in line with the primary one first, i.e.
+  sql_select_limit and the current catalog. If the replica turns out to be
+  gone, it is marked as dead and the statement is detached from it, so the
+  caller can fall back to the primary connection
+*/
+
+static int replica_query(STMT *stmt, char *query, SQLULEN query_length)
+{
+  REPLICA *replica= stmt->replica;
+  SQLULEN lim_value= stmt->stmt_options.max_rows;
+  int     native_error= 0;
+
+  /* Both 0 and max(SQLULEN) value mean no limit */
+  if (lim_value == (SQLULEN)-1)
+    lim_value= 0;
+
+  if (lim_value != replica->sql_select_limit)
+  {
+    char buff[44];
+
+    if (lim_value > 0)
+      sprintf(buff, "set @@sql_select_limit=%lu", (unsigned long)lim_value);
+    else
+      strcpy(buff, "set @@sql_select_limit=DEFAULT");
+
+    if (!(native_error= mysql_query(&replica->mysql, buff)))
+      replica->sql_select_limit= lim_value;
+
+    PERF_ADD(stmt, PERF_ROUND_TRIPS, 1);
+    PERF_ADD(stmt, PERF_HIDDEN_ROUND_TRIPS, 1);
+  }
+
+  if (!native_error && stmt->dbc->database
+   && (!replica->mysql.db
+    || cmp_database(replica->mysql.db, stmt->dbc->database)))
+  {
+    native_error= mysql_select_db(&replica->mysql, stmt->dbc->database);
+
+    PERF_ADD(stmt, PERF_ROUND_TRIPS, 1);
+    PERF_ADD(stmt, PERF_HIDDEN_ROUND_TRIPS, 1);
+  }
+
+  if (!native_error)
+  {
+    native_error= mysql_real_query(&replica->mysql, query, query_length);
+  }
+
+  if (native_error && (mysql_errno(&replica->mysql) == CR_SERVER_GONE_ERROR
+                    || mysql_errno(&replica->mysql) == CR_SERVER_LOST))
+  {
+    replica->alive= FALSE;
+    replica->last_query_time= (time_t) time((time_t*) 0);
+    release_replica(stmt);
+  }
+
+  return native_error;
+}
+
+
+/*
+  Releases the query passed to do_query(), unless it is the statement's own
+  text or its query buffer. The buffer is kept for the next execution unless
+  it has grown too large, e.g. with a big BLOB parameter.
+*/
+static void free_query_text(STMT *stmt, char *query)
+{
+  if (query == (char*) stmt->query_buf.buff)
+  {
+    if (stmt->query_buf.max_packet > MAX_KEPT_QUERY_BUF)
+    {
+      myodbc_net_end(&stmt->query_buf);
+      stmt->query_buf.max_packet= 0;
+    }
+  }
+  else if (query != GET_QUERY(&stmt->query))
+  {
+    x_free(query);
+  }
+}
+
+
 /*
   @type    : myodbc3 internal
   @purpose : internal function to execute query and return result
@@ -43,6 +215,13 @@
 SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
 {
     int error= SQL_ERROR, native_error= 0;
+    const char *sent_query= query;
+    SQLULEN sent_length= 0;
+    long long started, elapsed;
+    my_bool release_on_exit= FALSE;
+
+    /* Previous result of the statement might have come from a replica */
+    release_replica(stmt);
 
     if (!query)
     {
@@ -67,7 +246,17 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
       query_length= strlen(query);
     }
 
-    MYLOG_QUERY(stmt, query);
+    sent_length= query_length;
+
+    if (stmt->dbc->query_log)
+    {
+      /* The statement is executed again without closing the result */
+      query_log_result_closed(stmt);
+    }
+    digest_result_closed(stmt);
+
+    started= perf_clock_ns();
+
     myodbc_mutex_lock(&stmt->dbc->lock);
 
     if ( check_if_server_is_alive( stmt->dbc ) )
@@ -103,7 +292,8 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
 
       scroller_create(stmt, query, query_length);
       scroller_move(stmt);
-      MYLOG_QUERY(stmt, stmt->scroller.query);
+      sent_query= stmt->scroller.query;
+      sent_length= (SQLULEN)stmt->scroller.query_len;
 
       native_error= mysql_real_query(&stmt->dbc->mysql, stmt->scroller.query,
                                   (unsigned long)stmt->scroller.query_len);
@@ -130,28 +320,41 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
                         mysql_stmt_errno(stmt->ssps));
         goto exit;
       }
-      MYLOG_QUERY(stmt, "ssps has been executed");
     }
     else
     {
-      MYLOG_QUERY(stmt, "Using direct execution");
       /* Need to close ps handler if it is open as our relsult will be generated
          by direct execution. and ps handler may create some chaos */
       ssps_close(stmt);
-      native_error= mysql_real_query(&stmt->dbc->mysql,query,query_length);
+
+      if ((stmt->replica= choose_replica(stmt)) != NULL)
+      {
+        native_error= replica_query(stmt, query, query_length);
+      }
+
+      /* Not routed, or the replica is gone */
+      if (stmt->replica == NULL)
+      {
+        native_error= mysql_real_query(&stmt->dbc->mysql,query,query_length);
+      }
     }
 
-    MYLOG_QUERY(stmt, "query has been executed");
+    PERF_ADD(stmt, PERF_ROUND_TRIPS, 1);
+
+    if (!native_error && !ssps_used(stmt))
+    {
+      PERF_ADD(stmt, PERF_BYTES_SENT, sent_length);
+    }
 
     if (native_error)
     {
-      MYLOG_QUERY(stmt, mysql_error(&stmt->dbc->mysql));
-      set_stmt_error(stmt, "HY000", mysql_error(&stmt->dbc->mysql),
-                     mysql_errno(&stmt->dbc->mysql));
+      MYSQL *mysql= stmt_connection(stmt);
+
+      set_stmt_error(stmt, "HY000", mysql_error(mysql), mysql_errno(mysql));
 
       /* For some errors - translating to more appropriate status */
-      translate_error(stmt->error.sqlstate, MYERR_S1000,
-                      mysql_errno(&stmt->dbc->mysql));
+      translate_error(stmt->error.sqlstate, MYERR_S1000, mysql_errno(mysql));
+      release_on_exit= TRUE;
       goto exit;
     }
 
@@ -160,8 +363,8 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
       /* Query was supposed to return result, but result is NULL*/
       if (returned_result(stmt))
       {
-        set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
-                mysql_errno(&stmt->dbc->mysql));
+        set_error(stmt, MYERR_S1000, mysql_error(stmt_connection(stmt)),
+                mysql_errno(stmt_connection(stmt)));
         goto exit;
       }
       else /* Query was not supposed to return a result */
@@ -169,6 +372,12 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
         error= SQL_SUCCESS;     /* no result set */
         stmt->state= ST_EXECUTED;
         update_affected_rows(stmt);
+
+        /* Replicas don't have the table later reads may use */
+        if (stmt->dbc->replica_count && is_create_temporary(&stmt->query))
+        {
+          stmt->dbc->temporary_tables= TRUE;
+        }
         goto exit;
       }
     }
@@ -193,8 +402,11 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
     {
       if (bind_result(stmt) || get_result(stmt))
       {
-          set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
-                  mysql_errno(&stmt->dbc->mysql));
+          MYSQL *mysql= stmt_connection(stmt);
+
+          set_error(stmt, MYERR_S1000, mysql_error(mysql),
+                  mysql_errno(mysql));
+          release_on_exit= TRUE;
           goto exit;
       }
       /* Caching row counts for queries returning resultset as well */
@@ -207,12 +419,28 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
 exit:
     myodbc_mutex_unlock(&stmt->dbc->lock);
 
-skip_unlock_exit:
-    if (query != GET_QUERY(&stmt->query))
+    elapsed= perf_clock_ns() - started;
+    PERF_ADD(stmt, PERF_QUERY_NS, elapsed);
+
+    if (stmt->dbc->query_log)
+    {
+      query_log_executed(stmt, sent_query, sent_length, elapsed / 1000, error);
+    }
+
+    if (stmt->dbc->digests)
+    {
+      digest_executed(stmt, sent_query, sent_length, elapsed / 1000, error);
+    }
+
+    /* Only now, so that the log tells which replica failed */
+    if (release_on_exit)
     {
-      x_free(query);
+      release_replica(stmt);
     }
 
+skip_unlock_exit:
+    free_query_text(stmt, query);
+
     /*
       If the original query was modified, we reset stmt->query so that the
       next execution re-starts with the original query.
@@ -232,10 +460,10 @@ skip_unlock_exit:
   @purpose : insert sql params at parameter positions
   @param[in]      stmt        Statement
   @param[in]      row         Parameters row
-  @param[in,out]  finalquery  if NULL, final query is not copied
+  @param[in,out]  finalquery  if not NULL, set to the built query
   @param[in,out]  length      Length of the query. Pointed value is used as initial offset
-  @comment : it allocates and modifies finalquery (when finalquery!=NULL),
-             so passing stmt->query->query can lead to memory leak.
+  @comment : the query is built in stmt->query_buf and finalquery points
+             into it, so it is only valid until the next call.
 */
 
 SQLRETURN insert_params(STMT *stmt, SQLULEN row, char **finalquery,
@@ -248,7 +476,7 @@ SQLRETURN insert_params(STMT *stmt, SQLULEN row, char **finalquery,
 
   int mutex_was_locked= myodbc_mutex_trylock(&stmt->dbc->lock);
 
-  net= &stmt->dbc->mysql.net;
+  net= &stmt->query_buf;
   to= (char*) net->buff + (finalquery_length!= NULL ? *finalquery_length : 0);
 
   if (!stmt->dbc->ds->dont_use_set_locale)
@@ -335,18 +563,10 @@ SQLRETURN insert_params(STMT *stmt, SQLULEN row, char **finalquery,
       *finalquery_length= to - (char*)net->buff - 1;
     }
 
+    /* The query is sent right from the buffer, see free_query_text() */
     if (finalquery!=NULL)
     {
-      if ( !(to= (char*) myodbc_memdup((char*) net->buff,
-        (uint) (to - (char*) net->buff),MYF(0))) )
-      {
-        goto memerror;
-      }
-    }
-
-    if (finalquery!=NULL)
-    {
-      *finalquery= to;
+      *finalquery= (char*) net->buff;
     }
   }
 
@@ -519,7 +739,6 @@ SQLRETURN check_c2sql_conversion_supported(STMT *stmt, DESCREC *aprec, DESCREC *
               buff_max    Size of the buffer
 
 */
-static
 SQLRETURN convert_c_type2str(STMT *stmt, SQLSMALLINT ctype, DESCREC *iprec,
                              char **res, long *length, char *buff, uint buff_max)
 {
@@ -590,21 +809,18 @@ SQLRETURN convert_c_type2str(STMT *stmt, SQLSMALLINT ctype, DESCREC *iprec,
         *res= buff;
         break;
     case SQL_C_FLOAT:
-      if ( iprec->concise_type != SQL_NUMERIC && iprec->concise_type != SQL_DECIMAL )
-      {
-        sprintf(buff, "%.17e", *((float*) *res));
-      }
-      else
-      {
-        /* We should perpare this data for string comparison */
-        sprintf(buff, "%.15e", *((float*) *res));
-      }
-      *length= strlen(*res= buff);
+      /* The shortest digits of a float are never more than the 15 used
+         for comparison with decimals */
+      *length= myodbc_ftoa(*((float*) *res), buff,
+                           MYODBC_FTOA_FLOAT | MYODBC_FTOA_EXP);
+      *res= buff;
       break;
     case SQL_C_DOUBLE:
       if ( iprec->concise_type != SQL_NUMERIC && iprec->concise_type != SQL_DECIMAL )
       {
-        sprintf(buff,"%.17e",*((double*) *res));
+        *length= myodbc_ftoa(*((double*) *res), buff, MYODBC_FTOA_EXP);
+        *res= buff;
+        break;
       }
       else
       {
@@ -779,7 +995,7 @@ SQLRETURN insert_param(STMT *stmt, uchar *place4param, DESC* apd,
     char buff[128], *data= NULL;
     BOOL convert= FALSE, free_data= FALSE;
     DBC *dbc= stmt->dbc;
-    NET *net= &dbc->mysql.net;
+    NET *net= &stmt->query_buf;
     SQLLEN *octet_length_ptr= NULL;
     SQLLEN *indicator_ptr= NULL;
     SQLRETURN result= SQL_SUCCESS;
@@ -1201,31 +1417,30 @@ SQLRETURN insert_param(STMT *stmt, uchar *place4param, DESC* apd,
     else
     {
     /* Convert binary data to hex sequence */
-      if(is_no_backslashes_escape_mode(stmt->dbc) &&
-       is_binary_sql_type(iprec->concise_type))
+      if ((is_no_backslashes_escape_mode(stmt->dbc) || dbc->ds->hex_binary_params)
+        && is_binary_sql_type(iprec->concise_type))
       {
-        SQLLEN transformed_len = 0;
-        to= add_to_buffer(net, to, " 0x", 3);
-        /* Make sure we have room for a fully-escaped string. */
-        if (!(to= extend_buffer(net, to, length * 2)))
+        to= add_to_buffer(net, to, " X'", 3);
+        if (!(to= extend_buffer(net, to, length * 2 + 1)))
         {
           goto memerror;
         }
 
-        copy_binhex_result(stmt, (SQLCHAR*)to, length * 2 + 1, &transformed_len, 0, data, length);
-        to += transformed_len;
+        myodbc_hex_encode(to, data, length);
+        to+= length * 2;
+        *to++= '\'';
       }
       else
       {
         to= add_to_buffer(net,to,"'",1);
         /* Make sure we have room for a fully-escaped string. */
-        if ( !(to= extend_buffer(net, to, length * 2)) )
+        if ( !(to= extend_buffer(net, to, length * 2 + 1)) )
         {
           goto memerror;
         }
 
-        to+= mysql_real_escape_string(&dbc->mysql, to, data, length);
-        to= add_to_buffer(net, to, "'", 1);
+        to+= myodbc_escape_param(dbc, to, data, length);
+        *to++= '\'';
       }
     }
 
@@ -1395,6 +1610,12 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
 
   is_select_stmt= is_select_statement(&pStmt->query);
 
+  /* A big parameter array of a plain INSERT goes as one LOAD DATA */
+  if (!is_select_stmt && load_data_possible(pStmt))
+  {
+    return load_data_params(pStmt);
+  }
+
   /* if ssps is used for select query then convert it to non ssps
    single statement using UNION
   */
@@ -1529,7 +1750,7 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
           const char * stmtsBinder= " UNION ALL ";
           const ulong binderLength= strlen(stmtsBinder);
 
-          add_to_buffer(&pStmt->dbc->mysql.net, (char*)pStmt->dbc->mysql.net.buff + length,
+          add_to_buffer(&pStmt->query_buf, (char*)pStmt->query_buf.buff + length,
                      stmtsBinder, binderLength);
           length+= binderLength;
         }
@@ -1549,10 +1770,7 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
       }
       else
       {
-        if (query != GET_QUERY(&pStmt->query))
-        {
-          x_free(query);
-        }
+        free_query_text(pStmt, query);
 
         /*
           If the original query was modified, we reset stmt->query so that the
@@ -1897,6 +2115,56 @@ SQLRETURN SQL_API SQLPutData( SQLHSTMT      hstmt,
 }
 
 
+/**
+  Kill the query currently running on the connection, using a second
+  connection to the same server.
+
+  @param[in] dbc      The connection
+  @param[in] replica  The read replica the query runs on, NULL for the
+                      primary connection
+
+  @return SQL_SUCCESS if KILL QUERY has been sent, SQL_ERROR otherwise. No
+          error is set, per the ODBC spec for SQLCancel().
+*/
+SQLRETURN myodbc_kill_query(DBC *dbc, REPLICA *replica)
+{
+  MYSQL *second= NULL;
+
+  second= mysql_init(second);
+
+  /** @todo need to preserve and use ssl params */
+
+  if (replica != NULL
+    ? !mysql_real_connect(second, replica->host, (const char*)dbc->ds->uid8,
+                          (const char*)dbc->ds->pwd8, NULL,
+                          replica->port ? replica->port : dbc->ds->port,
+                          NULL, 0)
+    : !mysql_real_connect(second, (const char*)dbc->ds->server8, (const char*)dbc->ds->uid8,
+                          (const char*)dbc->ds->pwd8, NULL, dbc->ds->port,
+                          (const char*)dbc->ds->socket8, 0))
+  {
+    mysql_close(second);
+    return SQL_ERROR;
+  }
+
+  {
+    char buff[40];
+    /* buff is always big enough because max length of %lu is 15 */
+    sprintf(buff, "KILL /*!50000 QUERY */ %lu",
+            mysql_thread_id(replica != NULL ? &replica->mysql : &dbc->mysql));
+    if (mysql_real_query(second, buff, strlen(buff)))
+    {
+      mysql_close(second);
+      return SQL_ERROR;
+    }
+  }
+
+  mysql_close(second);
+
+  return SQL_SUCCESS;
+}
+
+
 /**
   Cancel the query by opening another connection and using KILL when called
   from another thread while the query lock is being held. Otherwise, treat as
@@ -1908,7 +2176,6 @@ SQLRETURN SQL_API SQLPutData( SQLHSTMT      hstmt,
 */
 SQLRETURN SQL_API SQLCancel(SQLHSTMT hstmt)
 {
-  MYSQL *second= NULL;
   int error;
   DBC *dbc;
 
@@ -1931,33 +2198,7 @@ SQLRETURN SQL_API SQLCancel(SQLHSTMT hstmt)
 
   /*
     If the mutex was locked, we need to make a new connection and KILL the
-    ongoing query.
+    ongoing query. The query might have been routed to a read replica.
   */
-  second= mysql_init(second);
-
-  /** @todo need to preserve and use ssl params */
-
-  if (!mysql_real_connect(second, (const char*)dbc->ds->server8, (const char*)dbc->ds->uid8,
-                          (const char*)dbc->ds->pwd8, NULL, dbc->ds->port,
-                          (const char*)dbc->ds->socket8, 0))
-  {
-    /* We do not set the SQLSTATE here, per the ODBC spec. */
-    return SQL_ERROR;
-  }
-
-  {
-    char buff[40];
-    /* buff is always big enough because max length of %lu is 15 */
-    sprintf(buff, "KILL /*!50000 QUERY */ %lu", mysql_thread_id(&dbc->mysql));
-    if (mysql_real_query(second, buff, strlen(buff)))
-    {
-      mysql_close(second);
-      /* We do not set the SQLSTATE here, per the ODBC spec. */
-      return SQL_ERROR;
-    }
-  }
-
-  mysql_close(second);
-
-  return SQL_SUCCESS;
+  return myodbc_kill_query(dbc, ((STMT *)hstmt)->replica);
 }
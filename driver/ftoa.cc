@@ -0,0 +1,535 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/**
+  @file  ftoa.cc
+  @brief shortest round-trip formatting of floating point numbers
+
+  Digits are generated with the Grisu2 algorithm (Florian Loitsch, "Printing
+  Floating-Point Numbers Quickly and Accurately with Integers", PLDI 2010).
+  The result always reads back as the same value. In rare cases a digit
+  longer than the shortest possible string is produced. No locale is used.
+*/
+
+#include "ftoa.h"
+
+#include <string.h>
+
+typedef unsigned long long diy_uint64;
+
+/* "Do it yourself" floating point number f * 2^e */
+typedef struct
+{
+  diy_uint64 f;
+  int        e;
+} DIY_FP;
+
+/* Layout of the IEEE 754 binary formats */
+typedef struct
+{
+  int        significand_bits;
+  int        exponent_bias;   /* including significand_bits */
+  diy_uint64 hidden_bit;
+} FP_FORMAT;
+
+static const FP_FORMAT double_format= {52, 0x3FF + 52, 1ULL << 52};
+static const FP_FORMAT float_format=  {23, 0x7F + 23,  1ULL << 23};
+
+/* Normalized 10^k for k from -348 to 340 in steps of 8 */
+static const struct
+{
+  diy_uint64 f;
+  int        e;
+} cached_power[]=
+{
+  {0xfa8fd5a0081c0288ULL, -1220},
+  {0xbaaee17fa23ebf76ULL, -1193},
+  {0x8b16fb203055ac76ULL, -1166},
+  {0xcf42894a5dce35eaULL, -1140},
+  {0x9a6bb0aa55653b2dULL, -1113},
+  {0xe61acf033d1a45dfULL, -1087},
+  {0xab70fe17c79ac6caULL, -1060},
+  {0xff77b1fcbebcdc4fULL, -1034},
+  {0xbe5691ef416bd60cULL, -1007},
+  {0x8dd01fad907ffc3cULL,  -980},
+  {0xd3515c2831559a83ULL,  -954},
+  {0x9d71ac8fada6c9b5ULL,  -927},
+  {0xea9c227723ee8bcbULL,  -901},
+  {0xaecc49914078536dULL,  -874},
+  {0x823c12795db6ce57ULL,  -847},
+  {0xc21094364dfb5637ULL,  -821},
+  {0x9096ea6f3848984fULL,  -794},
+  {0xd77485cb25823ac7ULL,  -768},
+  {0xa086cfcd97bf97f4ULL,  -741},
+  {0xef340a98172aace5ULL,  -715},
+  {0xb23867fb2a35b28eULL,  -688},
+  {0x84c8d4dfd2c63f3bULL,  -661},
+  {0xc5dd44271ad3cdbaULL,  -635},
+  {0x936b9fcebb25c996ULL,  -608},
+  {0xdbac6c247d62a584ULL,  -582},
+  {0xa3ab66580d5fdaf6ULL,  -555},
+  {0xf3e2f893dec3f126ULL,  -529},
+  {0xb5b5ada8aaff80b8ULL,  -502},
+  {0x87625f056c7c4a8bULL,  -475},
+  {0xc9bcff6034c13053ULL,  -449},
+  {0x964e858c91ba2655ULL,  -422},
+  {0xdff9772470297ebdULL,  -396},
+  {0xa6dfbd9fb8e5b88fULL,  -369},
+  {0xf8a95fcf88747d94ULL,  -343},
+  {0xb94470938fa89bcfULL,  -316},
+  {0x8a08f0f8bf0f156bULL,  -289},
+  {0xcdb02555653131b6ULL,  -263},
+  {0x993fe2c6d07b7facULL,  -236},
+  {0xe45c10c42a2b3b06ULL,  -210},
+  {0xaa242499697392d3ULL,  -183},
+  {0xfd87b5f28300ca0eULL,  -157},
+  {0xbce5086492111aebULL,  -130},
+  {0x8cbccc096f5088ccULL,  -103},
+  {0xd1b71758e219652cULL,   -77},
+  {0x9c40000000000000ULL,   -50},
+  {0xe8d4a51000000000ULL,   -24},
+  {0xad78ebc5ac620000ULL,     3},
+  {0x813f3978f8940984ULL,    30},
+  {0xc097ce7bc90715b3ULL,    56},
+  {0x8f7e32ce7bea5c70ULL,    83},
+  {0xd5d238a4abe98068ULL,   109},
+  {0x9f4f2726179a2245ULL,   136},
+  {0xed63a231d4c4fb27ULL,   162},
+  {0xb0de65388cc8ada8ULL,   189},
+  {0x83c7088e1aab65dbULL,   216},
+  {0xc45d1df942711d9aULL,   242},
+  {0x924d692ca61be758ULL,   269},
+  {0xda01ee641a708deaULL,   295},
+  {0xa26da3999aef774aULL,   322},
+  {0xf209787bb47d6b85ULL,   348},
+  {0xb454e4a179dd1877ULL,   375},
+  {0x865b86925b9bc5c2ULL,   402},
+  {0xc83553c5c8965d3dULL,   428},
+  {0x952ab45cfa97a0b3ULL,   455},
+  {0xde469fbd99a05fe3ULL,   481},
+  {0xa59bc234db398c25ULL,   508},
+  {0xf6c69a72a3989f5cULL,   534},
+  {0xb7dcbf5354e9beceULL,   561},
+  {0x88fcf317f22241e2ULL,   588},
+  {0xcc20ce9bd35c78a5ULL,   614},
+  {0x98165af37b2153dfULL,   641},
+  {0xe2a0b5dc971f303aULL,   667},
+  {0xa8d9d1535ce3b396ULL,   694},
+  {0xfb9b7cd9a4a7443cULL,   720},
+  {0xbb764c4ca7a44410ULL,   747},
+  {0x8bab8eefb6409c1aULL,   774},
+  {0xd01fef10a657842cULL,   800},
+  {0x9b10a4e5e9913129ULL,   827},
+  {0xe7109bfba19c0c9dULL,   853},
+  {0xac2820d9623bf429ULL,   880},
+  {0x80444b5e7aa7cf85ULL,   907},
+  {0xbf21e44003acdd2dULL,   933},
+  {0x8e679c2f5e44ff8fULL,   960},
+  {0xd433179d9c8cb841ULL,   986},
+  {0x9e19db92b4e31ba9ULL,  1013},
+  {0xeb96bf6ebadf77d9ULL,  1039},
+  {0xaf87023b9bf0ee6bULL,  1066}
+};
+
+#define CACHED_POWER_MIN_K  -348
+#define CACHED_POWER_STEP   8
+
+static const diy_uint64 pow10_64[]=
+{
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+  100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+  1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+  1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+  1000000000000000000ULL, 10000000000000000000ULL
+};
+
+
+static DIY_FP diy_fp(diy_uint64 f, int e)
+{
+  DIY_FP r;
+  r.f= f;
+  r.e= e;
+  return r;
+}
+
+
+/* Product rounded to the upper 64 bits */
+static DIY_FP diy_multiply(DIY_FP x, DIY_FP y)
+{
+  const diy_uint64 mask32= 0xFFFFFFFFULL;
+  diy_uint64 a= x.f >> 32, b= x.f & mask32,
+             c= y.f >> 32, d= y.f & mask32;
+  diy_uint64 ac= a * c, bc= b * c, ad= a * d, bd= b * d;
+  diy_uint64 mid= (bd >> 32) + (ad & mask32) + (bc & mask32) + (1ULL << 31);
+
+  return diy_fp(ac + (ad >> 32) + (bc >> 32) + (mid >> 32), x.e + y.e + 64);
+}
+
+
+/* x.f must not be 0 */
+static DIY_FP diy_normalize(DIY_FP x)
+{
+#if defined(__GNUC__)
+  int shift= __builtin_clzll(x.f);
+
+  x.f<<= shift;
+  x.e-= shift;
+#else
+  while (!(x.f & (1ULL << 63)))
+  {
+    x.f<<= 1;
+    --x.e;
+  }
+#endif
+  return x;
+}
+
+
+/*
+  Splits a positive finite value into v and the normalized boundaries m_minus
+  and m_plus of the interval of the numbers that round to it.
+*/
+static void diy_boundaries(diy_uint64 bits, const FP_FORMAT *fmt,
+                           DIY_FP *v, DIY_FP *m_minus, DIY_FP *m_plus)
+{
+  diy_uint64 significand= bits & (fmt->hidden_bit - 1);
+  int biased_e= (int)(bits >> fmt->significand_bits);
+  DIY_FP plus, minus;
+
+  if (biased_e != 0)
+  {
+    *v= diy_fp(significand + fmt->hidden_bit, biased_e - fmt->exponent_bias);
+  }
+  else
+  {
+    *v= diy_fp(significand, 1 - fmt->exponent_bias);
+  }
+
+  plus= diy_normalize(diy_fp((v->f << 1) + 1, v->e - 1));
+
+  /* The gap below a power of 2 is half the one above it */
+  if (v->f == fmt->hidden_bit && biased_e > 1)
+  {
+    minus= diy_fp((v->f << 2) - 1, v->e - 2);
+  }
+  else
+  {
+    minus= diy_fp((v->f << 1) - 1, v->e - 1);
+  }
+
+  minus.f<<= minus.e - plus.e;
+  minus.e= plus.e;
+
+  *m_plus= plus;
+  *m_minus= minus;
+  *v= diy_normalize(*v);
+}
+
+
+/*
+  Cached power c = 10^-k such that the binary exponent of c * 2^e falls
+  within [-60, -32].
+*/
+static DIY_FP get_cached_power(int e, int *k)
+{
+  double dk= (-61 - e) * 0.30102999566398114 + 347;
+  int ik= (int)dk;
+  unsigned int index;
+
+  if (dk - ik > 0.0)
+  {
+    ++ik;
+  }
+
+  index= (unsigned int)((ik >> 3) + 1);
+  *k= -(CACHED_POWER_MIN_K + (int)(index * CACHED_POWER_STEP));
+
+  return diy_fp(cached_power[index].f, cached_power[index].e);
+}
+
+
+/* Moves the last digit towards w as long as it stays within the interval */
+static void grisu_round(char *buffer, int length, diy_uint64 delta,
+                        diy_uint64 rest, diy_uint64 ten_kappa, diy_uint64 wp_w)
+{
+  while (rest < wp_w && delta - rest >= ten_kappa &&
+         (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+  {
+    --buffer[length - 1];
+    rest+= ten_kappa;
+  }
+}
+
+
+static int count_digits(unsigned int n)
+{
+  int digits= 1;
+
+  while (digits < 10 && n >= pow10_64[digits])
+  {
+    ++digits;
+  }
+
+  return digits;
+}
+
+
+/*
+  Generates the digits of a number within (m_plus - delta, m_plus), as close
+  to w as possible. The value is buffer * 10^k.
+*/
+static int digit_gen(DIY_FP w, DIY_FP m_plus, diy_uint64 delta,
+                     char *buffer, int *k)
+{
+  const DIY_FP one= diy_fp(1ULL << -m_plus.e, m_plus.e);
+  const diy_uint64 wp_w= m_plus.f - w.f;
+  unsigned int p1= (unsigned int)(m_plus.f >> -one.e);
+  diy_uint64 p2= m_plus.f & (one.f - 1);
+  int kappa= count_digits(p1);
+  int length= 0;
+
+  while (kappa > 0)
+  {
+    unsigned int d= (unsigned int)(p1 / pow10_64[kappa - 1]);
+    diy_uint64 rest;
+
+    p1%= (unsigned int)pow10_64[kappa - 1];
+
+    if (d || length)
+    {
+      buffer[length++]= (char)('0' + d);
+    }
+
+    --kappa;
+    rest= ((diy_uint64)p1 << -one.e) + p2;
+
+    if (rest <= delta)
+    {
+      *k+= kappa;
+      grisu_round(buffer, length, delta, rest,
+                  pow10_64[kappa] << -one.e, wp_w);
+      return length;
+    }
+  }
+
+  for (;;)
+  {
+    char d;
+
+    p2*= 10;
+    delta*= 10;
+    d= (char)(p2 >> -one.e);
+
+    if (d || length)
+    {
+      buffer[length++]= (char)('0' + d);
+    }
+
+    p2&= one.f - 1;
+    --kappa;
+
+    if (p2 < delta)
+    {
+      *k+= kappa;
+      grisu_round(buffer, length, delta, p2, one.f,
+                  -kappa < 20 ? wp_w * pow10_64[-kappa] : 0);
+      return length;
+    }
+  }
+}
+
+
+/* Digits of a positive finite value, returns their number */
+static int grisu2(diy_uint64 bits, const FP_FORMAT *fmt, char *buffer, int *k)
+{
+  DIY_FP v, m_minus, m_plus, c_mk, w, wp, wm;
+
+  diy_boundaries(bits, fmt, &v, &m_minus, &m_plus);
+
+  c_mk= get_cached_power(m_plus.e, k);
+  w=  diy_multiply(v, c_mk);
+  wp= diy_multiply(m_plus, c_mk);
+  wm= diy_multiply(m_minus, c_mk);
+
+  /* Stay away from the boundaries, their products are not exact */
+  ++wm.f;
+  --wp.f;
+
+  return digit_gen(w, wp, wp.f - wm.f, buffer, k);
+}
+
+
+static char *write_exponent(char *to, int exponent)
+{
+  *to++= 'e';
+
+  if (exponent < 0)
+  {
+    *to++= '-';
+    exponent= -exponent;
+  }
+
+  if (exponent >= 100)
+  {
+    *to++= (char)('0' + exponent / 100);
+    exponent%= 100;
+    *to++= (char)('0' + exponent / 10);
+  }
+  else if (exponent >= 10)
+  {
+    *to++= (char)('0' + exponent / 10);
+  }
+  *to++= (char)('0' + exponent % 10);
+
+  return to;
+}
+
+
+/**
+  Formats a float or a double with the fewest digits that read back as the
+  same value.
+
+  Without MYODBC_FTOA_EXP the format of the server is used: the fixed point
+  one for numbers from 1e-15 up to 1e15, e.g. 0.1 or 100, and the exponent
+  one otherwise, e.g. 1.5e-20 or 1e300. With MYODBC_FTOA_EXP it's always the
+  exponent format, e.g. 1e-1.
+
+  Infinities and NaN come out as inf, -inf and nan.
+
+  @param[in]  value  The number, a float promoted to double if flags has
+                     MYODBC_FTOA_FLOAT
+  @param[out] to     Buffer of at least MYODBC_FTOA_BUFFER_SIZE bytes
+  @param[in]  flags  MYODBC_FTOA_FLOAT, MYODBC_FTOA_EXP
+
+  @return  Length of the result, which is null-terminated
+*/
+size_t myodbc_ftoa(double value, char *to, int flags)
+{
+  const FP_FORMAT *fmt;
+  char digits[20], *start= to;
+  diy_uint64 bits;
+  int length, k= 0, point, i;
+  if (flags & MYODBC_FTOA_FLOAT)
+  {
+    float f= (float)value;
+    unsigned int fbits;
+
+    memcpy(&fbits, &f, sizeof(fbits));
+    if (fbits >> 31)
+    {
+      *to++= '-';
+    }
+    bits= fbits & 0x7FFFFFFFU;
+    fmt= &float_format;
+  }
+  else
+  {
+    memcpy(&bits, &value, sizeof(bits));
+    if (bits >> 63)
+    {
+      *to++= '-';
+    }
+    bits&= ~(1ULL << 63);
+    fmt= &double_format;
+  }
+
+  /* All exponent bits set */
+  if ((bits >> fmt->significand_bits) ==
+      (1ULL << (fmt == &float_format ? 8 : 11)) - 1)
+  {
+    if (bits & (fmt->hidden_bit - 1))
+    {
+      to= start;
+      memcpy(to, "nan", 3);
+    }
+    else
+    {
+      memcpy(to, "inf", 3);
+    }
+    to[3]= '\0';
+    return to + 3 - start;
+  }
+
+  if (bits == 0)
+  {
+    length= 1;
+    digits[0]= '0';
+    k= 0;
+  }
+  else
+  {
+    length= grisu2(bits, fmt, digits, &k);
+  }
+
+  /* value = 0.digits * 10^point */
+  point= length + k;
+
+  if (flags & MYODBC_FTOA_EXP || point < -14 || point > 15)
+  {
+    *to++= digits[0];
+    if (length > 1)
+    {
+      *to++= '.';
+      memcpy(to, digits + 1, length - 1);
+      to+= length - 1;
+    }
+    to= write_exponent(to, bits == 0 ? 0 : point - 1);
+  }
+  else if (point <= 0)
+  {
+    *to++= '0';
+    *to++= '.';
+    for (i= point; i < 0; ++i)
+    {
+      *to++= '0';
+    }
+    memcpy(to, digits, length);
+    to+= length;
+  }
+  else if (point >= length)
+  {
+    memcpy(to, digits, length);
+    to+= length;
+    for (i= length; i < point; ++i)
+    {
+      *to++= '0';
+    }
+  }
+  else
+  {
+    memcpy(to, digits, point);
+    to+= point;
+    *to++= '.';
+    memcpy(to, digits + point, length - point);
+    to+= length - point;
+  }
+
+  *to= '\0';
+  return to - start;
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/**
+  @file  ftoa.h
+  @brief shortest round-trip formatting of floating point numbers
+*/
+
+#ifndef __MYODBC_FTOA_H__
+# define __MYODBC_FTOA_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* The value is a float, use as many digits as needed to read it back as one */
+#define MYODBC_FTOA_FLOAT 1
+/*
+  Always use the exponent format. It keeps SQL literals approximate values,
+  e.g. 1e-1 rather than the exact 0.1.
+*/
+#define MYODBC_FTOA_EXP   2
+
+/* Longest possible result, with the terminating null */
+#define MYODBC_FTOA_BUFFER_SIZE 40
+
+size_t myodbc_ftoa(double value, char *to, int flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MYODBC_FTOA_H__ */
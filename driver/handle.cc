@@ -123,6 +123,7 @@ SQLRETURN SQL_API SQLAllocEnv(SQLHENV *phenv)
 SQLRETURN SQL_API my_SQLFreeEnv(SQLHENV henv)
 {
     ENV *env= (ENV *) henv;
+    digests_free(env->digests);
     myodbc_mutex_destroy(&env->lock);
 #ifndef _UNIX_
     GlobalUnlock(GlobalHandle((HGLOBAL) henv));
@@ -267,6 +268,8 @@ SQLRETURN SQL_API my_SQLAllocConnect(SQLHENV henv, SQLHDBC *phdbc)
     dbc->exp_desc= NULL;
     dbc->sql_select_limit= (SQLULEN) -1;
     myodbc_mutex_init(&dbc->lock,NULL);
+    myodbc_mutex_init(&dbc->handle_lock,NULL);
+    query_cache_init(&dbc->query_cache);
     myodbc_mutex_lock(&dbc->lock);
     myodbc_ov_init(penv->odbc_ver); /* Initialize based on ODBC version */
     myodbc_mutex_unlock(&dbc->lock);
@@ -320,6 +323,8 @@ int wakeup_connection(DBC *dbc)
 {
   DataSource *ds= dbc->ds;
 
+  uint i;
+
   if (mysql_change_user(&dbc->mysql, ds_get_utf8attr(ds->uid, &ds->uid8),
                                      ds_get_utf8attr(ds->pwd, &ds->pwd8),
                                      ds_get_utf8attr(ds->database, &ds->database8)))
@@ -327,6 +332,22 @@ int wakeup_connection(DBC *dbc)
     return 1;
   }
 
+  /* A replica that fails here is not fatal, reads will go elsewhere */
+  for (i= 0; i < dbc->replica_count; ++i)
+  {
+    REPLICA *replica= &dbc->replicas[i];
+
+    if (replica->connected &&
+        mysql_change_user(&replica->mysql, (char *)ds->uid8, (char *)ds->pwd8,
+                          (char *)ds->database8))
+    {
+      replica->alive= FALSE;
+    }
+    replica->sql_select_limit= (SQLULEN) -1;
+  }
+
+  /* Changing the user drops them */
+  dbc->temporary_tables= FALSE;
   dbc->need_to_wakeup= 0;
   return 0;
 }
@@ -351,6 +372,8 @@ SQLRETURN SQL_API my_SQLFreeConnect(SQLHDBC hdbc)
       ds_delete(dbc->ds);
     }
     myodbc_mutex_destroy(&dbc->lock);
+    myodbc_mutex_destroy(&dbc->handle_lock);
+    query_cache_destroy(&dbc->query_cache);
 
     free_explicit_descriptors(dbc);
 
@@ -463,6 +486,117 @@ void delete_param_bind(DYNAMIC_ARRAY *param_bind)
 }
 
 
+/*
+  Frees the resources the statement keeps while it sits in the pool, and
+  the statement itself.
+*/
+static void stmt_free_pooled(STMT *stmt)
+{
+  desc_free(stmt->imp_apd);
+  desc_free(stmt->imp_ard);
+  desc_free(stmt->ipd);
+  desc_free(stmt->ird);
+
+  delete_parsed_query(&stmt->query);
+  delete_parsed_query(&stmt->orig_query);
+  delete_param_bind(stmt->param_bind);
+  myodbc_net_end(&stmt->query_buf);
+
+  delete stmt;
+}
+
+
+/*
+  Puts dropped statement to the connection's pool of statements for reuse
+  by my_SQLAllocStmt(). Descriptors, parsed query arrays, parameter bind
+  buffers and the query buffer are reset but keep their memory, the rest of
+  the statement is reinitialized. The statement must be already reset by
+  my_SQLFreeStmtExtended() and disassociated from explicit descriptors.
+
+  Returns FALSE if the pool is full and the statement has to be freed.
+*/
+static my_bool stmt_to_pool(STMT *stmt)
+{
+  DBC             *dbc= stmt->dbc;
+  DESC            *ard= stmt->imp_ard, *ird= stmt->ird,
+                  *apd= stmt->imp_apd, *ipd= stmt->ipd;
+  MY_PARSED_QUERY query= stmt->query, orig_query= stmt->orig_query;
+  DYNAMIC_ARRAY   *param_bind= stmt->param_bind;
+  NET             query_buf= stmt->query_buf;
+
+  myodbc_mutex_lock(&dbc->handle_lock);
+
+  if (dbc->stmt_pool_count >= MAX_POOLED_STMTS)
+  {
+    myodbc_mutex_unlock(&dbc->handle_lock);
+    return FALSE;
+  }
+
+  dbc->statements= list_delete(dbc->statements, &stmt->list);
+  myodbc_mutex_unlock(&dbc->handle_lock);
+
+  desc_reset(ard);
+  desc_reset(ird);
+  desc_reset(apd);
+  desc_reset(ipd);
+  x_free(stmt->cursor.name);
+
+  *stmt= STMT();
+
+  stmt->dbc= dbc;
+  stmt->ard= stmt->imp_ard= ard;
+  stmt->apd= stmt->imp_apd= apd;
+  stmt->ird= ird;
+  stmt->ipd= ipd;
+  stmt->query= query;
+  stmt->orig_query= orig_query;
+  stmt->param_bind= param_bind;
+  stmt->query_buf= query_buf;
+  stmt->list.data= stmt;
+
+  myodbc_mutex_lock(&dbc->handle_lock);
+  dbc->stmt_pool= list_add(dbc->stmt_pool, &stmt->list);
+  ++dbc->stmt_pool_count;
+  myodbc_mutex_unlock(&dbc->handle_lock);
+
+  return TRUE;
+}
+
+
+/*
+  Takes a statement from the connection's pool, NULL if the pool is empty
+*/
+static STMT * stmt_from_pool(DBC *dbc)
+{
+  STMT *stmt= NULL;
+
+  myodbc_mutex_lock(&dbc->handle_lock);
+  if (dbc->stmt_pool != NULL)
+  {
+    stmt= (STMT *)dbc->stmt_pool->data;
+    dbc->stmt_pool= list_delete(dbc->stmt_pool, dbc->stmt_pool);
+    --dbc->stmt_pool_count;
+  }
+  myodbc_mutex_unlock(&dbc->handle_lock);
+
+  return stmt;
+}
+
+
+/*
+  Frees all statements in the connection's pool
+*/
+void free_stmt_pool(DBC *dbc)
+{
+  STMT *stmt;
+
+  while ((stmt= stmt_from_pool(dbc)) != NULL)
+  {
+    stmt_free_pooled(stmt);
+  }
+}
+
+
 /*
   @type    : myodbc3 internal
   @purpose : allocates the statement handle
@@ -479,40 +613,46 @@ SQLRETURN SQL_API my_SQLAllocStmt(SQLHDBC hdbc,SQLHSTMT *phstmt)
     Keeping the check here to stay on the safe side */
   WAKEUP_CONN_IF_NEEDED(dbc);
 
-  stmt = new STMT();
-  stmt->dbc= dbc;
+  /* Recycled statement has all its buffers allocated already */
+  if ((stmt= stmt_from_pool(dbc)) == NULL)
+  {
+    stmt = new STMT();
+    stmt->dbc= dbc;
+    init_parsed_query(&stmt->query);
+    init_parsed_query(&stmt->orig_query);
+
+    if (!dbc->ds->no_ssps && allocate_param_bind(&stmt->param_bind, 10))
+    {
+      goto error;
+    }
+
+    if (!(stmt->ard= desc_alloc(stmt, SQL_DESC_ALLOC_AUTO,
+                                DESC_APP, DESC_ROW)))
+      goto error;
+    if (!(stmt->ird= desc_alloc(stmt, SQL_DESC_ALLOC_AUTO,
+                                DESC_IMP, DESC_ROW)))
+      goto error;
+    if (!(stmt->apd= desc_alloc(stmt, SQL_DESC_ALLOC_AUTO,
+                                DESC_APP, DESC_PARAM)))
+      goto error;
+    if (!(stmt->ipd= desc_alloc(stmt, SQL_DESC_ALLOC_AUTO,
+                                DESC_IMP, DESC_PARAM)))
+      goto error;
+    stmt->imp_ard= stmt->ard;
+    stmt->imp_apd= stmt->apd;
+  }
+
   *phstmt = (SQLHSTMT*)stmt;
 
-  myodbc_mutex_lock(&stmt->dbc->lock);
-  dbc->statements= list_add(dbc->statements,&stmt->list);
-  myodbc_mutex_unlock(&stmt->dbc->lock);
   stmt->list.data= stmt;
+  myodbc_mutex_lock(&dbc->handle_lock);
+  dbc->statements= list_add(dbc->statements,&stmt->list);
+  myodbc_mutex_unlock(&dbc->handle_lock);
   stmt->stmt_options= dbc->stmt_options;
+  stmt->query_buf.max_packet_size= dbc->mysql.net.max_packet_size;
   stmt->state= ST_UNKNOWN;
   stmt->dummy_state= ST_DUMMY_UNKNOWN;
   myodbc_stpmov(stmt->error.sqlstate, "00000");
-  init_parsed_query(&stmt->query);
-  init_parsed_query(&stmt->orig_query);
-
-  if (!dbc->ds->no_ssps && allocate_param_bind(&stmt->param_bind, 10))
-  {
-    goto error;
-  }
-
-  if (!(stmt->ard= desc_alloc(stmt, SQL_DESC_ALLOC_AUTO,
-                              DESC_APP, DESC_ROW)))
-    goto error;
-  if (!(stmt->ird= desc_alloc(stmt, SQL_DESC_ALLOC_AUTO,
-                              DESC_IMP, DESC_ROW)))
-    goto error;
-  if (!(stmt->apd= desc_alloc(stmt, SQL_DESC_ALLOC_AUTO,
-                              DESC_APP, DESC_PARAM)))
-    goto error;
-  if (!(stmt->ipd= desc_alloc(stmt, SQL_DESC_ALLOC_AUTO,
-                              DESC_IMP, DESC_PARAM)))
-    goto error;
-  stmt->imp_ard= stmt->ard;
-  stmt->imp_apd= stmt->apd;
 
   return SQL_SUCCESS;
 
@@ -524,6 +664,8 @@ error:
   delete_parsed_query(&stmt->query);
   delete_parsed_query(&stmt->orig_query);
   delete_param_bind(stmt->param_bind);
+  myodbc_net_end(&stmt->query_buf);
+  delete stmt;
 
   return set_dbc_error(dbc, "HY001", "Memory allocation error", MYERR_S1001);
 }
@@ -572,6 +714,39 @@ SQLRETURN SQL_API my_SQLFreeStmt(SQLHSTMT hstmt,SQLUSMALLINT fOption)
   return my_SQLFreeStmtExtended(hstmt,fOption,1);
 }
 
+/*
+  @type    : myodbc3 internal
+  @purpose : when a streamed (mysql_use_result) result is closed with more
+       than KILL_ON_CLOSE rows still pending, kill the query through a
+       second connection instead of reading all the rows off the socket.
+       The server then ends the result with an error packet, and the
+       usual draining resynchronizes the protocol after a few buffers.
+*/
+
+static void abandon_streamed_result(STMT *stmt)
+{
+  unsigned int rows_left= stmt->dbc->ds->kill_on_close;
+
+  if (rows_left == 0 || ssps_used(stmt) || stmt->result == NULL ||
+      stmt->result->handle == NULL)
+  {
+    return;
+  }
+
+  /* Small leftovers are cheaper to read than to kill */
+  while (rows_left > 0 && mysql_fetch_row(stmt->result) != NULL)
+  {
+    --rows_left;
+  }
+
+  /* handle is reset once the last row has been read */
+  if (stmt->result->handle != NULL)
+  {
+    myodbc_kill_query(stmt->dbc, stmt->replica);
+  }
+}
+
+
 /*
   @type    : myodbc3 internal
   @purpose : stops processing associated with a specific statement,
@@ -623,12 +798,16 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
       return SQL_SUCCESS;
     }
 
+    query_log_result_closed(stmt);
+    digest_result_closed(stmt);
+
     if (!stmt->fake_result)
     {
       if (clearAllResults)
       {
         /* We seiously CLOSEing statement for preparing handle object for
            new query */
+        abandon_streamed_result(stmt);
         free_internal_result_buffers(stmt);
         while (!next_result(stmt))
         {
@@ -665,6 +844,7 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
     stmt->cursor_row= -1;
     stmt->dae_type= 0;
     stmt->ird->count= 0;
+    release_replica(stmt);
 
     if (fOption == MYSQL_RESET_BUFFERS)
     {
@@ -730,6 +910,12 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
     /* explicitly allocated descriptors are affected up until this point */
     desc_remove_stmt(stmt->apd, stmt);
     desc_remove_stmt(stmt->ard, stmt);
+
+    if (stmt_to_pool(stmt))
+    {
+      return SQL_SUCCESS;
+    }
+
     desc_free(stmt->imp_apd);
     desc_free(stmt->imp_ard);
     desc_free(stmt->ipd);
@@ -740,10 +926,11 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
     delete_parsed_query(&stmt->query);
     delete_parsed_query(&stmt->orig_query);
     delete_param_bind(stmt->param_bind);
+    myodbc_net_end(&stmt->query_buf);
 
-    myodbc_mutex_lock(&stmt->dbc->lock);
+    myodbc_mutex_lock(&stmt->dbc->handle_lock);
     stmt->dbc->statements= list_delete(stmt->dbc->statements,&stmt->list);
-    myodbc_mutex_unlock(&stmt->dbc->lock);
+    myodbc_mutex_unlock(&stmt->dbc->handle_lock);
     delete stmt;
     return SQL_SUCCESS;
 }
@@ -766,9 +953,9 @@ SQLRETURN my_SQLAllocDesc(SQLHDBC hdbc, SQLHANDLE *pdesc)
   /* add to this connection's list of explicit descriptors */
   e= (LIST *) myodbc_malloc(sizeof(LIST), MYF(0));
   e->data= desc;
-  myodbc_mutex_lock(&dbc->lock);
+  myodbc_mutex_lock(&dbc->handle_lock);
   dbc->exp_desc= list_add(dbc->exp_desc, e);
-  myodbc_mutex_unlock(&dbc->lock);
+  myodbc_mutex_unlock(&dbc->handle_lock);
 
   *pdesc= desc;
   return SQL_SUCCESS;
@@ -794,17 +981,17 @@ SQLRETURN my_SQLFreeDesc(SQLHANDLE hdesc)
                           "allocated descriptor handle.", MYERR_S1017);
 
   /* remove from DBC */
+  myodbc_mutex_lock(&dbc->handle_lock);
   for (ldesc= dbc->exp_desc; ldesc; ldesc= ldesc->next)
   {
     if (ldesc->data == desc)
     {
-      myodbc_mutex_lock(&dbc->lock);
       dbc->exp_desc= list_delete(dbc->exp_desc, ldesc);
-      myodbc_mutex_unlock(&dbc->lock);
       x_free(ldesc);
       break;
     }
   }
+  myodbc_mutex_unlock(&dbc->handle_lock);
 
   /* reset all stmts it was on - to their implicit desc */
   for (lstmt= desc->exp.stmts; lstmt; lstmt= next)
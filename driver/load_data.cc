@@ -0,0 +1,792 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+/**
+  @file  load_data.cc
+  @brief sending parameter arrays of an INSERT as LOAD DATA LOCAL INFILE
+
+  With LOAD_DATA_ROWS=N, a parameter array of at least N rows for a plain
+  INSERT INTO t (c1, c2, ...) VALUES (?, ?, ...) is not sent as N
+  statements. The driver runs a single LOAD DATA LOCAL INFILE instead, and
+  its local infile handler produces the "file" from the application's
+  buffers, a tab separated row at a time. This needs ENABLE_LOCAL_INFILE=1
+  and local_infile enabled on the server.
+
+  The server handles the rows of LOAD DATA LOCAL as if IGNORE was given, so
+  duplicate keys and bad values are warnings instead of errors, and values
+  are truncated or clipped to the column. They make the execution return
+  SQL_SUCCESS_WITH_INFO, with every row marked SQL_PARAM_SUCCESS_WITH_INFO
+  as the server does not tell which rows they are about. Under a strict
+  sql_mode the usual INSERT refuses such values, so the parameter array
+  goes the usual way then.
+
+  A value the driver fails to convert ends the file early. The server has
+  stored the rows before it, which are marked SQL_PARAM_SUCCESS_WITH_INFO,
+  the row of the value is SQL_PARAM_ERROR and the rest SQL_PARAM_UNUSED.
+
+  Outside of load_data_params() the connection refuses every file the
+  server asks for, see load_data_refuse().
+*/
+
+#include "driver.h"
+#include "errmsg.h"
+
+/* The file name is only what the server shows in its logs */
+static const char load_data_head[]=
+  "LOAD DATA LOCAL INFILE 'odbc-parameters' INTO TABLE ";
+
+
+typedef struct load_data
+{
+  STMT        *stmt;
+  SQLULEN     row;          /* parameter row being sent */
+  uint        param;        /* next parameter of the row */
+  const char  *pos, *end;   /* part of the current value not sent yet */
+  char        *allocated;   /* the current value, if converted to the heap */
+  my_bool     escape;       /* FALSE for \N */
+  char        separator;    /* sent after the value, 0 when it is sent */
+  my_bool     failed;
+  SQLULEN     failed_row;   /* the row of the failed conversion */
+  MYERROR     error;        /* of the failed conversion */
+  char        buff[128];    /* the current value converted from a number,
+                               date etc. */
+} LOAD_DATA;
+
+
+/* Escape sequences of the bytes that need them in a LOAD DATA field */
+static const char load_data_escape[256]=
+{
+  '0', 0, 0, 0, 0, 0, 0, 0, 0, 't', 'n', 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0
+  /* the rest are 0 */
+};
+
+
+static my_bool is_ident_char(char c)
+{
+  return (uchar)c >= 0x80 || isalnum((uchar)c) || c == '_' || c == '$';
+}
+
+
+/*
+  Skips a table or column name, `quoted` or not. Returns the position after
+  it, or NULL if there is no name at pos
+*/
+static const char *skip_identifier(const char *pos, const char *end)
+{
+  if (pos < end && *pos == '`')
+  {
+    for (++pos; pos < end; ++pos)
+    {
+      if (*pos == '`')
+      {
+        if (pos + 1 < end && pos[1] == '`')
+          ++pos;
+        else
+          return pos + 1;
+      }
+    }
+    return NULL;
+  }
+
+  if (pos == end || !is_ident_char(*pos))
+    return NULL;
+
+  while (pos < end && is_ident_char(*pos))
+    ++pos;
+
+  return pos;
+}
+
+
+static const char *skip_spaces(const char *pos, const char *end)
+{
+  while (pos < end && isspace((uchar)*pos))
+    ++pos;
+
+  return pos;
+}
+
+
+/* Skips keyword and the spaces after it, NULL if the text is not there */
+static const char *skip_keyword(const char *pos, const char *end,
+                                const char *keyword)
+{
+  uint length= (uint)strlen(keyword);
+
+  if ((uint)(end - pos) < length || myodbc_casecmp(pos, keyword, length)
+   || (pos + length < end && is_ident_char(pos[length])))
+    return NULL;
+
+  return skip_spaces(pos + length, end);
+}
+
+
+/*
+  Checks that the statement is INSERT [INTO] t [(c1, ...)] VALUES (?, ...)
+  with nothing else in it, and finds the table name and the column list.
+  Comments, IGNORE, ON DUPLICATE KEY UPDATE and expressions all make it
+  go the usual way.
+*/
+static my_bool parse_plain_insert(STMT *stmt, const char **table,
+                                  const char **table_end,
+                                  const char **columns,
+                                  const char **columns_end)
+{
+  const char *pos= GET_QUERY(&stmt->query), *end= GET_QUERY_END(&stmt->query);
+  const char *next;
+  uint column_count= 0, marker_count= 0;
+
+  pos= skip_spaces(pos, end);
+  if (!(pos= skip_keyword(pos, end, "INSERT")))
+    return FALSE;
+  if ((next= skip_keyword(pos, end, "INTO")))
+    pos= next;
+
+  /* [db.]table */
+  *table= pos;
+  if (!(pos= skip_identifier(pos, end)))
+    return FALSE;
+  if (pos < end && *pos == '.' && !(pos= skip_identifier(pos + 1, end)))
+    return FALSE;
+  *table_end= pos;
+  pos= skip_spaces(pos, end);
+
+  *columns= *columns_end= NULL;
+  if (pos < end && *pos == '(')
+  {
+    *columns= pos;
+    do
+    {
+      pos= skip_spaces(pos + 1, end);
+      if (!(pos= skip_identifier(pos, end)))
+        return FALSE;
+      pos= skip_spaces(pos, end);
+      ++column_count;
+    } while (pos < end && *pos == ',');
+
+    if (pos == end || *pos != ')')
+      return FALSE;
+    *columns_end= ++pos;
+    pos= skip_spaces(pos, end);
+  }
+
+  if (!(next= skip_keyword(pos, end, "VALUES")) &&
+      !(next= skip_keyword(pos, end, "VALUE")))
+    return FALSE;
+  pos= next;
+
+  if (pos == end || *pos != '(')
+    return FALSE;
+  do
+  {
+    pos= skip_spaces(pos + 1, end);
+    if (pos == end || *pos != '?')
+      return FALSE;
+    pos= skip_spaces(pos + 1, end);
+    ++marker_count;
+  } while (pos < end && *pos == ',');
+
+  if (pos == end || *pos != ')')
+    return FALSE;
+  pos= skip_spaces(pos + 1, end);
+  if (pos < end && *pos == ';')
+    pos= skip_spaces(pos + 1, end);
+
+  return pos == end && marker_count == stmt->param_count &&
+         (!column_count || column_count == marker_count);
+}
+
+
+/*
+  Whether LOAD DATA stores the same value as the usual INSERT for a
+  parameter. Only the conversions that the server does the same way for
+  both are taken, checks and fix-ups the driver makes in insert_param(),
+  like the date overflow check or the locale of a number in a string, make
+  the parameter array go the usual way.
+*/
+static my_bool load_data_type_ok(DBC *dbc, DESCREC *aprec, DESCREC *iprec)
+{
+  SQLSMALLINT sql_type= iprec->concise_type;
+  my_bool is_text= is_char_sql_type(sql_type) || is_wchar_sql_type(sql_type);
+  my_bool is_exact= FALSE, is_approximate= FALSE;
+
+  switch (sql_type)
+  {
+  case SQL_TINYINT:
+  case SQL_SMALLINT:
+  case SQL_INTEGER:
+  case SQL_BIGINT:
+  case SQL_DECIMAL:
+  case SQL_NUMERIC:
+    is_exact= TRUE;
+    break;
+  case SQL_REAL:
+  case SQL_FLOAT:
+  case SQL_DOUBLE:
+    is_approximate= TRUE;
+    break;
+  }
+
+  switch (aprec->concise_type)
+  {
+  case SQL_C_CHAR:
+    return (is_text || is_exact) &&
+           dbc->ansi_charset_info->number == dbc->cxn_charset_info->number;
+
+  case SQL_C_WCHAR:
+    return (is_text || is_exact) &&
+           !strncmp(dbc->cxn_charset_info->csname, "utf8", 4);
+
+  case SQL_C_BIT:
+  case SQL_C_TINYINT:
+  case SQL_C_STINYINT:
+  case SQL_C_UTINYINT:
+  case SQL_C_SHORT:
+  case SQL_C_SSHORT:
+  case SQL_C_USHORT:
+  case SQL_C_LONG:
+  case SQL_C_SLONG:
+  case SQL_C_ULONG:
+  case SQL_C_SBIGINT:
+  case SQL_C_UBIGINT:
+  case SQL_C_FLOAT:
+  case SQL_C_DOUBLE:
+    return is_text || is_exact || is_approximate;
+
+  case SQL_C_DATE:
+  case SQL_C_TYPE_DATE:
+    return is_text || sql_type == SQL_TYPE_DATE ||
+           sql_type == SQL_DATE || sql_type == SQL_TYPE_TIMESTAMP ||
+           sql_type == SQL_TIMESTAMP;
+
+  case SQL_C_TIMESTAMP:
+  case SQL_C_TYPE_TIMESTAMP:
+    return is_text || sql_type == SQL_TYPE_TIMESTAMP ||
+           sql_type == SQL_TIMESTAMP;
+
+  case SQL_C_TIME:
+  case SQL_C_TYPE_TIME:
+    return is_text || sql_type == SQL_TYPE_TIME ||
+           sql_type == SQL_TIME;
+  }
+
+  return FALSE;
+}
+
+
+/*
+  Checks if the parameter array of the statement can be sent with
+  load_data_params(), which is only when it cannot fail on values the
+  usual INSERT would take
+*/
+my_bool load_data_possible(STMT *stmt)
+{
+  DBC *dbc= stmt->dbc;
+  DESC *apd= stmt->apd;
+  const char *table, *table_end, *columns, *columns_end;
+  SQLULEN row;
+  uint i;
+
+  if (!dbc->ds->enable_local_infile || !dbc->ds->load_data_rows ||
+      apd->array_size < dbc->ds->load_data_rows || !stmt->param_count ||
+      stmt->query.query_type != myqtInsert || IS_BATCH(&stmt->query) ||
+      /* Multi-byte characters must not contain the bytes we escape */
+      dbc->cxn_charset_info->mbminlen != 1 ||
+      dbc->cxn_charset_info->escape_with_backslash_is_dangerous ||
+      !parse_plain_insert(stmt, &table, &table_end, &columns, &columns_end))
+  {
+    return FALSE;
+  }
+
+  for (i= 0; i < stmt->param_count; ++i)
+  {
+    DESCREC *aprec= desc_get_rec(apd, i, FALSE);
+    DESCREC *iprec= desc_get_rec(stmt->ipd, i, FALSE);
+
+    if (!aprec || !iprec || !aprec->par.real_param_done || !aprec->data_ptr ||
+        !load_data_type_ok(dbc, aprec, iprec))
+    {
+      return FALSE;
+    }
+  }
+
+  /* DEFAULT and data at execution cannot be in the file */
+  for (row= 0; row < apd->array_size; ++row)
+  {
+    SQLUSMALLINT *operation= (SQLUSMALLINT *)
+      ptr_offset_adjust(apd->array_status_ptr, NULL, 0, sizeof(SQLUSMALLINT),
+                        row);
+
+    if (operation && *operation == SQL_PARAM_IGNORE)
+      continue;
+
+    for (i= 0; i < stmt->param_count; ++i)
+    {
+      DESCREC *aprec= desc_get_rec(apd, i, FALSE);
+      SQLLEN *octet_length_ptr= (SQLLEN *)
+        ptr_offset_adjust(aprec->octet_length_ptr, apd->bind_offset_ptr,
+                          apd->bind_type, sizeof(SQLLEN), row);
+      SQLLEN *indicator_ptr= (SQLLEN *)
+        ptr_offset_adjust(aprec->indicator_ptr, apd->bind_offset_ptr,
+                          apd->bind_type, sizeof(SQLLEN), row);
+
+      if (indicator_ptr && *indicator_ptr == SQL_NULL_DATA)
+        continue;
+
+      if (octet_length_ptr && (*octet_length_ptr == SQL_COLUMN_IGNORE ||
+                               IS_DATA_AT_EXEC(octet_length_ptr)))
+        return FALSE;
+
+      /* insert_param() refuses those, without telling which row */
+      if (aprec->concise_type == SQL_C_TIME ||
+          aprec->concise_type == SQL_C_TYPE_TIME)
+      {
+        TIME_STRUCT *time= (TIME_STRUCT *)
+          ptr_offset_adjust(aprec->data_ptr, apd->bind_offset_ptr,
+                            apd->bind_type, sizeof(TIME_STRUCT), row);
+        if (time->hour > 23)
+          return FALSE;
+      }
+    }
+  }
+
+  /*
+    STRICT_TRANS_TABLES or STRICT_ALL_TABLES, also part of TRADITIONAL. The
+    value is left as it is if the mode cannot be read, which is taken as
+    strict.
+  */
+  {
+    char sql_mode[2048]= "STRICT_";
+
+    get_session_variable(stmt, "SQL_MODE", sql_mode, sizeof(sql_mode));
+    if (strstr(sql_mode, "STRICT_"))
+    {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+
+/*
+  Makes the next parameter value the current one. Returns 1 if there is
+  one, 0 at the end of the array and -1 if the conversion failed.
+*/
+static int load_data_next_value(LOAD_DATA *ld)
+{
+  STMT *stmt= ld->stmt;
+  DESC *apd= stmt->apd;
+  DESCREC *aprec, *iprec;
+  SQLLEN *octet_length_ptr, *indicator_ptr;
+  SQLULEN row;
+  char *data;
+  long length;
+
+  x_free(ld->allocated);
+  ld->allocated= NULL;
+
+  /* Rows the application asked to ignore */
+  while (ld->param == 0 && ld->row < apd->array_size)
+  {
+    SQLUSMALLINT *operation= (SQLUSMALLINT *)
+      ptr_offset_adjust(apd->array_status_ptr, NULL, 0, sizeof(SQLUSMALLINT),
+                        ld->row);
+
+    if (!operation || *operation != SQL_PARAM_IGNORE)
+      break;
+    ++ld->row;
+  }
+
+  if (ld->row == apd->array_size)
+    return 0;
+
+  row= ld->row;
+  aprec= desc_get_rec(apd, ld->param, FALSE);
+  iprec= desc_get_rec(stmt->ipd, ld->param, FALSE);
+
+  if (++ld->param < stmt->param_count)
+  {
+    ld->separator= '\t';
+  }
+  else
+  {
+    ld->separator= '\n';
+    ld->param= 0;
+    ++ld->row;
+  }
+  ld->escape= TRUE;
+
+  indicator_ptr= (SQLLEN *)ptr_offset_adjust(aprec->indicator_ptr,
+                                             apd->bind_offset_ptr,
+                                             apd->bind_type, sizeof(SQLLEN),
+                                             row);
+  octet_length_ptr= (SQLLEN *)ptr_offset_adjust(aprec->octet_length_ptr,
+                                                apd->bind_offset_ptr,
+                                                apd->bind_type,
+                                                sizeof(SQLLEN), row);
+  data= (char *)ptr_offset_adjust(aprec->data_ptr, apd->bind_offset_ptr,
+                                  apd->bind_type,
+                                  bind_length(aprec->concise_type,
+                                              aprec->octet_length), row);
+
+  if (indicator_ptr && *indicator_ptr == SQL_NULL_DATA)
+  {
+    ld->pos= "\\N";
+    ld->end= ld->pos + 2;
+    ld->escape= FALSE;
+    return 1;
+  }
+
+  /* The same as in insert_param(), only characters have a length */
+  if (aprec->concise_type != SQL_C_CHAR && aprec->concise_type != SQL_C_WCHAR)
+  {
+    length= 0;
+  }
+  else if (!octet_length_ptr || *octet_length_ptr == SQL_NTS)
+  {
+    if (aprec->concise_type == SQL_C_WCHAR)
+      length= (long)(sqlwcharlen((SQLWCHAR *)data) * sizeof(SQLWCHAR));
+    else
+      length= (long)strlen(data);
+
+    if (!octet_length_ptr && aprec->octet_length > 0 &&
+        aprec->octet_length != SQL_SETPARAM_VALUE_MAX)
+      length= myodbc_min(length, aprec->octet_length);
+  }
+  else
+  {
+    length= (long)*octet_length_ptr;
+  }
+
+  if (aprec->concise_type != SQL_C_CHAR)
+  {
+    if (!SQL_SUCCEEDED(convert_c_type2str(stmt, aprec->concise_type, iprec,
+                                          &data, &length, ld->buff,
+                                          sizeof(ld->buff))))
+    {
+      return -1;
+    }
+
+    if (data == NULL)
+    {
+      set_error(stmt, MYERR_S1001, NULL, 4001);
+      return -1;
+    }
+
+    if (!(data >= ld->buff && data < ld->buff + sizeof(ld->buff)))
+      ld->allocated= data;
+  }
+
+  ld->pos= data;
+  ld->end= data + length;
+
+  return 1;
+}
+
+
+static int load_data_init(void **ptr, const char *filename, void *userdata)
+{
+  *ptr= userdata;
+  return 0;
+}
+
+
+/*
+  Fills buf with the rows of the parameter array, escaping the values
+  straight from the application's buffers.
+
+  The server keeps the rows it got before a conversion fails. The values
+  of the failing row are left out if they are still in buf, and the
+  failure is returned by the next call.
+*/
+static int load_data_read(void *ptr, char *buf, unsigned int buf_len)
+{
+  LOAD_DATA *ld= (LOAD_DATA *)ptr;
+  char *to= buf, *end= buf + buf_len, *row_start= NULL;
+
+  if (ld->failed)
+    return -1;
+
+  while (to < end)
+  {
+    if (!ld->separator)
+    {
+      int rc;
+
+      if (ld->param == 0)
+        row_start= to;
+
+      rc= load_data_next_value(ld);
+
+      if (rc < 0)
+      {
+        ld->failed= TRUE;
+        ld->failed_row= ld->param ? ld->row : ld->row - 1;
+        ld->error= ld->stmt->error;
+
+        if (!row_start)
+          return -1;
+        to= row_start;
+        break;
+      }
+      if (rc == 0)
+        break;
+    }
+
+    while (ld->pos < ld->end && to < end)
+    {
+      const char *run= ld->pos;
+      size_t count;
+
+      if (ld->escape)
+      {
+        while (run < ld->end && !load_data_escape[(uchar)*run])
+          ++run;
+      }
+      else
+      {
+        run= ld->end;
+      }
+
+      count= myodbc_min((size_t)(run - ld->pos), (size_t)(end - to));
+      memcpy(to, ld->pos, count);
+      to+= count;
+      ld->pos+= count;
+
+      if (ld->pos == run && run < ld->end)
+      {
+        if (end - to < 2)
+          break;
+        *to++= '\\';
+        *to++= load_data_escape[(uchar)*ld->pos++];
+      }
+    }
+
+    if (ld->pos < ld->end || to == end)
+      break;
+
+    *to++= ld->separator;
+    ld->separator= 0;
+  }
+
+  PERF_ADD(ld->stmt, PERF_BYTES_SENT, to - buf);
+
+  return (int)(to - buf);
+}
+
+
+static void load_data_end(void *ptr)
+{
+  LOAD_DATA *ld= (LOAD_DATA *)ptr;
+
+  x_free(ld->allocated);
+  ld->allocated= NULL;
+}
+
+
+static int load_data_error(void *ptr, char *error_msg, unsigned int error_msg_len)
+{
+  LOAD_DATA *ld= (LOAD_DATA *)ptr;
+
+  strmake(error_msg, (char *)ld->error.message, error_msg_len - 1);
+
+  return ld->error.native_error ? ld->error.native_error : CR_UNKNOWN_ERROR;
+}
+
+
+static int load_data_refuse_init(void **ptr, const char *filename,
+                                 void *userdata)
+{
+  *ptr= NULL;
+  return 1;
+}
+
+
+static int load_data_refuse_read(void *ptr, char *buf, unsigned int buf_len)
+{
+  return -1;
+}
+
+
+static void load_data_refuse_end(void *ptr)
+{
+}
+
+
+static int load_data_refuse_error(void *ptr, char *error_msg,
+                                  unsigned int error_msg_len)
+{
+  strmake(error_msg, "LOAD DATA LOCAL INFILE is only used by the driver for "
+          "parameter arrays", error_msg_len - 1);
+
+  return CR_UNKNOWN_ERROR;
+}
+
+
+/*
+  Makes the connection refuse every file the server asks for. The client
+  library's default handler would read any file the server names, and
+  MYSQL_OPT_LOCAL_INFILE stays on for the whole connection.
+*/
+void load_data_refuse(MYSQL *mysql)
+{
+  mysql_set_local_infile_handler(mysql, load_data_refuse_init,
+                                 load_data_refuse_read, load_data_refuse_end,
+                                 load_data_refuse_error, NULL);
+}
+
+
+/*
+  Executes the statement for the whole parameter array with one
+  LOAD DATA LOCAL INFILE, see load_data_possible()
+*/
+SQLRETURN load_data_params(STMT *stmt)
+{
+  DBC *dbc= stmt->dbc;
+  DESC *apd= stmt->apd;
+  NET *net= &stmt->query_buf;
+  const char *table, *table_end, *columns, *columns_end;
+  const char *csname= dbc->cxn_charset_info->csname;
+  char *to= (char *)net->buff;
+  LOAD_DATA ld;
+  MYSQL_STMT *ssps;
+  SQLRETURN rc;
+  SQLUSMALLINT row_status;
+  SQLULEN row;
+
+  parse_plain_insert(stmt, &table, &table_end, &columns, &columns_end);
+
+  to= add_to_buffer(net, to, load_data_head, sizeof(load_data_head) - 1);
+  if (to)
+    to= add_to_buffer(net, to, table, (ulong)(table_end - table));
+  if (to)
+    to= add_to_buffer(net, to, " CHARACTER SET ", 15);
+  if (to)
+    to= add_to_buffer(net, to, csname, (ulong)strlen(csname));
+  if (to && columns)
+  {
+    to= add_to_buffer(net, to, " ", 1);
+    if (to)
+      to= add_to_buffer(net, to, columns, (ulong)(columns_end - columns));
+  }
+  if (!to || !(to= add_to_buffer(net, to, "", 1)))
+  {
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  memset(&ld, 0, sizeof(ld));
+  ld.stmt= stmt;
+
+  if (stmt->ipd->rows_processed_ptr)
+  {
+    *stmt->ipd->rows_processed_ptr= apd->array_size;
+  }
+
+  if (!dbc->ds->dont_use_set_locale)
+  {
+    setlocale(LC_NUMERIC, "C");
+  }
+
+  mysql_set_local_infile_handler(&dbc->mysql, load_data_init, load_data_read,
+                                 load_data_end, load_data_error, &ld);
+
+  /*
+    do_query() would execute the server prepared INSERT. It is kept for the
+    executions that don't go as LOAD DATA.
+  */
+  ssps= stmt->ssps;
+  stmt->ssps= NULL;
+
+  rc= do_query(stmt, (char *)net->buff, to - (char *)net->buff - 1);
+
+  stmt->ssps= ssps;
+
+  load_data_refuse(&dbc->mysql);
+
+  /* Rows skipped as duplicates or stored with adjusted values */
+  if (SQL_SUCCEEDED(rc) && mysql_warning_count(&dbc->mysql) > 0)
+  {
+    rc= set_error(stmt, MYERR_01000, mysql_info(&dbc->mysql), 0);
+  }
+
+  if (!dbc->ds->dont_use_set_locale)
+  {
+    setlocale(LC_NUMERIC, default_locale);
+  }
+
+  /*
+    The error of the conversion rather than the client library's copy. The
+    rows before the failing one are stored, without their warnings.
+  */
+  if (ld.failed)
+  {
+    stmt->error= ld.error;
+    rc= SQL_ERROR;
+
+    if (stmt->ipd->rows_processed_ptr)
+    {
+      *stmt->ipd->rows_processed_ptr= ld.failed_row + 1;
+    }
+  }
+
+  if (!SQL_SUCCEEDED(rc))
+    row_status= ld.failed ? SQL_PARAM_SUCCESS_WITH_INFO : SQL_PARAM_ERROR;
+  else if (rc == SQL_SUCCESS_WITH_INFO)
+    row_status= SQL_PARAM_SUCCESS_WITH_INFO;
+  else
+    row_status= SQL_PARAM_SUCCESS;
+
+  for (row= 0; row < apd->array_size; ++row)
+  {
+    SQLUSMALLINT *operation= (SQLUSMALLINT *)
+      ptr_offset_adjust(apd->array_status_ptr, NULL, 0, sizeof(SQLUSMALLINT),
+                        row);
+    SQLUSMALLINT *status= (SQLUSMALLINT *)
+      ptr_offset_adjust(stmt->ipd->array_status_ptr, NULL, 0,
+                        sizeof(SQLUSMALLINT), row);
+
+    if (!status)
+      break;
+
+    if ((operation && *operation == SQL_PARAM_IGNORE) ||
+        (ld.failed && row > ld.failed_row))
+      *status= SQL_PARAM_UNUSED;
+    else if (ld.failed && row == ld.failed_row)
+      *status= SQL_PARAM_ERROR;
+    else
+      *status= row_status;
+  }
+
+  return rc;
+}
@@ -54,10 +54,13 @@ static char * my_ul_to_a(char * buf, size_t buf_size, unsigned long long a)
 
 
 /* {{{ my_f_to_a() -I- */
-static char * my_f_to_a(char * buf, size_t buf_size, double a)
+/* Formats the value the way the server does in text protocol results.
+   buf_size must be at least MYODBC_FTOA_BUFFER_SIZE */
+static char * my_f_to_a(char * buf, size_t buf_size, double a, my_bool is_float)
 {
-	myodbc_snprintf(buf, buf_size, "%f", a);
-	return buf;
+  assert(buf_size >= MYODBC_FTOA_BUFFER_SIZE);
+  myodbc_ftoa(a, buf, is_float ? MYODBC_FTOA_FLOAT : 0);
+  return buf;
 }
 /* }}} */
 
@@ -255,7 +258,10 @@ int ssps_get_result(STMT *stmt)
   {
     if (!if_forward_cache(stmt))
     {
-      return mysql_stmt_store_result(stmt->ssps);
+      int rc= mysql_stmt_store_result(stmt->ssps);
+
+      perf_count_stored_result(stmt);
+      return rc;
     }
 
   }
@@ -771,7 +777,8 @@ char * ssps_get_string(STMT *stmt, ulong column_number, char *value, ulong *leng
     {
       buffer= ALLOC_IFNULL(buffer, 50);
       my_f_to_a(buffer, 49, ssps_get_double(stmt, column_number, value,
-                                            *length));
+                                            *length),
+                col_rbind->buffer_type == MYSQL_TYPE_FLOAT);
 
       *length= strlen(buffer);
       return buffer;
@@ -42,6 +42,29 @@ BOOL ssps_used(STMT *stmt)
 }
 
 
+/* Connection the text protocol result of the statement belongs to - either
+   the primary connection or the read replica the query has been routed to */
+MYSQL * stmt_connection(STMT *stmt)
+{
+  return stmt->replica != NULL ? &stmt->replica->mysql : &stmt->dbc->mysql;
+}
+
+
+/* Detaches statement from the replica its last query has been routed to */
+void release_replica(STMT *stmt)
+{
+  REPLICA *replica= stmt->replica;
+
+  if (replica != NULL)
+  {
+    myodbc_mutex_lock(&replica->lock);
+    --replica->outstanding;
+    myodbc_mutex_unlock(&replica->lock);
+    stmt->replica= NULL;
+  }
+}
+
+
 /* Errors processing? */
 BOOL returned_result(STMT *stmt)
 {
@@ -61,7 +84,7 @@ BOOL returned_result(STMT *stmt)
   }
   else
   {
-    return mysql_field_count(&stmt->dbc->mysql) > 0 ;
+    return mysql_field_count(stmt_connection(stmt)) > 0 ;
   }
 }
 
@@ -87,6 +110,7 @@ my_bool free_current_result(STMT *stmt)
 
     stmt->result= NULL;
   }
+  stmt->columnar_pending= NULL;
   return res;
 }
 
@@ -98,13 +122,14 @@ static
 MYSQL_RES * stmt_get_result(STMT *stmt, BOOL force_use)
 {
   /* We can't use USE_RESULT because SQLRowCount will fail in this case! */
-  if (if_forward_cache(stmt) || force_use)
+  /* Replica may be shared by several statements, its result is always stored */
+  if ((if_forward_cache(stmt) || force_use) && stmt->replica == NULL)
   {
     return mysql_use_result(&stmt->dbc->mysql);
   }
   else
   {
-    return mysql_store_result(&stmt->dbc->mysql);
+    return mysql_store_result(stmt_connection(stmt));
   }
 }
 
@@ -124,6 +149,7 @@ MYSQL_RES * get_result_metadata(STMT *stmt, BOOL force_use)
   else
   {
     stmt->result= stmt_get_result(stmt, force_use);
+    perf_count_stored_result(stmt);
   }
 
   return stmt->result;
@@ -162,7 +188,7 @@ unsigned int field_count(STMT *stmt)
   {
     return stmt->result && stmt->result->field_count > 0 ?
       stmt->result->field_count :
-      mysql_field_count(&stmt->dbc->mysql);
+      mysql_field_count(stmt_connection(stmt));
   }
 }
 
@@ -176,7 +202,7 @@ my_ulonglong affected_rows(STMT *stmt)
   else
   {
     /* In some cases in c/odbc it cannot be used instead of mysql_num_rows */
-    return mysql_affected_rows(&stmt->dbc->mysql);
+    return mysql_affected_rows(stmt_connection(stmt));
   }
 }
 
@@ -208,6 +234,43 @@ my_ulonglong num_rows(STMT *stmt)
 }
 
 
+/* Add the length of the current row to the connection payload counter */
+static void count_row_payload(STMT *stmt)
+{
+  unsigned long *lengths;
+  unsigned int i, count;
+  my_ulonglong bytes= 0;
+
+  /* Results made up by the driver did not come from the server */
+  if (stmt->fake_result || (lengths= fetch_lengths(stmt)) == NULL)
+  {
+    return;
+  }
+
+  count= field_count(stmt);
+
+  for (i= 0; i < count; ++i)
+  {
+    bytes+= lengths[i];
+  }
+
+  PERF_ADD(stmt, PERF_ROWS_FETCHED, 1);
+  PERF_ADD(stmt, PERF_BYTES_RECEIVED, bytes);
+
+  if (stmt->digest)
+  {
+    ++stmt->digest_rows;
+    stmt->digest_bytes+= bytes;
+  }
+
+  if (stmt->query_log_entry)
+  {
+    ++stmt->query_log_entry->rows_fetched;
+    stmt->query_log_entry->bytes_received+= bytes;
+  }
+}
+
+
 MYSQL_ROW fetch_row(STMT *stmt)
 {
   if (ssps_used(stmt))
@@ -226,11 +289,19 @@ MYSQL_ROW fetch_row(STMT *stmt)
       }
     }
 
+    count_row_payload(stmt);
     return stmt->array;
   }
   else
   {
-    return mysql_fetch_row(stmt->result);
+    MYSQL_ROW row= mysql_fetch_row(stmt->result);
+
+    if (row != NULL)
+    {
+      count_row_payload(stmt);
+    }
+
+    return row;
   }
 }
 
@@ -297,7 +368,7 @@ int next_result(STMT *stmt)
   }
   else
   {
-    return mysql_next_result(&stmt->dbc->mysql);
+    return mysql_next_result(stmt_connection(stmt));
   }
 }
 
@@ -305,27 +376,84 @@ int next_result(STMT *stmt)
 /* --- Data conversion methods --- */
 int get_int(STMT *stmt, ulong column_number, char *value, ulong length)
 {
+  return (int)get_int64(stmt, column_number, value, length);
+}
+
+
+long long get_int64(STMT *stmt, ulong column_number, char *value, ulong length)
+{
+  ulonglong magnitude;
+  my_bool negative;
+
   if (ssps_used(stmt))
   {
-     return (int)ssps_get_int64(stmt, column_number, value, length);
+     return ssps_get_int64(stmt, column_number, value, length);
+  }
+  else if (myodbc_parse_int(value, length, &magnitude, &negative) ==
+           MYODBC_INT_OK)
+  {
+    /* Saturates like strtoll() */
+    if (magnitude > (ulonglong)LLONG_MAX)
+    {
+      return negative ? LLONG_MIN : LLONG_MAX;
+    }
+    return negative ? -(long long)magnitude : (long long)magnitude;
   }
   else
   {
-    return atoi(value);
+    return strtoll(value, NULL, 10);
   }
 }
 
 
-long long get_int64(STMT *stmt, ulong column_number, char *value, ulong length)
+/*
+  Reads an integer for the integer C types as its absolute value and sign,
+  so that the whole range of BIGINT UNSIGNED is kept. Returns FALSE if the
+  value does not fit into 64 bits.
+*/
+my_bool get_int_value(STMT *stmt, ulong column_number, char *value,
+                      ulong length, ulonglong *magnitude, my_bool *negative)
 {
   if (ssps_used(stmt))
   {
-     return ssps_get_int64(stmt, column_number, value, length);
+    long long number= ssps_get_int64(stmt, column_number, value, length);
+
+    *negative= number < 0 && !stmt->result_bind[column_number].is_unsigned;
+    *magnitude= *negative ? 0 - (ulonglong)number : (ulonglong)number;
+    return TRUE;
+  }
+
+  switch (myodbc_parse_int(value, length, magnitude, negative))
+  {
+  case MYODBC_INT_OK:
+    return TRUE;
+  case MYODBC_INT_OVERFLOW:
+    return FALSE;
+  }
+
+  /* Decimals, floating point numbers and strings: what strtoll() makes
+     of them, but without losing the unsigned values */
+  while (isspace((uchar)*value))
+  {
+    ++value;
+  }
+
+  errno= 0;
+  *negative= *value == '-';
+
+  if (*negative)
+  {
+    long long number= strtoll(value, NULL, 10);
+
+    *negative= number < 0;
+    *magnitude= 0 - (ulonglong)number;
   }
   else
   {
-    return strtoll(value, NULL, 10);
+    *magnitude= strtoull(value, NULL, 10);
   }
+
+  return errno != ERANGE;
 }
 
 
@@ -384,10 +512,22 @@ SQLRETURN prepare(STMT *stmt, char * query, SQLINTEGER query_length)
                      stmt->dbc->cxn_charset_info);
   /* Tokenising string, detecting and storing parameters placeholders, removing {}
      So far the only possible error is memory allocation. Thus setting it here.
-     If that changes we will need to make "parse" to set error and return rc */
-  if (parse(&stmt->query))
+     If that changes we will need to make "parse" to set error and return rc.
+     Applications tend to prepare the same few texts over and over, so the
+     results are looked up in the connection's cache first */
+  if (query_cache_get(&stmt->dbc->query_cache, &stmt->query))
   {
-    return set_error(stmt, MYERR_S1001, NULL, 4001);
+    PERF_ADD(stmt, PERF_PREPARE_CACHE_HITS, 1);
+  }
+  else
+  {
+    PERF_ADD(stmt, PERF_PREPARE_CACHE_MISSES, 1);
+
+    if (parse(&stmt->query))
+    {
+      return set_error(stmt, MYERR_S1001, NULL, 4001);
+    }
+    query_cache_put(&stmt->dbc->query_cache, &stmt->query);
   }
 
   ssps_close(stmt);
@@ -397,17 +537,16 @@ SQLRETURN prepare(STMT *stmt, char * query, SQLINTEGER query_length)
   if (!stmt->dbc->ds->no_ssps && PARAM_COUNT(&stmt->query) && !IS_BATCH(&stmt->query)
     && preparable_on_server(&stmt->query, stmt->dbc->mysql.server_version))
   {
-    MYLOG_QUERY(stmt, "Using prepared statement");
     ssps_init(stmt);
 
     /* If the query is in the form of "WHERE CURRENT OF" - we do not need to prepare
        it at the moment */
     if (!get_cursor_name(&stmt->query))
     {
+      PERF_ADD(stmt, PERF_ROUND_TRIPS, 1);
+
       if (mysql_stmt_prepare(stmt->ssps, query, query_length))
       {
-        MYLOG_QUERY(stmt, mysql_error(&stmt->dbc->mysql));
-
         set_stmt_error(stmt,"HY000",mysql_error(&stmt->dbc->mysql),
                        mysql_errno(&stmt->dbc->mysql));
         translate_error(stmt->error.sqlstate,MYERR_S1000,
@@ -571,14 +710,48 @@ BOOL scroller_exists(STMT * stmt)
   return stmt->scroller.offset_pos != NULL;
 }
 
+/*
+  Whether the query to be executed is the prepared text itself (i.e. no
+  parameters have been put in it), so that what is found out about it can be
+  kept in the statement's parsed query and its cache entry.
+*/
+static BOOL is_parsed_text(STMT *stmt, const char *query, const char *query_end)
+{
+  return GET_QUERY(&stmt->query) != NULL
+      && query_end - query == GET_QUERY_LENGTH(&stmt->query)
+      && memcmp(query, GET_QUERY(&stmt->query), query_end - query) == 0;
+}
+
+
 /* Initialization of a scroller */
 void scroller_create(STMT * stmt, char *query, SQLULEN query_len)
 {
   /* MAX32_BUFF_SIZE includes place for terminating null, which we do not need
      and will use for comma */
   const size_t len2add= 7/*" LIMIT "*/ + MAX64_BUFF_SIZE/*offset*/ /*- 1*/ + MAX32_BUFF_SIZE;
-  MY_LIMIT_CLAUSE limit= find_position4limit(stmt->dbc->ansi_charset_info,
-                                            query, query + query_len);
+  MY_LIMIT_CLAUSE limit;
+
+  if (!is_parsed_text(stmt, query, query + query_len))
+  {
+    limit= find_position4limit(stmt->dbc->ansi_charset_info,
+                               query, query + query_len);
+  }
+  else
+  {
+    MY_LIMIT_CLAUSE *cached= &stmt->query.limit;
+
+    if (cached->begin == NULL)
+    {
+      *cached= find_position4limit(stmt->dbc->ansi_charset_info,
+                                   GET_QUERY(&stmt->query),
+                                   GET_QUERY_END(&stmt->query));
+      query_cache_update(&stmt->dbc->query_cache, &stmt->query);
+    }
+
+    limit= *cached;
+    limit.begin= query + (cached->begin - GET_QUERY(&stmt->query));
+    limit.end=   query + (cached->end - GET_QUERY(&stmt->query));
+  }
 
   stmt->scroller.start_offset= limit.offset;
   stmt->scroller.total_rows= myodbc_max(stmt->stmt_options.max_rows, 0);
@@ -681,13 +854,8 @@ SQLRETURN scroller_prefetch(STMT * stmt)
 
 
 
-BOOL scrollable(STMT * stmt, char * query, char * query_end)
+static BOOL check_scrollable(STMT * stmt, char * query, char * query_end)
 {
-  if (!is_select_statement(&stmt->query))
-  {
-    return FALSE;
-  }
-
   /* FOR UPDATE*/
   {
     const char *before_token= query_end;
@@ -717,3 +885,25 @@ BOOL scrollable(STMT * stmt, char * query, char * query_end)
 
   return TRUE;
 }
+
+
+BOOL scrollable(STMT * stmt, char * query, char * query_end)
+{
+  if (!is_select_statement(&stmt->query))
+  {
+    return FALSE;
+  }
+
+  if (!is_parsed_text(stmt, query, query_end))
+  {
+    return check_scrollable(stmt, query, query_end);
+  }
+
+  if (stmt->query.scrollable < 0)
+  {
+    stmt->query.scrollable= check_scrollable(stmt, query, query_end);
+    query_cache_update(&stmt->dbc->query_cache, &stmt->query);
+  }
+
+  return stmt->query.scrollable != 0;
+}
@@ -53,11 +53,14 @@
 #define reset_ptr(x) {if (x) x= 0;}
 #define digit(A) ((int) (A - '0'))
 
-#define MYLOG_QUERY(A,B) {if ((A)->dbc->ds->save_queries) \
-               query_print((A)->dbc->query_log,(char*) B);}
+#define MYLOG_QUERY(A,B) MYLOG_DBC_QUERY((A)->dbc,B)
 
-#define MYLOG_DBC_QUERY(A,B) {if((A)->ds->save_queries) \
-               query_print((A)->query_log,(char*) B);}
+#define MYLOG_DBC_QUERY(A,B) {if((A)->query_log) \
+               query_log_statement((A),(const char*) B);}
+
+/* Performance counters of a connection, and of a statement and its connection */
+#define PERF_DBC_ADD(A,C,N) ((A)->perf[C].fetch_add((N), std::memory_order_relaxed))
+#define PERF_ADD(A,C,N) {(A)->perf[C]+= (N); PERF_DBC_ADD((A)->dbc,C,N);}
 
 /* A few character sets we care about. */
 #define ASCII_CHARSET_NUMBER  11
@@ -72,6 +75,11 @@
 #define SQLTS_NULL_DATE -1
 #define SQLTS_BAD_DATE -2
 
+/* Results of myodbc_parse_int() */
+#define MYODBC_INT_OK       0
+#define MYODBC_INT_OVERFLOW 1  /* does not fit into 64 bits */
+#define MYODBC_INT_INVALID  2  /* not the canonical text of an integer */
+
 /* Sizes of buffer for converion of 4 and 8 bytes integer values*/
 #define MAX32_BUFF_SIZE 11
 #define MAX64_BUFF_SIZE 21
@@ -141,11 +149,13 @@ SQLRETURN SQL_API my_SQLAllocStmt       (SQLHDBC hdbc,SQLHSTMT *phstmt);
 SQLRETURN         do_query              (STMT *stmt,char *query, SQLULEN query_length);
 SQLRETURN         insert_params         (STMT *stmt, SQLULEN row, char **finalquery,
                                         SQLULEN *length);
+SQLRETURN         myodbc_kill_query     (DBC *dbc, REPLICA *replica);
 SQLRETURN odbc_stmt(DBC *dbc, const char *query, SQLULEN query_length,
                     my_bool reqLock);
 void      myodbc_link_fields (STMT *stmt,MYSQL_FIELD *fields,uint field_count);
 void      fix_row_lengths   (STMT *stmt, const long* fix_rules, uint row, uint field_count);
 void      fix_result_types  (STMT *stmt);
+void      fix_row_charsets  (STMT *stmt, DESCREC *irrec, MYSQL_FIELD *field);
 char *    fix_str           (char *to,const char *from,int length);
 char *    dupp_str          (char *from,int length);
 SQLRETURN my_pos_delete (STMT *stmt,STMT *stmtParam,
@@ -155,6 +165,9 @@ SQLRETURN my_pos_update (STMT *stmt,STMT *stmtParam,
 char *    check_if_positioned_cursor_exists (STMT *stmt, STMT **stmtNew);
 SQLRETURN insert_param  (STMT *stmt, uchar *to, DESC *apd,
                         DESCREC *aprec, DESCREC *iprec, SQLULEN row);
+SQLRETURN convert_c_type2str(STMT *stmt, SQLSMALLINT ctype, DESCREC *iprec,
+                             char **res, long *length, char *buff,
+                             uint buff_max);
 char *    add_to_buffer (NET *net,char *to,const char *from,ulong length);
 
 void reset_getdata_position   (STMT *stmt);
@@ -170,7 +183,7 @@ copy_and_convert(char *to, uint32 to_length, CHARSET_INFO *to_cs,
 SQLRETURN
 copy_ansi_result(STMT *stmt,
                  SQLCHAR *result, SQLLEN result_bytes, SQLLEN *used_bytes,
-                 MYSQL_FIELD *field, char *src, unsigned long src_bytes);
+                 DESCREC *irrec, char *src, unsigned long src_bytes);
 SQLRETURN
 copy_binary_result(STMT *stmt,
                    SQLCHAR *result, SQLLEN result_bytes, SQLLEN *used_bytes,
@@ -181,7 +194,7 @@ SQLRETURN copy_binhex_result(STMT *stmt,
 			     ulong src_length);
 SQLRETURN copy_wchar_result(STMT *stmt,
                             SQLWCHAR *rgbValue, SQLINTEGER cbValueMax,
-                            SQLLEN *pcbValue, MYSQL_FIELD *field, char *src,
+                            SQLLEN *pcbValue, DESCREC *irrec, char *src,
                             long src_length);
 
 SQLRETURN set_dbc_error   (DBC *dbc, char *state,const char *message,uint errcode);
@@ -251,6 +264,8 @@ int       default_c_type        (int sql_data_type);
 ulong     bind_length           (int sql_data_type,ulong length);
 my_bool   str_to_date           (SQL_DATE_STRUCT *rgbValue, const char *str,
                                 uint length, int zeroToMin);
+int       myodbc_parse_int      (const char *str, ulong length,
+                                ulonglong *magnitude, my_bool *negative);
 int       str_to_ts             (SQL_TIMESTAMP_STRUCT *ts, const char *str, int len,
                                 int zeroToMin, BOOL dont_use_set_locale);
 my_bool str_to_time_st          (SQL_TIME_STRUCT *ts, const char *str);
@@ -261,6 +276,8 @@ void  myodbc_ov_init            (SQLINTEGER odbc_version);
 void  myodbc_sqlstate2_init     (void);
 void  myodbc_sqlstate3_init     (void);
 int   check_if_server_is_alive  (DBC *dbc);
+int   check_if_mysql_is_alive   (MYSQL *mysql, time_t *last_query_time);
+SQLRETURN get_compression_stats (DBC *dbc);
 
 my_bool   dynstr_append_quoted_name (DYNAMIC_STRING *str, const char *name);
 SQLRETURN set_handle_error          (SQLSMALLINT HandleType, SQLHANDLE handle,
@@ -298,6 +315,7 @@ DESC*     desc_alloc              (STMT *stmt, SQLSMALLINT alloc_type,
                                   desc_ref_type ref_type, desc_desc_type desc_type);
 void      desc_free_paramdata     (DESC *desc);
 void      desc_free               (DESC *desc);
+void      desc_reset              (DESC *desc);
 void      desc_rec_init_apd       (DESCREC *rec);
 void      desc_rec_init_ipd       (DESCREC *rec);
 void      desc_remove_stmt        (DESC *desc, STMT *stmt);
@@ -314,6 +332,8 @@ SQLRETURN stmt_SQLCopyDesc(STMT *stmt, DESC *src, DESC *dest);
 
 void sqlnum_from_str      (const char *numstr, SQL_NUMERIC_STRUCT *sqlnum,
                           int *overflow_ptr);
+void sqlnum_from_int      (ulonglong value, my_bool negative,
+                          SQL_NUMERIC_STRUCT *sqlnum, int *overflow_ptr);
 void sqlnum_to_str        (SQL_NUMERIC_STRUCT *sqlnum, SQLCHAR *numstr,
                           SQLCHAR **numbegin, SQLCHAR reqprec, SQLSCHAR reqscale,
                           int *truncptr);
@@ -324,9 +344,26 @@ void *ptr_offset_adjust   (void *ptr, SQLULEN *bind_offset,
 void free_internal_result_buffers(STMT *stmt);
 
 /* Functions used when debugging */
-void query_print          (FILE *log_file,char *query);
-FILE *init_query_log      (void);
-void end_query_log        (FILE *query_log);
+void query_log_statement  (DBC *dbc, const char *query);
+void query_log_executed   (STMT *stmt, const char *query, SQLULEN length,
+                           long long latency_us, SQLRETURN rc);
+void query_log_result_closed(STMT *stmt);
+void digest_executed      (STMT *stmt, const char *query, SQLULEN length,
+                           long long latency_us, SQLRETURN rc);
+void digest_result_closed (STMT *stmt);
+void perf_count_stored_result(STMT *stmt);
+void perf_counters_dump   (DBC *dbc);
+
+/* Reading results a rowset at a time by columns, columnar.cc */
+SQLRETURN columnar_check  (STMT *stmt);
+long      columnar_next_row(STMT *stmt);
+void      columnar_end    (STMT *stmt, long cur_row, SQLULEN rows);
+long      days_from_civil (long y, unsigned int m, unsigned int d);
+
+/* Parameter arrays of INSERT sent as LOAD DATA LOCAL INFILE, load_data.cc */
+my_bool   load_data_possible(STMT *stmt);
+SQLRETURN load_data_params  (STMT *stmt);
+void      load_data_refuse  (MYSQL *mysql);
 
 LIST *list_delete_forward (LIST *elem);
 
@@ -358,6 +395,9 @@ char *          complete_timestamp  (const char * value, ulong length, char buff
 long double     myodbc_strtold             (const char *nptr, char **endptr);
 char *          extend_buffer       (NET *net, char *to, ulong length);
 char *          add_to_buffer       (NET *net,char *to,const char *from,ulong length);
+ulong           myodbc_escape_param (DBC *dbc, char *to, const char *from,
+                                     ulong length);
+void            myodbc_hex_encode   (char *to, const char *from, ulong length);
 MY_LIMIT_CLAUSE find_position4limit (CHARSET_INFO* cs, char *query,
                                     char * query_end);
 BOOL            myodbc_isspace      (CHARSET_INFO* cs, const char * begin, const char *end);
@@ -377,6 +417,7 @@ int get_session_variable(STMT *stmt, const char *var, char *result,
 /* handle.c*/
 BOOL          allocate_param_bind     (DYNAMIC_ARRAY **param_bind, uint elements);
 int           adjust_param_bind_array (STMT *stmt);
+void          free_stmt_pool          (DBC *dbc);
 /* Actions taken when connection is put to the pool. Used in connection freeing as well */
 int           reset_connection        (DBC *dbc);
 /* Actions taken when connection is taken from the pool */
@@ -399,6 +440,8 @@ void          fill_ird_data_lengths (DESC *ird, ulong *lengths, uint fields);
 
 /* my_stmt.c */
 BOOL              ssps_used           (STMT *stmt);
+MYSQL *           stmt_connection     (STMT *stmt);
+void              release_replica     (STMT *stmt);
 BOOL              returned_result     (STMT *stmt);
 my_bool           free_current_result (STMT *stmt);
 MYSQL_RES *       get_result_metadata (STMT *stmt, BOOL force_use);
@@ -421,6 +464,9 @@ int           get_int     (STMT *stmt, ulong column_number, char *value,
                           ulong length);
 long long     get_int64   (STMT *stmt, ulong column_number, char *value,
                           ulong length);
+my_bool       get_int_value(STMT *stmt, ulong column_number, char *value,
+                          ulong length, ulonglong *magnitude,
+                          my_bool *negative);
 char *        get_string  (STMT *stmt, ulong column_number, char *value,
                           ulong *length, char * buffer);
 long double   get_double  (STMT *stmt, ulong column_number, char *value,
@@ -461,6 +507,8 @@ MYSQL_BIND * get_param_bind       (STMT *stmt, unsigned int param_number, int re
 
 /* connect.c */
 void free_connection_stmts(DBC *dbc);
+void myodbc_close_replicas(DBC *dbc);
+my_bool myodbc_reconnect_replica(DBC *dbc, REPLICA *replica);
 
 #ifdef __WIN__
 #define cmp_database(A,B) myodbc_strcasecmp((const char *)(A),(const char *)(B))
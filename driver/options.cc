@@ -265,6 +265,8 @@ MySQLSetConnectAttr(SQLHDBC hdbc, SQLINTEGER Attribute,
   switch (Attribute)
   {
     case SQL_ATTR_ACCESS_MODE:
+      /* Only used to route statements to the read replicas, if there are any */
+      dbc->access_mode= (SQLUINTEGER)(SQLULEN)ValuePtr;
       break;
 
     case SQL_ATTR_AUTOCOMMIT:
@@ -340,6 +342,8 @@ MySQLSetConnectAttr(SQLHDBC hdbc, SQLINTEGER Attribute,
         myodbc_mutex_lock(&dbc->lock);
         if (is_connected(dbc))
         {
+          PERF_DBC_ADD(dbc, PERF_ROUND_TRIPS, 1);
+
           if (mysql_select_db(&dbc->mysql,(char*) db))
           {
             set_conn_error(dbc,MYERR_S1000,mysql_error(&dbc->mysql),mysql_errno(&dbc->mysql));
@@ -471,7 +475,7 @@ MySQLGetConnectAttr(SQLHDBC hdbc, SQLINTEGER attrib, SQLCHAR **char_attr,
   switch (attrib)
   {
   case SQL_ATTR_ACCESS_MODE:
-    *((SQLUINTEGER *)num_attr)= SQL_MODE_READ_WRITE;
+    *((SQLUINTEGER *)num_attr)= dbc->access_mode;
     break;
 
   case SQL_ATTR_AUTO_IPD:
@@ -534,6 +538,46 @@ MySQLGetConnectAttr(SQLHDBC hdbc, SQLINTEGER attrib, SQLCHAR **char_attr,
     *((SQLUINTEGER *)num_attr)= dbc->mysql.net.max_packet;
     break;
 
+  case SQL_ATTR_MYSQL_COMPRESSION_STATS:
+    if (!is_connected(dbc))
+    {
+      return set_handle_error(SQL_HANDLE_DBC, hdbc, MYERR_S1C00,
+                              "Compression statistics are not available "\
+                              "before connection is established", 0);
+    }
+    if (!SQL_SUCCEEDED(result= get_compression_stats(dbc)))
+    {
+      return result;
+    }
+    *char_attr= (SQLCHAR *)dbc->compression_stats;
+    break;
+
+  case SQL_ATTR_MYSQL_PERF_COUNTERS:
+    {
+      unsigned long long values[PERF_COUNTER_COUNT];
+
+      perf_counters_load(dbc->perf, values);
+      perf_counters_format(dbc->perf_counters, sizeof(dbc->perf_counters),
+                           values);
+      *char_attr= (SQLCHAR *)dbc->perf_counters;
+    }
+    break;
+
+  case SQL_ATTR_MYSQL_STATEMENT_DIGESTS:
+    if (!dbc->digests)
+    {
+      return set_handle_error(SQL_HANDLE_DBC, hdbc, MYERR_S1C00,
+                              "Statement digests are not collected, "\
+                              "set STATEMENT_DIGESTS in the data source", 0);
+    }
+    x_free(dbc->digest_text);
+    if (!(dbc->digest_text= digests_format(dbc->digests)))
+    {
+      return set_handle_error(SQL_HANDLE_DBC, hdbc, MYERR_S1001, NULL, 0);
+    }
+    *char_attr= (SQLCHAR *)dbc->digest_text;
+    break;
+
   case SQL_ATTR_TXN_ISOLATION:
     /*
       If we don't know the isolation level already, we need to ask the
@@ -800,7 +844,7 @@ MySQLSetStmtAttr(SQLHSTMT hstmt, SQLINTEGER Attribute, SQLPOINTER ValuePtr,
 
 SQLRETURN SQL_API
 MySQLGetStmtAttr(SQLHSTMT hstmt, SQLINTEGER Attribute, SQLPOINTER ValuePtr,
-                 SQLINTEGER BufferLength __attribute__((unused)),
+                 SQLINTEGER BufferLength,
                  SQLINTEGER *StringLengthPtr)
 {
     SQLRETURN result= SQL_SUCCESS;
@@ -905,6 +949,24 @@ MySQLGetStmtAttr(SQLHSTMT hstmt, SQLINTEGER Attribute, SQLPOINTER ValuePtr,
             *StringLengthPtr= sizeof(SQLPOINTER);
             break;
 
+        case SQL_ATTR_MYSQL_PERF_COUNTERS:
+            {
+              char buff[PERF_COUNTERS_TEXT_SIZE];
+
+              *StringLengthPtr= (SQLINTEGER)perf_counters_format(buff,
+                                                 sizeof(buff), stmt->perf);
+
+              if (ValuePtr != &vparam && BufferLength > 0)
+              {
+                strmake((char *)ValuePtr, buff, BufferLength - 1);
+              }
+              if (*StringLengthPtr > BufferLength - 1)
+              {
+                result= set_error(stmt, MYERR_01004, NULL, 0);
+              }
+            }
+            break;
+
             /*
               3.x driver doesn't support any statement attributes
               at connection level, but to make sure all 2.x apps
@@ -65,6 +65,7 @@ static const MY_STRING use=        {"USE"      , 3, 3};
 static const MY_STRING create=     {"CREATE"   , 6, 6};
 static const MY_STRING drop=       {"DROP"     , 4, 4};
 static const MY_STRING table=      {"TABLE"    , 5, 5};
+static const MY_STRING temporary=  {"TEMPORARY", 9, 9};
 static const MY_STRING procedure=  {"PROCEDURE", 9, 9};
 static const MY_STRING function=   {"FUNCTION" , 8, 8};
 static const MY_STRING where_=     {"WHERE"    , 5, 5};
@@ -138,6 +139,10 @@ MY_PARSED_QUERY * init_parsed_query(MY_PARSED_QUERY *pq)
     pq->query_end=  NULL;
     pq->last_char=  NULL;
     pq->is_batch=   NULL;
+    pq->braces[0]=  pq->braces[1]= NULL;
+    pq->scrollable= -1;
+    pq->limit.begin= pq->limit.end= NULL;
+    pq->cache_entry= NULL;
 
     pq->query_type= myqtOther;
 
@@ -163,6 +168,10 @@ MY_PARSED_QUERY * reset_parsed_query(MY_PARSED_QUERY *pq, char * query,
 
     pq->last_char= NULL;
     pq->is_batch=  NULL;
+    pq->braces[0]= pq->braces[1]= NULL;
+    pq->scrollable= -1;
+    pq->limit.begin= pq->limit.end= NULL;
+    pq->cache_entry= NULL;
 
     pq->query_type= myqtOther;
 
@@ -199,6 +208,7 @@ void delete_parsed_query(MY_PARSED_QUERY *pq)
 int copy_parsed_query(MY_PARSED_QUERY* src, MY_PARSED_QUERY *target)
 {
   char * dummy= myodbc_strdup(GET_QUERY(src), MYF(0));
+  int i;
 
   if (dummy == NULL)
   {
@@ -220,6 +230,25 @@ int copy_parsed_query(MY_PARSED_QUERY* src, MY_PARSED_QUERY *target)
 
   target->query_type= src->query_type;
 
+  for (i= 0; i < 2; ++i)
+  {
+    if (src->braces[i] != NULL)
+    {
+      target->braces[i]= target->query + (src->braces[i] - src->query);
+    }
+  }
+
+  target->scrollable= src->scrollable;
+  if (src->limit.begin != NULL)
+  {
+    target->limit= src->limit;
+    target->limit.begin= target->query + (src->limit.begin - src->query);
+    target->limit.end=   target->query + (src->limit.end - src->query);
+  }
+
+  target->cache_entry=      src->cache_entry;
+  target->cache_generation= src->cache_generation;
+
   if (myodbc_allocate_dynamic(&target->token, src->token.elements))
   {
     return 1;
@@ -241,11 +270,305 @@ int copy_parsed_query(MY_PARSED_QUERY* src, MY_PARSED_QUERY *target)
 }
 
 
+/* Offset of ptr in the query, or -1 if ptr is NULL */
+#define PQ_OFFSET(pq, ptr) ((ptr) != NULL ? (long)((ptr) - GET_QUERY(pq)) : -1L)
+#define PQ_POINTER(pq, offset) ((offset) >= 0 ? GET_QUERY(pq) + (offset) : NULL)
+
+
+static unsigned long long query_hash(const char *query, size_t length,
+                                     CHARSET_INFO *cs)
+{
+  const unsigned long long mul= 0x9E3779B97F4A7C15ULL;
+  unsigned long long h= (length + 1) * mul ^ (unsigned long long)cs->number;
+  unsigned long long word;
+
+  for (; length >= sizeof(word); length-= sizeof(word), query+= sizeof(word))
+  {
+    memcpy(&word, query, sizeof(word));
+    h= (h ^ word) * mul;
+    h^= h >> 29;
+  }
+
+  word= 0;
+  memcpy(&word, query, length);
+  h= (h ^ word) * mul;
+
+  return h ^ (h >> 32);
+}
+
+
+static void query_cache_free_entry(QUERY_CACHE *cache, QUERY_CACHE_ENTRY *entry)
+{
+  if (entry->query != NULL)
+  {
+    cache->bytes-= entry->length +
+      (entry->token_count + entry->param_count) * sizeof(uint);
+    x_free(entry->query);
+    x_free(entry->offsets);
+    entry->query= NULL;
+    entry->offsets= NULL;
+    ++entry->generation;
+  }
+}
+
+
+/* Must be called with the cache lock held */
+static QUERY_CACHE_ENTRY * query_cache_find(QUERY_CACHE *cache,
+                                            MY_PARSED_QUERY *pq,
+                                            unsigned long long hash)
+{
+  size_t length= GET_QUERY_LENGTH(pq);
+  int i;
+
+  for (i= 0; i < QUERY_CACHE_ENTRIES; ++i)
+  {
+    QUERY_CACHE_ENTRY *entry= &cache->entry[i];
+
+    if (entry->query != NULL && entry->hash == hash
+     && entry->length == length && entry->cs == pq->cs
+     && memcmp(entry->query, GET_QUERY(pq), length) == 0)
+    {
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+
+void query_cache_init(QUERY_CACHE *cache)
+{
+  memset(cache, 0, sizeof(QUERY_CACHE));
+  myodbc_mutex_init(&cache->lock, NULL);
+}
+
+
+void query_cache_clear(QUERY_CACHE *cache)
+{
+  int i;
+
+  myodbc_mutex_lock(&cache->lock);
+
+  for (i= 0; i < QUERY_CACHE_ENTRIES; ++i)
+  {
+    query_cache_free_entry(cache, &cache->entry[i]);
+  }
+
+  myodbc_mutex_unlock(&cache->lock);
+}
+
+
+void query_cache_destroy(QUERY_CACHE *cache)
+{
+  query_cache_clear(cache);
+  myodbc_mutex_destroy(&cache->lock);
+}
+
+
+/**
+  Fills a parsed query, that has been reset with the query text but not
+  parsed yet, from the cache. That includes blanking out the ODBC escape
+  braces the way parse() does.
+
+  @return TRUE if the query was found in the cache.
+*/
+BOOL query_cache_get(QUERY_CACHE *cache, MY_PARSED_QUERY *pq)
+{
+  QUERY_CACHE_ENTRY *entry;
+  unsigned long long hash;
+  BOOL found= FALSE;
+  int i;
+
+  if (GET_QUERY(pq) == NULL || pq->cs == NULL
+   || GET_QUERY_LENGTH(pq) > QUERY_CACHE_MAX_QUERY)
+  {
+    return FALSE;
+  }
+
+  hash= query_hash(GET_QUERY(pq), GET_QUERY_LENGTH(pq), pq->cs);
+
+  myodbc_mutex_lock(&cache->lock);
+
+  if ((entry= query_cache_find(cache, pq, hash)) != NULL
+   && !myodbc_allocate_dynamic(&pq->token, entry->token_count)
+   && !myodbc_allocate_dynamic(&pq->param_pos, entry->param_count))
+  {
+    memcpy(pq->token.buffer, entry->offsets,
+           entry->token_count * sizeof(uint));
+    pq->token.elements= entry->token_count;
+    memcpy(pq->param_pos.buffer, entry->offsets + entry->token_count,
+           entry->param_count * sizeof(uint));
+    pq->param_pos.elements= entry->param_count;
+
+    pq->query_type= entry->query_type;
+    pq->last_char=  PQ_POINTER(pq, entry->last_char);
+    pq->is_batch=   PQ_POINTER(pq, entry->is_batch);
+
+    for (i= 0; i < 2; ++i)
+    {
+      if ((pq->braces[i]= PQ_POINTER(pq, entry->braces[i])) != NULL)
+      {
+        *pq->braces[i]= ' ';
+      }
+    }
+
+    pq->scrollable= entry->scrollable;
+    if (entry->limit_begin >= 0)
+    {
+      pq->limit.begin=     PQ_POINTER(pq, entry->limit_begin);
+      pq->limit.end=       PQ_POINTER(pq, entry->limit_end);
+      pq->limit.offset=    entry->limit_offset;
+      pq->limit.row_count= entry->limit_row_count;
+    }
+
+    pq->cache_entry=      entry;
+    pq->cache_generation= entry->generation;
+    entry->last_used=     ++cache->tick;
+
+    found= TRUE;
+  }
+
+  myodbc_mutex_unlock(&cache->lock);
+
+  return found;
+}
+
+
+/**
+  Stores the results of parse() in the cache, evicting the least recently
+  used entries if needed.
+*/
+void query_cache_put(QUERY_CACHE *cache, MY_PARSED_QUERY *pq)
+{
+  QUERY_CACHE_ENTRY *entry= NULL;
+  size_t length= GET_QUERY_LENGTH(pq),
+         offsets_size= (TOKEN_COUNT(pq) + PARAM_COUNT(pq)) * sizeof(uint);
+  char *query;
+  uint *offsets;
+  int i;
+
+  if (GET_QUERY(pq) == NULL || pq->cs == NULL || length > QUERY_CACHE_MAX_QUERY)
+  {
+    return;
+  }
+
+  query=   (char *)myodbc_malloc(length + 1, MYF(0));
+  offsets= (uint *)myodbc_malloc(offsets_size + 1, MYF(0));
+
+  if (query == NULL || offsets == NULL)
+  {
+    x_free(query);
+    x_free(offsets);
+    return;
+  }
+
+  /* The key is the text as the application sent it */
+  memcpy(query, GET_QUERY(pq), length);
+  query[length]= '\0';
+  if (pq->braces[0] != NULL)
+  {
+    query[pq->braces[0] - GET_QUERY(pq)]= '{';
+  }
+  if (pq->braces[1] != NULL)
+  {
+    query[pq->braces[1] - GET_QUERY(pq)]= '}';
+  }
+
+  memcpy(offsets, pq->token.buffer, TOKEN_COUNT(pq) * sizeof(uint));
+  memcpy(offsets + TOKEN_COUNT(pq), pq->param_pos.buffer,
+         PARAM_COUNT(pq) * sizeof(uint));
+
+  myodbc_mutex_lock(&cache->lock);
+
+  /* Another statement may have got there first */
+  if (query_cache_find(cache, pq, query_hash(query, length, pq->cs)) != NULL)
+  {
+    myodbc_mutex_unlock(&cache->lock);
+    x_free(query);
+    x_free(offsets);
+    return;
+  }
+
+  do
+  {
+    entry= NULL;
+    for (i= 0; i < QUERY_CACHE_ENTRIES; ++i)
+    {
+      if (entry == NULL || cache->entry[i].query == NULL
+       || (entry->query != NULL
+        && cache->entry[i].last_used < entry->last_used))
+      {
+        entry= &cache->entry[i];
+      }
+    }
+    query_cache_free_entry(cache, entry);
+  } while (cache->bytes + length + offsets_size > QUERY_CACHE_MAX_BYTES
+        && cache->bytes > 0);
+
+  entry->hash=        query_hash(query, length, pq->cs);
+  entry->cs=          pq->cs;
+  entry->query=       query;
+  entry->length=      length;
+  entry->offsets=     offsets;
+  entry->token_count= TOKEN_COUNT(pq);
+  entry->param_count= PARAM_COUNT(pq);
+  entry->query_type=  pq->query_type;
+  entry->last_char=   PQ_OFFSET(pq, pq->last_char);
+  entry->is_batch=    PQ_OFFSET(pq, pq->is_batch);
+  entry->braces[0]=   PQ_OFFSET(pq, pq->braces[0]);
+  entry->braces[1]=   PQ_OFFSET(pq, pq->braces[1]);
+  entry->scrollable=  -1;
+  entry->limit_begin= entry->limit_end= -1;
+  entry->last_used=   ++cache->tick;
+
+  cache->bytes+= length + offsets_size;
+
+  pq->cache_entry=      entry;
+  pq->cache_generation= entry->generation;
+
+  myodbc_mutex_unlock(&cache->lock);
+}
+
+
+/**
+  Stores the scrollable() and find_position4limit() results that have been
+  worked out for the query since it was parsed.
+*/
+void query_cache_update(QUERY_CACHE *cache, MY_PARSED_QUERY *pq)
+{
+  QUERY_CACHE_ENTRY *entry= pq->cache_entry;
+
+  if (entry == NULL)
+  {
+    return;
+  }
+
+  myodbc_mutex_lock(&cache->lock);
+
+  /* Nothing to do if the entry has been evicted in the meantime */
+  if (entry->generation == pq->cache_generation && entry->query != NULL)
+  {
+    entry->scrollable= pq->scrollable;
+    if (pq->limit.begin != NULL)
+    {
+      entry->limit_begin=     PQ_OFFSET(pq, pq->limit.begin);
+      entry->limit_end=       PQ_OFFSET(pq, pq->limit.end);
+      entry->limit_offset=    pq->limit.offset;
+      entry->limit_row_count= pq->limit.row_count;
+    }
+  }
+
+  myodbc_mutex_unlock(&cache->lock);
+}
+
+
 MY_PARSER * init_parser(MY_PARSER * parser, MY_PARSED_QUERY *pq)
 {
   parser->query=  pq;
   parser->pos=    GET_QUERY(pq);
   parser->quote=  NULL;
+  /* In ucs2/utf16/utf32 ASCII bytes can be parts of other characters */
+  parser->fast_scan= pq->cs != NULL && pq->cs->mbminlen == 1;
 
   get_ctype(parser);
 
@@ -542,6 +865,105 @@ BOOL stmt_returns_result(const MY_PARSED_QUERY *query)
 }
 
 
+/*
+  Bytes of ansi_syntax_markers that start something tokenize() has to
+  handle outside of quotes and comments: spaces, quotes, comments, query
+  separators and parameter markers.
+*/
+static const char main_stop_bytes[]= {'\'', '"', '`', '#', '-', '/', ';',
+                                      '\\', '?'};
+
+/*
+  Returns the first position in [pos, end) holding one of the stop bytes,
+  a byte with the high bit set if stop_high is set, or a space or control
+  character if stop_space is set. Stopping too early is harmless - the
+  character by character parsing takes it from there - so the checks only
+  need to be conservative.
+*/
+static const char * find_stop_byte(const char *pos, const char *end,
+                                   const char *stop, int stop_count,
+                                   BOOL stop_high, BOOL stop_space)
+{
+  int i;
+
+#ifdef MYODBC_SSE2
+  {
+    /* As signed bytes, the high bit ones are negative, i.e. below any ASCII byte */
+    const __m128i below= _mm_set1_epi8(stop_space ? '!' :
+                                       stop_high ? 0 : -128);
+
+    while (end - pos >= 16)
+    {
+      __m128i chunk= _mm_loadu_si128((const __m128i *)pos);
+      __m128i hit= _mm_cmplt_epi8(chunk, below);
+      unsigned int mask;
+
+      for (i= 0; i < stop_count; ++i)
+      {
+        hit= _mm_or_si128(hit, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(stop[i])));
+      }
+
+      if ((mask= (unsigned int)_mm_movemask_epi8(hit)) != 0)
+      {
+        return pos + myodbc_first_bit(mask);
+      }
+
+      pos+= 16;
+    }
+  }
+#endif
+
+  for (; pos < end; ++pos)
+  {
+    unsigned char c= (unsigned char)*pos;
+
+    if ((stop_high && c >= 0x80) || (stop_space && (c <= ' ' || c >= 0x80)))
+    {
+      return pos;
+    }
+
+    for (i= 0; i < stop_count; ++i)
+    {
+      if (*pos == stop[i])
+      {
+        return pos;
+      }
+    }
+  }
+
+  return end;
+}
+
+
+/*
+  Moves the parser over the bytes find_stop_byte() says are not special.
+  Returns the last byte skipped, or NULL if nothing was skipped.
+*/
+static char * skip_to_stop_byte(MY_PARSER *parser, const char *stop,
+                                 int stop_count, BOOL stop_space)
+{
+  char *start= parser->pos;
+
+  if (!parser->fast_scan || !END_NOT_REACHED(parser))
+  {
+    return NULL;
+  }
+
+  parser->pos= (char *)find_stop_byte(parser->pos, parser->query->query_end,
+                                      stop, stop_count,
+                                      parser->query->cs->mbmaxlen > 1,
+                                      stop_space);
+  if (parser->pos == start)
+  {
+    return NULL;
+  }
+
+  get_ctype(parser);
+
+  return parser->pos - 1;
+}
+
+
 /* TRUE if end has been reached */
 BOOL skip_spaces(MY_PARSER *parser)
 {
@@ -556,6 +978,15 @@ BOOL skip_spaces(MY_PARSER *parser)
 
 BOOL skip_comment(MY_PARSER *parser)
 {
+  const char *comment_end= parser->c_style_comment ?
+                            parser->syntax->c_style_close_comment.str :
+                            parser->syntax->new_line_end.str;
+
+  if (parser->hash_comment || parser->dash_comment || parser->c_style_comment)
+  {
+    skip_to_stop_byte(parser, comment_end, 1, FALSE);
+  }
+
   while(END_NOT_REACHED(parser) && 
         ((parser->hash_comment && 
             !compare(parser, &parser->syntax->new_line_end)) ||  
@@ -565,6 +996,7 @@ BOOL skip_comment(MY_PARSER *parser)
             !compare(parser, &parser->syntax->c_style_close_comment))))
   {
     step_char(parser);
+    skip_to_stop_byte(parser, comment_end, 1, FALSE);
   }
 
   return !END_NOT_REACHED(parser);
@@ -655,6 +1087,15 @@ char * find_closing_quote(MY_PARSER *parser)
   char *closing_quote= NULL;
   while(END_NOT_REACHED(parser))
   {
+    const char stop[]= {parser->quote->str[0], parser->syntax->escape->str[0]};
+
+    skip_to_stop_byte(parser, stop, 2, FALSE);
+
+    if (!END_NOT_REACHED(parser))
+    {
+      break;
+    }
+
     if (is_escape(parser))
     {
       step_char(parser);
@@ -699,8 +1140,9 @@ my_bool add_parameter(MY_PARSER *parser)
 
 void step_char(MY_PARSER *parser)
 {
-  /* We must step forward at least one byte */
-  parser->pos+= parser->bytes_at_pos ? parser->bytes_at_pos : 1;
+  /* We must step forward at least one byte, ctype() gives a negative
+     length for an incomplete character at the end */
+  parser->pos+= parser->bytes_at_pos > 0 ? parser->bytes_at_pos : 1;
 
   if (END_NOT_REACHED(parser))
   {
@@ -767,6 +1209,15 @@ BOOL tokenize(MY_PARSER *parser)
     }
     else
     {
+      /* Ordinary characters only become the last char */
+      char *last_skipped= skip_to_stop_byte(parser, main_stop_bytes,
+                                            sizeof(main_stop_bytes), TRUE);
+      if (last_skipped != NULL)
+      {
+        parser->query->last_char= last_skipped;
+        continue;
+      }
+
       if (IS_SPACE(parser))
       {
         step_char(parser);
@@ -946,6 +1397,9 @@ BOOL remove_braces(MY_PARSER *parser)
       token[0]= ' ';
       *parser->query->last_char= ' ';
 
+      parser->query->braces[0]= token;
+      parser->query->braces[1]= parser->query->last_char;
+
       parser->pos= token;
 
       get_ctype(parser);
@@ -978,3 +1432,470 @@ BOOL remove_braces(MY_PARSER *parser)
 
   return FALSE;
 }
+
+
+/*
+  Statement digests: the query text with comments dropped, literals turned
+  into '?' and the tokens separated by single spaces, so that executions of
+  the same statement with different values give the same text. Quotes,
+  escapes and comments are found with the tokenizer's functions above.
+*/
+
+#define DIGEST_MAX_DEPTH 16
+
+enum digest_token
+{
+  DIGEST_NONE, DIGEST_WORD, DIGEST_VALUE, DIGEST_PUNCT, DIGEST_OPEN,
+  DIGEST_CLOSE
+};
+
+typedef struct digest_writer
+{
+  char        *buff, *pos, *end;
+  int         last;                     /* digest_token last written */
+  const char  *word;                    /* last DIGEST_WORD in the query */
+  size_t      word_length;
+  char        *group[DIGEST_MAX_DEPTH]; /* '(' of the open parentheses */
+  my_bool     list[DIGEST_MAX_DEPTH];   /* of values, not of arguments */
+  my_bool     values_only[DIGEST_MAX_DEPTH];
+  int         depth;
+  my_bool     truncated;
+} DIGEST_WRITER;
+
+
+static my_bool digest_last_word(DIGEST_WRITER *w, const char *word)
+{
+  size_t length= strlen(word);
+
+  return w->last == DIGEST_WORD && w->word_length == length &&
+         !myodbc_casecmp(w->word, word, (uint)length);
+}
+
+
+/*
+  Only the parentheses after IN and VALUES, the rows following a collapsed
+  one and the groups inside a list are lists. Those of function calls,
+  e.g. f(-2), are kept.
+*/
+static my_bool digest_list_starts(DIGEST_WRITER *w)
+{
+  return digest_last_word(w, "IN") || digest_last_word(w, "VALUES") ||
+         digest_last_word(w, "VALUE") ||
+         (w->pos - w->buff >= 7 && !memcmp(w->pos - 7, "(...), ", 7)) ||
+         (w->last == DIGEST_OPEN && w->depth > 0 &&
+          w->depth <= DIGEST_MAX_DEPTH && w->list[w->depth - 1]);
+}
+
+
+static void digest_write(DIGEST_WRITER *w, int token, const char *str,
+                         size_t length)
+{
+  my_bool space= w->pos > w->buff && w->last != DIGEST_OPEN &&
+                 w->pos[-1] != '.' && token != DIGEST_CLOSE &&
+                 *str != ',' && *str != '.' && *str != ';';
+
+  if (w->truncated)
+  {
+    return;
+  }
+
+  if (w->pos + length + space > w->end)
+  {
+    w->truncated= TRUE;
+    return;
+  }
+
+  /* A group with anything but values and commas in it is not a list */
+  if (w->depth > 0 && w->depth <= DIGEST_MAX_DEPTH &&
+      token != DIGEST_VALUE && token != DIGEST_CLOSE && *str != ',')
+  {
+    w->values_only[w->depth - 1]= FALSE;
+  }
+
+  if (space)
+  {
+    *w->pos++= ' ';
+  }
+
+  if (token == DIGEST_OPEN)
+  {
+    if (w->depth < DIGEST_MAX_DEPTH)
+    {
+      w->group[w->depth]= w->pos;
+      w->list[w->depth]= digest_list_starts(w);
+      /* Empty parentheses are not a list */
+      w->values_only[w->depth]= FALSE;
+    }
+    ++w->depth;
+  }
+  else if (token == DIGEST_VALUE && w->depth > 0 &&
+           w->depth <= DIGEST_MAX_DEPTH && w->pos[-1] == '(')
+  {
+    w->values_only[w->depth - 1]= w->list[w->depth - 1];
+  }
+
+  memcpy(w->pos, str, length);
+  w->pos+= length;
+  w->last= token;
+
+  if (token == DIGEST_WORD)
+  {
+    w->word= str;
+    w->word_length= length;
+  }
+
+  if (token == DIGEST_CLOSE && w->depth > 0 && w->depth-- <= DIGEST_MAX_DEPTH &&
+      w->values_only[w->depth])
+  {
+    char *group= w->group[w->depth];
+
+    /* "(...)" is longer than the "(?)" it may replace */
+    if (group + 5 > w->end)
+    {
+      w->pos= group;
+      w->truncated= TRUE;
+      return;
+    }
+
+    /* IN (1, 2, 3) -> IN (...), and rows of VALUES collapse to one */
+    w->pos= myodbc_stpmov(group, "(...)");
+
+    if (group - w->buff >= 7 && !memcmp(group - 7, "(...), ", 7))
+    {
+      w->pos= group - 2;
+    }
+    w->last= DIGEST_VALUE;
+  }
+}
+
+
+#define DIGEST_IDENT(c) (isalnum(c) || (c) == '_' || (c) == '$' || \
+                         (c) == '@' || (c) >= 0x80)
+
+static void digest_skip_ident(MY_PARSER *parser)
+{
+  while (END_NOT_REACHED(parser) && DIGEST_IDENT((uchar)*parser->pos))
+  {
+    step_char(parser);
+  }
+}
+
+
+/* Leaves the parser after the closing quote, at the end if there is none */
+static void digest_skip_quoted(MY_PARSER *parser)
+{
+  open_quote(parser, is_quote(parser));
+  step_char(parser);
+  find_closing_quote(parser);
+  CLOSE_QUOTE(parser);
+}
+
+
+/**
+  Computes the digest text of a query. Lists of values in parentheses, like
+  those after IN, are replaced by "(...)", and so are the rows of an
+  INSERT ... VALUES. A digest that does not fit into the buffer is cut at
+  a token boundary and ends with "...".
+
+  @param[in]  query  The query
+  @param[in]  end    End of the query
+  @param[in]  cs     Character set of the query
+  @param[out] buff   Buffer for the digest text
+  @param[in]  size   Size of the buffer, at least 4
+
+  @return Length of the digest text, which is NUL-terminated
+*/
+size_t query_digest(const char *query, const char *end, CHARSET_INFO *cs,
+                    char *buff, size_t size)
+{
+  static const char *operators[]= {"<=>", "->>", "<=", ">=", "<>", "!=", ":=",
+                                   "||", "&&", "<<", ">>", "->"};
+  MY_PARSED_QUERY pq;
+  MY_PARSER parser;
+  DIGEST_WRITER w;
+  my_bool version_comment= FALSE;
+
+  memset(&w, 0, sizeof(w));
+  w.buff= w.pos= buff;
+  /* Room for "..." and the terminating NUL */
+  w.end= buff + size - 4;
+
+  /* Only the text and the charset are needed to run the parser */
+  pq= MY_PARSED_QUERY();
+  pq.query= (char *)query;
+  pq.query_end= (char *)end;
+  pq.cs= cs;
+  init_parser(&parser, &pq);
+
+  while (END_NOT_REACHED(&parser) && !w.truncated)
+  {
+    const char *pos= parser.pos, *next;
+    uchar c= (uchar)*pos;
+
+    /* Not every charset marks the control characters as spaces */
+    if (c <= ' ' || IS_SPACE(&parser))
+    {
+      step_char(&parser);
+    }
+    else if (is_quote(&parser))
+    {
+      digest_skip_quoted(&parser);
+
+      if (c == '`')
+      {
+        digest_write(&w, DIGEST_WORD, pos, parser.pos - pos);
+      }
+      else
+      {
+        digest_write(&w, DIGEST_VALUE, "?", 1);
+      }
+    }
+    else if (is_comment(&parser))
+    {
+      skip_comment(&parser);
+
+      /* skip_comment() stops at the end of a C style comment */
+      if (parser.c_style_comment && END_NOT_REACHED(&parser))
+      {
+        parser.pos+= parser.syntax->c_style_close_comment.bytes;
+        get_ctype(&parser);
+      }
+    }
+    else if (compare(&parser, &parser.syntax->c_var_open_comment))
+    {
+      /* The text of a versioned comment is part of the query */
+      parser.pos+= parser.syntax->c_var_open_comment.bytes;
+      while (parser.pos < end && isdigit((uchar)*parser.pos))
+      {
+        ++parser.pos;
+      }
+      get_ctype(&parser);
+      version_comment= TRUE;
+    }
+    else if (version_comment &&
+             compare(&parser, &parser.syntax->c_style_close_comment))
+    {
+      parser.pos+= parser.syntax->c_style_close_comment.bytes;
+      get_ctype(&parser);
+      version_comment= FALSE;
+    }
+    else if (is_param_marker(&parser))
+    {
+      step_char(&parser);
+      digest_write(&w, DIGEST_VALUE, "?", 1);
+    }
+    else if (isdigit(c) || (c == '.' && end - pos >= 2 && isdigit(pos[1])) ||
+             ((c == '-' || c == '+') && end - pos >= 2 &&
+              (isdigit(pos[1]) || pos[1] == '.') &&
+              w.last != DIGEST_WORD && w.last != DIGEST_VALUE &&
+              w.last != DIGEST_CLOSE))
+    {
+      /* Numbers, signed where a sign can't be an operator */
+      next= pos + (c == '-' || c == '+');
+
+      if (next[0] == '0' && end - next >= 3 &&
+          (next[1] == 'x' || next[1] == 'X') && isxdigit((uchar)next[2]))
+      {
+        for (next+= 2; next < end && isxdigit((uchar)*next); ++next)
+          ;
+      }
+      else if (next[0] == '0' && end - next >= 3 &&
+               (next[1] == 'b' || next[1] == 'B') &&
+               (next[2] == '0' || next[2] == '1'))
+      {
+        for (next+= 2; next < end && (*next == '0' || *next == '1'); ++next)
+          ;
+      }
+      else
+      {
+        while (next < end && (isdigit((uchar)*next) || *next == '.'))
+        {
+          ++next;
+        }
+
+        if (end - next >= 2 && (*next == 'e' || *next == 'E') &&
+            (isdigit((uchar)next[1]) ||
+             (end - next >= 3 && (next[1] == '-' || next[1] == '+') &&
+              isdigit((uchar)next[2]))))
+        {
+          for (next+= 2; next < end && isdigit((uchar)*next); ++next)
+            ;
+        }
+      }
+
+      /* Digits and signs are single bytes in every client charset */
+      parser.pos= (char *)next;
+      get_ctype(&parser);
+
+      /* Identifiers may start with digits, e.g. 1col */
+      if (END_NOT_REACHED(&parser) && DIGEST_IDENT((uchar)*parser.pos))
+      {
+        digest_skip_ident(&parser);
+        digest_write(&w, DIGEST_WORD, pos, parser.pos - pos);
+      }
+      else
+      {
+        digest_write(&w, DIGEST_VALUE, "?", 1);
+      }
+    }
+    else if (DIGEST_IDENT(c))
+    {
+      digest_skip_ident(&parser);
+
+      /* X'..', B'..', N'..' and _charset'..' literals */
+      if (END_NOT_REACHED(&parser) && *parser.pos == '\'' &&
+          (c == '_' || (parser.pos - pos == 1 && strchr("xXbBnN", c))))
+      {
+        digest_skip_quoted(&parser);
+        digest_write(&w, DIGEST_VALUE, "?", 1);
+      }
+      else
+      {
+        digest_write(&w, DIGEST_WORD, pos, parser.pos - pos);
+      }
+    }
+    else if (c == '(' || c == ')')
+    {
+      step_char(&parser);
+      digest_write(&w, c == '(' ? DIGEST_OPEN : DIGEST_CLOSE, pos, 1);
+    }
+    else
+    {
+      size_t i, length= 0;
+
+      for (i= 0; i < sizeof(operators) / sizeof(operators[0]); ++i)
+      {
+        size_t op_length= strlen(operators[i]);
+
+        if ((size_t)(end - pos) >= op_length &&
+            !memcmp(pos, operators[i], op_length))
+        {
+          length= op_length;
+          break;
+        }
+      }
+
+      if (length)
+      {
+        parser.pos+= length;
+        get_ctype(&parser);
+      }
+      else
+      {
+        step_char(&parser);
+        length= parser.pos - pos;
+      }
+
+      digest_write(&w, DIGEST_PUNCT, pos, length);
+    }
+  }
+
+  if (w.truncated)
+  {
+    w.pos= myodbc_stpmov(w.pos, "...");
+  }
+  *w.pos= '\0';
+
+  return w.pos - buff;
+}
+
+
+/* Functions whose result belongs to the session, or that take locks */
+static const char *session_functions[]=
+{
+  "LAST_INSERT_ID", "FOUND_ROWS", "ROW_COUNT", "CONNECTION_ID", "GET_LOCK",
+  "RELEASE_LOCK", "RELEASE_ALL_LOCKS", "IS_FREE_LOCK", "IS_USED_LOCK"
+};
+
+#define WORD_IS(pos, length, word) ((length) == sizeof(word) - 1 && \
+                                    !myodbc_casecmp((pos), (word), (length)))
+
+/**
+  Tells if a SELECT has to run in the session of the application rather
+  than on another connection, e.g. a read replica: it locks rows with
+  FOR UPDATE, FOR SHARE or LOCK IN SHARE MODE, reads user or system
+  variables, or calls one of session_functions. Quoted text and comments
+  are not looked at.
+
+  @param[in]  pq  The parsed query
+
+  @return TRUE if the query depends on the session
+*/
+BOOL is_session_select(MY_PARSED_QUERY *pq)
+{
+  MY_PARSER parser;
+  const char *prev= NULL;
+  size_t prev_length= 0, i;
+
+  init_parser(&parser, pq);
+
+  while (END_NOT_REACHED(&parser))
+  {
+    const char *pos= parser.pos;
+    uchar c= (uchar)*pos;
+
+    if (is_quote(&parser))
+    {
+      digest_skip_quoted(&parser);
+      prev= NULL;
+    }
+    else if (is_comment(&parser))
+    {
+      skip_comment(&parser);
+
+      if (parser.c_style_comment && END_NOT_REACHED(&parser))
+      {
+        parser.pos+= parser.syntax->c_style_close_comment.bytes;
+        get_ctype(&parser);
+      }
+    }
+    else if (DIGEST_IDENT(c))
+    {
+      size_t length;
+
+      digest_skip_ident(&parser);
+      length= parser.pos - pos;
+
+      /* @var and @@var */
+      if (c == '@')
+      {
+        return TRUE;
+      }
+
+      for (i= 0; i < sizeof(session_functions) / sizeof(char *); ++i)
+      {
+        if (length == strlen(session_functions[i]) &&
+            !myodbc_casecmp(pos, session_functions[i], length))
+        {
+          return TRUE;
+        }
+      }
+
+      if (prev && ((WORD_IS(prev, prev_length, "FOR") &&
+                    (WORD_IS(pos, length, "UPDATE") ||
+                     WORD_IS(pos, length, "SHARE"))) ||
+                   (WORD_IS(prev, prev_length, "LOCK") &&
+                    WORD_IS(pos, length, "IN"))))
+      {
+        return TRUE;
+      }
+
+      prev= pos;
+      prev_length= length;
+    }
+    else
+    {
+      step_char(&parser);
+    }
+  }
+
+  return FALSE;
+}
+
+
+/* CREATE TEMPORARY TABLE, which the tokens of a parsed query start with */
+BOOL is_create_temporary(MY_PARSED_QUERY *pq)
+{
+  return TOKEN_COUNT(pq) > 1 && case_compare(pq, get_token(pq, 0), &create) &&
+         case_compare(pq, get_token(pq, 1), &temporary);
+}
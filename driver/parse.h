@@ -116,6 +116,16 @@ typedef struct syntax_markers
 
 } MY_SYNTAX_MARKERS;
 
+typedef struct limit
+{
+  unsigned long long  offset;
+  unsigned int        row_count;
+  char                *begin, *end;
+
+} MY_LIMIT_CLAUSE;
+
+struct query_cache_entry;
+
 typedef struct parsed_query
 {
   CHARSET_INFO  *cs;        /* We need it for parsing                  */
@@ -129,9 +139,55 @@ typedef struct parsed_query
   QUERY_TYPE_ENUM query_type;
   const char *  is_batch;   /* Pointer to the begin of a 2nd query in a batch */
 
+  char          *braces[2]; /* '{' and '}' blanked out by remove_braces */
+  int           scrollable; /* scrollable() for the query, -1 if not known */
+  MY_LIMIT_CLAUSE limit;    /* find_position4limit() for the query,
+                               begin is NULL if not known */
+
+  struct query_cache_entry *cache_entry; /* entry the results are cached in */
+  unsigned int  cache_generation;
+
 } MY_PARSED_QUERY;
 
 
+/* Per connection cache of parsing results, keyed by the query text */
+#define QUERY_CACHE_ENTRIES   64
+#define QUERY_CACHE_MAX_QUERY (64 * 1024)       /* longer ones are not cached */
+#define QUERY_CACHE_MAX_BYTES (4 * 1024 * 1024)
+
+typedef struct query_cache_entry
+{
+  unsigned long long  hash;
+  CHARSET_INFO        *cs;
+  char                *query;       /* text before parsing, NULL if unused */
+  size_t              length;
+  uint                *offsets;     /* tokens, then parameter markers */
+  uint                token_count;
+  uint                param_count;
+  QUERY_TYPE_ENUM     query_type;
+  long                last_char;    /* offsets below are -1 for NULL */
+  long                is_batch;
+  long                braces[2];
+  int                 scrollable;
+  long                limit_begin;
+  long                limit_end;
+  unsigned long long  limit_offset;
+  unsigned int        limit_row_count;
+  unsigned int        generation;   /* changes every time the slot is reused */
+  unsigned long long  last_used;
+} QUERY_CACHE_ENTRY;
+
+typedef struct query_cache
+{
+  QUERY_CACHE_ENTRY   entry[QUERY_CACHE_ENTRIES];
+  size_t              bytes;
+  unsigned long long  tick;
+#ifdef THREAD
+  myodbc_mutex_t      lock;
+#endif
+} QUERY_CACHE;
+
+
 typedef struct parser
 {
   char              *pos;
@@ -142,6 +198,8 @@ typedef struct parser
   BOOL hash_comment;      /* Comment starts with "#" and end with end of line */
   BOOL dash_comment;      /* Comment starts with "-- " and end with end of line  */
   BOOL c_style_comment;   /* C style comment */
+  BOOL fast_scan;         /* ASCII bytes are always single characters and
+                             can be skipped without the charset functions */
 
   const MY_SYNTAX_MARKERS *syntax;
 } MY_PARSER;
@@ -153,6 +211,13 @@ void              delete_parsed_query(MY_PARSED_QUERY *pq);
 int               copy_parsed_query(MY_PARSED_QUERY *src,
                                     MY_PARSED_QUERY *target);
 
+void              query_cache_init   (QUERY_CACHE *cache);
+void              query_cache_clear  (QUERY_CACHE *cache);
+void              query_cache_destroy(QUERY_CACHE *cache);
+BOOL              query_cache_get    (QUERY_CACHE *cache, MY_PARSED_QUERY *pq);
+void              query_cache_put    (QUERY_CACHE *cache, MY_PARSED_QUERY *pq);
+void              query_cache_update (QUERY_CACHE *cache, MY_PARSED_QUERY *pq);
+
 /* Those are taking pointer to MY_PARSED_QUERY as a parameter*/
 #define GET_QUERY(pq) (pq)->query
 #define GET_QUERY_END(pq) (pq)->query_end
@@ -223,4 +288,10 @@ BOOL        stmt_returns_result     (const MY_PARSED_QUERY *query);
 
 BOOL        remove_braces           (MY_PARSER *query);
 
+size_t      query_digest            (const char *query, const char *end,
+                                     CHARSET_INFO *cs, char *buff,
+                                     size_t size);
+BOOL        is_session_select       (MY_PARSED_QUERY *pq);
+BOOL        is_create_temporary     (MY_PARSED_QUERY *pq);
+
 #endif
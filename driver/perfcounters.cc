@@ -0,0 +1,122 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+/**
+  @file  perfcounters.cc
+  @brief counters of what the driver itself spends on a connection
+
+  The counters are kept on every connection and statement, so updating them
+  must stay cheap: a relaxed atomic add on the connection and a plain add on
+  the statement. They are read with SQL_ATTR_MYSQL_PERF_COUNTERS and written
+  to the PERF_COUNTERS_FILE of the data source at disconnect.
+*/
+
+#include "driver.h"
+
+#include <chrono>
+
+static const char *perf_counter_names[PERF_COUNTER_COUNT]=
+{
+  "round_trips",
+  "hidden_round_trips",
+  "bytes_sent",
+  "bytes_received",
+  "rows_fetched",
+  "query_ns",
+  "fetch_ns",
+  "convert_ns",
+  "store_result_peak",
+  "prepare_cache_hits",
+  "prepare_cache_misses"
+};
+
+
+long long perf_clock_ns(void)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/* Raises the counter to the value if it is below it */
+void perf_counter_peak(PERF_COUNTER *counter, unsigned long long value)
+{
+  unsigned long long current= counter->load(std::memory_order_relaxed);
+
+  while (current < value &&
+         !counter->compare_exchange_weak(current, value,
+                                         std::memory_order_relaxed))
+    ;
+}
+
+
+void perf_counters_load(const PERF_COUNTER *counters,
+                        unsigned long long *values)
+{
+  int i;
+
+  for (i= 0; i < PERF_COUNTER_COUNT; ++i)
+  {
+    values[i]= counters[i].load(std::memory_order_relaxed);
+  }
+}
+
+
+void perf_counters_reset(PERF_COUNTER *counters)
+{
+  int i;
+
+  for (i= 0; i < PERF_COUNTER_COUNT; ++i)
+  {
+    counters[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+
+/**
+  Formats the counters as "name=value;..." like the other statistics
+  attributes of the driver.
+
+  @return Length of the text, not counting the terminating NUL
+*/
+size_t perf_counters_format(char *buff, size_t size,
+                            const unsigned long long *values)
+{
+  size_t length= 0;
+  int i;
+
+  buff[0]= '\0';
+
+  for (i= 0; i < PERF_COUNTER_COUNT && length < size; ++i)
+  {
+    length+= myodbc_snprintf(buff + length, size - length, "%s%s=%llu",
+                             i ? ";" : "", perf_counter_names[i], values[i]);
+  }
+
+  return myodbc_min(length, size - 1);
+}
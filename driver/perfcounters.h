@@ -0,0 +1,75 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+/**
+  @file  perfcounters.h
+  @brief counters of what the driver itself spends on a connection
+*/
+
+#ifndef __MYODBC_PERFCOUNTERS_H__
+# define __MYODBC_PERFCOUNTERS_H__
+
+#include <stddef.h>
+#include <atomic>
+
+typedef enum perf_counter_id
+{
+  PERF_ROUND_TRIPS,           /* statements and commands sent */
+  PERF_HIDDEN_ROUND_TRIPS,    /* of those, sent by the driver on its own */
+  PERF_BYTES_SENT,            /* query text */
+  PERF_BYTES_RECEIVED,        /* row data the application read */
+  PERF_ROWS_FETCHED,
+  PERF_QUERY_NS,              /* in do_query() */
+  PERF_FETCH_NS,              /* in fill_fetch_buffers(), conversion included */
+  PERF_CONVERT_NS,            /* copying text to SQL_C_CHAR or SQL_C_WCHAR */
+  PERF_STORE_RESULT_PEAK,     /* memory of the largest stored result */
+  PERF_PREPARE_CACHE_HITS,
+  PERF_PREPARE_CACHE_MISSES,
+  PERF_COUNTER_COUNT
+} PERF_COUNTER_ID;
+
+/*
+  Counters of a connection may be bumped by its statements on different
+  threads. Statements keep plain counters, as ODBC doesn't let two threads
+  use a statement at the same time.
+*/
+typedef std::atomic<unsigned long long> PERF_COUNTER;
+
+/* Enough for all counters as "name=value;..." */
+#define PERF_COUNTERS_TEXT_SIZE 512
+
+long long perf_clock_ns(void);
+
+void perf_counter_peak(PERF_COUNTER *counter, unsigned long long value);
+void perf_counters_load(const PERF_COUNTER *counters,
+                        unsigned long long *values);
+void perf_counters_reset(PERF_COUNTER *counters);
+size_t perf_counters_format(char *buff, size_t size,
+                            const unsigned long long *values);
+
+#endif /* __MYODBC_PERFCOUNTERS_H__ */
@@ -0,0 +1,485 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/**
+  @file  querylog.cc
+  @brief structured query log written by a background thread
+
+  Each connection with query logging on owns a bounded queue of entries.
+  Threads executing statements only put entries into it, which takes a
+  compare-and-swap and no lock. A single writer thread, started with the
+  first logging connection and stopped with the last one, drains all the
+  queues into the log file as JSON lines.
+
+  When a queue is full, the statement waits up to QUERY_LOG_MAX_WAIT_US for
+  the writer to make room and then drops its entry. The writer reports the
+  number of dropped entries in the log.
+*/
+
+#include "driver.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+struct query_log_writer;
+
+/* Sequence numbers tell whether the cell is free or holds an entry */
+struct query_log_cell
+{
+  std::atomic<size_t> sequence;
+  QUERY_LOG_ENTRY *entry;
+};
+
+struct query_log
+{
+  query_log_cell      cells[QUERY_LOG_CAPACITY];
+  std::atomic<size_t> enqueue_pos;
+  std::atomic<size_t> dequeue_pos;  /* moved by the writer only */
+  std::atomic<unsigned long> dropped;
+  query_log_writer   *writer;
+  QUERY_LOG          *next;
+};
+
+struct query_log_writer
+{
+  std::thread             thread;
+  std::condition_variable wakeup;
+  FILE                   *file;
+  QUERY_LOG              *logs;
+  bool                    stop;
+};
+
+/* Protects the writer and its list of logs, and serializes the file */
+static std::mutex writer_lock;
+static query_log_writer *writer= NULL;
+
+
+long long query_log_now_us(void)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+
+long long query_log_clock_us(void)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/**
+  Allocates a log entry for the given statement text. Fields other than
+  the time and the connection are set to "not applicable".
+
+  The entries are freed by the writer thread, so they are allocated with
+  plain malloc() rather than by the client library.
+*/
+QUERY_LOG_ENTRY *query_log_entry_new(const char *query, size_t length,
+                                     unsigned long connection_id)
+{
+  QUERY_LOG_ENTRY *entry=
+    (QUERY_LOG_ENTRY *)malloc(sizeof(QUERY_LOG_ENTRY) + length);
+
+  if (entry == NULL)
+  {
+    return NULL;
+  }
+
+  entry->time_us= query_log_now_us();
+  entry->connection_id= connection_id;
+  entry->latency_us= entry->rows_fetched= entry->rows_affected= -1;
+  entry->bytes_sent= entry->bytes_received= -1;
+  entry->sqlstate[0]= entry->replica[0]= '\0';
+  entry->length= length;
+  memcpy(entry->query, query, length);
+  entry->query[length]= '\0';
+
+  return entry;
+}
+
+
+void query_log_entry_free(QUERY_LOG_ENTRY *entry)
+{
+  free(entry);
+}
+
+
+static bool query_log_push(QUERY_LOG *log, QUERY_LOG_ENTRY *entry)
+{
+  size_t pos= log->enqueue_pos.load(std::memory_order_relaxed);
+  query_log_cell *cell;
+
+  for (;;)
+  {
+    size_t sequence;
+
+    cell= &log->cells[pos % QUERY_LOG_CAPACITY];
+    sequence= cell->sequence.load(std::memory_order_acquire);
+
+    if (sequence == pos)
+    {
+      if (log->enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                 std::memory_order_relaxed))
+        break;
+    }
+    else if ((ptrdiff_t)(sequence - pos) < 0)
+    {
+      /* The writer has not taken the entry put here a round ago */
+      return false;
+    }
+    else
+    {
+      pos= log->enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->entry= entry;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+
+  return true;
+}
+
+
+static QUERY_LOG_ENTRY *query_log_pop(QUERY_LOG *log)
+{
+  size_t pos= log->dequeue_pos.load(std::memory_order_relaxed);
+  query_log_cell *cell= &log->cells[pos % QUERY_LOG_CAPACITY];
+  QUERY_LOG_ENTRY *entry;
+
+  if (cell->sequence.load(std::memory_order_acquire) != pos + 1)
+  {
+    return NULL;
+  }
+
+  entry= cell->entry;
+  cell->sequence.store(pos + QUERY_LOG_CAPACITY, std::memory_order_release);
+  log->dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+
+  return entry;
+}
+
+
+/**
+  Queues the entry for the writer, which takes ownership of it.
+*/
+void query_log_add(QUERY_LOG *log, QUERY_LOG_ENTRY *entry)
+{
+  long long deadline;
+
+  if (query_log_push(log, entry))
+  {
+    /* Don't let the queue fill up before the writer's next round */
+    if (log->enqueue_pos.load(std::memory_order_relaxed) -
+        log->dequeue_pos.load(std::memory_order_relaxed) >
+        QUERY_LOG_CAPACITY / 2)
+    {
+      log->writer->wakeup.notify_one();
+    }
+    return;
+  }
+
+  log->writer->wakeup.notify_one();
+  deadline= query_log_clock_us() + QUERY_LOG_MAX_WAIT_US;
+
+  do
+  {
+    std::this_thread::yield();
+
+    if (query_log_push(log, entry))
+    {
+      return;
+    }
+  } while (query_log_clock_us() < deadline);
+
+  log->dropped.fetch_add(1, std::memory_order_relaxed);
+  query_log_entry_free(entry);
+}
+
+
+static void write_json_string(FILE *file, const char *str, size_t length)
+{
+  const char *end= str + length, *run= str;
+
+  fputc('"', file);
+
+  for (; str < end; ++str)
+  {
+    unsigned char c= (unsigned char)*str;
+
+    if (c >= 0x20 && c != '"' && c != '\\')
+    {
+      continue;
+    }
+
+    fwrite(run, 1, str - run, file);
+    run= str + 1;
+
+    switch (c)
+    {
+    case '"':  fputs("\\\"", file); break;
+    case '\\': fputs("\\\\", file); break;
+    case '\n': fputs("\\n", file); break;
+    case '\r': fputs("\\r", file); break;
+    case '\t': fputs("\\t", file); break;
+    default:   fprintf(file, "\\u%04x", c);
+    }
+  }
+
+  fwrite(run, 1, str - run, file);
+  fputc('"', file);
+}
+
+
+static void write_time(FILE *file, long long time_us)
+{
+  time_t seconds= (time_t)(time_us / 1000000);
+  struct tm tm;
+
+#ifdef _WIN32
+  gmtime_s(&tm, &seconds);
+#else
+  gmtime_r(&seconds, &tm);
+#endif
+
+  fprintf(file, "{\"time\":\"%04d-%02d-%02dT%02d:%02d:%02d.%06dZ\"",
+          tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+          tm.tm_hour, tm.tm_min, tm.tm_sec, (int)(time_us % 1000000));
+}
+
+
+static void write_entry(FILE *file, QUERY_LOG_ENTRY *entry)
+{
+  write_time(file, entry->time_us);
+  fprintf(file, ",\"connection_id\":%lu,\"statement\":",
+          entry->connection_id);
+  write_json_string(file, entry->query, entry->length);
+
+  if (entry->latency_us >= 0)
+    fprintf(file, ",\"latency_us\":%lld", entry->latency_us);
+  if (entry->rows_fetched >= 0)
+    fprintf(file, ",\"rows_fetched\":%lld", entry->rows_fetched);
+  if (entry->rows_affected >= 0)
+    fprintf(file, ",\"rows_affected\":%lld", entry->rows_affected);
+  if (entry->bytes_sent >= 0)
+    fprintf(file, ",\"bytes_sent\":%lld", entry->bytes_sent);
+  if (entry->bytes_received >= 0)
+    fprintf(file, ",\"bytes_received\":%lld", entry->bytes_received);
+  if (entry->sqlstate[0])
+    fprintf(file, ",\"sqlstate\":\"%s\"", entry->sqlstate);
+  if (entry->replica[0])
+  {
+    fputs(",\"replica\":", file);
+    write_json_string(file, entry->replica, strlen(entry->replica));
+  }
+
+  fputs("}\n", file);
+}
+
+
+/* Writes out what is queued in the log. Called with writer_lock held */
+static void query_log_drain(FILE *file, QUERY_LOG *log)
+{
+  QUERY_LOG_ENTRY *entry;
+  unsigned long dropped;
+
+  while ((entry= query_log_pop(log)) != NULL)
+  {
+    write_entry(file, entry);
+    query_log_entry_free(entry);
+  }
+
+  if ((dropped= log->dropped.exchange(0, std::memory_order_relaxed)))
+  {
+    write_time(file, query_log_now_us());
+    fprintf(file, ",\"dropped\":%lu}\n", dropped);
+  }
+}
+
+
+static void writer_run(query_log_writer *w)
+{
+  std::unique_lock<std::mutex> guard(writer_lock);
+
+  while (!w->stop)
+  {
+    QUERY_LOG *log;
+
+    w->wakeup.wait_for(guard, std::chrono::milliseconds(QUERY_LOG_FLUSH_MS));
+
+    for (log= w->logs; log; log= log->next)
+    {
+      query_log_drain(w->file, log);
+    }
+    fflush(w->file);
+  }
+}
+
+
+static FILE *open_log_file(void)
+{
+  FILE *file;
+#ifdef _WIN32
+  char filename[MAX_PATH];
+  size_t buffsize;
+
+  getenv_s(&buffsize, filename, sizeof(filename), "TEMP");
+
+  if (buffsize)
+  {
+    sprintf(filename + buffsize - 1, "\\%s", DRIVER_QUERY_LOGFILE);
+  }
+  else
+  {
+    sprintf(filename, "c:\\%s", DRIVER_QUERY_LOGFILE);
+  }
+
+  if ((file= fopen(filename, "a+")))
+#else
+  if ((file= fopen(DRIVER_QUERY_LOGFILE, "a+")))
+#endif
+  {
+    write_time(file, query_log_now_us());
+    fprintf(file, ",\"driver\":\"%s\",\"version\":\"%s\"}\n", DRIVER_NAME,
+            DRIVER_VERSION);
+  }
+
+  return file;
+}
+
+
+/**
+  Creates the query log of a connection, and starts the writer thread if
+  this is the only one.
+
+  @return The log, or NULL if the log file or the thread could not be
+          created.
+*/
+QUERY_LOG *query_log_open(void)
+{
+  std::lock_guard<std::mutex> guard(writer_lock);
+  QUERY_LOG *log= new (std::nothrow) QUERY_LOG;
+  size_t i;
+
+  if (log == NULL)
+  {
+    return NULL;
+  }
+
+  if (writer == NULL)
+  {
+    query_log_writer *w= new (std::nothrow) query_log_writer;
+
+    if (w == NULL || (w->file= open_log_file()) == NULL)
+    {
+      delete w;
+      delete log;
+      return NULL;
+    }
+
+    w->logs= NULL;
+    w->stop= false;
+
+    try
+    {
+      w->thread= std::thread(writer_run, w);
+    }
+    catch (...)
+    {
+      fclose(w->file);
+      delete w;
+      delete log;
+      return NULL;
+    }
+
+    writer= w;
+  }
+
+  for (i= 0; i < QUERY_LOG_CAPACITY; ++i)
+  {
+    log->cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  log->enqueue_pos.store(0, std::memory_order_relaxed);
+  log->dequeue_pos.store(0, std::memory_order_relaxed);
+  log->dropped.store(0, std::memory_order_relaxed);
+
+  log->writer= writer;
+  log->next= writer->logs;
+  writer->logs= log;
+
+  return log;
+}
+
+
+/**
+  Writes out what is left in the log and frees it. The writer thread
+  stops with the last log.
+*/
+void query_log_close(QUERY_LOG *log)
+{
+  query_log_writer *stopped= NULL;
+
+  if (log == NULL)
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(writer_lock);
+    QUERY_LOG **prev;
+
+    query_log_drain(log->writer->file, log);
+    fflush(log->writer->file);
+
+    for (prev= &log->writer->logs; *prev != log; prev= &(*prev)->next)
+      ;
+    *prev= log->next;
+
+    if (log->writer->logs == NULL)
+    {
+      stopped= log->writer;
+      stopped->stop= true;
+      stopped->wakeup.notify_one();
+      writer= NULL;
+    }
+  }
+
+  if (stopped != NULL)
+  {
+    stopped->thread.join();
+    fclose(stopped->file);
+    delete stopped;
+  }
+
+  delete log;
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+
+/**
+  @file  querylog.h
+  @brief structured query log written by a background thread
+*/
+
+#ifndef __MYODBC_QUERYLOG_H__
+# define __MYODBC_QUERYLOG_H__
+
+#include <stddef.h>
+
+/* Entries a connection can have waiting for the writer */
+#define QUERY_LOG_CAPACITY 1024
+/* How long a full log holds up the query before the entry is dropped */
+#define QUERY_LOG_MAX_WAIT_US 2000
+/* How often the writer looks for entries when not woken up */
+#define QUERY_LOG_FLUSH_MS 100
+
+typedef struct query_log QUERY_LOG;
+
+/*
+  One line of the log. Numbers that don't apply to the statement are -1
+  and left out of the line.
+*/
+typedef struct query_log_entry
+{
+  long long     time_us;            /* start, microseconds since the epoch */
+  unsigned long connection_id;      /* server thread id */
+  long long     latency_us;         /* execution, up to the result */
+  long long     rows_fetched;       /* rows the application read */
+  long long     rows_affected;
+  long long     bytes_sent;         /* query text, not with server side
+                                       prepared statements */
+  long long     bytes_received;     /* row data the application read */
+  char          sqlstate[6];
+  char          replica[64];        /* host of the read replica used */
+  size_t        length;
+  char          query[1];           /* allocated with the entry */
+} QUERY_LOG_ENTRY;
+
+QUERY_LOG *query_log_open(void);
+void query_log_close(QUERY_LOG *log);
+
+QUERY_LOG_ENTRY *query_log_entry_new(const char *query, size_t length,
+                                     unsigned long connection_id);
+void query_log_entry_free(QUERY_LOG_ENTRY *entry);
+void query_log_add(QUERY_LOG *log, QUERY_LOG_ENTRY *entry);
+
+long long query_log_now_us(void);
+long long query_log_clock_us(void);
+
+#endif /* __MYODBC_QUERYLOG_H__ */
@@ -63,22 +63,145 @@ my_bool is_binary_ctype( SQLSMALLINT cType)
 /* Converts binary(currently used for bit field only) to long long number.*/
 long long binary2numeric(long long *dst, char *src, uint srcLen)
 {
-  *dst= 0;
+  ulonglong value= 0;
 
-  while (srcLen)
+  /* if source binary data is longer than 8 bytes(size of long long)
+     we consider only minor 8 bytes */
+  if (srcLen > sizeof(long long))
   {
-    /* if source binary data is longer than 8 bytes(size of long long)
-       we consider only minor 8 bytes */
-    if (srcLen > sizeof(long long))
-          continue;
-    *dst+= (0xff & *src) << (--srcLen)*8;
-    ++src;
+    src+= srcLen - sizeof(long long);
+    srcLen= sizeof(long long);
   }
 
+  while (srcLen--)
+  {
+    value= value << 8 | (uchar)*src++;
+  }
+
+  *dst= (long long)value;
   return *dst;
 }
 
 
+/*
+  Checks that an integer fits into one of the integer C types. The types
+  without a sign come from ODBC 2.x, where the column decides the sign, so
+  they take both the signed and the unsigned range.
+*/
+static my_bool int_fits_ctype(SQLSMALLINT fCType, ulonglong magnitude,
+                              my_bool negative)
+{
+  ulonglong max, min= 0; /* largest magnitudes of positive/negative values */
+
+  switch (fCType)
+  {
+  case SQL_C_TINYINT:
+    max= 255;
+    min= 128;
+    break;
+  case SQL_C_STINYINT:
+    max= 127;
+    min= 128;
+    break;
+  case SQL_C_UTINYINT:
+    max= 255;
+    break;
+  case SQL_C_SHORT:
+    max= 65535;
+    min= 32768;
+    break;
+  case SQL_C_SSHORT:
+    max= 32767;
+    min= 32768;
+    break;
+  case SQL_C_USHORT:
+    max= 65535;
+    break;
+  case SQL_C_LONG:
+    max= 4294967295ULL;
+    min= 2147483648ULL;
+    break;
+  case SQL_C_SLONG:
+    max= 2147483647;
+    min= 2147483648ULL;
+    break;
+  case SQL_C_ULONG:
+    max= 4294967295ULL;
+    break;
+  case SQL_C_SBIGINT:
+    max= LLONG_MAX;
+    min= (ulonglong)LLONG_MAX + 1;
+    break;
+  default:
+    max= ULLONG_MAX;
+  }
+
+  return magnitude <= (negative ? min : max);
+}
+
+
+/*
+  Stores an integer in one of the integer C types, or sets 22003 if it
+  does not fit into the type.
+
+  @param[in]  stmt        Handle of statement
+  @param[in]  fCType      Integer C type
+  @param[out] rgbValue    Buffer of the type
+  @param[in]  magnitude   Absolute value
+  @param[in]  negative    Sign of the value
+  @param[in]  fits        FALSE if the value did not even fit into 64 bits
+*/
+static SQLRETURN int_to_ctype(STMT *stmt, SQLSMALLINT fCType,
+                              SQLPOINTER rgbValue, ulonglong magnitude,
+                              my_bool negative, my_bool fits)
+{
+  ulonglong value= negative ? 0 - magnitude : magnitude;
+
+  if (!fits || !int_fits_ctype(fCType, magnitude, negative))
+  {
+    return set_stmt_error(stmt, "22003", "Numeric value out of range", 0);
+  }
+
+  switch (fCType)
+  {
+  case SQL_C_TINYINT:
+  case SQL_C_STINYINT:
+  case SQL_C_UTINYINT:
+    *((SQLCHAR *)rgbValue)= (SQLCHAR)value;
+    break;
+  case SQL_C_SHORT:
+  case SQL_C_SSHORT:
+  case SQL_C_USHORT:
+    *((SQLUSMALLINT *)rgbValue)= (SQLUSMALLINT)value;
+    break;
+  case SQL_C_LONG:
+  case SQL_C_SLONG:
+  case SQL_C_ULONG:
+    *((SQLUINTEGER *)rgbValue)= (SQLUINTEGER)value;
+    break;
+  default:
+    /** @todo This is not right. SQLUBIGINT is not always ulonglong. */
+    *((ulonglong *)rgbValue)= value;
+  }
+
+  return SQL_SUCCESS;
+}
+
+
+/* Stores the bookmark text in one of the integer C types */
+static SQLRETURN bookmark_to_ctype(STMT *stmt, SQLSMALLINT fCType,
+                                   SQLPOINTER rgbValue, char *value,
+                                   ulong length)
+{
+  ulonglong magnitude;
+  my_bool negative;
+  int parsed= myodbc_parse_int(value, length, &magnitude, &negative);
+
+  return int_to_ctype(stmt, fCType, rgbValue, magnitude, negative,
+                      parsed == MYODBC_INT_OK);
+}
+
+
 /* Function that verifies if conversion from given sql type to c type supported.
    Based on http://msdn.microsoft.com/en-us/library/ms709280%28VS.85%29.aspx
    and underlying pages.
@@ -270,60 +393,26 @@ sql_get_bookmark_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
         *pcbValue= (SQLINTEGER)(cbValueMax / sizeof(SQLWCHAR));
 
     }
+    break;
 
   case SQL_C_TINYINT:
   case SQL_C_STINYINT:
-    if (rgbValue && stmt->stmt_options.retrieve_data)
-      *((SQLSCHAR *)rgbValue)= (SQLSCHAR) get_int(stmt, column_number,
-                                                  value, length);
-    *pcbValue= 1;
-    break;
-
   case SQL_C_UTINYINT:
-    if (rgbValue && stmt->stmt_options.retrieve_data)
-      *((SQLCHAR *)rgbValue)= (SQLCHAR)(unsigned int)
-                              get_int(stmt, column_number, value, length);
-    *pcbValue= 1;
-    break;
-
   case SQL_C_SHORT:
   case SQL_C_SSHORT:
-    if (rgbValue && stmt->stmt_options.retrieve_data)
-      *((SQLSMALLINT *)rgbValue)= (SQLSMALLINT) get_int(stmt, column_number,
-                                                        value, length);
-    *pcbValue= sizeof(SQLSMALLINT);
-    break;
-
   case SQL_C_USHORT:
-    if (rgbValue && stmt->stmt_options.retrieve_data)
-      *((SQLUSMALLINT *)rgbValue)= (SQLUSMALLINT)(uint)
-                              get_int64(stmt, column_number, value, length);
-    *pcbValue= sizeof(SQLUSMALLINT);
-    break;
-
   case SQL_C_LONG:
   case SQL_C_SLONG:
-    if (rgbValue && stmt->stmt_options.retrieve_data)
+  case SQL_C_ULONG:
+  case SQL_C_SBIGINT:
+  case SQL_C_UBIGINT:
+    /* The bookmark is always text, whatever protocol the result uses */
+    if (rgbValue && stmt->stmt_options.retrieve_data &&
+        bookmark_to_ctype(stmt, fCType, rgbValue, value, length) != SQL_SUCCESS)
     {
-      if (length >= 10 && value[4] == '-' && value[7] == '-' &&
-           (!value[10] || value[10] == ' '))
-      {
-        *((SQLINTEGER *)rgbValue)= ((SQLINTEGER) atol(value) * 10000L +
-                                    (SQLINTEGER) atol(value + 5) * 100L +
-                                    (SQLINTEGER) atol(value + 8));
-      }
-      else
-        *((SQLINTEGER *)rgbValue)= (SQLINTEGER) get_int64(stmt,
-                                              column_number, value, length);
+      return SQL_ERROR;
     }
-    *pcbValue= sizeof(SQLINTEGER);
-    break;
-
-  case SQL_C_ULONG:
-    if (rgbValue && stmt->stmt_options.retrieve_data)
-      *((SQLUINTEGER *)rgbValue)= (SQLUINTEGER) get_int64(stmt, column_number,
-                                                          value, length);
-    *pcbValue= sizeof(SQLUINTEGER);
+    *pcbValue= bind_length(fCType, 0);
     break;
 
   case SQL_C_FLOAT:
@@ -340,22 +429,6 @@ sql_get_bookmark_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
     *pcbValue= sizeof(double);
     break;
 
-  case SQL_C_SBIGINT:
-    /** @todo This is not right. SQLBIGINT is not always longlong. */
-    if (rgbValue && stmt->stmt_options.retrieve_data)
-      *((longlong *)rgbValue)= (longlong) get_int64(stmt, column_number,
-                                                    value, length);
-    *pcbValue= sizeof(longlong);
-    break;
-
-  case SQL_C_UBIGINT:
-    /** @todo This is not right. SQLUBIGINT is not always ulonglong.  */
-    if (rgbValue && stmt->stmt_options.retrieve_data)
-        *((ulonglong *)rgbValue)= (ulonglong) get_int64(stmt, column_number,
-                                                        value, length);
-    *pcbValue= sizeof(ulonglong);
-    break;
-
   default:
     return set_error(stmt,MYERR_07006,
                      "Restricted data type attribute violation",0);
@@ -369,6 +442,26 @@ sql_get_bookmark_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
 }
 
 
+/*
+  IRD record of a column, with its charsets as fix_result_types() left them.
+  Results it has not seen, like the output parameters, get them resolved
+  into the temporary record.
+*/
+static DESCREC *result_rec(STMT *stmt, uint column_number, MYSQL_FIELD *field,
+                           DESCREC *tmp_rec)
+{
+  DESCREC *irrec= desc_get_rec(stmt->ird, column_number, FALSE);
+
+  if (irrec && irrec->row.field == field)
+  {
+    return irrec;
+  }
+
+  fix_row_charsets(stmt, tmp_rec, field);
+  return tmp_rec;
+}
+
+
 /**
   Retrieve the data from a field as a specified ODBC C type.
 
@@ -397,6 +490,7 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
   SQLRETURN result= SQL_SUCCESS;
   char      as_string[50]; /* Buffer that might be required to convert other
                               types data to its string representation */
+  DESCREC   tmp_rec;
 
   /* get the exact type if we don't already have it */
   if (fCType == SQL_C_DEFAULT)
@@ -531,33 +625,52 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
         else
         {
           char *tmp= get_string(stmt, column_number, value, &length, as_string);
-          return copy_ansi_result(stmt,(SQLCHAR*)rgbValue, cbValueMax, pcbValue,
-                                  field, tmp,length);
+          long long started= perf_clock_ns();
+
+          result= copy_ansi_result(stmt,(SQLCHAR*)rgbValue, cbValueMax, pcbValue,
+                                   result_rec(stmt, column_number, field,
+                                              &tmp_rec),
+                                   tmp, length);
+          PERF_ADD(stmt, PERF_CONVERT_NS, perf_clock_ns() - started);
+          return result;
         }
       }
 
     case SQL_C_WCHAR:
       {
         char *tmp= get_string(stmt, column_number, value, &length, as_string);
+        long long started= perf_clock_ns();
 
-        return copy_wchar_result(stmt, (SQLWCHAR *)rgbValue,
+        result= copy_wchar_result(stmt, (SQLWCHAR *)rgbValue,
                         (SQLINTEGER)(cbValueMax / sizeof(SQLWCHAR)), pcbValue,
-                        field, tmp, length);
+                        result_rec(stmt, column_number, field, &tmp_rec),
+                        tmp, length);
+        PERF_ADD(stmt, PERF_CONVERT_NS, perf_clock_ns() - started);
+        return result;
       }
 
     case SQL_C_BIT:
+      /*
+        The value is read as an integer, 1 if it is positive and 0 if not.
+        There is no 22003 or 01S07 as in the ODBC conversion rules, since
+        applications bind SQL_C_BIT to INT columns as flags (Bug#39644).
+      */
       if (rgbValue)
       {
         /* for MySQL bit(n>1) 1st byte may be '\0'. So testing already converted
-           to a number value or atoi for other types. */
+           to a number value or the value of other types. */
         if (!convert)
         {
           *((char *)rgbValue)= numericValue > 0 ? '\1' : '\0';
         }
         else
         {
-          *((char *)rgbValue)= get_int(stmt, column_number, value, length) > 0 ?
-                               '\1' : '\0';
+          ulonglong magnitude;
+          my_bool negative;
+
+          get_int_value(stmt, column_number, value, length, &magnitude,
+                        &negative);
+          *((char *)rgbValue)= magnitude && !negative ? '\1' : '\0';
         }
       }
 
@@ -566,69 +679,67 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
 
     case SQL_C_TINYINT:
     case SQL_C_STINYINT:
-      if (rgbValue)
-        *((SQLSCHAR *)rgbValue)= (SQLSCHAR)(convert
-                                 ? get_int(stmt, column_number, value, length)
-                                 : (numericValue & (SQLSCHAR)(-1)));
-      *pcbValue= 1;
-      break;
-
     case SQL_C_UTINYINT:
-      if (rgbValue)
-        *((SQLCHAR *)rgbValue)= (SQLCHAR)(unsigned int)(convert
-                                ? get_int(stmt, column_number, value, length)
-                                : (numericValue & (SQLCHAR)(-1)));
-      *pcbValue= 1;
-      break;
-
     case SQL_C_SHORT:
     case SQL_C_SSHORT:
-      if (rgbValue)
-        *((SQLSMALLINT *)rgbValue)= (SQLSMALLINT)(convert
-                                ? get_int(stmt, column_number, value, length)
-                                : (numericValue & (SQLUSMALLINT)(-1)));
-      *pcbValue= sizeof(SQLSMALLINT);
-      break;
-
     case SQL_C_USHORT:
-      if (rgbValue)
-        *((SQLUSMALLINT *)rgbValue)= (SQLUSMALLINT)(uint)(convert
-                                ? get_int64(stmt, column_number, value, length)
-                                : (numericValue & (SQLUSMALLINT)(-1)));
-      *pcbValue= sizeof(SQLUSMALLINT);
-      break;
-
     case SQL_C_LONG:
     case SQL_C_SLONG:
-      if (rgbValue)
+    case SQL_C_ULONG:
+    case SQL_C_SBIGINT:
+    case SQL_C_UBIGINT:
+      *pcbValue= bind_length(fCType, 0);
+
+      if (!rgbValue)
+      {
+        break;
+      }
+
+      if (!convert)
       {
-        /* Check if it could be a date...... :) */
-        if (convert)
+        /* BIT(n) keeps the bits that fit */
+        switch (fCType)
         {
-          if (length >= 10 && value[4] == '-' && value[7] == '-' &&
-               (!value[10] || value[10] == ' '))
-          {
-            *((SQLINTEGER *)rgbValue)= ((SQLINTEGER) atol(value) * 10000L +
-                                        (SQLINTEGER) atol(value + 5) * 100L +
-                                        (SQLINTEGER) atol(value + 8));
-          }
-          else
-            *((SQLINTEGER *)rgbValue)= (SQLINTEGER) get_int64(stmt,
-                                                  column_number, value, length);
+        case SQL_C_TINYINT:
+        case SQL_C_STINYINT:
+        case SQL_C_UTINYINT:
+          *((SQLCHAR *)rgbValue)= (SQLCHAR)numericValue;
+          break;
+        case SQL_C_SHORT:
+        case SQL_C_SSHORT:
+        case SQL_C_USHORT:
+          *((SQLUSMALLINT *)rgbValue)= (SQLUSMALLINT)numericValue;
+          break;
+        case SQL_C_LONG:
+        case SQL_C_SLONG:
+        case SQL_C_ULONG:
+          *((SQLUINTEGER *)rgbValue)= (SQLUINTEGER)numericValue;
+          break;
+        default:
+          *((ulonglong *)rgbValue)= (ulonglong)numericValue;
         }
-        else
-          *((SQLINTEGER *)rgbValue)= (SQLINTEGER)(numericValue
-                                                  & (SQLUINTEGER)(-1));
       }
-      *pcbValue= sizeof(SQLINTEGER);
-      break;
+      /* Check if it could be a date...... :) */
+      else if ((fCType == SQL_C_LONG || fCType == SQL_C_SLONG) &&
+               length >= 10 && value[4] == '-' && value[7] == '-' &&
+               (!value[10] || value[10] == ' '))
+      {
+        *((SQLINTEGER *)rgbValue)= ((SQLINTEGER) atol(value) * 10000L +
+                                    (SQLINTEGER) atol(value + 5) * 100L +
+                                    (SQLINTEGER) atol(value + 8));
+      }
+      else
+      {
+        ulonglong magnitude;
+        my_bool negative, fits= get_int_value(stmt, column_number, value,
+                                              length, &magnitude, &negative);
 
-    case SQL_C_ULONG:
-      if (rgbValue)
-        *((SQLUINTEGER *)rgbValue)= (SQLUINTEGER)(convert ?
-                                get_int64(stmt, column_number, value, length) :
-                                numericValue & (SQLUINTEGER)(-1));
-      *pcbValue= sizeof(SQLUINTEGER);
+        if (int_to_ctype(stmt, fCType, rgbValue, magnitude, negative, fits)
+            != SQL_SUCCESS)
+        {
+          return SQL_ERROR;
+        }
+      }
       break;
 
     case SQL_C_FLOAT:
@@ -861,24 +972,6 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
       break;
       }
 
-    case SQL_C_SBIGINT:
-      /** @todo This is not right. SQLBIGINT is not always longlong. */
-      if (rgbValue)
-        *((longlong *)rgbValue)= (longlong)(convert ? get_int64(stmt,
-                        column_number, value, length) : numericValue);
-
-      *pcbValue= sizeof(longlong);
-      break;
-
-    case SQL_C_UBIGINT:
-      /** @todo This is not right. SQLUBIGINT is not always ulonglong.  */
-      if (rgbValue)
-          *((ulonglong *)rgbValue)= (ulonglong)(convert ? get_int64(stmt,
-                        column_number, value, length) : numericValue);
-
-      *pcbValue= sizeof(ulonglong);
-      break;
-
     case SQL_C_NUMERIC:
       {
         int overflow= 0;
@@ -886,18 +979,28 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
 
         if (rgbValue)
         {
-          if (convert)
-            sqlnum_from_str(get_string(stmt, column_number, value, &length, as_string), sqlnum, &overflow);
-          else /* bit field */
+          if (!convert) /* bit field */
+          {
+            sqlnum_from_int((ulonglong)numericValue, FALSE, sqlnum, &overflow);
+          }
+          else if (ssps_used(stmt) &&
+                   (field->type == MYSQL_TYPE_TINY ||
+                    field->type == MYSQL_TYPE_SHORT ||
+                    field->type == MYSQL_TYPE_INT24 ||
+                    field->type == MYSQL_TYPE_LONG ||
+                    field->type == MYSQL_TYPE_LONGLONG))
           {
-            /* Lazy way - converting number we have to a string.
-               If it couldn't happen we have to scale/unscale number - we would
-               just reverse binary data */
-            char _value[21]; /* max string length of 64bit number */
-            sprintf(_value, "%llu", numericValue);
+            /* Binary integers don't need to be printed first */
+            longlong num= get_int64(stmt, column_number, value, length);
 
-            sqlnum_from_str(_value, sqlnum, &overflow);
+            if (field->flags & UNSIGNED_FLAG)
+              sqlnum_from_int((ulonglong)num, FALSE, sqlnum, &overflow);
+            else
+              sqlnum_from_int(num < 0 ? 0ULL - (ulonglong)num : (ulonglong)num,
+                              num < 0, sqlnum, &overflow);
           }
+          else
+            sqlnum_from_str(get_string(stmt, column_number, value, &length, as_string), sqlnum, &overflow);
 
         }
         *pcbValue= sizeof(ulonglong);
@@ -1782,20 +1885,336 @@ fill_fetch_bookmark_buffers(STMT *stmt, ulong value, uint rownum)
 }
 
 
+/*
+  Merges the result of filling one buffer into the result of the row:
+  any error fails the row, a warning leaves it SQL_SUCCESS_WITH_INFO.
+*/
+static SQLRETURN merge_fill_result(SQLRETURN res, SQLRETURN tmp_res)
+{
+  if (tmp_res == SQL_SUCCESS)
+    return res;
+
+  if (tmp_res == SQL_SUCCESS_WITH_INFO)
+    return res == SQL_SUCCESS ? tmp_res : res;
+
+  return SQL_ERROR;
+}
+
+
+/* Kinds of columns fill_fetch_columns() converts itself */
+enum fetch_column_kind
+{
+  FETCH_COLUMN_NONE,
+  FETCH_COLUMN_INT,     /* integer column as SQL_C_SLONG or SQL_C_SBIGINT */
+  FETCH_COLUMN_REAL,    /* numeric column as SQL_C_DOUBLE or SQL_C_FLOAT */
+  FETCH_COLUMN_DATE     /* DATE column as SQL_C_TYPE_DATE */
+};
+
+
+static enum fetch_column_kind fetch_column_kind(STMT *stmt, uint column,
+                                                DESCREC *arrec)
+{
+  MYSQL_FIELD *field= mysql_fetch_field_direct(stmt->result, column);
+  my_bool is_integer= FALSE, is_real= FALSE;
+
+  if (!arrec->data_ptr)
+    return FETCH_COLUMN_NONE;
+
+  switch (field->type)
+  {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+  case MYSQL_TYPE_LONGLONG:
+    is_integer= TRUE;
+    break;
+  case MYSQL_TYPE_FLOAT:
+  case MYSQL_TYPE_DOUBLE:
+  case MYSQL_TYPE_DECIMAL:
+  case MYSQL_TYPE_NEWDECIMAL:
+    is_real= TRUE;
+    break;
+  default:
+    break;
+  }
+
+  if (!odbc_supported_conversion(get_sql_data_type(stmt, field, 0),
+                                 arrec->concise_type)
+      && !driver_supported_conversion(field, arrec->concise_type))
+  {
+    return FETCH_COLUMN_NONE;
+  }
+
+  switch (arrec->concise_type)
+  {
+  case SQL_C_LONG:
+  case SQL_C_SLONG:
+  case SQL_C_SBIGINT:
+    return is_integer ? FETCH_COLUMN_INT : FETCH_COLUMN_NONE;
+  case SQL_C_FLOAT:
+  case SQL_C_DOUBLE:
+    return is_integer || is_real ? FETCH_COLUMN_REAL : FETCH_COLUMN_NONE;
+  case SQL_C_DATE:
+  case SQL_C_TYPE_DATE:
+    return field->type == MYSQL_TYPE_DATE ? FETCH_COLUMN_DATE
+                                          : FETCH_COLUMN_NONE;
+  }
+
+  return FETCH_COLUMN_NONE;
+}
+
+
+/* Working memory of fill_fetch_columns() for one rowset */
+typedef struct
+{
+  SQLRETURN  *row_res;  /* result of each row so far */
+  char       *filled;   /* columns that have been filled for all rows */
+  MYSQL_ROW  *rows;
+  ulong      *lengths;  /* field_count lengths of each row */
+  SQLULEN     count;    /* rows gathered */
+} FETCH_COLUMNS;
+
+
+/*
+  Converts a cell that the column loops do not handle themselves, the way
+  fill_fetch_buffers() would have.
+*/
+static void fill_fetch_cell(STMT *stmt, FETCH_COLUMNS *fc, uint column,
+                            DESCREC *arrec, SQLULEN row)
+{
+  SQLLEN *pcbValue= NULL;
+
+  if (arrec->octet_length_ptr)
+  {
+    pcbValue= (SQLLEN *)ptr_offset_adjust(arrec->octet_length_ptr,
+                                          stmt->ard->bind_offset_ptr,
+                                          stmt->ard->bind_type,
+                                          sizeof(SQLLEN), row);
+  }
+
+  reset_getdata_position(stmt);
+  fc->row_res[row]= merge_fill_result(fc->row_res[row],
+    sql_get_data(stmt, arrec->concise_type, column,
+                 ptr_offset_adjust(arrec->data_ptr, stmt->ard->bind_offset_ptr,
+                                   stmt->ard->bind_type, arrec->octet_length,
+                                   row),
+                 arrec->octet_length, pcbValue, fc->rows[row][column],
+                 fc->lengths[row * stmt->result->field_count + column],
+                 arrec));
+}
+
+
+/*
+  Fills the column-wise bound buffers of the rowset a column at a time for
+  the columns and C types that convert without looking at anything but the
+  cell text: integers, floating point numbers and dates. The rows are read
+  ahead from the stored result and the cursor is put back, so that the row
+  loop of my_SQLExtendedFetch() still fetches them and fills the rest of the
+  columns.
+
+  Only works for the text protocol results that stay in memory. Returns
+  FALSE if no column was filled, fc then does not have to be freed.
+*/
+static my_bool fill_fetch_columns(STMT *stmt, SQLULEN rows, FETCH_COLUMNS *fc)
+{
+  uint field_count= stmt->result->field_count;
+  uint columns= myodbc_min(stmt->ird->count, stmt->ard->count);
+  uint column;
+  SQLULEN row;
+  MYSQL_ROW_OFFSET start;
+  my_bool any= FALSE;
+  long long started;
+
+  if (ssps_used(stmt) || if_forward_cache(stmt) || stmt->result_array ||
+      stmt->fix_fields || stmt->fake_result || scroller_exists(stmt) ||
+      stmt->out_params_state != OPS_UNKNOWN ||
+      stmt->ard->bind_type != SQL_BIND_BY_COLUMN || rows < 2)
+  {
+    return FALSE;
+  }
+
+  for (column= 0; column < columns && !any; ++column)
+  {
+    DESCREC *arrec= desc_get_rec(stmt->ard, column, FALSE);
+    any= ARD_IS_BOUND(arrec) &&
+         fetch_column_kind(stmt, column, arrec) != FETCH_COLUMN_NONE;
+  }
+
+  if (!any)
+    return FALSE;
+
+  started= perf_clock_ns();
+
+  /* One block, widest members first to keep every array aligned */
+  fc->rows= (MYSQL_ROW *)myodbc_malloc(rows * sizeof(MYSQL_ROW) +
+                                       rows * field_count * sizeof(ulong) +
+                                       rows * sizeof(SQLRETURN) +
+                                       field_count, MYF(MY_ZEROFILL));
+  if (!fc->rows)
+    return FALSE;
+
+  fc->lengths= (ulong *)(fc->rows + rows);
+  fc->row_res= (SQLRETURN *)(fc->lengths + rows * field_count);
+  fc->filled= (char *)(fc->row_res + rows);
+
+  /* Read ahead without counting, the row loop counts the rows it fetches */
+  start= mysql_row_tell(stmt->result);
+
+  for (fc->count= 0; fc->count < rows; ++fc->count)
+  {
+    ulong *lengths;
+
+    if (!(fc->rows[fc->count]= mysql_fetch_row(stmt->result)) ||
+        !(lengths= mysql_fetch_lengths(stmt->result)))
+    {
+      break;
+    }
+
+    memcpy(fc->lengths + fc->count * field_count, lengths,
+           field_count * sizeof(ulong));
+  }
+
+  mysql_row_seek(stmt->result, start);
+
+  for (column= 0; column < columns; ++column)
+  {
+    DESCREC *arrec= desc_get_rec(stmt->ard, column, FALSE);
+    enum fetch_column_kind kind;
+    SQLCHAR *target;
+    SQLLEN *indicator= NULL, size;
+
+    if (!ARD_IS_BOUND(arrec) ||
+        (kind= fetch_column_kind(stmt, column, arrec)) == FETCH_COLUMN_NONE)
+    {
+      continue;
+    }
+
+    fc->filled[column]= 1;
+
+    /* Column-wise binding: the buffers of the rows follow each other */
+    target= (SQLCHAR *)ptr_offset_adjust(arrec->data_ptr,
+                                         stmt->ard->bind_offset_ptr,
+                                         SQL_BIND_BY_COLUMN, 0, 0);
+    size= arrec->octet_length;
+
+    if (arrec->octet_length_ptr)
+    {
+      indicator= (SQLLEN *)ptr_offset_adjust(arrec->octet_length_ptr,
+                                             stmt->ard->bind_offset_ptr,
+                                             SQL_BIND_BY_COLUMN, 0, 0);
+    }
+
+    for (row= 0; row < fc->count; ++row, target+= size)
+    {
+      char *value= fc->rows[row][column];
+      ulong length= fc->lengths[row * field_count + column];
+      ulonglong magnitude;
+      my_bool negative;
+
+      /* NULL without an indicator is an error sql_get_data() reports */
+      if (!value)
+      {
+        if (indicator)
+          indicator[row]= SQL_NULL_DATA;
+        else
+          fill_fetch_cell(stmt, fc, column, arrec, row);
+        continue;
+      }
+
+      switch (kind)
+      {
+      case FETCH_COLUMN_INT:
+        /* Anything out of the ordinary, like 22003, is sql_get_data()'s */
+        if (myodbc_parse_int(value, length, &magnitude, &negative) !=
+              MYODBC_INT_OK ||
+            !int_fits_ctype(arrec->concise_type, magnitude, negative))
+        {
+          fill_fetch_cell(stmt, fc, column, arrec, row);
+        }
+        else if (arrec->concise_type == SQL_C_SBIGINT)
+        {
+          *(ulonglong *)target= negative ? 0 - magnitude : magnitude;
+          if (indicator)
+            indicator[row]= sizeof(longlong);
+        }
+        else
+        {
+          *(SQLUINTEGER *)target= (SQLUINTEGER)(negative ? 0 - magnitude
+                                                         : magnitude);
+          if (indicator)
+            indicator[row]= sizeof(SQLINTEGER);
+        }
+        break;
+
+      case FETCH_COLUMN_REAL:
+        {
+          long double real;
+
+          /* Exact for integers, same as strtold() of their text */
+          if (myodbc_parse_int(value, length, &magnitude, &negative) ==
+              MYODBC_INT_OK)
+            real= negative ? -(long double)magnitude : (long double)magnitude;
+          else
+            real= myodbc_strtold(value, NULL);
+
+          if (arrec->concise_type == SQL_C_FLOAT)
+          {
+            *(float *)target= (float)real;
+            if (indicator)
+              indicator[row]= sizeof(float);
+          }
+          else
+          {
+            *(double *)target= (double)real;
+            if (indicator)
+              indicator[row]= sizeof(double);
+          }
+        }
+        break;
+
+      case FETCH_COLUMN_DATE:
+        if (!str_to_date((SQL_DATE_STRUCT *)target, value, length,
+                         stmt->dbc->ds->zero_date_to_min))
+        {
+          if (indicator)
+            indicator[row]= sizeof(SQL_DATE_STRUCT);
+        }
+        else if (indicator)
+        {
+          indicator[row]= SQL_NULL_DATA;  /* ODBC can't handle 0000-00-00 dates */
+        }
+        break;
+
+      default:
+        break;
+      }
+    }
+  }
+
+  PERF_ADD(stmt, PERF_FETCH_NS, perf_clock_ns() - started);
+
+  return TRUE;
+}
+
+
 /**
   Populate a single row of fetch buffers
 
   @param[in]  stmt        Handle of statement
   @param[in]  values      Row buffers from libmysql
   @param[in]  rownum      Row number of current fetch block
+  @param[in]  filled      Columns fill_fetch_columns() has filled, or NULL
 */
 static SQLRETURN
-fill_fetch_buffers(STMT *stmt, MYSQL_ROW values, uint rownum)
+fill_fetch_buffers(STMT *stmt, MYSQL_ROW values, uint rownum,
+                   const char *filled)
 {
   SQLRETURN res= SQL_SUCCESS, tmp_res;
   int i;
   ulong length= 0;
   DESCREC *irrec, *arrec;
+  long long started= perf_clock_ns();
 
   for (i= 0; i < myodbc_min(stmt->ird->count, stmt->ard->count); ++i, ++values)
   {
@@ -1803,7 +2222,7 @@ fill_fetch_buffers(STMT *stmt, MYSQL_ROW values, uint rownum)
     arrec= desc_get_rec(stmt->ard, i, FALSE);
     assert(irrec && arrec);
 
-    if (ARD_IS_BOUND(arrec))
+    if (ARD_IS_BOUND(arrec) && !(filled && filled[i]))
     {
       SQLLEN *pcbValue= NULL;
       SQLPOINTER TargetValuePtr= NULL;
@@ -1840,21 +2259,12 @@ fill_fetch_buffers(STMT *stmt, MYSQL_ROW values, uint rownum)
       tmp_res= sql_get_data(stmt, arrec->concise_type, (uint)i,
                             TargetValuePtr, arrec->octet_length, pcbValue,
                             *values, length, arrec);
-      if (tmp_res != SQL_SUCCESS)
-      {
-        if (tmp_res == SQL_SUCCESS_WITH_INFO)
-        {
-          if (res == SQL_SUCCESS)
-            res= tmp_res;
-        }
-        else
-        {
-          res= SQL_ERROR;
-        }
-      }
+      res= merge_fill_result(res, tmp_res);
     }
   }
 
+  PERF_ADD(stmt, PERF_FETCH_NS, perf_clock_ns() - started);
+
   return res;
 }
 
@@ -2098,7 +2508,7 @@ SQLRETURN SQL_API myodbc_single_fetch( SQLHSTMT             hstmt,
                               stmt->result->field_count);
     }
 
-    row_res= fill_fetch_buffers(stmt, values, cur_row);
+    row_res= fill_fetch_buffers(stmt, values, cur_row, NULL);
 
     /* For SQL_SUCCESS we need all rows to be SQL_SUCCESS */
     if (res != row_res)
@@ -2216,10 +2626,16 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
     SQLULEN           dummy_pcrow;
     BOOL              disconnected= FALSE;
     long              brow= 0;
+    FETCH_COLUMNS     columns;
+    my_bool           columns_filled;
 
     if ( !stmt->result )
       return set_stmt_error(stmt, "24000", "Fetch without a SELECT", 0);
 
+    /* A streamed result has to be read to the end by MySQLFetchColumns() */
+    if (stmt->columnar_pending)
+      return set_error(stmt, MYERR_S1010, NULL, 0);
+
     if (stmt->out_params_state != OPS_UNKNOWN)
     {
       switch(stmt->out_params_state)
@@ -2395,6 +2811,8 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
       setlocale(LC_NUMERIC, "C");
     }
 
+    columns_filled= fill_fetch_columns(stmt, rows_to_fetch, &columns);
+
     res= SQL_SUCCESS;
     for (i= 0 ; i < rows_to_fetch ; ++i)
     {
@@ -2483,7 +2901,13 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
       {
         row_book= fill_fetch_bookmark_buffers(stmt, irow + i + 1, i);
       }
-      row_res= fill_fetch_buffers(stmt, values, i);
+      row_res= fill_fetch_buffers(stmt, values, i,
+                                  columns_filled ? columns.filled : NULL);
+
+      if (columns_filled && i < columns.count)
+      {
+        row_res= merge_fill_result(row_res, columns.row_res[i]);
+      }
 
       /* For SQL_SUCCESS we need all rows to be SQL_SUCCESS */
       if (res != row_res || res != row_book)
@@ -2523,6 +2947,11 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
       ++cur_row;
     }   /* fetching cycle end*/
 
+    if (columns_filled)
+    {
+      x_free(columns.rows);
+    }
+
     stmt->rows_found_in_set= i;
     *pcrow= i;
 
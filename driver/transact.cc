@@ -80,6 +80,10 @@ static SQLRETURN my_transact(SQLHDBC hdbc, SQLSMALLINT CompletionType)
 			     mysql_error(&dbc->mysql),
 			     mysql_errno(&dbc->mysql));
     }
+    else
+    {
+      PERF_DBC_ADD(dbc, PERF_ROUND_TRIPS, 1);
+    }
     myodbc_mutex_unlock(&dbc->lock);
   }
   return(result);
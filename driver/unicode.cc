@@ -797,6 +797,35 @@ SQLGetStmtAttrW(SQLHSTMT hstmt, SQLINTEGER attribute, SQLPOINTER value,
 {
   CHECK_HANDLE(hstmt);
 
+  /* The only string attribute, made up of ASCII characters */
+  if (attribute == SQL_ATTR_MYSQL_PERF_COUNTERS)
+  {
+    SQLCHAR buff[PERF_COUNTERS_TEXT_SIZE];
+    SQLINTEGER len, i;
+    SQLRETURN rc= MySQLGetStmtAttr(hstmt, attribute, buff, sizeof(buff),
+                                   &len);
+
+    /* value_max is in bytes, we want it in chars. */
+    value_max/= sizeof(SQLWCHAR);
+
+    if (value && value_max > 0)
+    {
+      for (i= 0; i < len && i < value_max - 1; ++i)
+      {
+        ((SQLWCHAR *)value)[i]= buff[i];
+      }
+      ((SQLWCHAR *)value)[i]= 0;
+    }
+
+    if (len > value_max - 1)
+      rc= set_error((STMT *)hstmt, MYERR_01004, NULL, 0);
+
+    if (value_len)
+      *value_len= len * sizeof(SQLWCHAR);
+
+    return rc;
+  }
+
   return MySQLGetStmtAttr(hstmt, attribute, value, value_max, value_len);
 }
 
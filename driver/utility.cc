@@ -62,7 +62,16 @@ SQLRETURN exec_stmt_query(STMT *stmt, const char *query,
     return rc;
   }
 
-  return odbc_stmt(stmt->dbc, query, query_length, req_lock);
+  if (SQL_SUCCEEDED(rc= odbc_stmt(stmt->dbc, query, query_length, req_lock)))
+  {
+    /* odbc_stmt() has counted it for the connection */
+    ++stmt->perf[PERF_ROUND_TRIPS];
+    ++stmt->perf[PERF_HIDDEN_ROUND_TRIPS];
+    stmt->perf[PERF_BYTES_SENT]+= query_length == SQL_NTS ? strlen(query) :
+                                                             query_length;
+  }
+
+  return rc;
 }
 
 
@@ -98,6 +107,12 @@ SQLRETURN odbc_stmt(DBC *dbc, const char *query,
     result= set_conn_error(dbc,MYERR_S1000,mysql_error(&dbc->mysql),
                            mysql_errno(&dbc->mysql));
   }
+  else
+  {
+    PERF_DBC_ADD(dbc, PERF_ROUND_TRIPS, 1);
+    PERF_DBC_ADD(dbc, PERF_HIDDEN_ROUND_TRIPS, 1);
+    PERF_DBC_ADD(dbc, PERF_BYTES_SENT, query_length);
+  }
 
   if (req_lock)
   {
@@ -184,7 +199,7 @@ void fix_result_types(STMT *stmt)
     /* TODO function for this */
     field= result->fields + i;
 
-    irrec->row.field= field;
+    fix_row_charsets(stmt, irrec, field);
     irrec->type= get_sql_data_type(stmt, field, NULL);
     irrec->concise_type= get_sql_data_type(stmt, field,
                                            (char *)irrec->row.type_name);
@@ -354,6 +369,34 @@ void fix_result_types(STMT *stmt)
 }
 
 
+/**
+  Resolves the character sets of a column's data for the conversions to
+  SQL_C_CHAR and SQL_C_WCHAR, so that it is done once for the result set
+  and not for every value.
+
+  @param[in]     stmt   The statement
+  @param[in,out] irrec  IRD record of the column
+  @param[in]     field  The column
+*/
+void fix_row_charsets(STMT *stmt, DESCREC *irrec, MYSQL_FIELD *field)
+{
+  /* Binary function results are UTF-8 if they are to be read as text */
+  my_bool convert_binary= field->charsetnr == BINARY_CHARSET_NUMBER &&
+                          field->org_table_length == 0 &&
+                          stmt->dbc->ds->handle_binary_as_char;
+
+  irrec->row.field= field;
+  irrec->row.ansi_cs= get_charset(field->charsetnr && !convert_binary ?
+                                  field->charsetnr : UTF8_CHARSET_NUMBER,
+                                  MYF(0));
+  irrec->row.wchar_cs= get_charset(field->charsetnr ? field->charsetnr :
+                                   UTF8_CHARSET_NUMBER, MYF(0));
+  irrec->row.ansi_as_is= irrec->row.ansi_cs &&
+                         irrec->row.ansi_cs->number ==
+                           stmt->dbc->ansi_charset_info->number;
+}
+
+
 /**
   Change a string with a length to a NUL-terminated string.
 
@@ -469,7 +512,7 @@ copy_binary_result(STMT *stmt,
   @param[in]     result_bytes Size of result buffer (in bytes)
   @param[out]    avail_bytes  Pointer to buffer for storing number of bytes
                               available as result
-  @param[in]     field        Field being stored
+  @param[in]     irrec        IRD record of the field being stored
   @param[in]     src          Source data for result
   @param[in]     src_bytes    Length of source data (in bytes)
 
@@ -478,21 +521,17 @@ copy_binary_result(STMT *stmt,
 SQLRETURN
 copy_ansi_result(STMT *stmt,
                  SQLCHAR *result, SQLLEN result_bytes, SQLLEN *avail_bytes,
-                 MYSQL_FIELD *field, char *src, unsigned long src_bytes)
+                 DESCREC *irrec, char *src, unsigned long src_bytes)
 {
   SQLRETURN rc= SQL_SUCCESS;
   char *src_end;
   SQLCHAR *result_end;
   ulong used_bytes= 0, used_chars= 0, error_count= 0;
+  const TRANSCODER *tc;
 
-  my_bool convert_binary= (field->charsetnr == BINARY_CHARSET_NUMBER ? 1 : 0) &&
-                          (field->org_table_length == 0 ? 1 : 0) &&
-                          stmt->dbc->ds->handle_binary_as_char;
-
+  MYSQL_FIELD *field= irrec->row.field;
   CHARSET_INFO *to_cs= stmt->dbc->ansi_charset_info,
-               *from_cs= get_charset(field->charsetnr && (!convert_binary) ?
-                                     field->charsetnr : UTF8_CHARSET_NUMBER,
-                                     MYF(0));
+               *from_cs= irrec->row.ansi_cs;
 
   if (!from_cs)
     return set_stmt_error(stmt, "07006", "Source character set not "
@@ -505,7 +544,7 @@ copy_ansi_result(STMT *stmt,
    If we don't have to do any charset conversion, we can just use
    copy_binary_result() and NUL-terminate the buffer here.
   */
-  if (to_cs->number == from_cs->number)
+  if (irrec->row.ansi_as_is)
   {
     SQLLEN bytes;
     if (!avail_bytes)
@@ -589,6 +628,55 @@ copy_ansi_result(STMT *stmt,
     stmt->getdata.latest_used+= new_bytes;
   }
 
+  /*
+    Into a single-byte character set every character is one byte, so the
+    transcoder of the pair can do the part that fits and count the rest.
+    Whatever it stops at is left to the loop below.
+  */
+  if (stmt->stmt_options.retrieve_data &&
+      (tc= get_transcoder(from_cs, to_cs)) != NULL)
+  {
+    uint32 bytes, chars, count;
+    uint errors= 0;
+
+    if (result)
+    {
+      count= transcode(tc, (char *)result, (uint32)(result_end - result),
+                       src, (uint32)(src_end - src), &bytes, &chars, &errors);
+      result+= count;
+      used_bytes+= count;
+      used_chars+= chars;
+      src+= bytes;
+      stmt->getdata.source+= bytes;
+
+      if (result == result_end)
+      {
+        /* The length is known from the first call, nothing to count */
+        if (stmt->getdata.dst_bytes != (ulong)~0L)
+          src_end= src;
+
+        *result= '\0';
+        result= NULL;
+      }
+    }
+
+    while (!result && src < src_end)
+    {
+      char buff[256];
+
+      if (!(count= transcode(tc, buff, sizeof(buff), src,
+                             (uint32)(src_end - src), &bytes, &chars,
+                             &errors)))
+        break;
+
+      used_bytes+= count;
+      used_chars+= chars;
+      src+= bytes;
+    }
+
+    error_count+= errors;
+  }
+
   while (src < src_end)
   {
     /* Find the conversion functions. */
@@ -746,7 +834,7 @@ convert_to_out:
   @param[in]     result_len  Size of result buffer (in characters)
   @param[out]    avail_bytes Pointer to buffer for storing amount of data
                              available before this call
-  @param[in]     field       Field being stored
+  @param[in]     irrec       IRD record of the field being stored
   @param[in]     src         Source data for result
   @param[in]     src_bytes   Length of source data (in bytes)
 
@@ -755,15 +843,13 @@ convert_to_out:
 SQLRETURN
 copy_wchar_result(STMT *stmt,
                   SQLWCHAR *result, SQLINTEGER result_len, SQLLEN *avail_bytes,
-                  MYSQL_FIELD *field, char *src, long src_bytes)
+                  DESCREC *irrec, char *src, long src_bytes)
 {
   SQLRETURN rc= SQL_SUCCESS;
   char *src_end;
   SQLWCHAR *result_end;
   ulong used_chars= 0, error_count= 0;
-  CHARSET_INFO *from_cs= get_charset(field->charsetnr ? field->charsetnr :
-                                     UTF8_CHARSET_NUMBER,
-                                     MYF(0));
+  CHARSET_INFO *from_cs= irrec->row.wchar_cs;
 
   if (!from_cs)
     return set_stmt_error(stmt, "07006", "Source character set not "
@@ -983,10 +1069,6 @@ SQLRETURN copy_binhex_result(STMT *stmt,
     ulong length;
     ulong max_length= stmt->stmt_options.max_length;
     ulong *offset= &stmt->getdata.src_offset;
-#if MYSQL_VERSION_ID >= 40100
-    char NEAR _dig_vec[] =
-    "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-#endif
 
     if ( !cbValueMax )
         dst= 0;  /* Don't copy anything! */
@@ -1008,13 +1090,8 @@ SQLRETURN copy_binhex_result(STMT *stmt,
         *pcbValue= src_length*2;
     if ( dst && stmt->stmt_options.retrieve_data )  /* Bind allows null pointers */
     {
-        ulong i;
-        for ( i= 0 ; i < length ; ++i )
-        {
-            *dst++= _dig_vec[(uchar) *src >> 4];
-            *dst++= _dig_vec[(uchar) *src++ & 15];
-        }
-        *dst= 0;
+        myodbc_hex_encode(dst, src, length);
+        dst[length * 2]= 0;
     }
     if ( (ulong) cbValueMax > length*2 )
         return SQL_SUCCESS;
@@ -1993,6 +2070,132 @@ SQLLEN get_bookmark_value(SQLSMALLINT fCType, SQLPOINTER rgbValue)
 }
 
 
+/*
+  Byte layouts of the 8 character windows of the canonical
+  "YYYY-MM-DD HH:MM:SS" text, loaded in little-endian order: the mask
+  selects the separator bytes and the value holds the expected separators.
+*/
+#define DT_YEAR_MONTH_MASK  0xFF0000FF00000000ULL  /* "YYYY-MM-" */
+#define DT_YEAR_MONTH_SEPS  0x2D00002D00000000ULL
+#define DT_DAY_MINUTE_MASK  0x0000FF0000FF0000ULL  /* "DD HH:MM" */
+#define DT_DAY_MINUTE_SEPS  0x00003A0000200000ULL
+#define DT_TIME_MASK        0x0000FF0000FF0000ULL  /* "HH:MM:SS" */
+#define DT_TIME_SEPS        0x00003A00003A0000ULL
+
+#define DT_BYTE(word, n) ((uint) ((word) >> ((n) * 8)) & 0xFF)
+
+/*
+  Checks 8 characters of a date/time string against a layout in one go:
+  separator positions must hold exactly the given characters and all
+  others must be digits. On success *pairs gets the value of the two digit
+  number starting at each position in the corresponding byte, so
+  DT_BYTE(*pairs, n) is the field that starts at character n.
+*/
+static inline my_bool load_datetime_digits(const char *str, ulonglong mask,
+                                           ulonglong seps, ulonglong *pairs)
+{
+  const uchar *s= (const uchar *) str;
+  ulonglong word= (ulonglong) s[0]       | (ulonglong) s[1] << 8  |
+                  (ulonglong) s[2] << 16 | (ulonglong) s[3] << 24 |
+                  (ulonglong) s[4] << 32 | (ulonglong) s[5] << 40 |
+                  (ulonglong) s[6] << 48 | (ulonglong) s[7] << 56;
+
+  if ((word & mask) != seps)
+  {
+    return FALSE;
+  }
+
+  /* Treat separators as '0' so that every byte must be in '0'..'9' */
+  word= (word & ~mask) | (0x3030303030303030ULL & mask);
+
+  if ((word & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL ||
+      ((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) !=
+        0x3030303030303030ULL)
+  {
+    return FALSE;
+  }
+
+  word-= 0x3030303030303030ULL;
+  *pairs= word * 10 + (word >> 8);
+
+  return TRUE;
+}
+
+
+/*
+  Decodes the text the server sends for DATE, DATETIME and TIMESTAMP
+  values: "YYYY-MM-DD" or "YYYY-MM-DD HH:MM:SS" with an optional fraction
+  of up to 9 digits. The server always writes the fraction after a '.',
+  whatever the locale decimal point is. Returns FALSE for anything else,
+  which is left to the tolerant parser in str_to_ts().
+*/
+static my_bool canonical_str_to_ts(SQL_TIMESTAMP_STRUCT *ts, const char *str,
+                                   int len)
+{
+  ulonglong date, day_minute, hms;
+
+  if (len < 10 ||
+      !load_datetime_digits(str, DT_YEAR_MONTH_MASK, DT_YEAR_MONTH_SEPS,
+                            &date))
+  {
+    return FALSE;
+  }
+
+  ts->year=  DT_BYTE(date, 0) * 100 + DT_BYTE(date, 2);
+  ts->month= DT_BYTE(date, 5);
+  ts->fraction= 0;
+
+  if (len == 10)
+  {
+    if (!isdigit(str[8]) || !isdigit(str[9]))
+    {
+      return FALSE;
+    }
+    ts->day= digit(str[8]) * 10 + digit(str[9]);
+    ts->hour= ts->minute= ts->second= 0;
+
+    return TRUE;
+  }
+
+  if (len < 19 ||
+      !load_datetime_digits(str + 8, DT_DAY_MINUTE_MASK, DT_DAY_MINUTE_SEPS,
+                            &day_minute) ||
+      !load_datetime_digits(str + 11, DT_TIME_MASK, DT_TIME_SEPS, &hms))
+  {
+    return FALSE;
+  }
+
+  ts->day=    DT_BYTE(day_minute, 0);
+  ts->hour=   DT_BYTE(day_minute, 3);
+  ts->minute= DT_BYTE(day_minute, 6);
+  ts->second= DT_BYTE(hms, 6);
+
+  if (len > 19)
+  {
+    const char *pos= str + 20, *end= str + len;
+    SQLUINTEGER fraction= 0, scale= 1000000000;
+
+    if (str[19] != '.' || len == 20 || len > 29)
+    {
+      return FALSE;
+    }
+
+    for (; pos < end; ++pos)
+    {
+      if (!isdigit(*pos))
+      {
+        return FALSE;
+      }
+      scale/= 10;
+      fraction+= digit(*pos) * scale;
+    }
+    ts->fraction= fraction;
+  }
+
+  return TRUE;
+}
+
+
 /*
   @type    : myodbc internal
   @purpose : convert a possible string to a timestamp value
@@ -2018,6 +2221,23 @@ int str_to_ts(SQL_TIMESTAMP_STRUCT *ts, const char *str, int len, int zeroToMin,
       len= strlen(str);
     }
 
+    if (canonical_str_to_ts(&tmp_timestamp, str, len))
+    {
+      if (!tmp_timestamp.month || !tmp_timestamp.day)
+      {
+        if (!zeroToMin) /* Don't convert invalid */
+          return SQLTS_NULL_DATE;
+
+        if (!tmp_timestamp.month)
+          tmp_timestamp.month= 1;
+        if (!tmp_timestamp.day)
+          tmp_timestamp.day= 1;
+      }
+
+      *ts= tmp_timestamp;
+      return 0;
+    }
+
     /* We don't wan to change value in the out parameter directly
        before we know that string is a good datetime */
     end= get_fractional_part(str, len, dont_use_set_locale, &fraction);
@@ -2112,6 +2332,22 @@ my_bool str_to_time_st(SQL_TIME_STRUCT *ts, const char *str)
     if ( !ts )
         ts= (SQL_TIME_STRUCT *) &tmp_time;
 
+    /* Canonical "HH:MM:SS[.fraction]" of a TIME value within a day */
+    if (memchr(str, 0, 8) == NULL && (str[8] == 0 || str[8] == '.'))
+    {
+      ulonglong hms;
+
+      if (load_datetime_digits(str, DT_TIME_MASK, DT_TIME_SEPS, &hms) &&
+          DT_BYTE(hms, 3) < 60 && DT_BYTE(hms, 6) < 60)
+      {
+        ts->hour=   DT_BYTE(hms, 0);
+        ts->minute= DT_BYTE(hms, 3);
+        ts->second= DT_BYTE(hms, 6);
+
+        return 0;
+      }
+    }
+
     /* remember the position of the first numeric string */
     tokens[0]= buff;
 
@@ -2161,6 +2397,100 @@ my_bool str_to_time_st(SQL_TIME_STRUCT *ts, const char *str)
     return 0;
 }
 
+/*
+  Value of the 8 decimal digits at str, or FALSE if one of them is not a
+  digit. The characters are loaded like in load_datetime_digits() and then
+  folded into pairs, groups of 4 and finally the whole number, every step
+  combining all neighbouring groups with one multiplication.
+*/
+static inline my_bool load_int_digits(const char *str, ulonglong *value)
+{
+  const uchar *s= (const uchar *) str;
+  ulonglong word= (ulonglong) s[0]       | (ulonglong) s[1] << 8  |
+                  (ulonglong) s[2] << 16 | (ulonglong) s[3] << 24 |
+                  (ulonglong) s[4] << 32 | (ulonglong) s[5] << 40 |
+                  (ulonglong) s[6] << 48 | (ulonglong) s[7] << 56;
+
+  if ((word & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL ||
+      ((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) !=
+        0x3030303030303030ULL)
+  {
+    return FALSE;
+  }
+
+  word-= 0x3030303030303030ULL;
+  word= (word * 10 + (word >> 8)) & 0x00FF00FF00FF00FFULL;
+  word= (word * 100 + (word >> 16)) & 0x0000FFFF0000FFFFULL;
+  *value= (word * 10000 + (word >> 32)) & 0xFFFFFFFFULL;
+
+  return TRUE;
+}
+
+
+/*
+  Parses the text the server sends for integer values: an optional sign
+  and up to 20 significant digits, nothing else. Returns MYODBC_INT_OK with
+  the absolute value and the sign, MYODBC_INT_OVERFLOW (and the largest
+  magnitude) if the number does not fit into 64 bits, or MYODBC_INT_INVALID
+  for any other text, which is left to the caller's strtoll().
+*/
+int myodbc_parse_int(const char *str, ulong length, ulonglong *magnitude,
+                     my_bool *negative)
+{
+  const char *end= str + length, *first;
+  ulonglong value= 0, chunk;
+
+  *negative= FALSE;
+
+  if (str != end && (*str == '-' || *str == '+'))
+  {
+    *negative= *str++ == '-';
+  }
+
+  if (str == end)
+  {
+    return MYODBC_INT_INVALID;
+  }
+
+  /* Leading zeros of ZEROFILL columns do not count */
+  while (end - str > 1 && *str == '0')
+  {
+    ++str;
+  }
+
+  for (first= str; end - str >= 8; str+= 8)
+  {
+    if (!load_int_digits(str, &chunk))
+    {
+      return MYODBC_INT_INVALID;
+    }
+    value= value * 100000000 + chunk;
+  }
+
+  for (; str != end; ++str)
+  {
+    uint digit= (uchar) *str - '0';
+
+    if (digit > 9)
+    {
+      return MYODBC_INT_INVALID;
+    }
+    value= value * 10 + digit;
+  }
+
+  /* 19 digits always fit, 20 only up to the largest unsigned value */
+  if (end - first > 20 ||
+      (end - first == 20 && memcmp(first, "18446744073709551615", 20) > 0))
+  {
+    *magnitude= ULLONG_MAX;
+    return MYODBC_INT_OVERFLOW;
+  }
+
+  *magnitude= value;
+  return MYODBC_INT_OK;
+}
+
+
 /*
   @type    : myodbc internal
   @purpose : convert a possible string to a data value. if
@@ -2174,6 +2504,27 @@ my_bool str_to_date(SQL_DATE_STRUCT *rgbValue, const char *str,
     uint field_length,year_length,digits,i,date[3];
     const char *pos;
     const char *end= str+length;
+    ulonglong year_month;
+
+    /* Canonical "YYYY-MM-DD", possibly followed by the time */
+    if (length >= 10 && isdigit(str[8]) && isdigit(str[9]) &&
+        load_datetime_digits(str, DT_YEAR_MONTH_MASK, DT_YEAR_MONTH_SEPS,
+                             &year_month))
+    {
+      date[0]= DT_BYTE(year_month, 0) * 100 + DT_BYTE(year_month, 2);
+      date[1]= DT_BYTE(year_month, 5);
+      date[2]= digit(str[8]) * 10 + digit(str[9]);
+
+      if ((!date[1] || !date[2]) && !zeroToMin)
+        return 1;
+
+      rgbValue->year=  date[0];
+      rgbValue->month= date[1] ? date[1] : 1;
+      rgbValue->day=   date[2] ? date[2] : 1;
+
+      return 0;
+    }
+
     for ( ; !isdigit(*str) && str != end ; ++str ) ;
     /*
       Calculate first number of digits.
@@ -2273,13 +2624,25 @@ ulong str_to_time_as_long(const char *str, uint length)
 */
 
 int check_if_server_is_alive( DBC *dbc )
+{
+    return check_if_mysql_is_alive( &dbc->mysql, &dbc->last_query_time );
+}
+
+
+/*
+  @type    : myodbc internal
+  @purpose : the check_if_server_is_alive() logic for any connection of the
+  DBC, i.e. for the primary as well as for the read replicas
+*/
+
+int check_if_mysql_is_alive( MYSQL *mysql, time_t *last_query_time )
 {
     time_t seconds= (time_t) time( (time_t*)0 );
     int result= 0;
 
-    if ( (ulong)(seconds - dbc->last_query_time) >= CHECK_IF_ALIVE )
+    if ( (ulong)(seconds - *last_query_time) >= CHECK_IF_ALIVE )
     {
-        if ( mysql_ping( &dbc->mysql ) )
+        if ( mysql_ping( mysql ) )
         {
             /*  BUG: 14639
 
@@ -2296,16 +2659,150 @@ int check_if_server_is_alive( DBC *dbc )
                 PAH - 9.MAR.06
             */
 
-            if ( mysql_errno( &dbc->mysql ) == CR_SERVER_LOST )
+            if ( mysql_errno( mysql ) == CR_SERVER_LOST )
                 result = 1;
         }
     }
-    dbc->last_query_time = seconds;
+    *last_query_time = seconds;
 
     return result;
 }
 
 
+/**
+  Format the compression statistics of the connection into
+  dbc->compression_stats, which is what SQL_ATTR_MYSQL_COMPRESSION_STATS
+  returns.
+
+  The payload counters are kept by the driver: query text sent and row
+  data read. The wire counters are the server's Bytes_received and
+  Bytes_sent for the session, i.e. what went over the socket after
+  compression, protocol overhead included.
+
+  @param[in] dbc  The connection
+
+  @return SQL_SUCCESS, or SQL_ERROR with the error set on the connection
+*/
+SQLRETURN get_compression_stats(DBC *dbc)
+{
+  MYSQL_RES *res;
+  MYSQL_ROW  row;
+  const char *wire_sent= "0", *wire_received= "0",
+             *compression= "OFF", *algorithm= "", *level= "";
+  SQLRETURN rc;
+
+  myodbc_mutex_lock(&dbc->lock);
+
+  rc= odbc_stmt(dbc, "SHOW SESSION STATUS WHERE Variable_name IN "
+                "('Bytes_received','Bytes_sent','Compression',"
+                "'Compression_algorithm','Compression_level')",
+                SQL_NTS, FALSE);
+
+  if (!SQL_SUCCEEDED(rc) || !(res= mysql_store_result(&dbc->mysql)))
+  {
+    myodbc_mutex_unlock(&dbc->lock);
+    return SQL_SUCCEEDED(rc) ? set_conn_error(dbc, MYERR_S1000,
+                                              mysql_error(&dbc->mysql),
+                                              mysql_errno(&dbc->mysql)) : rc;
+  }
+
+  while ((row= mysql_fetch_row(res)))
+  {
+    if (!row[1])
+      continue;
+    /* The server counts in its own direction */
+    if (!myodbc_strcasecmp(row[0], "Bytes_received"))
+      wire_sent= row[1];
+    else if (!myodbc_strcasecmp(row[0], "Bytes_sent"))
+      wire_received= row[1];
+    else if (!myodbc_strcasecmp(row[0], "Compression"))
+      compression= row[1];
+    else if (!myodbc_strcasecmp(row[0], "Compression_algorithm"))
+      algorithm= row[1];
+    else if (!myodbc_strcasecmp(row[0], "Compression_level"))
+      level= row[1];
+  }
+
+  myodbc_snprintf(dbc->compression_stats, sizeof(dbc->compression_stats),
+                  "compression=%s;algorithm=%s;level=%s;"
+                  "payload_sent=%llu;payload_received=%llu;"
+                  "wire_sent=%s;wire_received=%s",
+                  compression, algorithm, level,
+                  dbc->perf[PERF_BYTES_SENT].load(std::memory_order_relaxed),
+                  dbc->perf[PERF_BYTES_RECEIVED].load(std::memory_order_relaxed),
+                  wire_sent, wire_received);
+
+  mysql_free_result(res);
+  myodbc_mutex_unlock(&dbc->lock);
+
+  return SQL_SUCCESS;
+}
+
+
+/**
+  Counts the memory taken by the result just stored for the statement
+  towards the store_result_peak counter.
+*/
+void perf_count_stored_result(STMT *stmt)
+{
+  MEM_ROOT *alloc= NULL;
+  unsigned long long size;
+
+  if (ssps_used(stmt))
+  {
+    alloc= stmt->ssps->result.alloc;
+  }
+  else if (stmt->result && stmt->result->data)
+  {
+    alloc= stmt->result->data->alloc;
+  }
+
+  if (alloc == NULL)
+  {
+    return;
+  }
+
+  size= alloc->allocated_size();
+
+  if (size > stmt->perf[PERF_STORE_RESULT_PEAK])
+  {
+    stmt->perf[PERF_STORE_RESULT_PEAK]= size;
+  }
+  perf_counter_peak(&stmt->dbc->perf[PERF_STORE_RESULT_PEAK], size);
+}
+
+
+/**
+  Appends the counters of the connection to the PERF_COUNTERS_FILE of its
+  data source, if one is set, and starts them over. Called at disconnect,
+  while the connection is still open.
+*/
+void perf_counters_dump(DBC *dbc)
+{
+  unsigned long long values[PERF_COUNTER_COUNT];
+  const char *filename;
+  FILE *file;
+
+  perf_counters_load(dbc->perf, values);
+  perf_counters_reset(dbc->perf);
+
+  if (!dbc->ds || !dbc->ds->perf_counters_file ||
+      !(filename= ds_get_utf8attr(dbc->ds->perf_counters_file,
+                                  &dbc->ds->perf_counters_file8)) ||
+      !(file= fopen(filename, "a")))
+  {
+    return;
+  }
+
+  perf_counters_format(dbc->perf_counters, sizeof(dbc->perf_counters),
+                       values);
+  fprintf(file, "time=%lld;connection_id=%lu;%s\n",
+          (long long)time(NULL), mysql_thread_id(&dbc->mysql),
+          dbc->perf_counters);
+  fclose(file);
+}
+
+
 /*
   @type    : myodbc3 internal
   @purpose : appends quoted string to dynamic string
@@ -2427,81 +2924,141 @@ void free_internal_result_buffers(STMT *stmt)
 
 /*
   @type    : myodbc3 internal
-  @purpose : logs the queries sent to server
+  @purpose : logs the text of a query sent to server
 */
 
-void query_print(FILE *log_file,char *query)
+void query_log_statement(DBC *dbc, const char *query)
 {
-    if ( log_file && query )
-    {
-      /*
-        because of bug 68201 we bring the result of time() call
-        to 64-bits in any case
-      */
-      long long time_now= time(NULL);
+  QUERY_LOG_ENTRY *entry;
 
-      fprintf(log_file, "%lld:%s;\n", time_now, query);
-    }
+  if (query && (entry= query_log_entry_new(query, strlen(query),
+                                           mysql_thread_id(&dbc->mysql))))
+  {
+    query_log_add(dbc->query_log, entry);
+  }
 }
 
 
-FILE *init_query_log(void)
+/**
+  Logs a statement executed by do_query() with its latency and outcome.
+  If it produced a result, the entry is kept on the statement until the
+  result is closed, to add what the application read from it.
+
+  @param[in] stmt        The statement
+  @param[in] query       Query text sent to the server
+  @param[in] length      Length of the query text
+  @param[in] latency_us  Time the execution took
+  @param[in] rc          Result of the execution
+*/
+void query_log_executed(STMT *stmt, const char *query, SQLULEN length,
+                        long long latency_us, SQLRETURN rc)
 {
-    FILE *query_log;
-#ifdef _WIN32
-    char filename[MAX_PATH];
-    size_t buffsize;
-
-    getenv_s(&buffsize, filename, sizeof(filename), "TEMP");
-
-    if (buffsize)
-    {
-      sprintf(filename + buffsize - 1, "\\%s", DRIVER_QUERY_LOGFILE);
-    }
-    else
-    {
-      sprintf(filename, "c:\\%s", DRIVER_QUERY_LOGFILE);
-    }
+  QUERY_LOG_ENTRY *entry= query_log_entry_new(query, (size_t)length,
+                            mysql_thread_id(stmt_connection(stmt)));
 
-    if ( (query_log= fopen(filename, "a+")) )
-#else
-    if ( (query_log= fopen(DRIVER_QUERY_LOGFILE, "a+")) )
-#endif
-    {
-        fprintf(query_log,"-- Query logging\n");
-        fprintf(query_log,"--\n");
-        fprintf(query_log,"--  Driver name: %s  Version: %s\n",DRIVER_NAME,
-                DRIVER_VERSION);
-#ifdef HAVE_LOCALTIME_R
-        {
-            time_t now= time(NULL);
-            struct tm start;
-            localtime_r(&now,&start);
-
-            fprintf(query_log,"-- Timestamp: %02d%02d%02d %2d:%02d:%02d\n",
-                    start.tm_year % 100,
-                    start.tm_mon+1,
-                    start.tm_mday,
-                    start.tm_hour,
-                    start.tm_min,
-                    start.tm_sec);
-        }
-#endif /* HAVE_LOCALTIME_R */
-      fprintf(query_log,"\n");
-    }
-    return query_log;
-}
+  if (entry == NULL)
+  {
+    return;
+  }
 
+  entry->latency_us= latency_us;
+  entry->time_us-= entry->latency_us;
+  /* The execution of a prepared statement sends parameters, not the text */
+  entry->bytes_sent= ssps_used(stmt) ? -1 : (long long)length;
+  myodbc_stpmov(entry->sqlstate,
+                rc == SQL_SUCCESS ? "00000" : stmt->error.sqlstate);
 
-void end_query_log(FILE *query_log)
-{
-  if ( query_log )
+  if (stmt->replica)
   {
-      fclose(query_log);
-      query_log= 0;
+    strmake(entry->replica, stmt->replica->host, sizeof(entry->replica) - 1);
   }
-}
-
+
+  if (SQL_SUCCEEDED(rc) && stmt->result)
+  {
+    entry->rows_fetched= entry->bytes_received= 0;
+    stmt->query_log_entry= entry;
+    return;
+  }
+
+  if (SQL_SUCCEEDED(rc))
+  {
+    entry->rows_affected= (long long)stmt->affected_rows;
+  }
+
+  query_log_add(stmt->dbc->query_log, entry);
+}
+
+
+/*
+  @type    : myodbc internal
+  @purpose : logs the statement whose result has been read or discarded
+*/
+
+void query_log_result_closed(STMT *stmt)
+{
+  if (stmt->query_log_entry)
+  {
+    if (stmt->dbc->query_log)
+    {
+      query_log_add(stmt->dbc->query_log, stmt->query_log_entry);
+    }
+    else
+    {
+      query_log_entry_free(stmt->query_log_entry);
+    }
+    stmt->query_log_entry= NULL;
+  }
+}
+
+
+/**
+  Counts an executed statement against its digest. If the statement
+  produced a result, the rows and bytes the application reads from it are
+  added when the result is closed.
+
+  @param[in] stmt        The statement
+  @param[in] query       Query text sent to the server
+  @param[in] length      Length of the query text
+  @param[in] latency_us  Time the execution took
+  @param[in] rc          Result of the execution
+*/
+void digest_executed(STMT *stmt, const char *query, SQLULEN length,
+                     long long latency_us, SQLRETURN rc)
+{
+  char text[DIGEST_TEXT_LENGTH];
+  size_t text_length= query_digest(query, query + length,
+                                   stmt->dbc->cxn_charset_info,
+                                   text, sizeof(text));
+  STMT_DIGEST *digest= digest_find(stmt->dbc->digests, text, text_length);
+
+  digest_add(stmt->dbc->digests, digest, 1, !SQL_SUCCEEDED(rc),
+             (unsigned long long)latency_us,
+             SQL_SUCCEEDED(rc) && !stmt->result ? stmt->affected_rows : 0, 0);
+
+  if (SQL_SUCCEEDED(rc) && stmt->result)
+  {
+    stmt->digest= digest;
+    stmt->digest_rows= stmt->digest_bytes= 0;
+  }
+}
+
+
+/*
+  @type    : myodbc internal
+  @purpose : adds what was read from the result to the statement's digest
+*/
+
+void digest_result_closed(STMT *stmt)
+{
+  if (stmt->digest)
+  {
+    /* The environment keeps the table until all its connections are gone */
+    digest_add(stmt->dbc->env->digests, stmt->digest, 0, 0, 0,
+               stmt->digest_rows, stmt->digest_bytes);
+    stmt->digest= NULL;
+  }
+}
+
 
 my_bool is_minimum_version(const char *server_version,const char *version)
 {
@@ -2633,6 +3190,150 @@ ulong myodbc_escape_string(STMT *stmt,
 }
 
 
+/*
+  Unsigned 128-bit integer with the value of SQL_NUMERIC_STRUCT.val.
+  Compilers without a native type use a pair of 64-bit halves.
+*/
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 sqlnum_uint128;
+#else
+typedef struct
+{
+  ulonglong lo, hi;
+} sqlnum_uint128;
+#endif
+
+/* Any string of up to this many digits fits into sqlnum_uint128 */
+#define SQLNUM_INT128_DIGITS 38
+
+static const uint sqlnum_pow10[]=
+{
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+
+static inline void sqlnum_u128_set(sqlnum_uint128 *v, ulonglong value)
+{
+#ifdef __SIZEOF_INT128__
+  *v= value;
+#else
+  v->lo= value;
+  v->hi= 0;
+#endif
+}
+
+
+/**
+  Computes v * mul + add.
+
+  @return FALSE if the result does not fit into 128 bits, v is unchanged
+*/
+static inline my_bool sqlnum_u128_mul_add(sqlnum_uint128 *v, uint mul,
+                                          uint add)
+{
+#ifdef __SIZEOF_INT128__
+  if (*v > (~(sqlnum_uint128) 0 - add) / mul)
+    return FALSE;
+
+  *v= *v * mul + add;
+#else
+  ulonglong low= (v->lo & 0xFFFFFFFFULL) * mul + add;
+  ulonglong high= (v->lo >> 32) * mul + (low >> 32);
+  ulonglong carry= high >> 32;
+
+  if (v->hi > (~0ULL - carry) / mul)
+    return FALSE;
+
+  v->lo= (high << 32) | (low & 0xFFFFFFFFULL);
+  v->hi= v->hi * mul + carry;
+#endif
+  return TRUE;
+}
+
+
+/**
+  Divides v by 10.
+
+  @return The remainder
+*/
+static inline uint sqlnum_u128_divmod10(sqlnum_uint128 *v)
+{
+#ifdef __SIZEOF_INT128__
+  uint rem;
+
+  /* Most values fit into 64 bits, which divide by a multiplication */
+  if (!(*v >> 64))
+  {
+    ulonglong low= (ulonglong) *v;
+    *v= low / 10;
+    return (uint) (low % 10);
+  }
+
+  rem= (uint) (*v % 10);
+  *v/= 10;
+  return rem;
+#else
+  /* Long division by 32-bit digits */
+  ulonglong rem= v->hi % 10, part, upper;
+
+  v->hi/= 10;
+  part= (rem << 32) | (v->lo >> 32);
+  upper= part / 10;
+  rem= part % 10;
+  part= (rem << 32) | (v->lo & 0xFFFFFFFFULL);
+  v->lo= (upper << 32) | (part / 10);
+  return (uint) (part % 10);
+#endif
+}
+
+
+static inline my_bool sqlnum_u128_is_zero(const sqlnum_uint128 *v)
+{
+#ifdef __SIZEOF_INT128__
+  return *v == 0;
+#else
+  return !v->lo && !v->hi;
+#endif
+}
+
+
+/* Reads the little endian SQL_NUMERIC_STRUCT.val */
+static void sqlnum_u128_load(sqlnum_uint128 *v, const SQLCHAR *val)
+{
+  ulonglong lo= 0, hi= 0;
+  int i;
+
+  for (i= 7; i >= 0; --i)
+  {
+    lo= (lo << 8) | val[i];
+    hi= (hi << 8) | val[i + 8];
+  }
+#ifdef __SIZEOF_INT128__
+  *v= ((sqlnum_uint128) hi << 64) | lo;
+#else
+  v->lo= lo;
+  v->hi= hi;
+#endif
+}
+
+
+static void sqlnum_u128_store(const sqlnum_uint128 *v, SQLCHAR *val)
+{
+#ifdef __SIZEOF_INT128__
+  ulonglong lo= (ulonglong) *v, hi= (ulonglong) (*v >> 64);
+#else
+  ulonglong lo= v->lo, hi= v->hi;
+#endif
+  int i;
+
+  for (i= 0; i < 8; ++i)
+  {
+    val[i]= (SQLCHAR) (lo >> (i * 8));
+    val[i + 8]= (SQLCHAR) (hi >> (i * 8));
+  }
+}
+
+
 /**
   Scale an int[] representing SQL_C_NUMERIC
 
@@ -2674,24 +3375,6 @@ static void sqlnum_unscale_le(int *ary)
 }
 
 
-/**
-  Unscale an int[] representing SQL_C_NUMERIC. This
-  leaves the last element (7) with the value of the
-  last digit.
-
-  @param[in] ary   Array in big endian form
-*/
-static void sqlnum_unscale_be(int *ary, int start)
-{
-  int i;
-  for (i= start; i < 7; ++i)
-  {
-    ary[i + 1] += (ary[i] % 10) << 16;
-    ary[i] /= 10;
-  }
-}
-
-
 /**
   Perform the carry to get all elements below 2^16.
   Should be called right after sqlnum_scale().
@@ -2711,18 +3394,19 @@ static void sqlnum_carry(int *ary)
 
 
 /**
-  Retrieve a SQL_NUMERIC_STRUCT from a string. The requested scale
-  and precesion are first read from sqlnum, and then updated values
-  are written back at the end.
+  Retrieve a SQL_NUMERIC_STRUCT from a string of any length using 16-bit
+  limbs. Used by sqlnum_from_str() for what sqlnum_set_value() can't do.
 
   @param[in] numstr       String representation of number to convert
   @param[in] sqlnum       Destination struct
+  @param[in] reqscale     Requested scale
+  @param[in] reqprec      Requested precision
   @param[in] overflow_ptr Whether or not whole-number overflow occurred.
-                          This indicates failure, and the result of sqlnum
-                          is undefined.
 */
-void sqlnum_from_str(const char *numstr, SQL_NUMERIC_STRUCT *sqlnum,
-                     int *overflow_ptr)
+static void sqlnum_from_str_limbs(const char *numstr,
+                                  SQL_NUMERIC_STRUCT *sqlnum,
+                                  SQLSCHAR reqscale, SQLCHAR reqprec,
+                                  int *overflow_ptr)
 {
   /*
      We use 16 bits of each integer to convert the
@@ -2740,8 +3424,6 @@ void sqlnum_from_str(const char *numstr, SQL_NUMERIC_STRUCT *sqlnum,
   int len;
   char *decpt= strchr((char*)numstr, '.');
   int overflow= 0;
-  SQLSCHAR reqscale= sqlnum->scale;
-  SQLCHAR reqprec= sqlnum->precision;
 
   memset(&sqlnum->val, 0, sizeof(sqlnum->val));
   memset(build_up, 0, sizeof(build_up));
@@ -2866,6 +3548,180 @@ end:
 }
 
 
+/**
+  Stores a whole number of digits with the given precision and scale into
+  sqlnum, adjusted to the requested scale and checked against the
+  requested precision the same way as sqlnum_from_str_limbs() does.
+
+  @return FALSE if scaling up does not fit into 128 bits, and sqlnum is
+          left unchanged
+*/
+static my_bool sqlnum_set_value(SQL_NUMERIC_STRUCT *sqlnum,
+                                sqlnum_uint128 value, SQLCHAR precision,
+                                SQLSCHAR scale, SQLSCHAR reqscale,
+                                SQLCHAR reqprec, int *overflow_ptr)
+{
+  sqlnum_uint128 tmp;
+  uint last_digit;
+  int overflow= 0;
+
+  /* scale up to SQL_DESC_SCALE */
+  if (reqscale > 0 && reqscale > scale)
+  {
+    tmp= value;
+    for (; reqscale > scale; ++scale)
+    {
+      if (!sqlnum_u128_mul_add(&tmp, 10, 0))
+        return FALSE;
+    }
+    value= tmp;
+  }
+  /* scale back, truncating decimals */
+  else
+  {
+    for (; reqscale < scale && scale > 0; --precision, --scale)
+      sqlnum_u128_divmod10(&value);
+  }
+
+  memset(&sqlnum->val, 0, sizeof(sqlnum->val));
+
+  /* scale back whole numbers while there's no significant digits */
+  for (; reqscale < scale; --precision, --scale)
+  {
+    tmp= value;
+    if (sqlnum_u128_divmod10(&tmp))
+    {
+      overflow= 1;
+      goto end;
+    }
+    value= tmp;
+  }
+
+  /* calculate minimum precision */
+  tmp= value;
+  do
+  {
+    last_digit= sqlnum_u128_divmod10(&tmp);
+    if (last_digit == 0)
+      --precision;
+  } while (last_digit == 0 && precision > 0);
+
+  /* detect precision overflow */
+  if (precision > reqprec)
+    overflow= 1;
+  else
+    precision= reqprec;
+
+  sqlnum_u128_store(&value, sqlnum->val);
+
+end:
+  sqlnum->precision= precision;
+  sqlnum->scale= scale;
+
+  if (overflow_ptr)
+    *overflow_ptr= overflow;
+
+  return TRUE;
+}
+
+
+/**
+  Retrieve a SQL_NUMERIC_STRUCT from a string. The requested scale
+  and precesion are first read from sqlnum, and then updated values
+  are written back at the end.
+
+  Plain decimal strings of up to SQLNUM_INT128_DIGITS digits, which is
+  what the server sends, are accumulated in a single 128-bit integer.
+
+  @param[in] numstr       String representation of number to convert
+  @param[in] sqlnum       Destination struct
+  @param[in] overflow_ptr Whether or not whole-number overflow occurred.
+                          This indicates failure, and the result of sqlnum
+                          is undefined.
+*/
+void sqlnum_from_str(const char *numstr, SQL_NUMERIC_STRUCT *sqlnum,
+                     int *overflow_ptr)
+{
+  SQLSCHAR reqscale= sqlnum->scale;
+  SQLCHAR reqprec= sqlnum->precision;
+  my_bool negative= *numstr == '-';
+  const char *start= numstr + negative, *pos;
+  const char *decpt= NULL;
+  sqlnum_uint128 value;
+  uint chunk= 0, chunk_digits= 0, digits= 0;
+
+  sqlnum_u128_set(&value, 0);
+
+  for (pos= start; *pos; ++pos)
+  {
+    if (*pos == '.' && !decpt)
+    {
+      decpt= pos;
+      continue;
+    }
+
+    if (!isdigit(*pos) || ++digits > SQLNUM_INT128_DIGITS)
+      break;
+
+    chunk= chunk * 10 + digit(*pos);
+    if (++chunk_digits == 9)
+    {
+      sqlnum_u128_mul_add(&value, sqlnum_pow10[9], chunk);
+      chunk= chunk_digits= 0;
+    }
+  }
+
+  if (!*pos)
+  {
+    sqlnum_u128_mul_add(&value, sqlnum_pow10[chunk_digits], chunk);
+    sqlnum->sign= !negative;
+
+    if (sqlnum_set_value(sqlnum, value,
+                         (SQLCHAR) (pos - start - (decpt ? 1 : 0)),
+                         (SQLSCHAR) (decpt ? pos - decpt - 1 : 0),
+                         reqscale, reqprec, overflow_ptr))
+      return;
+  }
+
+  /* Anything the server would not send, or too many digits */
+  sqlnum_from_str_limbs(numstr, sqlnum, reqscale, reqprec, overflow_ptr);
+}
+
+
+/**
+  Retrieve a SQL_NUMERIC_STRUCT from an integer, the same as
+  sqlnum_from_str() does from its decimal string.
+
+  @param[in] value        Absolute value of the number
+  @param[in] negative     Whether the number is negative
+  @param[in] sqlnum       Destination struct
+  @param[in] overflow_ptr Whether or not whole-number overflow occurred.
+*/
+void sqlnum_from_int(ulonglong value, my_bool negative,
+                     SQL_NUMERIC_STRUCT *sqlnum, int *overflow_ptr)
+{
+  SQLSCHAR reqscale= sqlnum->scale;
+  SQLCHAR reqprec= sqlnum->precision;
+  sqlnum_uint128 value128;
+  ulonglong rest;
+  SQLCHAR digits= 1;
+  char buff[22];
+
+  for (rest= value / 10; rest; rest/= 10)
+    ++digits;
+
+  sqlnum_u128_set(&value128, value);
+  sqlnum->sign= !negative;
+
+  if (!sqlnum_set_value(sqlnum, value128, digits, 0, reqscale, reqprec,
+                        overflow_ptr))
+  {
+    sprintf(buff, "%s%llu", negative ? "-" : "", value);
+    sqlnum_from_str(buff, sqlnum, overflow_ptr);
+  }
+}
+
+
 /**
   Convert a SQL_NUMERIC_STRUCT to a string. Only val and sign are
   read from the struct. precision and scale will be updated on the
@@ -2889,9 +3745,8 @@ void sqlnum_to_str(SQL_NUMERIC_STRUCT *sqlnum, SQLCHAR *numstr,
                    SQLCHAR **numbegin, SQLCHAR reqprec, SQLSCHAR reqscale,
                    int *truncptr)
 {
-  int expanded[8];
-  int i, j;
-  int max_space= 0;
+  sqlnum_uint128 value;
+  int j;
   int calcprec= 0;
   int trunc= 0; /* truncation indicator */
 
@@ -2902,41 +3757,22 @@ void sqlnum_to_str(SQL_NUMERIC_STRUCT *sqlnum, SQLCHAR *numstr,
      (~at least min(39, max(prec, scale+2)) + 3)
   */
 
-  /*
-     expand the packed sqlnum->val so we have space to divide through
-     expansion happens into an array in big-endian form
-  */
-  for (i= 0; i < 8; ++i)
-    expanded[7 - i]= (sqlnum->val[(2 * i) + 1] << 8) | sqlnum->val[2 * i];
+  sqlnum_u128_load(&value, sqlnum->val);
 
   /* max digits = 39 = log_10(2^128)+1 */
   for (j= 0; j < 39; ++j)
   {
-    /* skip empty prefix */
-    while (!expanded[max_space])
-      ++max_space;
-    /* if only the last piece has a value, it's the end */
-    if (max_space >= 7)
+    if (sqlnum_u128_is_zero(&value))
     {
-      i= 7;
-      if (!expanded[7])
+      /* special case for zero, we'll end immediately */
+      if (!calcprec)
       {
-        /* special case for zero, we'll end immediately */
-        if (!*(numstr + 1))
-        {
-          *numstr--= '0';
-          calcprec= 1;
-        }
-        break;
+        *numstr--= '0';
+        calcprec= 1;
       }
+      break;
     }
-    else
-    {
-      /* extract the next digit */
-      sqlnum_unscale_be(expanded, max_space);
-    }
-    *numstr--= '0' + (expanded[7] % 10);
-    expanded[7] /= 10;
+    *numstr--= '0' + sqlnum_u128_divmod10(&value);
     ++calcprec;
     if (j == reqscale - 1)
       *numstr--= '.';
@@ -3896,6 +4732,163 @@ char *add_to_buffer(NET *net,char *to,const char *from,ulong length)
     return to+length;
 }
 
+/*
+  Escape sequences used by mysql_real_escape_string() for the bytes that
+  need them, 0 for the bytes that are copied as is.
+*/
+static const char escape_char[256]=
+{
+  '0', 0, 0, 0, 0, 0, 0, 0, 0, 0, 'n', 0, 0, 'r', 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 'Z', 0, 0, 0, 0, 0,
+  0, 0, '"', 0, 0, 0, 0, '\'', 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0
+  /* the rest are 0 */
+};
+
+
+/*
+  Returns the position of the first byte in [from, end) that has to be
+  escaped, or end.
+*/
+static const char *find_escaped_byte(const char *from, const char *end)
+{
+#ifdef MYODBC_SSE2
+  const __m128i nul=   _mm_setzero_si128(),
+                lf=    _mm_set1_epi8('\n'),
+                cr=    _mm_set1_epi8('\r'),
+                ctrlz= _mm_set1_epi8('\032'),
+                dquot= _mm_set1_epi8('"'),
+                squot= _mm_set1_epi8('\''),
+                bslash=_mm_set1_epi8('\\');
+
+  while (end - from >= 16)
+  {
+    __m128i chunk= _mm_loadu_si128((const __m128i *)from);
+    __m128i hit= _mm_or_si128(
+      _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, nul),
+                                _mm_cmpeq_epi8(chunk, lf)),
+                   _mm_or_si128(_mm_cmpeq_epi8(chunk, cr),
+                                _mm_cmpeq_epi8(chunk, ctrlz))),
+      _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, dquot),
+                                _mm_cmpeq_epi8(chunk, squot)),
+                   _mm_cmpeq_epi8(chunk, bslash)));
+    unsigned int mask= (unsigned int)_mm_movemask_epi8(hit);
+
+    if (mask != 0)
+    {
+      return from + myodbc_first_bit(mask);
+    }
+
+    from+= 16;
+  }
+#endif
+
+  for (; from < end; ++from)
+  {
+    if (escape_char[(uchar)*from])
+    {
+      break;
+    }
+  }
+
+  return from;
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : escapes a string parameter value the way
+             mysql_real_escape_string() does, copying the runs of bytes that
+             need no escaping in bulk. to must have room for 2*length bytes.
+             The result is not null-terminated.
+  @return  : number of bytes written to to
+*/
+ulong myodbc_escape_param(DBC *dbc, char *to, const char *from, ulong length)
+{
+  const char *end= from + length;
+  char *start= to;
+  CHARSET_INFO *cs= dbc->mysql.charset;
+
+  /*
+    In charsets like sjis a byte of a multibyte character can look like a
+    quote or a backslash, and without backslash escapes quotes are doubled
+    instead. The client library takes care of those.
+  */
+  if (is_no_backslashes_escape_mode(dbc) || cs == NULL || cs->mbminlen != 1
+   || cs->escape_with_backslash_is_dangerous)
+  {
+    return mysql_real_escape_string(&dbc->mysql, to, from, length);
+  }
+
+  while (from < end)
+  {
+    const char *pos= find_escaped_byte(from, end);
+
+    memcpy(to, from, pos - from);
+    to+= pos - from;
+
+    if (pos == end)
+    {
+      break;
+    }
+
+    *to++= '\\';
+    *to++= escape_char[(uchar)*pos];
+    from= pos + 1;
+  }
+
+  return (ulong)(to - start);
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : writes length bytes of binary data as 2*length upper case
+             hexadecimal digits, without a terminating null
+*/
+void myodbc_hex_encode(char *to, const char *from, ulong length)
+{
+  static const char digit[]= "0123456789ABCDEF";
+  const char *end= from + length;
+
+#ifdef MYODBC_SSE2
+  {
+    const __m128i low_nibble= _mm_set1_epi8(0x0F),
+                  nine=       _mm_set1_epi8(9),
+                  zero=       _mm_set1_epi8('0'),
+                  letter=     _mm_set1_epi8('A' - '0' - 10);
+
+    while (end - from >= 16)
+    {
+      __m128i chunk= _mm_loadu_si128((const __m128i *)from);
+      __m128i hi= _mm_and_si128(_mm_srli_epi16(chunk, 4), low_nibble);
+      __m128i lo= _mm_and_si128(chunk, low_nibble);
+
+      /* nibble + '0', plus the distance to 'A' for nibbles over 9 */
+      hi= _mm_add_epi8(_mm_add_epi8(hi, zero),
+                       _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letter));
+      lo= _mm_add_epi8(_mm_add_epi8(lo, zero),
+                       _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letter));
+
+      _mm_storeu_si128((__m128i *)to, _mm_unpacklo_epi8(hi, lo));
+      _mm_storeu_si128((__m128i *)(to + 16), _mm_unpackhi_epi8(hi, lo));
+
+      from+= 16;
+      to+= 32;
+    }
+  }
+#endif
+
+  for (; from < end; ++from)
+  {
+    *to++= digit[(uchar)*from >> 4];
+    *to++= digit[(uchar)*from & 15];
+  }
+}
+
+
 /*
   Get the offset and row numbers from a string with LIMIT
 
@@ -4093,7 +5086,8 @@ int got_out_parameters(STMT *stmt)
 }
 
 
-int get_session_variable(STMT *stmt, const char *var, char *result)
+int get_session_variable(STMT *stmt, const char *var, char *result,
+                         size_t buf_len)
 {
   char buff[255+4*NAME_CHAR_LEN], *to;
   MYSQL_RES *res;
@@ -4118,7 +5112,7 @@ int get_session_variable(STMT *stmt, const char *var, char *result)
     row= mysql_fetch_row(res);
     if (row)
     {
-      strcpy(result, row[1]);
+      strmake(result, row[1], buf_len - 1);
       mysql_free_result(res);
       return strlen(result);
     }
@@ -4179,7 +5173,8 @@ SQLULEN get_query_timeout(STMT *stmt)
     /* Be cautious with very long values even if they don't make sense */
     char query_timeout_char[32]= {0};
     uint length= get_session_variable(stmt, "MAX_EXECUTION_TIME",
-                                      (char*)query_timeout_char);
+                                      (char*)query_timeout_char,
+                                      sizeof(query_timeout_char));
     /* Terminate the string just in case */
     query_timeout_char[length]= 0;
     /* convert */
@@ -4204,7 +5199,8 @@ const char get_identifier_quote(STMT *stmt)
       The token finder skips the leading space and starts
       with the first non-space value. Thus (sql_mode+1).
     */
-    uint length= get_session_variable(stmt, "SQL_MODE", (char*)(sql_mode+1));
+    uint length= get_session_variable(stmt, "SQL_MODE", (char*)(sql_mode+1),
+                                      sizeof(sql_mode) - 1);
 
     const char *end=  sql_mode + length;
     if (find_first_token(stmt->dbc->ansi_charset_info, sql_mode, end, "ANSI_QUOTES"))
@@ -47,6 +47,12 @@ static const char *MYODBC_OPTIONS[][3] = {
   {"INITSTMT",          "T", "Initial statement executed at the connecting time"},
   {"CHARSET",           "T", "The character set to use for the connection"},
   {"PREFETCH",          "T", "Prefecth from server by N rows at a time"},
+  {"READ_REPLICAS",     "T", "Comma separated list of host[:port] replicas used for reads"},
+  {"KILL_ON_CLOSE",     "T", "Kill the query instead of reading more than N rows of a closed streamed result"},
+  {"COMPRESSION_ALGORITHMS", "T", "Permitted protocol compression algorithms, e.g. zstd,zlib"},
+  {"ZSTD_COMPRESSION_LEVEL", "T", "Compression level for zstd (1-22)"},
+  {"LOAD_DATA_ROWS",    "T", "Send parameter arrays of INSERT from N rows up with LOAD DATA LOCAL INFILE, which skips duplicate keys (not under a strict sql_mode)"},
+  {"PERF_COUNTERS_FILE", "F", "File the driver's performance counters are appended to at disconnect"},
   {"READTIMEOUT",       "T", "The timeout in seconds for attempts to read from the server"},
   {"WRITETIMEOUT",      "T", "The timeout in seconds for attempts to write to the server"},
   {"SSLCA",             "F", "The path to a file with a list of trust SSL CAs"},
@@ -86,6 +92,9 @@ static const char *MYODBC_OPTIONS[][3] = {
   {"CAN_HANDLE_EXP_PWD",      "C", "Can Handle Expired Password"},
   {"ENABLE_CLEARTEXT_PLUGIN", "C", "Enable Cleartext Authentication"},
   {"NO_SSPS",                 "C", "Prepare statements on the client"},
+  {"HEX_BINARY_PARAMS",       "C", "Send binary parameters as hexadecimal literals"},
+  {"STATEMENT_DIGESTS",       "C", "Aggregate statistics per statement digest"},
+  {"ENABLE_LOCAL_INFILE",     "C", "Enable LOAD DATA LOCAL INFILE"},
   {NULL, NULL, NULL}
 };
 
@@ -1213,6 +1213,387 @@ DECLARE_TEST(t_ssl_mode)
   return OK;
 }
 
+/*
+  Read/write splitting. The same server is used as the replica, so we can
+  only tell where the statement went by its connection id.
+*/
+DECLARE_TEST(t_read_replicas)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  SQLCHAR     opts[256];
+  SQLINTEGER  primary_id, replica_id;
+  SQLUINTEGER mode= 0;
+
+  if (myport)
+    sprintf((char *)opts, "READ_REPLICAS=%s:%d", myserver, myport);
+  else
+    sprintf((char *)opts, "READ_REPLICAS=%s", myserver);
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+    NULL, NULL, NULL, opts));
+
+  /* Inside of a transaction everything goes to the primary */
+  ok_con(hdbc1, SQLSetConnectAttr(hdbc1, SQL_ATTR_AUTOCOMMIT,
+                                  (SQLPOINTER)SQL_AUTOCOMMIT_OFF, 0));
+  ok_sql(hstmt1, "SELECT CONNECTION_ID()");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  primary_id= my_fetch_int(hstmt1, 1);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_con(hdbc1, SQLEndTran(SQL_HANDLE_DBC, hdbc1, SQL_COMMIT));
+
+  /* SELECT in autocommit mode is routed to the replica */
+  ok_con(hdbc1, SQLSetConnectAttr(hdbc1, SQL_ATTR_AUTOCOMMIT,
+                                  (SQLPOINTER)SQL_AUTOCOMMIT_ON, 0));
+  ok_sql(hstmt1, "SELECT CONNECTION_ID()");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  replica_id= my_fetch_int(hstmt1, 1);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  is(primary_id != replica_id);
+
+  /* In read-only mode it is routed even inside of a transaction */
+  ok_con(hdbc1, SQLSetConnectAttr(hdbc1, SQL_ATTR_ACCESS_MODE,
+                                  (SQLPOINTER)SQL_MODE_READ_ONLY, 0));
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_ACCESS_MODE, &mode, 0,
+                                  NULL));
+  is_num(mode, SQL_MODE_READ_ONLY);
+  ok_con(hdbc1, SQLSetConnectAttr(hdbc1, SQL_ATTR_AUTOCOMMIT,
+                                  (SQLPOINTER)SQL_AUTOCOMMIT_OFF, 0));
+  ok_sql(hstmt1, "SELECT CONNECTION_ID()");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), replica_id);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_con(hdbc1, SQLEndTran(SQL_HANDLE_DBC, hdbc1, SQL_COMMIT));
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+  return OK;
+}
+
+
+/*
+  Dropped statements are kept by the connection and reused. The recycled
+  statement must look exactly like a freshly allocated one.
+*/
+DECLARE_TEST(t_stmt_reuse)
+{
+  SQLHSTMT    hstmt1;
+  SQLULEN     value= 0;
+  SQLSMALLINT cols, params;
+  SQLINTEGER  id;
+  int         i;
+
+  for (i= 0; i < 3; ++i)
+  {
+    ok_con(hdbc, SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt1));
+
+    ok_stmt(hstmt1, SQLGetStmtAttr(hstmt1, SQL_ATTR_ROW_ARRAY_SIZE, &value,
+                                   0, NULL));
+    is_num(value, 1);
+    ok_stmt(hstmt1, SQLGetStmtAttr(hstmt1, SQL_ATTR_MAX_ROWS, &value, 0,
+                                   NULL));
+    is_num(value, 0);
+
+    ok_stmt(hstmt1, SQLPrepare(hstmt1, (SQLCHAR *)"SELECT ?, 2", SQL_NTS));
+    ok_stmt(hstmt1, SQLNumParams(hstmt1, &params));
+    is_num(params, 1);
+    ok_stmt(hstmt1, SQLNumResultCols(hstmt1, &cols));
+    is_num(cols, 2);
+
+    ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                     SQL_INTEGER, 0, 0, &id, 0, NULL));
+    ok_stmt(hstmt1, SQLBindCol(hstmt1, 1, SQL_C_LONG, &id, 0, NULL));
+    id= i;
+    ok_stmt(hstmt1, SQLExecute(hstmt1));
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(id, i);
+
+    /* Things that must not leak into the next statement */
+    ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_ROW_ARRAY_SIZE,
+                                   (SQLPOINTER)10, 0));
+    ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_MAX_ROWS,
+                                   (SQLPOINTER)1, 0));
+
+    ok_stmt(hstmt1, SQLFreeHandle(SQL_HANDLE_STMT, hstmt1));
+  }
+
+  /* Unprepared statement from the pool */
+  ok_con(hdbc, SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt1));
+  ok_stmt(hstmt1, SQLNumParams(hstmt1, &params));
+  is_num(params, 0);
+  ok_sql(hstmt1, "SELECT 1 UNION SELECT 2");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+  ok_stmt(hstmt1, SQLFreeHandle(SQL_HANDLE_STMT, hstmt1));
+
+  return OK;
+}
+
+
+#ifndef SQL_ATTR_MYSQL_COMPRESSION_STATS
+# define SQL_ATTR_MYSQL_COMPRESSION_STATS 0x4001
+#endif
+
+/*
+  COMPRESSION_ALGORITHMS/ZSTD_COMPRESSION_LEVEL and the compression
+  statistics attribute.
+*/
+DECLARE_TEST(t_compression_stats)
+{
+  SQLHENV     henv1;
+  SQLHDBC     hdbc1;
+  SQLHSTMT    hstmt1;
+  SQLCHAR     stats[256], *pos, name[64], value[64];
+  SQLINTEGER  len, found= 0;
+
+  /* Compression_algorithm and _level appeared together with the options */
+  if (!mysql_min_version(hdbc, "8.0.18", 6))
+    skip("server does not support COMPRESSION_ALGORITHMS");
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL,
+                                        "COMPRESSION_ALGORITHMS=zstd,zlib,"
+                                        "uncompressed;"
+                                        "ZSTD_COMPRESSION_LEVEL=3"));
+
+  /* zstd has been negotiated, at the level asked for */
+  ok_sql(hstmt1, "SHOW SESSION STATUS LIKE 'Compression%'");
+  while (SQLFetch(hstmt1) == SQL_SUCCESS)
+  {
+    my_fetch_str(hstmt1, name, 1);
+    my_fetch_str(hstmt1, value, 2);
+
+    if (!strcmp((char *)name, "Compression"))
+    {
+      is_str(value, "ON", 3);
+      ++found;
+    }
+    else if (!strcmp((char *)name, "Compression_algorithm"))
+    {
+      is_str(value, "zstd", 5);
+      ++found;
+    }
+    else if (!strcmp((char *)name, "Compression_level"))
+    {
+      is_str(value, "3", 2);
+      ++found;
+    }
+  }
+  is_num(found, 3);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "SELECT REPEAT('x', 100000)");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYSQL_COMPRESSION_STATS,
+                                  stats, sizeof(stats), &len));
+  printMessage("%s", stats);
+  is_num(len, strlen((char *)stats));
+
+  is(strstr((char *)stats, "compression=ON;algorithm=zstd;level=3;") ==
+     (char *)stats);
+
+  pos= (SQLCHAR *)strstr((char *)stats, "payload_received=");
+  is(pos != NULL);
+  is(strtoul((char *)pos + sizeof("payload_received=") - 1, NULL, 10)
+     >= 100000);
+
+  pos= (SQLCHAR *)strstr((char *)stats, "wire_received=");
+  is(pos != NULL);
+  is(strtoul((char *)pos + sizeof("wire_received=") - 1, NULL, 10) > 0);
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+/*
+  Parse results are cached per connection by the query text. Executing the
+  same texts repeatedly, on different statements, must give the same results
+  as the first time.
+*/
+DECLARE_TEST(t_query_cache)
+{
+  SQLHENV     henv1;
+  SQLHDBC     hdbc1;
+  SQLHSTMT    hstmt1, hstmt2;
+  SQLINTEGER  param, i, rows;
+  SQLCHAR     buff[16];
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL, "PREFETCH=2"));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_query_cache");
+  ok_sql(hstmt1, "CREATE TABLE t_query_cache (id INT)");
+  ok_sql(hstmt1, "INSERT INTO t_query_cache VALUES (1),(2),(3),(4),(5)");
+
+  for (i= 0; i < 3; ++i)
+  {
+    ok_con(hdbc1, SQLAllocStmt(hdbc1, &hstmt2));
+
+    /* ODBC escape braces are removed from the statement's copy only */
+    ok_sql(hstmt2, "{SELECT '{x}'}");
+    ok_stmt(hstmt2, SQLFetch(hstmt2));
+    is_str(my_fetch_str(hstmt2, buff, 1), "{x}", 4);
+    ok_stmt(hstmt2, SQLFreeStmt(hstmt2, SQL_CLOSE));
+
+    param= 10 * i;
+    ok_stmt(hstmt2, SQLBindParameter(hstmt2, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                     SQL_INTEGER, 0, 0, &param, 0, NULL));
+    ok_stmt(hstmt2, SQLExecDirect(hstmt2, (SQLCHAR *)"SELECT ? + 1 FROM DUAL",
+                                  SQL_NTS));
+    ok_stmt(hstmt2, SQLFetch(hstmt2));
+    is_num(my_fetch_int(hstmt2, 1), param + 1);
+    ok_stmt(hstmt2, SQLFreeStmt(hstmt2, SQL_CLOSE));
+
+    /* Scrolled with LIMIT, which is looked up in the cached text */
+    ok_sql(hstmt2, "SELECT id FROM t_query_cache ORDER BY id LIMIT 1, 3");
+    for (rows= 0; SQLFetch(hstmt2) == SQL_SUCCESS; ++rows)
+    {
+      is_num(my_fetch_int(hstmt2, 1), rows + 2);
+    }
+    is_num(rows, 3);
+
+    ok_stmt(hstmt2, SQLFreeStmt(hstmt2, SQL_DROP));
+  }
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_query_cache");
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
+#ifndef SQL_ATTR_MYSQL_PERF_COUNTERS
+# define SQL_ATTR_MYSQL_PERF_COUNTERS 0x4002
+#endif
+
+static unsigned long long perf_counter(SQLCHAR *counters, const char *name)
+{
+  char *pos= strstr((char *)counters, name);
+
+  if (pos == NULL || pos[strlen(name)] != '=')
+    return (unsigned long long)-1;
+
+  return strtoull(pos + strlen(name) + 1, NULL, 10);
+}
+
+/*
+  Performance counters of the connection and of a statement.
+*/
+DECLARE_TEST(t_perf_counters)
+{
+  SQLHENV     henv1;
+  SQLHDBC     hdbc1;
+  SQLHSTMT    hstmt1;
+  SQLCHAR     counters[512];
+  SQLINTEGER  len, i;
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL, NULL));
+
+  for (i= 0; i < 3; ++i)
+  {
+    ok_sql(hstmt1, "SELECT REPEAT('x', 1000) UNION ALL SELECT 'y'");
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+    ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  }
+
+  ok_stmt(hstmt1, SQLGetStmtAttr(hstmt1, SQL_ATTR_MYSQL_PERF_COUNTERS,
+                                 counters, sizeof(counters), &len));
+  printMessage("%s", counters);
+  is_num(len, strlen((char *)counters));
+  is_num(perf_counter(counters, "round_trips"), 3);
+  is_num(perf_counter(counters, "rows_fetched"), 6);
+  is_num(perf_counter(counters, "bytes_received"), 3 * 1001);
+  is_num(perf_counter(counters, "prepare_cache_hits"), 2);
+  is(perf_counter(counters, "store_result_peak") >= 1000);
+
+  /* The connection also counts what the driver sent on its own */
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYSQL_PERF_COUNTERS,
+                                  counters, sizeof(counters), &len));
+  printMessage("%s", counters);
+  is(perf_counter(counters, "round_trips") >= 3);
+  is(perf_counter(counters, "hidden_round_trips") != (unsigned long long)-1);
+  is_num(perf_counter(counters, "rows_fetched"), 6);
+
+  /* Truncated */
+  expect_stmt(hstmt1, SQLGetStmtAttr(hstmt1, SQL_ATTR_MYSQL_PERF_COUNTERS,
+                                     counters, 10, &len),
+              SQL_SUCCESS_WITH_INFO);
+  is_num(strlen((char *)counters), 9);
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
+#ifndef SQL_ATTR_MYSQL_STATEMENT_DIGESTS
+# define SQL_ATTR_MYSQL_STATEMENT_DIGESTS 0x4003
+#endif
+
+DECLARE_TEST(t_statement_digests)
+{
+  SQLHENV     henv1;
+  SQLHDBC     hdbc1;
+  SQLHSTMT    hstmt1;
+  SQLCHAR     digests[4096];
+  SQLINTEGER  len;
+  char        *line;
+
+  /* Not collected unless the data source asks for it */
+  expect_dbc(hdbc, SQLGetConnectAttr(hdbc, SQL_ATTR_MYSQL_STATEMENT_DIGESTS,
+                                     digests, sizeof(digests), &len),
+             SQL_ERROR);
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL,
+                                        (SQLCHAR *)"STATEMENT_DIGESTS=1"));
+
+  ok_sql(hstmt1, "SELECT 1 IN (1, 2, 3), 'a' UNION ALL SELECT 2, 'b'");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "SELECT  5 IN (7)  , \"x\" /* comment */ "
+                 "UNION ALL SELECT 0x1F, 'it''s'");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  expect_sql(hstmt1, "SELECT * FROM t_statement_digests_none WHERE a = 1",
+             SQL_ERROR);
+  expect_sql(hstmt1, "SELECT * FROM t_statement_digests_none WHERE a = 'b'",
+             SQL_ERROR);
+
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYSQL_STATEMENT_DIGESTS,
+                                  digests, sizeof(digests), &len));
+  printMessage("%s", digests);
+  is_num(len, strlen((char *)digests));
+
+  line= strstr((char *)digests, "digest=SELECT ? IN (...), ? UNION ALL "
+                                "SELECT ?, ?\n");
+  is(line != NULL);
+  while (line > (char *)digests && line[-1] != '\n')
+    --line;
+  is(strncmp(line, "count=2;errors=0;", 17) == 0);
+  is(strstr(line, ";rows=3;") != NULL);
+
+  line= strstr((char *)digests, "digest=SELECT * FROM "
+                                "t_statement_digests_none WHERE a = ?\n");
+  is(line != NULL);
+  while (line > (char *)digests && line[-1] != '\n')
+    --line;
+  is(strncmp(line, "count=2;errors=2;", 17) == 0);
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
 BEGIN_TESTS
   ADD_TEST(t_tls_opts)
   ADD_TEST(t_ssl_mode)
@@ -1247,6 +1628,12 @@ BEGIN_TESTS
   ADD_TEST(t_bug45378)
   ADD_TEST(t_bug63844)
   ADD_TEST(t_bug52996)
+  ADD_TEST(t_read_replicas)
+  ADD_TEST(t_stmt_reuse)
+  ADD_TEST(t_compression_stats)
+  ADD_TEST(t_query_cache)
+  ADD_TEST(t_perf_counters)
+  ADD_TEST(t_statement_digests)
   END_TESTS
 
 
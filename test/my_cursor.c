@@ -3419,6 +3419,62 @@ DECLARE_TEST(t_18805455)
 }
 
 
+/*
+  SQLSetPos(SQL_UPDATE) leaves the columns that are not bound out of the
+  SET clause, also when a later column is bound
+*/
+DECLARE_TEST(t_setpos_unbound_column)
+{
+  SQLINTEGER  id, val;
+  SQLCHAR     name[20];
+  SQLLEN      nRowCount;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_setpos_unbound_column");
+  ok_sql(hstmt, "CREATE TABLE t_setpos_unbound_column (id INT PRIMARY KEY, "
+                "name VARCHAR(20), val INT)");
+  ok_sql(hstmt, "INSERT INTO t_setpos_unbound_column VALUES (1, 'one', 10), "
+                "(2, 'two', 20)");
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE,
+                                (SQLPOINTER)SQL_CURSOR_STATIC, 0));
+  ok_sql(hstmt, "SELECT id, name, val FROM t_setpos_unbound_column "
+                "ORDER BY id");
+
+  /* name, between the bound columns, is not bound */
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, &id, 0, NULL));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 3, SQL_C_LONG, &val, 0, NULL));
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_FIRST, 1L));
+  is_num(id, 1);
+  is_num(val, 10);
+
+  val= 11;
+  ok_stmt(hstmt, SQLSetPos(hstmt, 1, SQL_UPDATE, SQL_LOCK_NO_CHANGE));
+  ok_stmt(hstmt, SQLRowCount(hstmt, &nRowCount));
+  is_num(nRowCount, 1);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_sql(hstmt, "SELECT id, name, val FROM t_setpos_unbound_column "
+                "ORDER BY id");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(my_fetch_int(hstmt, 1), 1);
+  is_str(my_fetch_str(hstmt, name, 2), "one", 3);
+  is_num(my_fetch_int(hstmt, 3), 11);
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(my_fetch_int(hstmt, 1), 2);
+  is_str(my_fetch_str(hstmt, name, 2), "two", 3);
+  is_num(my_fetch_int(hstmt, 3), 20);
+  expect_stmt(hstmt, SQLFetch(hstmt), SQL_NO_DATA_FOUND);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_setpos_unbound_column");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(my_positioned_cursor)
   ADD_TEST(my_setpos_cursor)
@@ -3480,6 +3536,7 @@ BEGIN_TESTS
   ADD_TEST(t_bug41946)
   /*ADD_TEST(t_sqlputdata)*/
   // ADD_TEST(t_18805455) TODO: Fix
+  ADD_TEST(t_setpos_unbound_column)
 END_TESTS
 
 
@@ -1416,6 +1416,117 @@ DECLARE_TEST(t_date_overflow)
 }
 
 
+/*
+  Canonical server output and looser layouts of the same values must be
+  converted alike
+*/
+DECLARE_TEST(t_datetime_layouts)
+{
+  SQL_TIMESTAMP_STRUCT ts;
+  SQL_DATE_STRUCT d;
+  SQL_TIME_STRUCT t;
+  SQLLEN len;
+  int i;
+
+  ok_sql(hstmt, "SELECT CAST('2023-04-05 06:07:08.123456' AS DATETIME(6)), "
+                "'2023-04-05 06:07:08.123456', '2023/04/05T06:07:08.123456', "
+                "'20230405060708.123456'");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+
+  for (i= 1; i <= 4; ++i)
+  {
+    ok_stmt(hstmt, SQLGetData(hstmt, (SQLUSMALLINT)i, SQL_C_TYPE_TIMESTAMP,
+                              &ts, sizeof(ts), &len));
+    is_num(ts.year, 2023);
+    is_num(ts.month, 4);
+    is_num(ts.day, 5);
+    is_num(ts.hour, 6);
+    is_num(ts.minute, 7);
+    is_num(ts.second, 8);
+    is_num(ts.fraction, 123456000);
+
+    ok_stmt(hstmt, SQLGetData(hstmt, (SQLUSMALLINT)i, SQL_C_TYPE_DATE,
+                              &d, sizeof(d), &len));
+    is_num(d.year, 2023);
+    is_num(d.month, 4);
+    is_num(d.day, 5);
+  }
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_sql(hstmt, "SELECT '2023-04-05', '2023-04-05 06:07:08.5', "
+                "'0000-00-00 00:00:00', '12:34:56', '12:34:56.5', '1:2:75'");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+
+  ok_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_TYPE_TIMESTAMP, &ts, sizeof(ts),
+                            &len));
+  is_num(ts.day, 5);
+  is_num(ts.hour, 0);
+  is_num(ts.fraction, 0);
+
+  ok_stmt(hstmt, SQLGetData(hstmt, 2, SQL_C_TYPE_TIMESTAMP, &ts, sizeof(ts),
+                            &len));
+  is_num(ts.second, 8);
+  is_num(ts.fraction, 500000000);
+
+  ok_stmt(hstmt, SQLGetData(hstmt, 3, SQL_C_TYPE_TIMESTAMP, &ts, sizeof(ts),
+                            &len));
+  is_num(len, SQL_NULL_DATA);
+
+  ok_stmt(hstmt, SQLGetData(hstmt, 4, SQL_C_TYPE_TIME, &t, sizeof(t), &len));
+  is_num(t.hour, 12);
+  is_num(t.minute, 34);
+  is_num(t.second, 56);
+
+  /* Lost fraction is reported as truncation */
+  expect_stmt(hstmt, SQLGetData(hstmt, 5, SQL_C_TYPE_TIME, &t, sizeof(t),
+                                &len), SQL_SUCCESS_WITH_INFO);
+  is_num(t.second, 56);
+
+  ok_stmt(hstmt, SQLGetData(hstmt, 6, SQL_C_TYPE_TIME, &t, sizeof(t), &len));
+  is_num(t.hour, 1);
+  is_num(t.minute, 3);
+  is_num(t.second, 15);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  return OK;
+}
+
+
+/*
+  The server writes fractions after a '.', which must be decoded the same
+  with the default locale handling and with NO_LOCALE
+*/
+DECLARE_TEST(t_datetime_fraction_locale)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  SQL_TIMESTAMP_STRUCT ts, ts1;
+  SQLLEN len;
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+           NULL, NULL, NULL, "NO_LOCALE=1"));
+
+  ok_sql(hstmt, "SELECT CAST('2023-04-05 06:07:08.123456' AS DATETIME(6))");
+  ok_sql(hstmt1, "SELECT CAST('2023-04-05 06:07:08.123456' AS DATETIME(6))");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+
+  ok_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_TYPE_TIMESTAMP, &ts, sizeof(ts),
+                            &len));
+  ok_stmt(hstmt1, SQLGetData(hstmt1, 1, SQL_C_TYPE_TIMESTAMP, &ts1,
+                             sizeof(ts1), &len));
+  is_num(ts.second, 8);
+  is_num(ts.fraction, 123456000);
+  is_num(ts1.second, 8);
+  is_num(ts1.fraction, 123456000);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
 
 BEGIN_TESTS
   ADD_TEST(t_date_overflow)
@@ -1441,6 +1552,8 @@ BEGIN_TESTS
   // ADD_TEST(t_bug60646) TODO: Fix
   ADD_TEST(t_bug60648)
   ADD_TEST(t_b13975271)
+  ADD_TEST(t_datetime_layouts)
+  ADD_TEST(t_datetime_fraction_locale)
 END_TESTS
 
 
@@ -1759,6 +1759,258 @@ DECLARE_TEST(t_bug28175772)
 }
 
 
+/*
+  Queries with parameter values put in are built in a buffer the statement
+  keeps between executions. Values of quite different sizes must not leave
+  anything of the previous query behind.
+*/
+DECLARE_TEST(t_query_buffer_reuse)
+{
+  SQLHENV   henv1;
+  SQLHDBC   hdbc1;
+  SQLHSTMT  hstmt1;
+  SQLCHAR   *blob;
+  SQLLEN    blob_len;
+  SQLINTEGER id;
+  const SQLLEN sizes[]= {1024 * 1024, 10, 0, 300000, 1};
+  unsigned int i;
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL, "NO_SSPS=1"));
+
+  blob= (SQLCHAR *)malloc(sizes[0]);
+  memset(blob, '\'', sizes[0]);
+
+  ok_stmt(hstmt1, SQLPrepare(hstmt1, (SQLCHAR *)"SELECT ?, LENGTH(?), ?",
+                             SQL_NTS));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, &id, 0, NULL));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 2, SQL_PARAM_INPUT, SQL_C_BINARY,
+                                   SQL_LONGVARBINARY, 0, 0, blob, 0,
+                                   &blob_len));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 3, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, &id, 0, NULL));
+
+  for (i= 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+  {
+    id= (SQLINTEGER)i;
+    blob_len= sizes[i];
+
+    ok_stmt(hstmt1, SQLExecute(hstmt1));
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(my_fetch_int(hstmt1, 1), i);
+    is_num(my_fetch_int(hstmt1, 2), sizes[i]);
+    is_num(my_fetch_int(hstmt1, 3), i);
+    expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+    ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  }
+
+  free(blob);
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
+/*
+  Binary parameters sent as X'..' literals or escaped, and character ones
+  escaped in bulk, must reach the server unchanged.
+*/
+DECLARE_TEST(t_param_escaping)
+{
+  SQLHENV   henv1;
+  SQLHDBC   hdbc1;
+  SQLHSTMT  hstmt1;
+  SQLCHAR   bin[256 + 40], chr[100], out[sizeof(bin)];
+  SQLLEN    bin_len, chr_len, out_len;
+  const char *options[]= {"NO_SSPS=1", "NO_SSPS=1;HEX_BINARY_PARAMS=1"};
+  unsigned int i, o;
+
+  for (i= 0; i < 256; ++i)
+  {
+    bin[i]= (SQLCHAR)i;
+  }
+  /* A long run of the bytes that need escaping */
+  memset(bin + 256, '\\', 20);
+  memset(bin + 276, '\'', 20);
+  strcpy((char *)chr, "It's a \"quoted\" \\ line\r\nwith\032 all of them");
+
+  for (o= 0; o < sizeof(options) / sizeof(options[0]); ++o)
+  {
+    is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                          NULL, NULL, (SQLCHAR *)options[o]));
+
+    ok_stmt(hstmt1, SQLPrepare(hstmt1, (SQLCHAR *)"SELECT ?, ?", SQL_NTS));
+    ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_BINARY,
+                                     SQL_VARBINARY, 0, 0, bin, 0, &bin_len));
+    ok_stmt(hstmt1, SQLBindParameter(hstmt1, 2, SQL_PARAM_INPUT, SQL_C_CHAR,
+                                     SQL_VARCHAR, 0, 0, chr, 0, &chr_len));
+
+    /* Lengths crossing the 16 byte blocks, including empty values */
+    for (bin_len= 0; bin_len <= (SQLLEN)sizeof(bin); bin_len+= 37)
+    {
+      chr_len= bin_len < (SQLLEN)strlen((char *)chr) ? bin_len :
+                                                       (SQLLEN)strlen((char *)chr);
+
+      ok_stmt(hstmt1, SQLExecute(hstmt1));
+      ok_stmt(hstmt1, SQLFetch(hstmt1));
+
+      ok_stmt(hstmt1, SQLGetData(hstmt1, 1, SQL_C_BINARY, out, sizeof(out),
+                                 &out_len));
+      is_num(out_len, bin_len);
+      is(memcmp(out, bin, bin_len) == 0);
+
+      ok_stmt(hstmt1, SQLGetData(hstmt1, 2, SQL_C_CHAR, out, sizeof(out),
+                                 &out_len));
+      is_num(out_len, chr_len);
+      is(memcmp(out, chr, chr_len) == 0);
+
+      ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+    }
+
+    free_basic_handles(&henv1, &hdbc1, &hstmt1);
+  }
+
+  return OK;
+}
+
+
+/*
+  LOAD_DATA_ROWS: a parameter array of a plain INSERT is sent as
+  LOAD DATA LOCAL INFILE, the values have to arrive as they were bound.
+  Rows skipped by the server come back as warnings, and no other file
+  can be loaded. A strict sql_mode keeps the usual way.
+*/
+DECLARE_TEST(t_load_data_params)
+{
+  SQLHENV       henv1;
+  SQLHDBC       hdbc1;
+  SQLHSTMT      hstmt1, hstmt2;
+  SQLINTEGER    id[100];
+  SQLCHAR       name[100][20], buff[20];
+  SQLLEN        name_ind[100], rows;
+  SQLUSMALLINT  operation[100], status[100];
+  SQLULEN       processed;
+  int           i;
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL, (SQLCHAR *)
+                                        "ENABLE_LOCAL_INFILE=1;"
+                                        "LOAD_DATA_ROWS=10"));
+
+  ok_sql(hstmt1, "SELECT @@local_infile");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  if (my_fetch_int(hstmt1, 1) == 0)
+  {
+    free_basic_handles(&henv1, &hdbc1, &hstmt1);
+    skip("local_infile is disabled on the server");
+  }
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_load_data_params");
+  ok_sql(hstmt1, "CREATE TABLE t_load_data_params (id INT PRIMARY KEY, "
+                 "name VARCHAR(20))");
+  ok_sql(hstmt1, "SET SESSION sql_mode=''");
+
+  for (i= 0; i < 100; ++i)
+  {
+    id[i]= i;
+    sprintf((char *)name[i], "%d\t\\%s\n", i, i % 2 ? "\\N" : "");
+    name_ind[i]= i % 7 == 3 ? SQL_NULL_DATA : SQL_NTS;
+    operation[i]= i == 50 ? SQL_PARAM_IGNORE : SQL_PARAM_PROCEED;
+  }
+
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMSET_SIZE,
+                                 (SQLPOINTER)100, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAM_OPERATION_PTR,
+                                 operation, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAM_STATUS_PTR,
+                                 status, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMS_PROCESSED_PTR,
+                                 &processed, 0));
+
+  ok_stmt(hstmt1, SQLPrepare(hstmt1, (SQLCHAR *)"INSERT INTO "
+                             "t_load_data_params (id, name) VALUES (?, ?)",
+                             SQL_NTS));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, id, 0, NULL));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 2, SQL_PARAM_INPUT, SQL_C_CHAR,
+                                   SQL_VARCHAR, 20, 0, name, sizeof(name[0]),
+                                   name_ind));
+  ok_stmt(hstmt1, SQLExecute(hstmt1));
+
+  ok_stmt(hstmt1, SQLRowCount(hstmt1, &rows));
+  is_num(rows, 99);
+  is_num(processed, 100);
+  for (i= 0; i < 100; ++i)
+  {
+    is_num(status[i], i == 50 ? SQL_PARAM_UNUSED : SQL_PARAM_SUCCESS);
+  }
+
+  /* The same ids again are skipped as duplicates */
+  expect_stmt(hstmt1, SQLExecute(hstmt1), SQL_SUCCESS_WITH_INFO);
+  is_num(check_sqlstate(hstmt1, "01000"), OK);
+  ok_stmt(hstmt1, SQLRowCount(hstmt1, &rows));
+  is_num(rows, 0);
+  for (i= 0; i < 100; ++i)
+  {
+    is_num(status[i], i == 50 ? SQL_PARAM_UNUSED :
+                                SQL_PARAM_SUCCESS_WITH_INFO);
+  }
+
+  /* Strict mode refuses the duplicates one INSERT at a time */
+  ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt2));
+  ok_sql(hstmt2, "SET SESSION sql_mode='STRICT_TRANS_TABLES'");
+  expect_stmt(hstmt1, SQLExecute(hstmt1), SQL_ERROR);
+  is_num(status[0], SQL_PARAM_DIAG_UNAVAILABLE);
+  is_num(status[99], SQL_PARAM_ERROR);
+  ok_sql(hstmt2, "SET SESSION sql_mode=''");
+  ok_stmt(hstmt2, SQLFreeHandle(SQL_HANDLE_STMT, hstmt2));
+
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMSET_SIZE,
+                                 (SQLPOINTER)1, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAM_OPERATION_PTR,
+                                 NULL, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAM_STATUS_PTR,
+                                 NULL, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMS_PROCESSED_PTR,
+                                 NULL, 0));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_RESET_PARAMS));
+
+  ok_sql(hstmt1, "SELECT id, name FROM t_load_data_params ORDER BY id");
+  for (i= 0; i < 100; ++i)
+  {
+    if (i == 50)
+      continue;
+
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(my_fetch_int(hstmt1, 1), i);
+    if (i % 7 == 3)
+    {
+      SQLLEN len;
+      ok_stmt(hstmt1, SQLGetData(hstmt1, 2, SQL_C_CHAR, buff, sizeof(buff),
+                                 &len));
+      is_num(len, SQL_NULL_DATA);
+    }
+    else
+    {
+      is_str(my_fetch_str(hstmt1, buff, 2), name[i], strlen((char *)name[i]));
+    }
+  }
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* The driver sends no file it has not made itself */
+  expect_sql(hstmt1, "LOAD DATA LOCAL INFILE '/etc/hosts' "
+                     "INTO TABLE t_load_data_params", SQL_ERROR);
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_load_data_params");
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_bug28175772)
   ADD_TEST(my_init_table)
@@ -1784,6 +2036,9 @@ BEGIN_TESTS
   // ADD_TEST(t_bug14586094) TODO: Fix
   // ADD_TEST(t_longtextoutparam)  TODO: Fix
   ADD_TEST(t_bug53891)
+  ADD_TEST(t_query_buffer_reuse)
+  ADD_TEST(t_param_escaping)
+  ADD_TEST(t_load_data_params)
 #if USE_UNIXODBC
   ADD_TEST(t_odbc_outstream_params)
   ADD_TEST(t_odbc_inoutstream_params)
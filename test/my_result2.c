@@ -29,6 +29,12 @@
 
 #include "odbctap.h"
 #include "../VersionInfo.h"
+#include "../driver/columnar.h"
+#include "../driver/arrow.h"
+
+#ifndef _WIN32
+# include <dlfcn.h>
+#endif
 
 
 /*
@@ -1425,6 +1431,394 @@ DECLARE_TEST(t_bug28098219)
   return OK;
 }
 
+/*
+  MySQLFetchColumns(), the column-wise fetch of the driver. The names do not
+  all fit into the string buffer, so some calls return less rows than asked
+*/
+DECLARE_TEST(t_fetch_columns)
+{
+  MySQLFetchColumns_t fetch_columns;
+  SQLHSTMT      driver_hstmt= hstmt;
+  SQLCHAR       driver_name[256], query[2048], name[32], *pos;
+  MYODBC_COLUMN columns[4];
+  SQLBIGINT     ids[10];
+  SQLDOUBLE     amounts[10];
+  SQLINTEGER    days[10], offsets[11];
+  SQLCHAR       names[64], validity[2];
+  SQLULEN       rows, i, total= 0;
+  SQLRETURN     rc;
+  int           calls= 0;
+#ifdef _WIN32
+  HMODULE       driver;
+#else
+  void          *driver;
+#endif
+
+  ok_con(hdbc, SQLGetInfo(hdbc, SQL_DRIVER_NAME, driver_name,
+                          sizeof(driver_name), NULL));
+#ifdef _WIN32
+  driver= GetModuleHandleA((char *)driver_name);
+  fetch_columns= driver ? (MySQLFetchColumns_t)GetProcAddress(driver,
+                                                   "MySQLFetchColumns") : NULL;
+#else
+  driver= dlopen((char *)driver_name, RTLD_LAZY | RTLD_NOLOAD);
+  fetch_columns= driver ? (MySQLFetchColumns_t)dlsym(driver,
+                                                   "MySQLFetchColumns") : NULL;
+#endif
+  if (!fetch_columns)
+    skip("The driver library is not loaded under its own name");
+
+  ok_con(hdbc, SQLGetInfo(hdbc, SQL_DRIVER_HSTMT, &driver_hstmt,
+                          sizeof(driver_hstmt), NULL));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_fetch_columns");
+  ok_sql(hstmt, "CREATE TABLE t_fetch_columns (id BIGINT, amount DOUBLE, "
+                "day DATE, name VARCHAR(20) CHARACTER SET latin1)");
+
+  pos= query + sprintf((char *)query, "INSERT INTO t_fetch_columns VALUES ");
+  for (i= 0; i < 25; ++i)
+  {
+    if (i % 5)
+      sprintf((char *)name, "'name-%d'", (int)i);
+    else
+      strcpy((char *)name, "NULL");
+
+    pos+= sprintf((char *)pos, "%s(%d, %d.25, '1970-01-%02d', %s)",
+                  i ? "," : "", (int)i - 3, (int)i, (int)i + 1, name);
+  }
+  ok_stmt(hstmt, SQLExecDirect(hstmt, query, SQL_NTS));
+
+  memset(columns, 0, sizeof(columns));
+  columns[0].layout= MYODBC_COLUMN_INT64;
+  columns[0].values= ids;
+  columns[1].layout= MYODBC_COLUMN_DOUBLE;
+  columns[1].values= amounts;
+  columns[2].layout= MYODBC_COLUMN_DATE32;
+  columns[2].values= days;
+  columns[3].layout= MYODBC_COLUMN_STRING;
+  columns[3].values= offsets;
+  columns[3].data= names;
+  columns[3].data_max= sizeof(names);
+  columns[3].validity= validity;
+
+  ok_sql(hstmt, "SELECT * FROM t_fetch_columns ORDER BY id");
+
+  while ((rc= fetch_columns(driver_hstmt, 4, columns, 10, &rows)) ==
+         SQL_SUCCESS)
+  {
+    ++calls;
+    is(rows > 0 && rows <= 10);
+
+    for (i= 0; i < rows; ++i, ++total)
+    {
+      is_num(ids[i], (SQLBIGINT)total - 3);
+      is(amounts[i] == total + 0.25);
+      is_num(days[i], total);
+
+      if (total % 5)
+      {
+        sprintf((char *)name, "name-%d", (int)total);
+        is(validity[i / 8] & (1 << (i % 8)));
+        is_num(offsets[i + 1] - offsets[i], strlen((char *)name));
+        is(!memcmp(names + offsets[i], name, strlen((char *)name)));
+      }
+      else
+      {
+        is(!(validity[i / 8] & (1 << (i % 8))));
+        is_num(offsets[i + 1], offsets[i]);
+      }
+    }
+    is_num(columns[3].data_used, offsets[rows]);
+    /* The names are sent as latin1, whatever the connection uses */
+    is_num(columns[3].charsetnr, 8);
+  }
+
+  is_num(rc, SQL_NO_DATA);
+  is_num(total, 25);
+  is(calls > 3);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  /* Any column can be read as strings, but not the VARCHAR one as dates */
+  columns[2].layout= MYODBC_COLUMN_STRING;
+  columns[3].layout= MYODBC_COLUMN_DATE32;
+  ok_sql(hstmt, "SELECT * FROM t_fetch_columns ORDER BY id");
+  is_num(fetch_columns(driver_hstmt, 4, columns, 10, &rows), SQL_ERROR);
+  is_num(check_sqlstate(hstmt, "07006"), OK);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_fetch_columns");
+
+#ifndef _WIN32
+  dlclose(driver);
+#endif
+
+  return OK;
+}
+
+
+/*
+  MySQLGetArrowStream(), only there when the driver is built WITH_ARROW.
+  Reads the result in batches of 4 rows through the Arrow C stream interface
+*/
+DECLARE_TEST(t_arrow_stream)
+{
+  MySQLGetArrowStream_t get_arrow_stream;
+  SQLHSTMT      driver_hstmt= hstmt;
+  SQLCHAR       driver_name[256];
+  struct ArrowArrayStream stream;
+  struct ArrowSchema schema;
+  struct ArrowArray batch;
+  const int64_t *ids;
+  const int32_t *offsets;
+  const uint8_t *validity;
+  const char    *names;
+  char          name[32];
+  int64_t       i;
+  int           total= 0, batches= 0;
+#ifdef _WIN32
+  HMODULE       driver;
+#else
+  void          *driver;
+#endif
+
+  ok_con(hdbc, SQLGetInfo(hdbc, SQL_DRIVER_NAME, driver_name,
+                          sizeof(driver_name), NULL));
+#ifdef _WIN32
+  driver= GetModuleHandleA((char *)driver_name);
+  get_arrow_stream= driver ? (MySQLGetArrowStream_t)GetProcAddress(driver,
+                                                 "MySQLGetArrowStream") : NULL;
+#else
+  driver= dlopen((char *)driver_name, RTLD_LAZY | RTLD_NOLOAD);
+  get_arrow_stream= driver ? (MySQLGetArrowStream_t)dlsym(driver,
+                                                 "MySQLGetArrowStream") : NULL;
+#endif
+  if (!get_arrow_stream)
+    skip("The driver is not built with the Arrow export");
+
+  ok_con(hdbc, SQLGetInfo(hdbc, SQL_DRIVER_HSTMT, &driver_hstmt,
+                          sizeof(driver_hstmt), NULL));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_arrow_stream");
+  ok_sql(hstmt, "CREATE TABLE t_arrow_stream (id BIGINT NOT NULL, "
+                "amount DECIMAL(10,2), name VARCHAR(20), "
+                "city VARCHAR(20) CHARACTER SET latin1)");
+  ok_sql(hstmt, "INSERT INTO t_arrow_stream (id, amount, name) "
+                "VALUES (1, 1.50, 'one'), "
+                "(2, -2.25, NULL), (3, NULL, 'three'), (4, 4, 'four'), "
+                "(5, 5.05, 'five'), (6, 6, NULL), (7, 7, 'seven')");
+  /* Zurich with u umlaut in latin1, exported converted to UTF-8 */
+  ok_sql(hstmt, "UPDATE t_arrow_stream SET city= X'5AFC72696368' "
+                "WHERE id = 1");
+
+  ok_sql(hstmt, "SELECT * FROM t_arrow_stream ORDER BY id");
+  ok_stmt(hstmt, get_arrow_stream(driver_hstmt, 4, &stream));
+
+  is_num(stream.get_schema(&stream, &schema), 0);
+  is_str(schema.format, "+s", 2);
+  is_num(schema.n_children, 4);
+  is_str(schema.children[0]->format, "l", 1);
+  is_num(schema.children[0]->flags & ARROW_FLAG_NULLABLE, 0);
+  is_str(schema.children[1]->format, "d:10,2", 6);
+  is_str(schema.children[2]->format, "u", 1);
+  is_str(schema.children[2]->name, "name", 4);
+  is_str(schema.children[3]->format, "u", 1);
+  schema.release(&schema);
+
+  while (stream.get_next(&stream, &batch) == 0 && batch.release)
+  {
+    ++batches;
+    is_num(batch.n_children, 4);
+    is(batch.length > 0 && batch.length <= 4);
+
+    ids= (const int64_t *)batch.children[0]->buffers[1];
+    validity= (const uint8_t *)batch.children[2]->buffers[0];
+    offsets= (const int32_t *)batch.children[2]->buffers[1];
+    names= (const char *)batch.children[2]->buffers[2];
+
+    for (i= 0; i < batch.length; ++i, ++total)
+    {
+      is_num(ids[i], total + 1);
+
+      if (total == 1 || total == 5)
+      {
+        is(!(validity[i / 8] & (1 << (i % 8))));
+        is_num(offsets[i + 1], offsets[i]);
+      }
+      else if (total == 0)
+      {
+        strcpy(name, "one");
+        is_num(offsets[i + 1] - offsets[i], strlen(name));
+        is(!memcmp(names + offsets[i], name, strlen(name)));
+
+        strcpy(name, "Z\xC3\xBCrich");
+        offsets= (const int32_t *)batch.children[3]->buffers[1];
+        names= (const char *)batch.children[3]->buffers[2];
+        is_num(offsets[i + 1] - offsets[i], strlen(name));
+        is(!memcmp(names + offsets[i], name, strlen(name)));
+        offsets= (const int32_t *)batch.children[2]->buffers[1];
+        names= (const char *)batch.children[2]->buffers[2];
+      }
+    }
+
+    /* 1.50 and -2.25 as 128 bit integers scaled by 100 */
+    if (batches == 1)
+    {
+      const int64_t *amounts= (const int64_t *)batch.children[1]->buffers[1];
+      is_num(amounts[0], 150);
+      is_num(amounts[1], 0);
+      is_num(amounts[2], -225);
+      is_num(amounts[3], -1);
+      is_num(batch.children[1]->null_count, 1);
+    }
+
+    batch.release(&batch);
+  }
+
+  is_num(total, 7);
+  is_num(batches, 2);
+  is(stream.get_last_error(&stream) == NULL);
+  stream.release(&stream);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_arrow_stream");
+
+#ifndef _WIN32
+  dlclose(driver);
+#endif
+
+  return OK;
+}
+
+
+/*
+  Column-wise bound rowsets of integers, floating point numbers and dates
+  are filled a column at a time. Check that gives the same as the row by
+  row conversion: NULLs, the ends of the BIGINT range, zero dates and a
+  bookmark offset applied to the buffers.
+*/
+DECLARE_TEST(t_rowset_columns)
+{
+  SQLINTEGER  ints[8];
+  SQLBIGINT   bigs[8];
+  SQLDOUBLE   dbls[8];
+  SQLREAL     flts[8];
+  SQL_DATE_STRUCT dates[8];
+  SQLLEN      ints_ind[8], bigs_ind[8], dbls_ind[8], flts_ind[8],
+              dates_ind[8];
+  SQLUSMALLINT status[8];
+  SQLULEN     fetched;
+  SQLCHAR     query[2048], *pos;
+  int         i, row= 0;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_rowset_columns");
+  ok_sql(hstmt, "CREATE TABLE t_rowset_columns (id INT, big BIGINT, "
+                "amount DECIMAL(10,3), ratio INT, day DATE)");
+
+  pos= query + sprintf((char *)query, "INSERT INTO t_rowset_columns VALUES ");
+  for (i= 0; i < 20; ++i)
+  {
+    char id[16], big[24];
+
+    if (i % 6 == 5)
+      strcpy(id, "NULL");
+    else
+      sprintf(id, "%d", -2000000000 + 1000 * i);
+
+    if (i == 3)
+      strcpy(big, "-9223372036854775808");
+    else if (i == 4)
+      strcpy(big, "9223372036854775807");
+    else
+      sprintf(big, "%lld", (long long)i * 3000000000LL);
+
+    pos+= sprintf((char *)pos, "%s(%s, %s, %d.125, %d, %s)", i ? "," : "",
+                  id, big, i - 10, i * 16777217,
+                  i == 7 ? "'0000-00-00'" :
+                  i % 4 == 1 ? "NULL" : "'2019-02-28'");
+  }
+  ok_sql(hstmt, "SET SESSION sql_mode=''");
+  ok_stmt(hstmt, SQLExecDirect(hstmt, query, SQL_NTS));
+  ok_sql(hstmt, "SET SESSION sql_mode=DEFAULT");
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)8, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_STATUS_PTR, status, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, &fetched,
+                                0));
+
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_SLONG, ints, 0, ints_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_SBIGINT, bigs, 0, bigs_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 3, SQL_C_DOUBLE, dbls, 0, dbls_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 4, SQL_C_FLOAT, flts, 0, flts_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 5, SQL_C_TYPE_DATE, dates, 0, dates_ind));
+
+  ok_sql(hstmt, "SELECT * FROM t_rowset_columns ORDER BY ratio");
+
+  while (SQLFetch(hstmt) != SQL_NO_DATA)
+  {
+    for (i= 0; i < (int)fetched; ++i, ++row)
+    {
+      is_num(status[i], SQL_ROW_SUCCESS);
+
+      if (row % 6 == 5)
+      {
+        is_num(ints_ind[i], SQL_NULL_DATA);
+      }
+      else
+      {
+        is_num(ints_ind[i], sizeof(SQLINTEGER));
+        is_num(ints[i], -2000000000 + 1000 * row);
+      }
+
+      is_num(bigs_ind[i], sizeof(SQLBIGINT));
+      if (row == 3)
+      {
+        is(bigs[i] == -9223372036854775807LL - 1);
+      }
+      else if (row == 4)
+      {
+        is(bigs[i] == 9223372036854775807LL);
+      }
+      else
+      {
+        is(bigs[i] == (SQLBIGINT)row * 3000000000LL);
+      }
+
+      is_num(dbls_ind[i], sizeof(SQLDOUBLE));
+      is(dbls[i] == row - 10 + (row < 10 ? -0.125 : 0.125));
+
+      is_num(flts_ind[i], sizeof(SQLREAL));
+      is(flts[i] == (SQLREAL)(row * 16777217));
+
+      if (row == 7 || row % 4 == 1)
+      {
+        is_num(dates_ind[i], SQL_NULL_DATA);
+      }
+      else
+      {
+        is_num(dates_ind[i], sizeof(SQL_DATE_STRUCT));
+        is_num(dates[i].year, 2019);
+        is_num(dates[i].month, 2);
+        is_num(dates[i].day, 28);
+      }
+    }
+  }
+  is_num(row, 20);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_STATUS_PTR, NULL, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)1,
+                                0));
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_rowset_columns");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_bug32420)
   ADD_TEST(t_bug34575)
@@ -1453,6 +1847,9 @@ BEGIN_TESTS
   ADD_TEST(t_bug17311065)
   ADD_TEST(t_prefetch_bug)
   ADD_TEST(t_bug28098219)
+  ADD_TEST(t_fetch_columns)
+  ADD_TEST(t_arrow_stream)
+  ADD_TEST(t_rowset_columns)
 END_TESTS
 
 
@@ -940,6 +940,66 @@ DECLARE_TEST(t_sqlnum_from_str)
    is(OK == sqlnum_test_from_str(hstmt, "340282366920938463463374607431768211456", 39, 0, 1, expdata, 0, 1)); /* MAX+1 */}
   {SQLCHAR expdata[SQL_MAX_NUMERIC_LEN]= {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
    is(OK == sqlnum_test_from_str(hstmt, "0", 1, 0, 1, expdata, 0, 0));}
+  /* largest DECIMAL(38,10), scaled up beyond 38 digits */
+  {SQLCHAR expdata[SQL_MAX_NUMERIC_LEN]= {0xff,0xff,0xff,0xff,0x3f,0x22,0x8a,0x09,0x7a,0xc4,0x86,0x5a,0xa8,0x4c,0x3b,0x4b};
+   is(OK == sqlnum_test_from_str(hstmt, "9999999999999999999999999999.9999999999", 38, 10, 1, expdata, 0, 0));}
+  {SQLCHAR expdata[SQL_MAX_NUMERIC_LEN]= {0x40,0x14,0xad,0xe8,0xd5,0x4e,0xd9,0x3a,0x8b,0x52,0xa1,0x7f,0x57,0xa5,0x79,0x99};
+   is(OK == sqlnum_test_from_str(hstmt, "-2040035048049092070.70610300000009", 39, 20, 0, expdata, 0, 0));}
+
+  return OK;
+}
+
+
+/*
+   Integers fetched through server side prepared statements are converted
+   to SQL_NUMERIC_STRUCT from their binary value
+*/
+DECLARE_TEST(t_sqlnum_from_int)
+{
+  SQL_NUMERIC_STRUCT sqlnum[3];
+  SQLHANDLE ard;
+  SQLSCHAR scale[3]= {0, 0, 2};
+  int i;
+  SQLCHAR min_bigint[SQL_MAX_NUMERIC_LEN]= {0,0,0,0,0,0,0,0x80, 0,0,0,0,0,0,0,0};
+  SQLCHAR max_ubigint[SQL_MAX_NUMERIC_LEN]= {0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff, 0,0,0,0,0,0,0,0};
+  SQLCHAR minus_500[SQL_MAX_NUMERIC_LEN]= {0xf4,0x01,0,0,0,0,0,0, 0,0,0,0,0,0,0,0};
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_sqlnum_from_int");
+  ok_sql(hstmt, "CREATE TABLE t_sqlnum_from_int (a BIGINT, "
+                "b BIGINT UNSIGNED, c INT)");
+  ok_sql(hstmt, "INSERT INTO t_sqlnum_from_int VALUES "
+                "(-9223372036854775808, 18446744073709551615, -5)");
+
+  ok_stmt(hstmt, SQLPrepare(hstmt, (SQLCHAR *)"SELECT a, b, c FROM "
+                            "t_sqlnum_from_int", SQL_NTS));
+  ok_stmt(hstmt, SQLExecute(hstmt));
+
+  ok_stmt(hstmt, SQLGetStmtAttr(hstmt, SQL_ATTR_APP_ROW_DESC, &ard, 0, NULL));
+
+  for (i= 0; i < 3; ++i)
+  {
+    ok_desc(ard, SQLSetDescField(ard, i + 1, SQL_DESC_TYPE,
+                                 (SQLPOINTER) SQL_C_NUMERIC, SQL_IS_INTEGER));
+    ok_desc(ard, SQLSetDescField(ard, i + 1, SQL_DESC_PRECISION,
+                                 (SQLPOINTER) 20, SQL_IS_INTEGER));
+    ok_desc(ard, SQLSetDescField(ard, i + 1, SQL_DESC_SCALE,
+                                 (SQLPOINTER)(size_t)scale[i], SQL_IS_INTEGER));
+    ok_desc(ard, SQLSetDescField(ard, i + 1, SQL_DESC_DATA_PTR,
+                                 &sqlnum[i], SQL_IS_POINTER));
+  }
+
+  ok_stmt(hstmt, SQLFetch(hstmt));
+
+  is_num(sqlnum[0].sign, 0);
+  is(!memcmp(sqlnum[0].val, min_bigint, SQL_MAX_NUMERIC_LEN));
+  is_num(sqlnum[1].sign, 1);
+  is(!memcmp(sqlnum[1].val, max_ubigint, SQL_MAX_NUMERIC_LEN));
+  is_num(sqlnum[2].sign, 0);
+  is_num(sqlnum[2].scale, 2);
+  is(!memcmp(sqlnum[2].val, minus_500, SQL_MAX_NUMERIC_LEN));
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_sqlnum_from_int");
 
   return OK;
 }
@@ -1248,6 +1308,105 @@ DECLARE_TEST(t_bug69545)
 }
 
 
+/*
+  Binary function results read as characters are UTF-8, converted to the
+  single-byte ANSI character set by its transcoder, also in pieces.
+*/
+DECLARE_TEST(t_transcode_ansi)
+{
+  SQLCHAR buf[16];
+  SQLLEN buflen;
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL,
+                                        "NO_BINARY_RESULT=1;CHARSET=latin1"));
+
+  /* U+2192 is not in latin1 */
+  ok_sql(hstmt1, "SELECT CAST(CONVERT(_utf8mb4 0x4772C3BCC39F652065E28692 "
+                 "USING utf8mb4) AS BINARY)");
+
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  expect_stmt(hstmt1, SQLGetData(hstmt1, 1, SQL_C_CHAR, buf, sizeof(buf),
+                                 &buflen), SQL_SUCCESS_WITH_INFO);
+  is(check_sqlstate(hstmt1, "22018") == OK);
+  is_num(buflen, 8);
+  is(memcmp(buf, "Gr\xfc\xdf""e e?", 9) == 0);
+
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "SELECT CAST(CONVERT(_utf8mb4 0x4772C3BCC39F6520 "
+                 "USING utf8mb4) AS BINARY)");
+
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  expect_stmt(hstmt1, SQLGetData(hstmt1, 1, SQL_C_CHAR, buf, 4, &buflen),
+              SQL_SUCCESS_WITH_INFO);
+  is_num(buflen, 6);
+  is_str(buf, "Gr\xfc", 4);
+  ok_stmt(hstmt1, SQLGetData(hstmt1, 1, SQL_C_CHAR, buf, 4, &buflen));
+  is_num(buflen, 3);
+  is_str(buf, "\xdf""e ", 4);
+  expect_stmt(hstmt1, SQLGetData(hstmt1, 1, SQL_C_CHAR, buf, 4, &buflen),
+              SQL_NO_DATA);
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+/*
+  Integer results that do not fit the requested C type are reported as
+  22003 instead of being truncated
+*/
+DECLARE_TEST(t_int_range)
+{
+  SQLINTEGER    slong;
+  SQLUINTEGER   ulong_val;
+  SQLBIGINT     sbig;
+  SQLUBIGINT    ubig;
+  SQLSCHAR      stiny;
+  SQLCHAR       utiny;
+  SQLSMALLINT   sshort;
+
+  ok_sql(hstmt, "SELECT 4294967295, 4294967295, -1, -1, "
+                "18446744073709551615, 18446744073709551615, 300, 300, "
+                "'-9223372036854775808', ' 0042'");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+
+  expect_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_SLONG, &slong, 0, NULL),
+              SQL_ERROR);
+  is(check_sqlstate(hstmt, "22003") == OK);
+  ok_stmt(hstmt, SQLGetData(hstmt, 2, SQL_C_ULONG, &ulong_val, 0, NULL));
+  is_num(ulong_val, 4294967295U);
+
+  expect_stmt(hstmt, SQLGetData(hstmt, 3, SQL_C_UBIGINT, &ubig, 0, NULL),
+              SQL_ERROR);
+  is(check_sqlstate(hstmt, "22003") == OK);
+  ok_stmt(hstmt, SQLGetData(hstmt, 4, SQL_C_STINYINT, &stiny, 0, NULL));
+  is_num(stiny, -1);
+
+  ok_stmt(hstmt, SQLGetData(hstmt, 5, SQL_C_UBIGINT, &ubig, 0, NULL));
+  is(ubig == 18446744073709551615ULL);
+  expect_stmt(hstmt, SQLGetData(hstmt, 6, SQL_C_SBIGINT, &sbig, 0, NULL),
+              SQL_ERROR);
+  is(check_sqlstate(hstmt, "22003") == OK);
+
+  expect_stmt(hstmt, SQLGetData(hstmt, 7, SQL_C_UTINYINT, &utiny, 0, NULL),
+              SQL_ERROR);
+  is(check_sqlstate(hstmt, "22003") == OK);
+  ok_stmt(hstmt, SQLGetData(hstmt, 8, SQL_C_SSHORT, &sshort, 0, NULL));
+  is_num(sshort, 300);
+
+  ok_stmt(hstmt, SQLGetData(hstmt, 9, SQL_C_SBIGINT, &sbig, 0, NULL));
+  is(sbig == -9223372036854775807LL - 1);
+  ok_stmt(hstmt, SQLGetData(hstmt, 10, SQL_C_SLONG, &slong, 0, NULL));
+  is_num(slong, 42);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_text_types)
   ADD_TEST(t_longlong1)
@@ -1260,6 +1419,7 @@ BEGIN_TESTS
   ADD_TEST(binary_suffix)
   ADD_TEST(t_sqlnum_msdn)
   ADD_TEST(t_sqlnum_from_str)
+  ADD_TEST(t_sqlnum_from_int)
 #endif
   ADD_TEST(t_bug16917)
   ADD_TEST(t_bug16235)
@@ -1274,6 +1434,8 @@ BEGIN_TESTS
   ADD_TEST(t_bug29402)
   ADD_TEST(t_bug67793)
   ADD_TEST(t_bug69545)
+  ADD_TEST(t_transcode_ansi)
+  ADD_TEST(t_int_range)
 END_TESTS
 
 
@@ -197,10 +197,51 @@ DECLARE_TEST(t_bug39878)
 }
 
 
+/**
+  KILL_ON_CLOSE: closing a streamed result early kills the query instead of
+  reading the remaining rows, and the connection stays usable.
+*/
+DECLARE_TEST(t_kill_on_close)
+{
+  SQLHENV    henv1;
+  SQLHDBC    hdbc1;
+  SQLHSTMT   hstmt1;
+  SQLINTEGER i;
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL,
+                                        "NO_CACHE=1;KILL_ON_CLOSE=1"));
+
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_CURSOR_TYPE,
+                                 (SQLPOINTER)SQL_CURSOR_FORWARD_ONLY, 0));
+
+  /* Big enough for the server to still be sending when we close */
+  ok_sql(hstmt1, "SELECT a.column_name FROM information_schema.columns a, "
+                 "information_schema.columns b");
+
+  for (i= 0; i < 10; ++i)
+  {
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+  }
+
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "SELECT 42");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), 42);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_use_result)
   ADD_TEST(t_bug4657)
   ADD_TEST(t_bug39878)
+  ADD_TEST(t_kill_on_close)
 END_TESTS
 
 
@@ -0,0 +1,216 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/*
+  Unit tests of myodbc_ftoa(). They need no server.
+
+  Every value must read back unchanged with strtod()/strtof(), in both the
+  plain and the exponent format. The values are fixed: subnormals, powers
+  of ten and their neighbours, powers of two, integers around 2^53 and 2^24 where every
+  other integer is halfway between two values, and binary fractions that
+  end in a decimal 5. No result may need more than the 17 (float: 9)
+  significant digits that are always enough; Grisu2 is not always the
+  shortest, so that is the only limit on their number.
+*/
+
+#include "ftoa.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static unsigned long long failures= 0, checked= 0;
+
+
+static int significant_digits(const char *str)
+{
+  int digits= 0, leading= 1;
+
+  for (; *str && *str != 'e' && *str != 'E'; ++str)
+  {
+    if (*str >= '0' && *str <= '9')
+    {
+      if (*str != '0')
+        leading= 0;
+      if (!leading)
+        ++digits;
+    }
+  }
+
+  /* Trailing zeros of integers written in full are not significant */
+  for (--str; digits > 1 && *str == '0'; --str)
+    --digits;
+
+  return digits ? digits : 1;
+}
+
+
+static void check_value(double value, bool single)
+{
+  char buf[MYODBC_FTOA_BUFFER_SIZE];
+  int flags;
+
+  for (flags= 0; flags <= MYODBC_FTOA_EXP; flags+= MYODBC_FTOA_EXP)
+  {
+    size_t length= myodbc_ftoa(value, buf, flags | (single ? MYODBC_FTOA_FLOAT : 0));
+    bool ok= length == strlen(buf) && length < MYODBC_FTOA_BUFFER_SIZE &&
+             (single ? strtof(buf, NULL) == (float)value
+                     : strtod(buf, NULL) == value) &&
+             std::signbit(single ? strtof(buf, NULL) : strtod(buf, NULL)) ==
+               std::signbit(value) &&
+             significant_digits(buf) <= (single ? 9 : 17);
+
+    ++checked;
+    if (!ok && ++failures <= 20)
+    {
+      printf("failed: %s %.17g flags=%d -> %s\n", single ? "float" : "double",
+             value, flags, buf);
+    }
+  }
+}
+
+
+static void check_both_signs(double value, bool single)
+{
+  check_value(value, single);
+  check_value(-value, single);
+}
+
+
+static double double_from_bits(unsigned long long bits)
+{
+  double d;
+
+  memcpy(&d, &bits, sizeof(d));
+  return d;
+}
+
+
+static float float_from_bits(unsigned int bits)
+{
+  float f;
+
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+
+int main()
+{
+  char power[16];
+  int i, e;
+
+  check_both_signs(0.0, false);
+  check_both_signs(0.0, true);
+
+  /* Subnormals: the smallest ones, the largest ones and the powers of two */
+  for (i= 1; i <= 1000; ++i)
+  {
+    check_both_signs(double_from_bits(i), false);
+    check_both_signs(double_from_bits(0x000FFFFFFFFFFFFFULL - i + 1), false);
+    check_both_signs(float_from_bits(i), true);
+    check_both_signs(float_from_bits(0x007FFFFF - i + 1), true);
+  }
+  for (i= 0; i < 52; ++i)
+  {
+    check_both_signs(double_from_bits(1ULL << i), false);
+  }
+  for (i= 0; i < 23; ++i)
+  {
+    check_both_signs(float_from_bits(1U << i), true);
+  }
+  /* The smallest normal numbers */
+  check_both_signs(double_from_bits(0x0010000000000000ULL), false);
+  check_both_signs(float_from_bits(0x00800000), true);
+
+  /* Powers of ten and the values right next to them */
+  for (e= -323; e <= 308; ++e)
+  {
+    double d;
+
+    snprintf(power, sizeof(power), "1e%d", e);
+    d= strtod(power, NULL);
+
+    check_both_signs(d, false);
+    check_both_signs(nextafter(d, 0.0), false);
+    check_both_signs(nextafter(d, HUGE_VAL), false);
+  }
+  for (e= -45; e <= 38; ++e)
+  {
+    float f;
+
+    snprintf(power, sizeof(power), "1e%d", e);
+    f= strtof(power, NULL);
+
+    check_both_signs(f, true);
+    check_both_signs(nextafterf(f, 0.0f), true);
+    check_both_signs(nextafterf(f, HUGE_VALF), true);
+  }
+
+  /* Powers of two, where the gap to the value below is half the one above */
+  for (e= -1022; e <= 1023; ++e)
+  {
+    check_both_signs(ldexp(1.0, e), false);
+  }
+  for (e= -126; e <= 127; ++e)
+  {
+    check_both_signs(ldexpf(1.0f, e), true);
+  }
+
+  /* The largest values */
+  check_both_signs(double_from_bits(0x7FEFFFFFFFFFFFFFULL), false);
+  check_both_signs(float_from_bits(0x7F7FFFFF), true);
+
+  /*
+    From 2^53 (2^24 for floats) on only even integers are exact, the odd
+    ones in between are halfway cases that must not be printed
+  */
+  for (i= -1000; i <= 1000; ++i)
+  {
+    check_both_signs(9007199254740992.0 + 2.0 * i, false);
+    check_both_signs(18014398509481984.0 + 4.0 * i, false);
+    check_both_signs((float)(16777216.0 + 2.0 * i), true);
+  }
+
+  /* Binary fractions, their shortest digits end in a 5 */
+  for (i= 0; i <= 2000; ++i)
+  {
+    check_both_signs(i + 0.5, false);
+    check_both_signs(i / 8.0, false);
+    check_both_signs(i / 1024.0, false);
+    check_both_signs(ldexp(2.0 * i + 1.0, -60), false);
+    check_both_signs((float)(i + 0.5), true);
+    check_both_signs((float)(i / 1024.0), true);
+  }
+
+  printf("checked=%llu;failures=%llu\n", checked, failures);
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,369 @@
+// Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, version 2.0, as
+// published by the Free Software Foundation.
+//
+// This program is also distributed with certain software (including
+// but not limited to OpenSSL) that is licensed under separate terms,
+// as designated in a particular file or component or in included license
+// documentation. The authors of MySQL hereby grant you an
+// additional permission to link the program and your derivative works
+// with the separately licensed software that they have included with
+// MySQL.
+//
+// Without limiting anything contained in the foregoing, this file,
+// which is part of <MySQL Product>, is also subject to the
+// Universal FOSS Exception, version 1.0, a copy of which can be found at
+// http://oss.oracle.com/licenses/universal-foss-exception.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License, version 2.0, for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+/*
+  Unit tests of the query tokenizer. They need no server.
+
+  Every query is tokenized twice, once with the bulk skipping of ordinary
+  bytes and once character by character, and the tokens, the parameter
+  markers and the last character must come out the same. The queries are
+  a fixed set plus random ones assembled from quotes, escapes, comments,
+  separators and multi-byte characters, with a fixed seed.
+
+  Statement digests, which are computed with the same tokenizer, are
+  checked against fixed texts and must fit into DIGEST_TEXT_LENGTH bytes
+  however long the query is.
+*/
+
+#include "driver.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static unsigned long long failures= 0, checked= 0;
+
+struct Tokenized
+{
+  std::vector<uint> tokens, params;
+  long last_char;
+};
+
+
+static Tokenized tokenize_query(const std::string &query, CHARSET_INFO *cs,
+                                BOOL fast_scan)
+{
+  MY_PARSED_QUERY pq;
+  MY_PARSER parser;
+  Tokenized result;
+  char *text= (char *)myodbc_malloc(query.length() + 1, MYF(0));
+
+  memcpy(text, query.c_str(), query.length() + 1);
+  init_parsed_query(&pq);
+  reset_parsed_query(&pq, text, text + query.length(), cs);
+
+  init_parser(&parser, &pq);
+  parser.fast_scan= parser.fast_scan && fast_scan;
+  tokenize(&parser);
+
+  result.tokens.assign((uint *)pq.token.buffer,
+                       (uint *)pq.token.buffer + TOKEN_COUNT(&pq));
+  result.params.assign((uint *)pq.param_pos.buffer,
+                       (uint *)pq.param_pos.buffer + PARAM_COUNT(&pq));
+  result.last_char= pq.last_char ? (long)(pq.last_char - text) : -1;
+
+  delete_parsed_query(&pq);
+
+  return result;
+}
+
+
+static void report(const char *what, const std::string &query,
+                   const char *charset)
+{
+  size_t i;
+
+  ++failures;
+  printf("failed: %s;charset=%s;query=", what, charset);
+  for (i= 0; i < query.length(); ++i)
+  {
+    unsigned char c= (unsigned char)query[i];
+
+    if (c >= ' ' && c < 0x7F && c != '\\')
+      putchar(c);
+    else
+      printf("\\x%02X", c);
+  }
+  putchar('\n');
+}
+
+
+/* The bulk skipping must not change what tokenize() finds */
+static void check_same(const std::string &query, CHARSET_INFO *cs)
+{
+  Tokenized fast= tokenize_query(query, cs, TRUE);
+  Tokenized slow= tokenize_query(query, cs, FALSE);
+
+  ++checked;
+
+  if (fast.tokens != slow.tokens || fast.params != slow.params ||
+      fast.last_char != slow.last_char)
+  {
+    report("bulk skipping differs", query, cs->csname);
+  }
+}
+
+
+static void check_params(const std::string &query, CHARSET_INFO *cs,
+                         size_t params)
+{
+  check_same(query, cs);
+
+  if (tokenize_query(query, cs, TRUE).params.size() != params)
+  {
+    report("parameter markers", query, cs->csname);
+  }
+}
+
+
+static void check_digest(const std::string &query, CHARSET_INFO *cs,
+                         const char *expected)
+{
+  char text[DIGEST_TEXT_LENGTH];
+  size_t length= query_digest(query.c_str(), query.c_str() + query.length(),
+                              cs, text, sizeof(text));
+
+  ++checked;
+
+  if (length != strlen(text) || strcmp(text, expected))
+  {
+    report("digest", query, cs->csname);
+    printf("  got: %s\n", text);
+  }
+}
+
+
+/* Digests that don't fit must be cut, also right after a collapsed list */
+static void check_long_digest(const std::string &query, CHARSET_INFO *cs)
+{
+  /* On the heap and of the exact size, so that ASan sees any overflow */
+  std::vector<char> text(DIGEST_TEXT_LENGTH);
+  size_t length= query_digest(query.c_str(), query.c_str() + query.length(),
+                              cs, &text[0], text.size());
+
+  ++checked;
+
+  if (length >= text.size() || length != strlen(&text[0]) ||
+      length < 3 || memcmp(&text[length - 3], "...", 3))
+  {
+    report("long digest", query, cs->csname);
+  }
+}
+
+
+/* What keeps a read on the primary instead of a read replica */
+static void check_session(const std::string &query, CHARSET_INFO *cs,
+                          BOOL session, BOOL temporary)
+{
+  MY_PARSED_QUERY pq;
+  MY_PARSER parser;
+  char *text= (char *)myodbc_malloc(query.length() + 1, MYF(0));
+
+  memcpy(text, query.c_str(), query.length() + 1);
+  init_parsed_query(&pq);
+  reset_parsed_query(&pq, text, text + query.length(), cs);
+  init_parser(&parser, &pq);
+  tokenize(&parser);
+
+  ++checked;
+
+  if (is_session_select(&pq) != session)
+  {
+    report("session select", query, cs->csname);
+  }
+  if (is_create_temporary(&pq) != temporary)
+  {
+    report("create temporary", query, cs->csname);
+  }
+
+  delete_parsed_query(&pq);
+}
+
+
+static const struct
+{
+  const char  *query;
+  BOOL        session, temporary;
+} sessions[]=
+{
+  {"SELECT a FROM t WHERE id = 1 FOR UPDATE", TRUE, FALSE},
+  {"select a from t for  share", TRUE, FALSE},
+  {"SELECT a FROM t LOCK IN SHARE MODE", TRUE, FALSE},
+  {"SELECT a FROM t WHERE x=LAST_INSERT_ID()", TRUE, FALSE},
+  {"SELECT found_rows()", TRUE, FALSE},
+  {"SELECT a FROM t WHERE b = @v", TRUE, FALSE},
+  {"SELECT @@session.sql_mode", TRUE, FALSE},
+  {"SELECT GET_LOCK('l', 0)", TRUE, FALSE},
+  {"SELECT a FROM t WHERE b = 'FOR UPDATE @v last_insert_id()'", FALSE, FALSE},
+  {"SELECT `get_lock`, `for` FROM t /* FOR UPDATE */ -- @v\n", FALSE, FALSE},
+  {"SELECT sql_calc_found_rows a, lock_id, updated FROM t", FALSE, FALSE},
+  {"CREATE TEMPORARY TABLE t (a INT)", FALSE, TRUE},
+  {"create  temporary table t select 1", FALSE, TRUE},
+  {"CREATE TABLE t (a INT)", FALSE, FALSE},
+};
+
+
+static const char *digests[][2]=
+{
+  {"SELECT a, b FROM t WHERE c = 1 AND d = 'x' -- c\n", "SELECT a, b FROM t WHERE c = ? AND d = ?"},
+  {"select *  from `t` where\ta in (1, -2, 3.5e3, ?, 'a''b')", "select * from `t` where a in (...)"},
+  {"INSERT INTO t VALUES (1, 'a'), (2, 'b'), (3, X'00')", "INSERT INTO t VALUES (...)"},
+  {"INSERT INTO t VALUES (1, NOW()), (2, NOW())", "INSERT INTO t VALUES (?, NOW ()), (?, NOW ())"},
+  {"SELECT f(-2), g(1, 2) FROM t", "SELECT f (?), g (?, ?) FROM t"},
+  {"SELECT a FROM t WHERE (a, b) IN ((1, 2), (3, 4))", "SELECT a FROM t WHERE (a, b) IN ((...))"},
+  {"SELECT a - 1, a-1, 1col FROM t /* 1 */ LIMIT 10", "SELECT a - ?, a - ?, 1col FROM t LIMIT ?"},
+  {"SELECT /*!50001 SQL_NO_CACHE */ _utf8'a', n'b', a.b", "SELECT SQL_NO_CACHE ?, ?, a.b"},
+  {"SELECT a <=> b, c->>'$.d' FROM t", "SELECT a <=> b, c ->> ? FROM t"},
+};
+
+static const char *fixed[][2]=
+{
+  /* query, expected parameter markers as digits */
+  {"SELECT ?", "1"},
+  {"SELECT '?', \"?\", `?`, ?", "1"},
+  {"SELECT 'it''s ?', 'a\\'?', ?", "1"},
+  {"SELECT 'a\\\\', ?, '\\\\'", "1"},
+  {"SELECT ? -- ?\n, ? # ?\r\n, ?", "3"},
+  {"SELECT /* ? */ ? /* ?", "1"},
+  {"SELECT /*! ? */ ?", "2"},
+  {"SELECT ?--?", "2"},
+  {"SELECT 1; SELECT ?;", "1"},
+  {"{call p(?, ?)}", "2"},
+  {"SELECT '", "0"},
+  {"SELECT 'abcdefghijklmnopqrstuvwxyz0123456789?' AS a, ?", "1"},
+  {"SELECT a FROM t WHERE b IN (1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, ?)", "1"},
+  {"/* a long comment with ? and ' and \" in it */ SELECT ?", "1"},
+};
+
+/* Pieces of the random queries; the last ones are charset specific */
+static const char *pieces[]=
+{
+  "SELECT", "a", "1", "_x", " ", "  ", "\t", "\n", "\r\n", "'", "\"", "`",
+  "\\", "\\'", "''", "?", "#", "-- ", "--", "-", "/*", "*/", "/*!", "/", "*",
+  ";", "{", "}", "(", ")", ",", "abcdefghijklmnopqrstuvwxyz", "0123456789"
+};
+
+static const struct
+{
+  const char *charset;
+  const char *pieces[3];
+} charsets[]=
+{
+  {"utf8mb4", {"\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80"}},
+  {"latin1",  {"\xE9", "\xA7", "\xFF"}},
+  /* Trailing bytes that are ASCII '\\', '`' and '{' */
+  {"gbk",     {"\x81\x5C", "\x81\x60", "\x81\x7B"}},
+  {"sjis",    {"\x95\x5C", "\x83\x60", "\x83\x7B"}}
+};
+
+
+int main()
+{
+  std::mt19937 random(20181018);
+  size_t c, i;
+
+  for (c= 0; c < sizeof(charsets) / sizeof(charsets[0]); ++c)
+  {
+    CHARSET_INFO *cs= get_charset_by_csname(charsets[c].charset,
+                                            MYF(MY_CS_PRIMARY), MYF(0));
+    size_t piece_count= sizeof(pieces) / sizeof(pieces[0]);
+    int n;
+
+    if (!cs)
+    {
+      printf("failed: no charset %s\n", charsets[c].charset);
+      ++failures;
+      continue;
+    }
+
+    for (i= 0; i < sizeof(fixed) / sizeof(fixed[0]); ++i)
+    {
+      check_params(fixed[i][0], cs, fixed[i][1][0] - '0');
+    }
+
+    /* A multi-byte character inside and outside quotes and comments */
+    for (i= 0; i < 3; ++i)
+    {
+      std::string mb= charsets[c].pieces[i];
+
+      check_params("SELECT '" + mb + "', ?", cs, 1);
+      check_params("SELECT `" + mb + "` FROM t WHERE a = ?", cs, 1);
+      check_params("SELECT " + mb + "?" + mb, cs, 1);
+      check_params("SELECT 1 /* " + mb + " */, ? -- " + mb + "\n", cs, 1);
+
+      /* An incomplete character at the end must not stop the parser */
+      if (mb.length() > 1)
+      {
+        std::string cut= mb.substr(0, mb.length() - 1);
+
+        check_params("SELECT ?, '" + cut, cs, 1);
+        check_params("SELECT ?, " + cut, cs, 1);
+        check_digest("SELECT ?, '" + cut, cs, "SELECT ?, ?");
+      }
+    }
+
+    for (i= 0; i < sizeof(digests) / sizeof(digests[0]); ++i)
+    {
+      check_digest(digests[i][0], cs, digests[i][1]);
+    }
+
+    for (i= 0; i < sizeof(sessions) / sizeof(sessions[0]); ++i)
+    {
+      check_session(sessions[i].query, cs, sessions[i].session,
+                    sessions[i].temporary);
+    }
+
+    /* Every alignment of the buffer end with a list, a word and a quote */
+    for (i= 0; i < 16; ++i)
+    {
+      std::string query= "SELECT " + std::string(i + 1, 'a') + " FROM t WHERE ";
+      std::string quoted= query;
+
+      for (n= 0; n < 200; ++n)
+      {
+        query+= "x IN (1) AND ";
+        quoted+= "'" + std::string(charsets[c].pieces[n % 3]) + "' = y" +
+                 std::to_string(n) + " AND ";
+      }
+      check_long_digest(query, cs);
+      check_long_digest(quoted, cs);
+    }
+
+    for (n= 0; n < 20000; ++n)
+    {
+      std::string query;
+      int length= 1 + random() % 40;
+
+      while (length-- > 0)
+      {
+        size_t piece= random() % (piece_count + 3);
+
+        query+= piece < piece_count ? pieces[piece] :
+                charsets[c].pieces[piece - piece_count];
+      }
+      check_same(query, cs);
+    }
+  }
+
+  printf("checked=%llu;failures=%llu\n", checked, failures);
+
+  return failures ? 1 : 0;
+}
@@ -192,6 +192,30 @@ static SQLWCHAR W_SSLMODE[] =
 { 'S', 'S', 'L', 'M', 'O', 'D', 'E', 0 };
 static SQLWCHAR W_NO_DATE_OVERFLOW[] =
 { 'N', 'O', '_', 'D', 'A', 'T', 'E', '_', 'O', 'V', 'E', 'R', 'F', 'L', 'O', 'W', 0 };
+static SQLWCHAR W_READ_REPLICAS[] =
+{ 'R', 'E', 'A', 'D', '_', 'R', 'E', 'P', 'L', 'I', 'C', 'A', 'S', 0 };
+static SQLWCHAR W_KILL_ON_CLOSE[] =
+{ 'K', 'I', 'L', 'L', '_', 'O', 'N', '_', 'C', 'L', 'O', 'S', 'E', 0 };
+static SQLWCHAR W_COMPRESSION_ALGORITHMS[] =
+{ 'C', 'O', 'M', 'P', 'R', 'E', 'S', 'S', 'I', 'O', 'N', '_',
+  'A', 'L', 'G', 'O', 'R', 'I', 'T', 'H', 'M', 'S', 0 };
+static SQLWCHAR W_ZSTD_COMPRESSION_LEVEL[] =
+{ 'Z', 'S', 'T', 'D', '_', 'C', 'O', 'M', 'P', 'R', 'E', 'S', 'S', 'I', 'O', 'N', '_',
+  'L', 'E', 'V', 'E', 'L', 0 };
+static SQLWCHAR W_HEX_BINARY_PARAMS[] =
+{ 'H', 'E', 'X', '_', 'B', 'I', 'N', 'A', 'R', 'Y', '_',
+  'P', 'A', 'R', 'A', 'M', 'S', 0 };
+static SQLWCHAR W_PERF_COUNTERS_FILE[] =
+{ 'P', 'E', 'R', 'F', '_', 'C', 'O', 'U', 'N', 'T', 'E', 'R', 'S', '_',
+  'F', 'I', 'L', 'E', 0 };
+static SQLWCHAR W_STATEMENT_DIGESTS[] =
+{ 'S', 'T', 'A', 'T', 'E', 'M', 'E', 'N', 'T', '_',
+  'D', 'I', 'G', 'E', 'S', 'T', 'S', 0 };
+static SQLWCHAR W_ENABLE_LOCAL_INFILE[] =
+{ 'E', 'N', 'A', 'B', 'L', 'E', '_', 'L', 'O', 'C', 'A', 'L', '_',
+  'I', 'N', 'F', 'I', 'L', 'E', 0 };
+static SQLWCHAR W_LOAD_DATA_ROWS[] =
+{ 'L', 'O', 'A', 'D', '_', 'D', 'A', 'T', 'A', '_', 'R', 'O', 'W', 'S', 0 };
 
 /* DS_PARAM */
 /* externally used strings */
@@ -225,7 +249,11 @@ SQLWCHAR *dsnparams[]= {W_DSN, W_DRIVER, W_DESCRIPTION, W_SERVER,
                         W_GET_SERVER_PUBLIC_KEY,
                         W_SAVEFILE, W_RSAKEY, W_PLUGIN_DIR, W_DEFAULT_AUTH,
                         W_NO_TLS_1, W_NO_TLS_1_1, W_NO_TLS_1_2,
-                        W_SSLMODE, W_NO_DATE_OVERFLOW};
+                        W_SSLMODE, W_NO_DATE_OVERFLOW, W_READ_REPLICAS,
+                        W_KILL_ON_CLOSE, W_COMPRESSION_ALGORITHMS,
+                        W_ZSTD_COMPRESSION_LEVEL, W_HEX_BINARY_PARAMS,
+                        W_PERF_COUNTERS_FILE, W_STATEMENT_DIGESTS,
+                        W_ENABLE_LOCAL_INFILE, W_LOAD_DATA_ROWS};
 static const
 int dsnparamcnt= sizeof(dsnparams) / sizeof(SQLWCHAR *);
 /* DS_PARAM */
@@ -678,6 +706,9 @@ void ds_delete(DataSource *ds)
   x_free(ds->savefile);
   x_free(ds->plugin_dir);
   x_free(ds->default_auth);
+  x_free(ds->read_replicas);
+  x_free(ds->compression_algorithms);
+  x_free(ds->perf_counters_file);
 
   x_free(ds->name8);
   x_free(ds->driver8);
@@ -699,6 +730,9 @@ void ds_delete(DataSource *ds)
   x_free(ds->savefile8);
   x_free(ds->plugin_dir8);
   x_free(ds->default_auth8);
+  x_free(ds->read_replicas8);
+  x_free(ds->compression_algorithms8);
+  x_free(ds->perf_counters_file8);
 
   x_free(ds);
 }
@@ -889,6 +923,24 @@ void ds_map_param(DataSource *ds, const SQLWCHAR *param,
     *booldest = &ds->no_tls_1_2;
   else if (!sqlwcharcasecmp(W_NO_DATE_OVERFLOW, param))
     *booldest = &ds->no_date_overflow;
+  else if (!sqlwcharcasecmp(W_READ_REPLICAS, param))
+    *strdest= &ds->read_replicas;
+  else if (!sqlwcharcasecmp(W_KILL_ON_CLOSE, param))
+    *intdest= &ds->kill_on_close;
+  else if (!sqlwcharcasecmp(W_COMPRESSION_ALGORITHMS, param))
+    *strdest= &ds->compression_algorithms;
+  else if (!sqlwcharcasecmp(W_ZSTD_COMPRESSION_LEVEL, param))
+    *intdest= &ds->zstd_compression_level;
+  else if (!sqlwcharcasecmp(W_HEX_BINARY_PARAMS, param))
+    *booldest= &ds->hex_binary_params;
+  else if (!sqlwcharcasecmp(W_PERF_COUNTERS_FILE, param))
+    *strdest= &ds->perf_counters_file;
+  else if (!sqlwcharcasecmp(W_STATEMENT_DIGESTS, param))
+    *booldest= &ds->statement_digests;
+  else if (!sqlwcharcasecmp(W_ENABLE_LOCAL_INFILE, param))
+    *booldest= &ds->enable_local_infile;
+  else if (!sqlwcharcasecmp(W_LOAD_DATA_ROWS, param))
+    *intdest= &ds->load_data_rows;
 
   /* DS_PARAM */
 }
@@ -1381,6 +1433,18 @@ int ds_add(DataSource *ds)
   if (ds_add_intprop(ds->name, W_NO_TLS_1_1, ds->no_tls_1_1)) goto error;
   if (ds_add_intprop(ds->name, W_NO_TLS_1_2, ds->no_tls_1_2)) goto error;
   if (ds_add_intprop(ds->name, W_NO_DATE_OVERFLOW, ds->no_date_overflow)) goto error;
+  if (ds_add_strprop(ds->name, W_READ_REPLICAS, ds->read_replicas)) goto error;
+  if (ds_add_intprop(ds->name, W_KILL_ON_CLOSE, ds->kill_on_close)) goto error;
+  if (ds_add_strprop(ds->name, W_COMPRESSION_ALGORITHMS,
+                     ds->compression_algorithms)) goto error;
+  if (ds_add_intprop(ds->name, W_ZSTD_COMPRESSION_LEVEL,
+                     ds->zstd_compression_level)) goto error;
+  if (ds_add_intprop(ds->name, W_HEX_BINARY_PARAMS, ds->hex_binary_params)) goto error;
+  if (ds_add_strprop(ds->name, W_PERF_COUNTERS_FILE,
+                     ds->perf_counters_file)) goto error;
+  if (ds_add_intprop(ds->name, W_STATEMENT_DIGESTS, ds->statement_digests)) goto error;
+  if (ds_add_intprop(ds->name, W_ENABLE_LOCAL_INFILE, ds->enable_local_infile)) goto error;
+  if (ds_add_intprop(ds->name, W_LOAD_DATA_ROWS, ds->load_data_rows)) goto error;
   /* DS_PARAM */
 
   rc= 0;
@@ -91,6 +91,9 @@ typedef struct {
   SQLWCHAR *savefile;
   SQLWCHAR *plugin_dir;
   SQLWCHAR *default_auth;
+  SQLWCHAR *read_replicas;    /* host[:port][,host[:port]...] */
+  SQLWCHAR *compression_algorithms; /* zstd,zlib,uncompressed */
+  SQLWCHAR *perf_counters_file; /* appended with the counters at disconnect */
 
   unsigned int port;
   unsigned int readtimeout;
@@ -117,6 +120,9 @@ typedef struct {
   SQLCHAR *savefile8;
   SQLCHAR *plugin_dir8;
   SQLCHAR *default_auth8;
+  SQLCHAR *read_replicas8;
+  SQLCHAR *compression_algorithms8;
+  SQLCHAR *perf_counters_file8;
 
   /*  */
   BOOL return_matching_rows;
@@ -157,6 +163,11 @@ typedef struct {
   /* SSL */
   unsigned int sslverify;
   unsigned int cursor_prefetch_number;
+  unsigned int kill_on_close;   /* rows to drain from a streamed result before
+                                   killing the query on SQLCloseCursor() */
+  unsigned int zstd_compression_level;
+  unsigned int load_data_rows;  /* parameter arrays of INSERT from this many
+                                   rows up are sent with LOAD DATA LOCAL */
   BOOL no_ssps;
 
   BOOL no_tls_1;
@@ -164,6 +175,9 @@ typedef struct {
   BOOL no_tls_1_2;
 
   BOOL no_date_overflow;
+  BOOL hex_binary_params;   /* send binary parameters as X'..' literals */
+  BOOL statement_digests;   /* aggregate statistics per statement digest */
+  BOOL enable_local_infile; /* allow LOAD DATA LOCAL INFILE */
 } DataSource;
 
 /* perhaps that is a good idea to have const ds object with defaults */
@@ -35,6 +35,9 @@
 
 #include "stringutil.h"
 
+#include <atomic>
+#include <mutex>
+
 
 CHARSET_INFO *utf8_charset_info= NULL;
 
@@ -495,6 +498,300 @@ SQLINTEGER sqlwchar_as_sqlchar_buf(CHARSET_INFO *charset_info,
 }
 
 
+/*
+  Transcoders convert straight into a single-byte character set, from
+  another single-byte one or from UTF-8, with a lookup table built the first
+  time the pair of character sets is used. The tables are made with the
+  charsets' own mb_wc() and wc_mb(), so they give the same result as going
+  through Unicode. Characters that don't map one to one, and anything the
+  table can't tell, still go through mb_wc() and wc_mb().
+*/
+
+/* Table entry of a character that has to go through Unicode */
+#define TRANSCODE_SLOW 0x100
+
+struct transcoder
+{
+  uint        from_number, to_number;
+  CHARSET_INFO *from_cs, *to_cs;
+  my_bool     from_utf8;
+  my_bool     ascii;              /* 0x00-0x7f are the same in both */
+  uint16      single[256];        /* by source byte, from single-byte */
+  uint16      *page[256];         /* by code point >> 8, from UTF-8 BMP */
+  TRANSCODER  *next;
+};
+
+static std::atomic<TRANSCODER *> transcoders(nullptr);
+static std::mutex transcoders_lock;
+
+
+static uint32
+convert_generic(char *to, uint32 to_length, CHARSET_INFO *to_cs,
+                const char *from, uint32 from_length, CHARSET_INFO *from_cs,
+                uint32 *used_bytes, uint32 *used_chars, uint *errors);
+
+
+static void transcoder_free(TRANSCODER *tc)
+{
+  uint i;
+
+  for (i= 0; i < 256; ++i)
+  {
+    free(tc->page[i]);
+  }
+  free(tc);
+}
+
+
+/* The single byte for the code point, or TRANSCODE_SLOW */
+static uint16 transcode_wc(CHARSET_INFO *to_cs, my_wc_t wc)
+{
+  uchar out[8];
+
+  if ((*to_cs->cset->wc_mb)(to_cs, wc, out, out + sizeof(out)) == 1)
+  {
+    return out[0];
+  }
+
+  return TRANSCODE_SLOW;
+}
+
+
+static TRANSCODER *transcoder_new(CHARSET_INFO *from_cs, CHARSET_INFO *to_cs)
+{
+  TRANSCODER *tc= (TRANSCODER *)calloc(1, sizeof(TRANSCODER));
+  my_wc_t wc;
+  uint i, j;
+
+  if (!tc)
+  {
+    return NULL;
+  }
+
+  tc->from_number= from_cs->number;
+  tc->to_number= to_cs->number;
+  tc->from_cs= from_cs;
+  tc->to_cs= to_cs;
+  tc->from_utf8= is_utf8_charset(from_cs->number);
+
+  for (i= 0; i < 256; ++i)
+  {
+    uchar byte= (uchar)i;
+
+    tc->single[i]= TRANSCODE_SLOW;
+
+    if (!tc->from_utf8)
+    {
+      if ((*from_cs->cset->mb_wc)(from_cs, &wc, &byte, &byte + 1) == 1)
+      {
+        tc->single[i]= transcode_wc(to_cs, wc);
+      }
+      continue;
+    }
+
+    /* From UTF-8 the table is the inverse of the target character set */
+    if ((*to_cs->cset->mb_wc)(to_cs, &wc, &byte, &byte + 1) != 1 ||
+        wc > 0xffff || transcode_wc(to_cs, wc) != i)
+    {
+      continue;
+    }
+
+    if (!tc->page[wc >> 8])
+    {
+      if (!(tc->page[wc >> 8]= (uint16 *)malloc(256 * sizeof(uint16))))
+      {
+        transcoder_free(tc);
+        return NULL;
+      }
+
+      for (j= 0; j < 256; ++j)
+      {
+        tc->page[wc >> 8][j]= TRANSCODE_SLOW;
+      }
+    }
+
+    tc->page[wc >> 8][wc & 0xff]= (uint16)i;
+  }
+
+  tc->ascii= TRUE;
+
+  for (i= 0; i < 0x80; ++i)
+  {
+    if ((tc->from_utf8 ? (tc->page[0] ? tc->page[0][i] : TRANSCODE_SLOW) :
+                         tc->single[i]) != i)
+    {
+      tc->ascii= FALSE;
+    }
+  }
+
+  return tc;
+}
+
+
+/**
+  Returns the transcoder for a pair of character sets, creating it on the
+  first use. Only conversions into a single-byte character set, from
+  another one or from UTF-8, have transcoders.
+
+  @return The transcoder, or NULL if the pair has none
+*/
+const TRANSCODER *get_transcoder(CHARSET_INFO *from_cs, CHARSET_INFO *to_cs)
+{
+  TRANSCODER *tc;
+
+  if (to_cs->mbmaxlen != 1 || from_cs->number == to_cs->number ||
+      (from_cs->mbmaxlen != 1 && !is_utf8_charset(from_cs->number)))
+  {
+    return NULL;
+  }
+
+  /* Transcoders are only ever added at the head, and never freed */
+  for (tc= transcoders.load(std::memory_order_acquire); tc; tc= tc->next)
+  {
+    if (tc->from_number == from_cs->number && tc->to_number == to_cs->number)
+    {
+      return tc;
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(transcoders_lock);
+
+  for (tc= transcoders.load(std::memory_order_relaxed); tc; tc= tc->next)
+  {
+    if (tc->from_number == from_cs->number && tc->to_number == to_cs->number)
+    {
+      return tc;
+    }
+  }
+
+  if ((tc= transcoder_new(from_cs, to_cs)))
+  {
+    tc->next= transcoders.load(std::memory_order_relaxed);
+    transcoders.store(tc, std::memory_order_release);
+  }
+
+  return tc;
+}
+
+
+/**
+  copy_and_convert() with a transcoder. Stops early, like it, when the
+  source ends in the middle of a character.
+*/
+uint32
+transcode(const TRANSCODER *tc, char *to, uint32 to_length,
+          const char *from, uint32 from_length,
+          uint32 *used_bytes, uint32 *used_chars, uint *errors)
+{
+  const uchar *src= (const uchar *)from, *src_end= src + from_length;
+  uchar *dst= (uchar *)to, *dst_end= dst + to_length;
+  uint32 chars= 0;
+  uint error_count= 0;
+
+  while (src < src_end && dst < dst_end)
+  {
+    uint c= *src, length= 1, out;
+
+    if (c < 0x80 && tc->ascii)
+    {
+      out= c;
+    }
+    else if (!tc->from_utf8)
+    {
+      out= tc->single[c];
+    }
+    else
+    {
+      my_wc_t wc= 0;
+
+      out= TRANSCODE_SLOW;
+
+      /* Well-formed 2 and 3 byte sequences, the rest is left to mb_wc() */
+      if (c < 0x80)
+      {
+        wc= c;
+      }
+      else if (c >= 0xc2 && c <= 0xdf && src_end - src >= 2 &&
+               (src[1] & 0xc0) == 0x80)
+      {
+        wc= ((c & 0x1f) << 6) | (src[1] & 0x3f);
+        length= 2;
+      }
+      else if (c >= 0xe0 && c <= 0xef && src_end - src >= 3 &&
+               (src[1] & 0xc0) == 0x80 && (src[2] & 0xc0) == 0x80)
+      {
+        wc= ((c & 0x0f) << 12) | ((src[1] & 0x3f) << 6) | (src[2] & 0x3f);
+        length= 3;
+
+        /* Overlong forms and surrogates */
+        if (wc < 0x800 || (wc >= 0xd800 && wc <= 0xdfff))
+        {
+          length= 0;
+        }
+      }
+      else
+      {
+        length= 0;
+      }
+
+      if (length && tc->page[wc >> 8])
+      {
+        out= tc->page[wc >> 8][wc & 0xff];
+      }
+    }
+
+    if (out == TRANSCODE_SLOW)
+    {
+      /* The same steps as convert_generic(), for one character */
+      my_wc_t wc;
+      int cnvres= (*tc->from_cs->cset->mb_wc)(tc->from_cs, &wc, src, src_end);
+
+      if (cnvres == MY_CS_ILSEQ)
+      {
+        ++error_count;
+        cnvres= 1;
+        wc= '?';
+      }
+      else if (cnvres < 0 && cnvres > MY_CS_TOOSMALL)
+      {
+        ++error_count;
+        cnvres= -cnvres;
+        wc= '?';
+      }
+      else if (cnvres < 0)
+      {
+        break; /* Not enough characters */
+      }
+
+      if ((*tc->to_cs->cset->wc_mb)(tc->to_cs, wc, dst, dst_end) <= 0)
+      {
+        if (wc == '?')
+          break;
+
+        ++error_count;
+        if ((*tc->to_cs->cset->wc_mb)(tc->to_cs, '?', dst, dst_end) <= 0)
+          break;
+      }
+      ++dst;
+      src+= cnvres;
+    }
+    else
+    {
+      *dst++= (uchar)out;
+      src+= length;
+    }
+    ++chars;
+  }
+
+  *used_bytes= (uint32)(src - (const uchar *)from);
+  *used_chars= chars;
+  if (errors)
+    *errors+= error_count;
+
+  return (uint32)(dst - (uchar *)to);
+}
+
+
 /**
   Copy a string from one character set to another. Taken from sql_string.cc
   in the MySQL Server source code, since we don't export this functionality
@@ -520,6 +817,28 @@ uint32
 copy_and_convert(char *to, uint32 to_length, CHARSET_INFO *to_cs,
                  const char *from, uint32 from_length, CHARSET_INFO *from_cs,
                  uint32 *used_bytes, uint32 *used_chars, uint *errors)
+{
+  const TRANSCODER *tc= get_transcoder(from_cs, to_cs);
+
+  if (tc)
+  {
+    return transcode(tc, to, to_length, from, from_length,
+                     used_bytes, used_chars, errors);
+  }
+
+  return convert_generic(to, to_length, to_cs, from, from_length, from_cs,
+                         used_bytes, used_chars, errors);
+}
+
+
+/*
+  copy_and_convert() through the Unicode conversion functions of the two
+  character sets
+*/
+static uint32
+convert_generic(char *to, uint32 to_length, CHARSET_INFO *to_cs,
+                const char *from, uint32 from_length, CHARSET_INFO *from_cs,
+                uint32 *used_bytes, uint32 *used_chars, uint *errors)
 {
   int         from_cnvres, to_cnvres;
   my_wc_t     wc;
@@ -98,6 +98,14 @@ copy_and_convert(char *to, uint32 to_length, CHARSET_INFO *to_cs,
                  const char *from, uint32 from_length, CHARSET_INFO *from_cs,
                  uint32 *used_bytes, uint32 *used_chars, uint *errors);
 
+typedef struct transcoder TRANSCODER;
+
+const TRANSCODER *get_transcoder(CHARSET_INFO *from_cs, CHARSET_INFO *to_cs);
+uint32
+transcode(const TRANSCODER *tc, char *to, uint32 to_length,
+          const char *from, uint32 from_length,
+          uint32 *used_bytes, uint32 *used_chars, uint *errors);
+
 
 /* wcs* replacements */
 int sqlwcharcasecmp(const SQLWCHAR *s1, const SQLWCHAR *s2);